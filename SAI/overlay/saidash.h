@@ -135,6 +135,13 @@ typedef enum _sai_inbound_acl_stage3_entry_action_t
  */
 typedef struct _sai_direction_lookup_entry_t
 {
+    /**
+     * @brief Switch ID
+     *
+     * @objects SAI_OBJECT_TYPE_SWITCH
+     */
+     sai_object_id_t switch_id;
+
     /**
      * @brief Exact matched key vni
      */
@@ -174,6 +181,22 @@ typedef enum _sai_direction_lookup_entry_attr_t
 } sai_direction_lookup_entry_attr_t;
 
 
+/**
+ * @brief Hash behind the outer UDP source port of the VXLAN encap
+ */
+typedef enum _sai_dash_encap_sport_hash_t
+{
+    /** The lowest port of the range for every flow */
+    SAI_DASH_ENCAP_SPORT_HASH_NONE,
+
+    /** CRC-32C of the inner 5-tuple */
+    SAI_DASH_ENCAP_SPORT_HASH_CRC32,
+
+    /** Toeplitz hash of the inner addresses and ports, with the default RSS key */
+    SAI_DASH_ENCAP_SPORT_HASH_TOEPLITZ,
+
+} sai_dash_encap_sport_hash_t;
+
 /**
  * @brief Attribute ID for appliance
  */
@@ -212,6 +235,60 @@ typedef enum _sai_appliance_attr_t
      */
     SAI_APPLIANCE_ATTR_IP,
 
+    /**
+     * @brief Idle timeout of TCP connections in milliseconds, 0 for none
+     *
+     * @type sai_uint32_t
+     * @flags CREATE_AND_SET
+     * @default 240000
+     */
+    SAI_APPLIANCE_ATTR_TCP_FLOW_TIMEOUT,
+
+    /**
+     * @brief Idle timeout of UDP flows in milliseconds, 0 for none
+     *
+     * @type sai_uint32_t
+     * @flags CREATE_AND_SET
+     * @default 1000
+     */
+    SAI_APPLIANCE_ATTR_UDP_FLOW_TIMEOUT,
+
+    /**
+     * @brief Hash of the inner headers that picks the outer UDP source port of the VXLAN encap
+     *
+     * @type sai_dash_encap_sport_hash_t
+     * @flags CREATE_AND_SET
+     * @default SAI_DASH_ENCAP_SPORT_HASH_CRC32
+     */
+    SAI_APPLIANCE_ATTR_ENCAP_SPORT_HASH,
+
+    /**
+     * @brief Lowest outer UDP source port of the VXLAN encap
+     *
+     * @type sai_uint16_t
+     * @flags CREATE_AND_SET
+     * @default 49152
+     */
+    SAI_APPLIANCE_ATTR_ENCAP_SPORT_MIN,
+
+    /**
+     * @brief Highest outer UDP source port of the VXLAN encap
+     *
+     * @type sai_uint16_t
+     * @flags CREATE_AND_SET
+     * @default 65535
+     */
+    SAI_APPLIANCE_ATTR_ENCAP_SPORT_MAX,
+
+    /**
+     * @brief Drop packets whose inner IPv4, TCP or UDP checksum is wrong
+     *
+     * @type bool
+     * @flags CREATE_AND_SET
+     * @default false
+     */
+    SAI_APPLIANCE_ATTR_VERIFY_INNER_CHECKSUM,
+
     /**
      * @brief End of attributes
      */
@@ -231,6 +308,13 @@ typedef enum _sai_appliance_attr_t
  */
 typedef struct _sai_outbound_eni_lookup_from_vm_entry_t
 {
+    /**
+     * @brief Switch ID
+     *
+     * @objects SAI_OBJECT_TYPE_SWITCH
+     */
+     sai_object_id_t switch_id;
+
     /**
      * @brief Exact matched key smac
      */
@@ -275,6 +359,13 @@ typedef enum _sai_outbound_eni_lookup_from_vm_entry_attr_t
  */
 typedef struct _sai_outbound_eni_to_vni_entry_t
 {
+    /**
+     * @brief Switch ID
+     *
+     * @objects SAI_OBJECT_TYPE_SWITCH
+     */
+     sai_object_id_t switch_id;
+
     /**
      * @brief Exact matched key eni
      */
@@ -320,29 +411,21 @@ typedef enum _sai_outbound_eni_to_vni_entry_attr_t
 typedef struct _sai_outbound_acl_stage1_entry_t
 {
     /**
-     * @brief List matched key dip
-     */
-     sai_ip_address_t dip;
-
-    /**
-     * @brief List matched key sip
-     */
-     sai_ip_address_t sip;
-
-    /**
-     * @brief List matched key protocol
+     * @brief Switch ID
+     *
+     * @objects SAI_OBJECT_TYPE_SWITCH
      */
-     sai_ip_address_t protocol;
+     sai_object_id_t switch_id;
 
     /**
-     * @brief Range_list matched key sport
+     * @brief Exact matched key eni
      */
-     sai_uint16_t sport;
+     sai_uint16_t eni;
 
     /**
-     * @brief Range_list matched key dport
+     * @brief Rule priority, lower values are matched first
      */
-     sai_uint16_t dport;
+     sai_uint32_t priority;
 } sai_outbound_acl_stage1_entry_t;
 /**
  * @brief Attribute ID for outbound_acl_stage1_entry
@@ -362,6 +445,56 @@ typedef enum _sai_outbound_acl_stage1_entry_attr_t
      */
     SAI_OUTBOUND_ACL_STAGE1_ENTRY_ATTR_ACTION = SAI_OUTBOUND_ACL_STAGE1_ENTRY_ATTR_START,
 
+    /**
+     * @brief List matched key dip
+     *
+     * An empty list matches any value.
+     *
+     * @type sai_ip_prefix_list_t
+     * @flags MANDATORY_ON_CREATE | CREATE_ONLY
+     */
+    SAI_OUTBOUND_ACL_STAGE1_ENTRY_ATTR_DIP,
+
+    /**
+     * @brief List matched key sip
+     *
+     * An empty list matches any value.
+     *
+     * @type sai_ip_prefix_list_t
+     * @flags MANDATORY_ON_CREATE | CREATE_ONLY
+     */
+    SAI_OUTBOUND_ACL_STAGE1_ENTRY_ATTR_SIP,
+
+    /**
+     * @brief List matched key protocol
+     *
+     * An empty list matches any value.
+     *
+     * @type sai_u8_list_t
+     * @flags MANDATORY_ON_CREATE | CREATE_ONLY
+     */
+    SAI_OUTBOUND_ACL_STAGE1_ENTRY_ATTR_PROTOCOL,
+
+    /**
+     * @brief Range_list matched key sport
+     *
+     * An empty list matches any value.
+     *
+     * @type sai_u16_range_list_t
+     * @flags MANDATORY_ON_CREATE | CREATE_ONLY
+     */
+    SAI_OUTBOUND_ACL_STAGE1_ENTRY_ATTR_SPORT,
+
+    /**
+     * @brief Range_list matched key dport
+     *
+     * An empty list matches any value.
+     *
+     * @type sai_u16_range_list_t
+     * @flags MANDATORY_ON_CREATE | CREATE_ONLY
+     */
+    SAI_OUTBOUND_ACL_STAGE1_ENTRY_ATTR_DPORT,
+
     /**
      * @brief End of attributes
      */
@@ -382,29 +515,21 @@ typedef enum _sai_outbound_acl_stage1_entry_attr_t
 typedef struct _sai_outbound_acl_stage2_entry_t
 {
     /**
-     * @brief List matched key dip
-     */
-     sai_ip_address_t dip;
-
-    /**
-     * @brief List matched key sip
-     */
-     sai_ip_address_t sip;
-
-    /**
-     * @brief List matched key protocol
+     * @brief Switch ID
+     *
+     * @objects SAI_OBJECT_TYPE_SWITCH
      */
-     sai_ip_address_t protocol;
+     sai_object_id_t switch_id;
 
     /**
-     * @brief Range_list matched key sport
+     * @brief Exact matched key eni
      */
-     sai_uint16_t sport;
+     sai_uint16_t eni;
 
     /**
-     * @brief Range_list matched key dport
+     * @brief Rule priority, lower values are matched first
      */
-     sai_uint16_t dport;
+     sai_uint32_t priority;
 } sai_outbound_acl_stage2_entry_t;
 /**
  * @brief Attribute ID for outbound_acl_stage2_entry
@@ -424,6 +549,56 @@ typedef enum _sai_outbound_acl_stage2_entry_attr_t
      */
     SAI_OUTBOUND_ACL_STAGE2_ENTRY_ATTR_ACTION = SAI_OUTBOUND_ACL_STAGE2_ENTRY_ATTR_START,
 
+    /**
+     * @brief List matched key dip
+     *
+     * An empty list matches any value.
+     *
+     * @type sai_ip_prefix_list_t
+     * @flags MANDATORY_ON_CREATE | CREATE_ONLY
+     */
+    SAI_OUTBOUND_ACL_STAGE2_ENTRY_ATTR_DIP,
+
+    /**
+     * @brief List matched key sip
+     *
+     * An empty list matches any value.
+     *
+     * @type sai_ip_prefix_list_t
+     * @flags MANDATORY_ON_CREATE | CREATE_ONLY
+     */
+    SAI_OUTBOUND_ACL_STAGE2_ENTRY_ATTR_SIP,
+
+    /**
+     * @brief List matched key protocol
+     *
+     * An empty list matches any value.
+     *
+     * @type sai_u8_list_t
+     * @flags MANDATORY_ON_CREATE | CREATE_ONLY
+     */
+    SAI_OUTBOUND_ACL_STAGE2_ENTRY_ATTR_PROTOCOL,
+
+    /**
+     * @brief Range_list matched key sport
+     *
+     * An empty list matches any value.
+     *
+     * @type sai_u16_range_list_t
+     * @flags MANDATORY_ON_CREATE | CREATE_ONLY
+     */
+    SAI_OUTBOUND_ACL_STAGE2_ENTRY_ATTR_SPORT,
+
+    /**
+     * @brief Range_list matched key dport
+     *
+     * An empty list matches any value.
+     *
+     * @type sai_u16_range_list_t
+     * @flags MANDATORY_ON_CREATE | CREATE_ONLY
+     */
+    SAI_OUTBOUND_ACL_STAGE2_ENTRY_ATTR_DPORT,
+
     /**
      * @brief End of attributes
      */
@@ -444,29 +619,21 @@ typedef enum _sai_outbound_acl_stage2_entry_attr_t
 typedef struct _sai_outbound_acl_stage3_entry_t
 {
     /**
-     * @brief List matched key dip
-     */
-     sai_ip_address_t dip;
-
-    /**
-     * @brief List matched key sip
-     */
-     sai_ip_address_t sip;
-
-    /**
-     * @brief List matched key protocol
+     * @brief Switch ID
+     *
+     * @objects SAI_OBJECT_TYPE_SWITCH
      */
-     sai_ip_address_t protocol;
+     sai_object_id_t switch_id;
 
     /**
-     * @brief Range_list matched key sport
+     * @brief Exact matched key eni
      */
-     sai_uint16_t sport;
+     sai_uint16_t eni;
 
     /**
-     * @brief Range_list matched key dport
+     * @brief Rule priority, lower values are matched first
      */
-     sai_uint16_t dport;
+     sai_uint32_t priority;
 } sai_outbound_acl_stage3_entry_t;
 /**
  * @brief Attribute ID for outbound_acl_stage3_entry
@@ -486,6 +653,56 @@ typedef enum _sai_outbound_acl_stage3_entry_attr_t
      */
     SAI_OUTBOUND_ACL_STAGE3_ENTRY_ATTR_ACTION = SAI_OUTBOUND_ACL_STAGE3_ENTRY_ATTR_START,
 
+    /**
+     * @brief List matched key dip
+     *
+     * An empty list matches any value.
+     *
+     * @type sai_ip_prefix_list_t
+     * @flags MANDATORY_ON_CREATE | CREATE_ONLY
+     */
+    SAI_OUTBOUND_ACL_STAGE3_ENTRY_ATTR_DIP,
+
+    /**
+     * @brief List matched key sip
+     *
+     * An empty list matches any value.
+     *
+     * @type sai_ip_prefix_list_t
+     * @flags MANDATORY_ON_CREATE | CREATE_ONLY
+     */
+    SAI_OUTBOUND_ACL_STAGE3_ENTRY_ATTR_SIP,
+
+    /**
+     * @brief List matched key protocol
+     *
+     * An empty list matches any value.
+     *
+     * @type sai_u8_list_t
+     * @flags MANDATORY_ON_CREATE | CREATE_ONLY
+     */
+    SAI_OUTBOUND_ACL_STAGE3_ENTRY_ATTR_PROTOCOL,
+
+    /**
+     * @brief Range_list matched key sport
+     *
+     * An empty list matches any value.
+     *
+     * @type sai_u16_range_list_t
+     * @flags MANDATORY_ON_CREATE | CREATE_ONLY
+     */
+    SAI_OUTBOUND_ACL_STAGE3_ENTRY_ATTR_SPORT,
+
+    /**
+     * @brief Range_list matched key dport
+     *
+     * An empty list matches any value.
+     *
+     * @type sai_u16_range_list_t
+     * @flags MANDATORY_ON_CREATE | CREATE_ONLY
+     */
+    SAI_OUTBOUND_ACL_STAGE3_ENTRY_ATTR_DPORT,
+
     /**
      * @brief End of attributes
      */
@@ -505,6 +722,13 @@ typedef enum _sai_outbound_acl_stage3_entry_attr_t
  */
 typedef struct _sai_outbound_routing_entry_t
 {
+    /**
+     * @brief Switch ID
+     *
+     * @objects SAI_OBJECT_TYPE_SWITCH
+     */
+     sai_object_id_t switch_id;
+
     /**
      * @brief Exact matched key eni
      */
@@ -513,7 +737,7 @@ typedef struct _sai_outbound_routing_entry_t
     /**
      * @brief LPM matched key destination
      */
-      destination;
+     sai_ip_prefix_t destination;
 } sai_outbound_routing_entry_t;
 /**
  * @brief Attribute ID for outbound_routing_entry
@@ -535,6 +759,15 @@ typedef enum _sai_outbound_routing_entry_attr_t
      */
     SAI_OUTBOUND_ROUTING_ENTRY_ATTR_DEST_VNET_VNI,
 
+    /**
+     * @brief Slot of the entry's routing_counter, its entry_id in
+     * get_outbound_counters_snapshot
+     *
+     * @type sai_uint32_t
+     * @flags READ_ONLY
+     */
+    SAI_OUTBOUND_ROUTING_ENTRY_ATTR_COUNTER_ID,
+
     /**
      * @brief End of attributes
      */
@@ -554,6 +787,13 @@ typedef enum _sai_outbound_routing_entry_attr_t
  */
 typedef struct _sai_outbound_ca_to_pa_entry_t
 {
+    /**
+     * @brief Switch ID
+     *
+     * @objects SAI_OBJECT_TYPE_SWITCH
+     */
+     sai_object_id_t switch_id;
+
     /**
      * @brief Exact matched key dest_vni
      */
@@ -602,6 +842,15 @@ typedef enum _sai_outbound_ca_to_pa_entry_attr_t
      */
     SAI_OUTBOUND_CA_TO_PA_ENTRY_ATTR_USE_DST_VNI,
 
+    /**
+     * @brief Slot of the entry's ca_to_pa_counter, its entry_id in
+     * get_outbound_counters_snapshot
+     *
+     * @type sai_uint32_t
+     * @flags READ_ONLY
+     */
+    SAI_OUTBOUND_CA_TO_PA_ENTRY_ATTR_COUNTER_ID,
+
     /**
      * @brief End of attributes
      */
@@ -615,12 +864,70 @@ typedef enum _sai_outbound_ca_to_pa_entry_attr_t
 
 } sai_outbound_ca_to_pa_entry_attr_t;
 
+/**
+ * @brief A direct counter in get_outbound_counters_snapshot
+ */
+typedef struct _sai_dash_counter_t
+{
+    /** Counter slot of the entry, its COUNTER_ID attribute */
+    sai_uint32_t entry_id;
+
+    /** Packets that hit the entry */
+    sai_uint64_t packets;
+
+    /** Bytes of the packets that hit the entry, as received */
+    sai_uint64_t bytes;
+
+} sai_dash_counter_t;
+
+/**
+ * @brief An ACL_STAGE table, in the ACL rule counter functions
+ */
+typedef enum _sai_dash_acl_stage_t
+{
+    SAI_DASH_ACL_STAGE_OUTBOUND_STAGE1,
+
+    SAI_DASH_ACL_STAGE_OUTBOUND_STAGE2,
+
+    SAI_DASH_ACL_STAGE_OUTBOUND_STAGE3,
+
+    SAI_DASH_ACL_STAGE_INBOUND_STAGE1,
+
+    SAI_DASH_ACL_STAGE_INBOUND_STAGE2,
+
+    SAI_DASH_ACL_STAGE_INBOUND_STAGE3,
+
+} sai_dash_acl_stage_t;
+
+/**
+ * @brief The direct counter of an ACL rule
+ */
+typedef struct _sai_dash_acl_rule_counter_t
+{
+    /** Priority of the rule, which with the ENI is its key */
+    sai_uint32_t priority;
+
+    /** Packets the rule classified */
+    sai_uint64_t packets;
+
+    /** Bytes of the packets the rule classified, as received */
+    sai_uint64_t bytes;
+
+} sai_dash_acl_rule_counter_t;
+
 
 /**
  * @brief inbound_eni_lookup_to_vm_entry
  */
 typedef struct _sai_inbound_eni_lookup_to_vm_entry_t
 {
+    /**
+     * @brief Switch ID
+     *
+     * @objects SAI_OBJECT_TYPE_SWITCH
+     */
+     sai_object_id_t switch_id;
+
     /**
      * @brief Exact matched key dmac
      */
@@ -665,6 +972,13 @@ typedef enum _sai_inbound_eni_lookup_to_vm_entry_attr_t
  */
 typedef struct _sai_inbound_eni_to_vm_entry_t
 {
+    /**
+     * @brief Switch ID
+     *
+     * @objects SAI_OBJECT_TYPE_SWITCH
+     */
+     sai_object_id_t switch_id;
+
     /**
      * @brief Exact matched key eni
      */
@@ -762,29 +1076,21 @@ typedef enum _sai_inbound_vm_attr_t
 typedef struct _sai_inbound_acl_stage1_entry_t
 {
     /**
-     * @brief List matched key dip
-     */
-     sai_ip_address_t dip;
-
-    /**
-     * @brief List matched key sip
-     */
-     sai_ip_address_t sip;
-
-    /**
-     * @brief List matched key protocol
+     * @brief Switch ID
+     *
+     * @objects SAI_OBJECT_TYPE_SWITCH
      */
-     sai_ip_address_t protocol;
+     sai_object_id_t switch_id;
 
     /**
-     * @brief Range_list matched key sport
+     * @brief Exact matched key eni
      */
-     sai_uint16_t sport;
+     sai_uint16_t eni;
 
     /**
-     * @brief Range_list matched key dport
+     * @brief Rule priority, lower values are matched first
      */
-     sai_uint16_t dport;
+     sai_uint32_t priority;
 } sai_inbound_acl_stage1_entry_t;
 /**
  * @brief Attribute ID for inbound_acl_stage1_entry
@@ -804,6 +1110,56 @@ typedef enum _sai_inbound_acl_stage1_entry_attr_t
      */
     SAI_INBOUND_ACL_STAGE1_ENTRY_ATTR_ACTION = SAI_INBOUND_ACL_STAGE1_ENTRY_ATTR_START,
 
+    /**
+     * @brief List matched key dip
+     *
+     * An empty list matches any value.
+     *
+     * @type sai_ip_prefix_list_t
+     * @flags MANDATORY_ON_CREATE | CREATE_ONLY
+     */
+    SAI_INBOUND_ACL_STAGE1_ENTRY_ATTR_DIP,
+
+    /**
+     * @brief List matched key sip
+     *
+     * An empty list matches any value.
+     *
+     * @type sai_ip_prefix_list_t
+     * @flags MANDATORY_ON_CREATE | CREATE_ONLY
+     */
+    SAI_INBOUND_ACL_STAGE1_ENTRY_ATTR_SIP,
+
+    /**
+     * @brief List matched key protocol
+     *
+     * An empty list matches any value.
+     *
+     * @type sai_u8_list_t
+     * @flags MANDATORY_ON_CREATE | CREATE_ONLY
+     */
+    SAI_INBOUND_ACL_STAGE1_ENTRY_ATTR_PROTOCOL,
+
+    /**
+     * @brief Range_list matched key sport
+     *
+     * An empty list matches any value.
+     *
+     * @type sai_u16_range_list_t
+     * @flags MANDATORY_ON_CREATE | CREATE_ONLY
+     */
+    SAI_INBOUND_ACL_STAGE1_ENTRY_ATTR_SPORT,
+
+    /**
+     * @brief Range_list matched key dport
+     *
+     * An empty list matches any value.
+     *
+     * @type sai_u16_range_list_t
+     * @flags MANDATORY_ON_CREATE | CREATE_ONLY
+     */
+    SAI_INBOUND_ACL_STAGE1_ENTRY_ATTR_DPORT,
+
     /**
      * @brief End of attributes
      */
@@ -824,29 +1180,21 @@ typedef enum _sai_inbound_acl_stage1_entry_attr_t
 typedef struct _sai_inbound_acl_stage2_entry_t
 {
     /**
-     * @brief List matched key dip
-     */
-     sai_ip_address_t dip;
-
-    /**
-     * @brief List matched key sip
-     */
-     sai_ip_address_t sip;
-
-    /**
-     * @brief List matched key protocol
+     * @brief Switch ID
+     *
+     * @objects SAI_OBJECT_TYPE_SWITCH
      */
-     sai_ip_address_t protocol;
+     sai_object_id_t switch_id;
 
     /**
-     * @brief Range_list matched key sport
+     * @brief Exact matched key eni
      */
-     sai_uint16_t sport;
+     sai_uint16_t eni;
 
     /**
-     * @brief Range_list matched key dport
+     * @brief Rule priority, lower values are matched first
      */
-     sai_uint16_t dport;
+     sai_uint32_t priority;
 } sai_inbound_acl_stage2_entry_t;
 /**
  * @brief Attribute ID for inbound_acl_stage2_entry
@@ -866,6 +1214,56 @@ typedef enum _sai_inbound_acl_stage2_entry_attr_t
      */
     SAI_INBOUND_ACL_STAGE2_ENTRY_ATTR_ACTION = SAI_INBOUND_ACL_STAGE2_ENTRY_ATTR_START,
 
+    /**
+     * @brief List matched key dip
+     *
+     * An empty list matches any value.
+     *
+     * @type sai_ip_prefix_list_t
+     * @flags MANDATORY_ON_CREATE | CREATE_ONLY
+     */
+    SAI_INBOUND_ACL_STAGE2_ENTRY_ATTR_DIP,
+
+    /**
+     * @brief List matched key sip
+     *
+     * An empty list matches any value.
+     *
+     * @type sai_ip_prefix_list_t
+     * @flags MANDATORY_ON_CREATE | CREATE_ONLY
+     */
+    SAI_INBOUND_ACL_STAGE2_ENTRY_ATTR_SIP,
+
+    /**
+     * @brief List matched key protocol
+     *
+     * An empty list matches any value.
+     *
+     * @type sai_u8_list_t
+     * @flags MANDATORY_ON_CREATE | CREATE_ONLY
+     */
+    SAI_INBOUND_ACL_STAGE2_ENTRY_ATTR_PROTOCOL,
+
+    /**
+     * @brief Range_list matched key sport
+     *
+     * An empty list matches any value.
+     *
+     * @type sai_u16_range_list_t
+     * @flags MANDATORY_ON_CREATE | CREATE_ONLY
+     */
+    SAI_INBOUND_ACL_STAGE2_ENTRY_ATTR_SPORT,
+
+    /**
+     * @brief Range_list matched key dport
+     *
+     * An empty list matches any value.
+     *
+     * @type sai_u16_range_list_t
+     * @flags MANDATORY_ON_CREATE | CREATE_ONLY
+     */
+    SAI_INBOUND_ACL_STAGE2_ENTRY_ATTR_DPORT,
+
     /**
      * @brief End of attributes
      */
@@ -879,36 +1277,28 @@ typedef enum _sai_inbound_acl_stage2_entry_attr_t
 
 } sai_inbound_acl_stage2_entry_attr_t;
 
-
-/**
- * @brief inbound_acl_stage3_entry
- */
-typedef struct _sai_inbound_acl_stage3_entry_t
-{
-    /**
-     * @brief List matched key dip
-     */
-     sai_ip_address_t dip;
-
-    /**
-     * @brief List matched key sip
-     */
-     sai_ip_address_t sip;
-
+
+/**
+ * @brief inbound_acl_stage3_entry
+ */
+typedef struct _sai_inbound_acl_stage3_entry_t
+{
     /**
-     * @brief List matched key protocol
+     * @brief Switch ID
+     *
+     * @objects SAI_OBJECT_TYPE_SWITCH
      */
-     sai_ip_address_t protocol;
+     sai_object_id_t switch_id;
 
     /**
-     * @brief Range_list matched key sport
+     * @brief Exact matched key eni
      */
-     sai_uint16_t sport;
+     sai_uint16_t eni;
 
     /**
-     * @brief Range_list matched key dport
+     * @brief Rule priority, lower values are matched first
      */
-     sai_uint16_t dport;
+     sai_uint32_t priority;
 } sai_inbound_acl_stage3_entry_t;
 /**
  * @brief Attribute ID for inbound_acl_stage3_entry
@@ -928,6 +1318,56 @@ typedef enum _sai_inbound_acl_stage3_entry_attr_t
      */
     SAI_INBOUND_ACL_STAGE3_ENTRY_ATTR_ACTION = SAI_INBOUND_ACL_STAGE3_ENTRY_ATTR_START,
 
+    /**
+     * @brief List matched key dip
+     *
+     * An empty list matches any value.
+     *
+     * @type sai_ip_prefix_list_t
+     * @flags MANDATORY_ON_CREATE | CREATE_ONLY
+     */
+    SAI_INBOUND_ACL_STAGE3_ENTRY_ATTR_DIP,
+
+    /**
+     * @brief List matched key sip
+     *
+     * An empty list matches any value.
+     *
+     * @type sai_ip_prefix_list_t
+     * @flags MANDATORY_ON_CREATE | CREATE_ONLY
+     */
+    SAI_INBOUND_ACL_STAGE3_ENTRY_ATTR_SIP,
+
+    /**
+     * @brief List matched key protocol
+     *
+     * An empty list matches any value.
+     *
+     * @type sai_u8_list_t
+     * @flags MANDATORY_ON_CREATE | CREATE_ONLY
+     */
+    SAI_INBOUND_ACL_STAGE3_ENTRY_ATTR_PROTOCOL,
+
+    /**
+     * @brief Range_list matched key sport
+     *
+     * An empty list matches any value.
+     *
+     * @type sai_u16_range_list_t
+     * @flags MANDATORY_ON_CREATE | CREATE_ONLY
+     */
+    SAI_INBOUND_ACL_STAGE3_ENTRY_ATTR_SPORT,
+
+    /**
+     * @brief Range_list matched key dport
+     *
+     * An empty list matches any value.
+     *
+     * @type sai_u16_range_list_t
+     * @flags MANDATORY_ON_CREATE | CREATE_ONLY
+     */
+    SAI_INBOUND_ACL_STAGE3_ENTRY_ATTR_DPORT,
+
     /**
      * @brief End of attributes
      */
@@ -947,6 +1387,13 @@ typedef enum _sai_inbound_acl_stage3_entry_attr_t
  */
 typedef struct _sai_eni_meter_entry_t
 {
+    /**
+     * @brief Switch ID
+     *
+     * @objects SAI_OBJECT_TYPE_SWITCH
+     */
+     sai_object_id_t switch_id;
+
     /**
      * @brief Exact matched key eni
      */
@@ -986,58 +1433,114 @@ typedef enum _sai_eni_meter_entry_attr_t
 
 } sai_eni_meter_entry_attr_t;
 
+/**
+ * @brief Counter IDs for eni_meter_entry, the eni_counter direct counter
+ */
+typedef enum _sai_eni_meter_entry_stat_t
+{
+    /** Packets that hit the entry */
+    SAI_ENI_METER_ENTRY_STAT_PACKETS,
+
+    /** Bytes of the packets that hit the entry, as received */
+    SAI_ENI_METER_ENTRY_STAT_BYTES,
+
+} sai_eni_meter_entry_stat_t;
+
 /**
  * @brief Create direction_lookup_entry
  *
- * @param[out] direction_lookup_entry_id Entry id
- * @param[in] switch_id Switch id
+ * @param[in] direction_lookup_entry Entry
  * @param[in] attr_count Number of attributes
  * @param[in] attr_list Array of attributes
  *
  * @return #SAI_STATUS_SUCCESS on success Failure status code on error
  */
 typedef sai_status_t (*sai_create_direction_lookup_entry_fn)(
-        _Out_ sai_object_id_t *direction_lookup_entry_id,
-        _In_ sai_object_id_t switch_id,
+        _In_ const sai_direction_lookup_entry_t *direction_lookup_entry,
         _In_ uint32_t attr_count,
         _In_ const sai_attribute_t *attr_list);
 
 /**
  * @brief Remove direction_lookup_entry
  *
- * @param[in] direction_lookup_entry_id Entry id
+ * @param[in] direction_lookup_entry Entry
  *
  * @return #SAI_STATUS_SUCCESS on success Failure status code on error
  */
 typedef sai_status_t (*sai_remove_direction_lookup_entry_fn)(
-        _In_ sai_object_id_t direction_lookup_entry_id);
+        _In_ const sai_direction_lookup_entry_t *direction_lookup_entry);
 
 /**
  * @brief Set attribute for direction_lookup_entry
  *
- * @param[in] direction_lookup_entry_id Entry id
+ * @param[in] direction_lookup_entry Entry
  * @param[in] attr Attribute
  *
  * @return #SAI_STATUS_SUCCESS on success Failure status code on error
  */
 typedef sai_status_t (*sai_set_direction_lookup_entry_attribute_fn)(
-        _In_ sai_object_id_t direction_lookup_entry_id,
+        _In_ const sai_direction_lookup_entry_t *direction_lookup_entry,
         _In_ const sai_attribute_t *attr);
 
 /**
  * @brief Get attribute for direction_lookup_entry
  *
- * @param[in] direction_lookup_entry_id Entry id
+ * @param[in] direction_lookup_entry Entry
  * @param[in] attr_count Number of attributes
  * @param[inout] attr_list Array of attributes
  *
  * @return #SAI_STATUS_SUCCESS on success Failure status code on error
  */
 typedef sai_status_t (*sai_get_direction_lookup_entry_attribute_fn)(
-        _In_ sai_object_id_t direction_lookup_entry_id,
+        _In_ const sai_direction_lookup_entry_t *direction_lookup_entry,
         _In_ uint32_t attr_count,
         _Inout_ sai_attribute_t *attr_list);
 
+/**
+ * @brief Bulk create direction_lookup_entry
+ *
+ * @param[in] object_count Number of objects to create
+ * @param[in] direction_lookup_entry List of entries to create
+ * @param[in] attr_count List of attr_count. Caller passes the number
+ *    of attribute for each object to create.
+ * @param[in] attr_list List of attributes for every object.
+ * @param[in] mode Bulk operation error handling mode.
+ * @param[out] object_statuses List of status for every object. Caller needs to
+ *    allocate the buffer
+ *
+ * @return #SAI_STATUS_SUCCESS on success when all objects are created or
+ * #SAI_STATUS_FAILURE when any of the objects fails to create. When there is
+ * failure, Caller is expected to go through the list of returned statuses to
+ * find out which fails and which succeeds.
+ */
+typedef sai_status_t (*sai_bulk_create_direction_lookup_entry_fn)(
+        _In_ uint32_t object_count,
+        _In_ const sai_direction_lookup_entry_t *direction_lookup_entry,
+        _In_ const uint32_t *attr_count,
+        _In_ const sai_attribute_t **attr_list,
+        _In_ sai_bulk_op_error_mode_t mode,
+        _Out_ sai_status_t *object_statuses);
+
+/**
+ * @brief Bulk remove direction_lookup_entry
+ *
+ * @param[in] object_count Number of objects to remove
+ * @param[in] direction_lookup_entry List of entries to remove
+ * @param[in] mode Bulk operation error handling mode.
+ * @param[out] object_statuses List of status for every object. Caller needs to
+ *    allocate the buffer
+ *
+ * @return #SAI_STATUS_SUCCESS on success when all objects are removed or
+ * #SAI_STATUS_FAILURE when any of the objects fails to remove. When there is
+ * failure, Caller is expected to go through the list of returned statuses to
+ * find out which fails and which succeeds.
+ */
+typedef sai_status_t (*sai_bulk_remove_direction_lookup_entry_fn)(
+        _In_ uint32_t object_count,
+        _In_ const sai_direction_lookup_entry_t *direction_lookup_entry,
+        _In_ sai_bulk_op_error_mode_t mode,
+        _Out_ sai_status_t *object_statuses);
+
 /**
  * @brief Create appliance
  *
@@ -1091,473 +1594,907 @@ typedef sai_status_t (*sai_get_appliance_attribute_fn)(
         _Inout_ sai_attribute_t *attr_list);
 
 /**
- * @brief Create outbound_eni_lookup_from_vm_entry
+ * @brief Bulk create appliance
  *
- * @param[out] outbound_eni_lookup_from_vm_entry_id Entry id
  * @param[in] switch_id Switch id
+ * @param[in] object_count Number of objects to create
+ * @param[in] attr_count List of attr_count. Caller passes the number
+ *    of attribute for each object to create.
+ * @param[in] attr_list List of attributes for every object.
+ * @param[in] mode Bulk operation error handling mode.
+ * @param[out] object_id List of object ids returned
+ * @param[out] object_statuses List of status for every object. Caller needs to
+ *    allocate the buffer
+ *
+ * @return #SAI_STATUS_SUCCESS on success when all objects are created or
+ * #SAI_STATUS_FAILURE when any of the objects fails to create. When there is
+ * failure, Caller is expected to go through the list of returned statuses to
+ * find out which fails and which succeeds.
+ */
+typedef sai_status_t (*sai_bulk_create_appliance_fn)(
+        _In_ sai_object_id_t switch_id,
+        _In_ uint32_t object_count,
+        _In_ const uint32_t *attr_count,
+        _In_ const sai_attribute_t **attr_list,
+        _In_ sai_bulk_op_error_mode_t mode,
+        _Out_ sai_object_id_t *object_id,
+        _Out_ sai_status_t *object_statuses);
+
+/**
+ * @brief Bulk remove appliance
+ *
+ * @param[in] object_count Number of objects to remove
+ * @param[in] object_id List of object ids
+ * @param[in] mode Bulk operation error handling mode.
+ * @param[out] object_statuses List of status for every object. Caller needs to
+ *    allocate the buffer
+ *
+ * @return #SAI_STATUS_SUCCESS on success when all objects are removed or
+ * #SAI_STATUS_FAILURE when any of the objects fails to remove. When there is
+ * failure, Caller is expected to go through the list of returned statuses to
+ * find out which fails and which succeeds.
+ */
+typedef sai_status_t (*sai_bulk_remove_appliance_fn)(
+        _In_ uint32_t object_count,
+        _In_ const sai_object_id_t *object_id,
+        _In_ sai_bulk_op_error_mode_t mode,
+        _Out_ sai_status_t *object_statuses);
+
+/**
+ * @brief Create outbound_eni_lookup_from_vm_entry
+ *
+ * @param[in] outbound_eni_lookup_from_vm_entry Entry
  * @param[in] attr_count Number of attributes
  * @param[in] attr_list Array of attributes
  *
  * @return #SAI_STATUS_SUCCESS on success Failure status code on error
  */
 typedef sai_status_t (*sai_create_outbound_eni_lookup_from_vm_entry_fn)(
-        _Out_ sai_object_id_t *outbound_eni_lookup_from_vm_entry_id,
-        _In_ sai_object_id_t switch_id,
+        _In_ const sai_outbound_eni_lookup_from_vm_entry_t *outbound_eni_lookup_from_vm_entry,
         _In_ uint32_t attr_count,
         _In_ const sai_attribute_t *attr_list);
 
 /**
  * @brief Remove outbound_eni_lookup_from_vm_entry
  *
- * @param[in] outbound_eni_lookup_from_vm_entry_id Entry id
+ * @param[in] outbound_eni_lookup_from_vm_entry Entry
  *
  * @return #SAI_STATUS_SUCCESS on success Failure status code on error
  */
 typedef sai_status_t (*sai_remove_outbound_eni_lookup_from_vm_entry_fn)(
-        _In_ sai_object_id_t outbound_eni_lookup_from_vm_entry_id);
+        _In_ const sai_outbound_eni_lookup_from_vm_entry_t *outbound_eni_lookup_from_vm_entry);
 
 /**
  * @brief Set attribute for outbound_eni_lookup_from_vm_entry
  *
- * @param[in] outbound_eni_lookup_from_vm_entry_id Entry id
+ * @param[in] outbound_eni_lookup_from_vm_entry Entry
  * @param[in] attr Attribute
  *
  * @return #SAI_STATUS_SUCCESS on success Failure status code on error
  */
 typedef sai_status_t (*sai_set_outbound_eni_lookup_from_vm_entry_attribute_fn)(
-        _In_ sai_object_id_t outbound_eni_lookup_from_vm_entry_id,
+        _In_ const sai_outbound_eni_lookup_from_vm_entry_t *outbound_eni_lookup_from_vm_entry,
         _In_ const sai_attribute_t *attr);
 
 /**
  * @brief Get attribute for outbound_eni_lookup_from_vm_entry
  *
- * @param[in] outbound_eni_lookup_from_vm_entry_id Entry id
+ * @param[in] outbound_eni_lookup_from_vm_entry Entry
  * @param[in] attr_count Number of attributes
  * @param[inout] attr_list Array of attributes
  *
  * @return #SAI_STATUS_SUCCESS on success Failure status code on error
  */
 typedef sai_status_t (*sai_get_outbound_eni_lookup_from_vm_entry_attribute_fn)(
-        _In_ sai_object_id_t outbound_eni_lookup_from_vm_entry_id,
+        _In_ const sai_outbound_eni_lookup_from_vm_entry_t *outbound_eni_lookup_from_vm_entry,
         _In_ uint32_t attr_count,
         _Inout_ sai_attribute_t *attr_list);
 
+/**
+ * @brief Bulk create outbound_eni_lookup_from_vm_entry
+ *
+ * @param[in] object_count Number of objects to create
+ * @param[in] outbound_eni_lookup_from_vm_entry List of entries to create
+ * @param[in] attr_count List of attr_count. Caller passes the number
+ *    of attribute for each object to create.
+ * @param[in] attr_list List of attributes for every object.
+ * @param[in] mode Bulk operation error handling mode.
+ * @param[out] object_statuses List of status for every object. Caller needs to
+ *    allocate the buffer
+ *
+ * @return #SAI_STATUS_SUCCESS on success when all objects are created or
+ * #SAI_STATUS_FAILURE when any of the objects fails to create. When there is
+ * failure, Caller is expected to go through the list of returned statuses to
+ * find out which fails and which succeeds.
+ */
+typedef sai_status_t (*sai_bulk_create_outbound_eni_lookup_from_vm_entry_fn)(
+        _In_ uint32_t object_count,
+        _In_ const sai_outbound_eni_lookup_from_vm_entry_t *outbound_eni_lookup_from_vm_entry,
+        _In_ const uint32_t *attr_count,
+        _In_ const sai_attribute_t **attr_list,
+        _In_ sai_bulk_op_error_mode_t mode,
+        _Out_ sai_status_t *object_statuses);
+
+/**
+ * @brief Bulk remove outbound_eni_lookup_from_vm_entry
+ *
+ * @param[in] object_count Number of objects to remove
+ * @param[in] outbound_eni_lookup_from_vm_entry List of entries to remove
+ * @param[in] mode Bulk operation error handling mode.
+ * @param[out] object_statuses List of status for every object. Caller needs to
+ *    allocate the buffer
+ *
+ * @return #SAI_STATUS_SUCCESS on success when all objects are removed or
+ * #SAI_STATUS_FAILURE when any of the objects fails to remove. When there is
+ * failure, Caller is expected to go through the list of returned statuses to
+ * find out which fails and which succeeds.
+ */
+typedef sai_status_t (*sai_bulk_remove_outbound_eni_lookup_from_vm_entry_fn)(
+        _In_ uint32_t object_count,
+        _In_ const sai_outbound_eni_lookup_from_vm_entry_t *outbound_eni_lookup_from_vm_entry,
+        _In_ sai_bulk_op_error_mode_t mode,
+        _Out_ sai_status_t *object_statuses);
+
 /**
  * @brief Create outbound_eni_to_vni_entry
  *
- * @param[out] outbound_eni_to_vni_entry_id Entry id
- * @param[in] switch_id Switch id
+ * @param[in] outbound_eni_to_vni_entry Entry
  * @param[in] attr_count Number of attributes
  * @param[in] attr_list Array of attributes
  *
  * @return #SAI_STATUS_SUCCESS on success Failure status code on error
  */
 typedef sai_status_t (*sai_create_outbound_eni_to_vni_entry_fn)(
-        _Out_ sai_object_id_t *outbound_eni_to_vni_entry_id,
-        _In_ sai_object_id_t switch_id,
+        _In_ const sai_outbound_eni_to_vni_entry_t *outbound_eni_to_vni_entry,
         _In_ uint32_t attr_count,
         _In_ const sai_attribute_t *attr_list);
 
 /**
  * @brief Remove outbound_eni_to_vni_entry
  *
- * @param[in] outbound_eni_to_vni_entry_id Entry id
+ * @param[in] outbound_eni_to_vni_entry Entry
  *
  * @return #SAI_STATUS_SUCCESS on success Failure status code on error
  */
 typedef sai_status_t (*sai_remove_outbound_eni_to_vni_entry_fn)(
-        _In_ sai_object_id_t outbound_eni_to_vni_entry_id);
+        _In_ const sai_outbound_eni_to_vni_entry_t *outbound_eni_to_vni_entry);
 
 /**
  * @brief Set attribute for outbound_eni_to_vni_entry
  *
- * @param[in] outbound_eni_to_vni_entry_id Entry id
+ * @param[in] outbound_eni_to_vni_entry Entry
  * @param[in] attr Attribute
  *
  * @return #SAI_STATUS_SUCCESS on success Failure status code on error
  */
 typedef sai_status_t (*sai_set_outbound_eni_to_vni_entry_attribute_fn)(
-        _In_ sai_object_id_t outbound_eni_to_vni_entry_id,
+        _In_ const sai_outbound_eni_to_vni_entry_t *outbound_eni_to_vni_entry,
         _In_ const sai_attribute_t *attr);
 
 /**
  * @brief Get attribute for outbound_eni_to_vni_entry
  *
- * @param[in] outbound_eni_to_vni_entry_id Entry id
+ * @param[in] outbound_eni_to_vni_entry Entry
  * @param[in] attr_count Number of attributes
  * @param[inout] attr_list Array of attributes
  *
  * @return #SAI_STATUS_SUCCESS on success Failure status code on error
  */
 typedef sai_status_t (*sai_get_outbound_eni_to_vni_entry_attribute_fn)(
-        _In_ sai_object_id_t outbound_eni_to_vni_entry_id,
+        _In_ const sai_outbound_eni_to_vni_entry_t *outbound_eni_to_vni_entry,
         _In_ uint32_t attr_count,
         _Inout_ sai_attribute_t *attr_list);
 
+/**
+ * @brief Bulk create outbound_eni_to_vni_entry
+ *
+ * @param[in] object_count Number of objects to create
+ * @param[in] outbound_eni_to_vni_entry List of entries to create
+ * @param[in] attr_count List of attr_count. Caller passes the number
+ *    of attribute for each object to create.
+ * @param[in] attr_list List of attributes for every object.
+ * @param[in] mode Bulk operation error handling mode.
+ * @param[out] object_statuses List of status for every object. Caller needs to
+ *    allocate the buffer
+ *
+ * @return #SAI_STATUS_SUCCESS on success when all objects are created or
+ * #SAI_STATUS_FAILURE when any of the objects fails to create. When there is
+ * failure, Caller is expected to go through the list of returned statuses to
+ * find out which fails and which succeeds.
+ */
+typedef sai_status_t (*sai_bulk_create_outbound_eni_to_vni_entry_fn)(
+        _In_ uint32_t object_count,
+        _In_ const sai_outbound_eni_to_vni_entry_t *outbound_eni_to_vni_entry,
+        _In_ const uint32_t *attr_count,
+        _In_ const sai_attribute_t **attr_list,
+        _In_ sai_bulk_op_error_mode_t mode,
+        _Out_ sai_status_t *object_statuses);
+
+/**
+ * @brief Bulk remove outbound_eni_to_vni_entry
+ *
+ * @param[in] object_count Number of objects to remove
+ * @param[in] outbound_eni_to_vni_entry List of entries to remove
+ * @param[in] mode Bulk operation error handling mode.
+ * @param[out] object_statuses List of status for every object. Caller needs to
+ *    allocate the buffer
+ *
+ * @return #SAI_STATUS_SUCCESS on success when all objects are removed or
+ * #SAI_STATUS_FAILURE when any of the objects fails to remove. When there is
+ * failure, Caller is expected to go through the list of returned statuses to
+ * find out which fails and which succeeds.
+ */
+typedef sai_status_t (*sai_bulk_remove_outbound_eni_to_vni_entry_fn)(
+        _In_ uint32_t object_count,
+        _In_ const sai_outbound_eni_to_vni_entry_t *outbound_eni_to_vni_entry,
+        _In_ sai_bulk_op_error_mode_t mode,
+        _Out_ sai_status_t *object_statuses);
+
 /**
  * @brief Create outbound_acl_stage1_entry
  *
- * @param[out] outbound_acl_stage1_entry_id Entry id
- * @param[in] switch_id Switch id
+ * @param[in] outbound_acl_stage1_entry Entry
  * @param[in] attr_count Number of attributes
  * @param[in] attr_list Array of attributes
  *
  * @return #SAI_STATUS_SUCCESS on success Failure status code on error
  */
 typedef sai_status_t (*sai_create_outbound_acl_stage1_entry_fn)(
-        _Out_ sai_object_id_t *outbound_acl_stage1_entry_id,
-        _In_ sai_object_id_t switch_id,
+        _In_ const sai_outbound_acl_stage1_entry_t *outbound_acl_stage1_entry,
         _In_ uint32_t attr_count,
         _In_ const sai_attribute_t *attr_list);
 
 /**
  * @brief Remove outbound_acl_stage1_entry
  *
- * @param[in] outbound_acl_stage1_entry_id Entry id
+ * @param[in] outbound_acl_stage1_entry Entry
  *
  * @return #SAI_STATUS_SUCCESS on success Failure status code on error
  */
 typedef sai_status_t (*sai_remove_outbound_acl_stage1_entry_fn)(
-        _In_ sai_object_id_t outbound_acl_stage1_entry_id);
+        _In_ const sai_outbound_acl_stage1_entry_t *outbound_acl_stage1_entry);
 
 /**
  * @brief Set attribute for outbound_acl_stage1_entry
  *
- * @param[in] outbound_acl_stage1_entry_id Entry id
+ * @param[in] outbound_acl_stage1_entry Entry
  * @param[in] attr Attribute
  *
  * @return #SAI_STATUS_SUCCESS on success Failure status code on error
  */
 typedef sai_status_t (*sai_set_outbound_acl_stage1_entry_attribute_fn)(
-        _In_ sai_object_id_t outbound_acl_stage1_entry_id,
+        _In_ const sai_outbound_acl_stage1_entry_t *outbound_acl_stage1_entry,
         _In_ const sai_attribute_t *attr);
 
 /**
  * @brief Get attribute for outbound_acl_stage1_entry
  *
- * @param[in] outbound_acl_stage1_entry_id Entry id
+ * @param[in] outbound_acl_stage1_entry Entry
  * @param[in] attr_count Number of attributes
  * @param[inout] attr_list Array of attributes
  *
  * @return #SAI_STATUS_SUCCESS on success Failure status code on error
  */
 typedef sai_status_t (*sai_get_outbound_acl_stage1_entry_attribute_fn)(
-        _In_ sai_object_id_t outbound_acl_stage1_entry_id,
+        _In_ const sai_outbound_acl_stage1_entry_t *outbound_acl_stage1_entry,
         _In_ uint32_t attr_count,
         _Inout_ sai_attribute_t *attr_list);
 
+/**
+ * @brief Bulk create outbound_acl_stage1_entry
+ *
+ * @param[in] object_count Number of objects to create
+ * @param[in] outbound_acl_stage1_entry List of entries to create
+ * @param[in] attr_count List of attr_count. Caller passes the number
+ *    of attribute for each object to create.
+ * @param[in] attr_list List of attributes for every object.
+ * @param[in] mode Bulk operation error handling mode.
+ * @param[out] object_statuses List of status for every object. Caller needs to
+ *    allocate the buffer
+ *
+ * @return #SAI_STATUS_SUCCESS on success when all objects are created or
+ * #SAI_STATUS_FAILURE when any of the objects fails to create. When there is
+ * failure, Caller is expected to go through the list of returned statuses to
+ * find out which fails and which succeeds.
+ */
+typedef sai_status_t (*sai_bulk_create_outbound_acl_stage1_entry_fn)(
+        _In_ uint32_t object_count,
+        _In_ const sai_outbound_acl_stage1_entry_t *outbound_acl_stage1_entry,
+        _In_ const uint32_t *attr_count,
+        _In_ const sai_attribute_t **attr_list,
+        _In_ sai_bulk_op_error_mode_t mode,
+        _Out_ sai_status_t *object_statuses);
+
+/**
+ * @brief Bulk remove outbound_acl_stage1_entry
+ *
+ * @param[in] object_count Number of objects to remove
+ * @param[in] outbound_acl_stage1_entry List of entries to remove
+ * @param[in] mode Bulk operation error handling mode.
+ * @param[out] object_statuses List of status for every object. Caller needs to
+ *    allocate the buffer
+ *
+ * @return #SAI_STATUS_SUCCESS on success when all objects are removed or
+ * #SAI_STATUS_FAILURE when any of the objects fails to remove. When there is
+ * failure, Caller is expected to go through the list of returned statuses to
+ * find out which fails and which succeeds.
+ */
+typedef sai_status_t (*sai_bulk_remove_outbound_acl_stage1_entry_fn)(
+        _In_ uint32_t object_count,
+        _In_ const sai_outbound_acl_stage1_entry_t *outbound_acl_stage1_entry,
+        _In_ sai_bulk_op_error_mode_t mode,
+        _Out_ sai_status_t *object_statuses);
+
 /**
  * @brief Create outbound_acl_stage2_entry
  *
- * @param[out] outbound_acl_stage2_entry_id Entry id
- * @param[in] switch_id Switch id
+ * @param[in] outbound_acl_stage2_entry Entry
  * @param[in] attr_count Number of attributes
  * @param[in] attr_list Array of attributes
  *
  * @return #SAI_STATUS_SUCCESS on success Failure status code on error
  */
 typedef sai_status_t (*sai_create_outbound_acl_stage2_entry_fn)(
-        _Out_ sai_object_id_t *outbound_acl_stage2_entry_id,
-        _In_ sai_object_id_t switch_id,
+        _In_ const sai_outbound_acl_stage2_entry_t *outbound_acl_stage2_entry,
         _In_ uint32_t attr_count,
         _In_ const sai_attribute_t *attr_list);
 
 /**
  * @brief Remove outbound_acl_stage2_entry
  *
- * @param[in] outbound_acl_stage2_entry_id Entry id
+ * @param[in] outbound_acl_stage2_entry Entry
  *
  * @return #SAI_STATUS_SUCCESS on success Failure status code on error
  */
 typedef sai_status_t (*sai_remove_outbound_acl_stage2_entry_fn)(
-        _In_ sai_object_id_t outbound_acl_stage2_entry_id);
+        _In_ const sai_outbound_acl_stage2_entry_t *outbound_acl_stage2_entry);
 
 /**
  * @brief Set attribute for outbound_acl_stage2_entry
  *
- * @param[in] outbound_acl_stage2_entry_id Entry id
+ * @param[in] outbound_acl_stage2_entry Entry
  * @param[in] attr Attribute
  *
  * @return #SAI_STATUS_SUCCESS on success Failure status code on error
  */
 typedef sai_status_t (*sai_set_outbound_acl_stage2_entry_attribute_fn)(
-        _In_ sai_object_id_t outbound_acl_stage2_entry_id,
+        _In_ const sai_outbound_acl_stage2_entry_t *outbound_acl_stage2_entry,
         _In_ const sai_attribute_t *attr);
 
 /**
  * @brief Get attribute for outbound_acl_stage2_entry
  *
- * @param[in] outbound_acl_stage2_entry_id Entry id
+ * @param[in] outbound_acl_stage2_entry Entry
  * @param[in] attr_count Number of attributes
  * @param[inout] attr_list Array of attributes
  *
  * @return #SAI_STATUS_SUCCESS on success Failure status code on error
  */
 typedef sai_status_t (*sai_get_outbound_acl_stage2_entry_attribute_fn)(
-        _In_ sai_object_id_t outbound_acl_stage2_entry_id,
+        _In_ const sai_outbound_acl_stage2_entry_t *outbound_acl_stage2_entry,
         _In_ uint32_t attr_count,
         _Inout_ sai_attribute_t *attr_list);
 
+/**
+ * @brief Bulk create outbound_acl_stage2_entry
+ *
+ * @param[in] object_count Number of objects to create
+ * @param[in] outbound_acl_stage2_entry List of entries to create
+ * @param[in] attr_count List of attr_count. Caller passes the number
+ *    of attribute for each object to create.
+ * @param[in] attr_list List of attributes for every object.
+ * @param[in] mode Bulk operation error handling mode.
+ * @param[out] object_statuses List of status for every object. Caller needs to
+ *    allocate the buffer
+ *
+ * @return #SAI_STATUS_SUCCESS on success when all objects are created or
+ * #SAI_STATUS_FAILURE when any of the objects fails to create. When there is
+ * failure, Caller is expected to go through the list of returned statuses to
+ * find out which fails and which succeeds.
+ */
+typedef sai_status_t (*sai_bulk_create_outbound_acl_stage2_entry_fn)(
+        _In_ uint32_t object_count,
+        _In_ const sai_outbound_acl_stage2_entry_t *outbound_acl_stage2_entry,
+        _In_ const uint32_t *attr_count,
+        _In_ const sai_attribute_t **attr_list,
+        _In_ sai_bulk_op_error_mode_t mode,
+        _Out_ sai_status_t *object_statuses);
+
+/**
+ * @brief Bulk remove outbound_acl_stage2_entry
+ *
+ * @param[in] object_count Number of objects to remove
+ * @param[in] outbound_acl_stage2_entry List of entries to remove
+ * @param[in] mode Bulk operation error handling mode.
+ * @param[out] object_statuses List of status for every object. Caller needs to
+ *    allocate the buffer
+ *
+ * @return #SAI_STATUS_SUCCESS on success when all objects are removed or
+ * #SAI_STATUS_FAILURE when any of the objects fails to remove. When there is
+ * failure, Caller is expected to go through the list of returned statuses to
+ * find out which fails and which succeeds.
+ */
+typedef sai_status_t (*sai_bulk_remove_outbound_acl_stage2_entry_fn)(
+        _In_ uint32_t object_count,
+        _In_ const sai_outbound_acl_stage2_entry_t *outbound_acl_stage2_entry,
+        _In_ sai_bulk_op_error_mode_t mode,
+        _Out_ sai_status_t *object_statuses);
+
 /**
  * @brief Create outbound_acl_stage3_entry
  *
- * @param[out] outbound_acl_stage3_entry_id Entry id
- * @param[in] switch_id Switch id
+ * @param[in] outbound_acl_stage3_entry Entry
  * @param[in] attr_count Number of attributes
  * @param[in] attr_list Array of attributes
  *
  * @return #SAI_STATUS_SUCCESS on success Failure status code on error
  */
 typedef sai_status_t (*sai_create_outbound_acl_stage3_entry_fn)(
-        _Out_ sai_object_id_t *outbound_acl_stage3_entry_id,
-        _In_ sai_object_id_t switch_id,
+        _In_ const sai_outbound_acl_stage3_entry_t *outbound_acl_stage3_entry,
         _In_ uint32_t attr_count,
         _In_ const sai_attribute_t *attr_list);
 
 /**
  * @brief Remove outbound_acl_stage3_entry
  *
- * @param[in] outbound_acl_stage3_entry_id Entry id
+ * @param[in] outbound_acl_stage3_entry Entry
  *
  * @return #SAI_STATUS_SUCCESS on success Failure status code on error
  */
 typedef sai_status_t (*sai_remove_outbound_acl_stage3_entry_fn)(
-        _In_ sai_object_id_t outbound_acl_stage3_entry_id);
+        _In_ const sai_outbound_acl_stage3_entry_t *outbound_acl_stage3_entry);
 
 /**
  * @brief Set attribute for outbound_acl_stage3_entry
  *
- * @param[in] outbound_acl_stage3_entry_id Entry id
+ * @param[in] outbound_acl_stage3_entry Entry
  * @param[in] attr Attribute
  *
  * @return #SAI_STATUS_SUCCESS on success Failure status code on error
  */
 typedef sai_status_t (*sai_set_outbound_acl_stage3_entry_attribute_fn)(
-        _In_ sai_object_id_t outbound_acl_stage3_entry_id,
+        _In_ const sai_outbound_acl_stage3_entry_t *outbound_acl_stage3_entry,
         _In_ const sai_attribute_t *attr);
 
 /**
  * @brief Get attribute for outbound_acl_stage3_entry
  *
- * @param[in] outbound_acl_stage3_entry_id Entry id
+ * @param[in] outbound_acl_stage3_entry Entry
  * @param[in] attr_count Number of attributes
  * @param[inout] attr_list Array of attributes
  *
  * @return #SAI_STATUS_SUCCESS on success Failure status code on error
  */
 typedef sai_status_t (*sai_get_outbound_acl_stage3_entry_attribute_fn)(
-        _In_ sai_object_id_t outbound_acl_stage3_entry_id,
+        _In_ const sai_outbound_acl_stage3_entry_t *outbound_acl_stage3_entry,
         _In_ uint32_t attr_count,
         _Inout_ sai_attribute_t *attr_list);
 
+/**
+ * @brief Bulk create outbound_acl_stage3_entry
+ *
+ * @param[in] object_count Number of objects to create
+ * @param[in] outbound_acl_stage3_entry List of entries to create
+ * @param[in] attr_count List of attr_count. Caller passes the number
+ *    of attribute for each object to create.
+ * @param[in] attr_list List of attributes for every object.
+ * @param[in] mode Bulk operation error handling mode.
+ * @param[out] object_statuses List of status for every object. Caller needs to
+ *    allocate the buffer
+ *
+ * @return #SAI_STATUS_SUCCESS on success when all objects are created or
+ * #SAI_STATUS_FAILURE when any of the objects fails to create. When there is
+ * failure, Caller is expected to go through the list of returned statuses to
+ * find out which fails and which succeeds.
+ */
+typedef sai_status_t (*sai_bulk_create_outbound_acl_stage3_entry_fn)(
+        _In_ uint32_t object_count,
+        _In_ const sai_outbound_acl_stage3_entry_t *outbound_acl_stage3_entry,
+        _In_ const uint32_t *attr_count,
+        _In_ const sai_attribute_t **attr_list,
+        _In_ sai_bulk_op_error_mode_t mode,
+        _Out_ sai_status_t *object_statuses);
+
+/**
+ * @brief Bulk remove outbound_acl_stage3_entry
+ *
+ * @param[in] object_count Number of objects to remove
+ * @param[in] outbound_acl_stage3_entry List of entries to remove
+ * @param[in] mode Bulk operation error handling mode.
+ * @param[out] object_statuses List of status for every object. Caller needs to
+ *    allocate the buffer
+ *
+ * @return #SAI_STATUS_SUCCESS on success when all objects are removed or
+ * #SAI_STATUS_FAILURE when any of the objects fails to remove. When there is
+ * failure, Caller is expected to go through the list of returned statuses to
+ * find out which fails and which succeeds.
+ */
+typedef sai_status_t (*sai_bulk_remove_outbound_acl_stage3_entry_fn)(
+        _In_ uint32_t object_count,
+        _In_ const sai_outbound_acl_stage3_entry_t *outbound_acl_stage3_entry,
+        _In_ sai_bulk_op_error_mode_t mode,
+        _Out_ sai_status_t *object_statuses);
+
 /**
  * @brief Create outbound_routing_entry
  *
- * @param[out] outbound_routing_entry_id Entry id
- * @param[in] switch_id Switch id
+ * @param[in] outbound_routing_entry Entry
  * @param[in] attr_count Number of attributes
  * @param[in] attr_list Array of attributes
  *
  * @return #SAI_STATUS_SUCCESS on success Failure status code on error
  */
 typedef sai_status_t (*sai_create_outbound_routing_entry_fn)(
-        _Out_ sai_object_id_t *outbound_routing_entry_id,
-        _In_ sai_object_id_t switch_id,
+        _In_ const sai_outbound_routing_entry_t *outbound_routing_entry,
         _In_ uint32_t attr_count,
         _In_ const sai_attribute_t *attr_list);
 
 /**
  * @brief Remove outbound_routing_entry
  *
- * @param[in] outbound_routing_entry_id Entry id
+ * @param[in] outbound_routing_entry Entry
  *
  * @return #SAI_STATUS_SUCCESS on success Failure status code on error
  */
 typedef sai_status_t (*sai_remove_outbound_routing_entry_fn)(
-        _In_ sai_object_id_t outbound_routing_entry_id);
+        _In_ const sai_outbound_routing_entry_t *outbound_routing_entry);
 
 /**
  * @brief Set attribute for outbound_routing_entry
  *
- * @param[in] outbound_routing_entry_id Entry id
+ * @param[in] outbound_routing_entry Entry
  * @param[in] attr Attribute
  *
  * @return #SAI_STATUS_SUCCESS on success Failure status code on error
  */
 typedef sai_status_t (*sai_set_outbound_routing_entry_attribute_fn)(
-        _In_ sai_object_id_t outbound_routing_entry_id,
+        _In_ const sai_outbound_routing_entry_t *outbound_routing_entry,
         _In_ const sai_attribute_t *attr);
 
 /**
  * @brief Get attribute for outbound_routing_entry
  *
- * @param[in] outbound_routing_entry_id Entry id
+ * @param[in] outbound_routing_entry Entry
  * @param[in] attr_count Number of attributes
  * @param[inout] attr_list Array of attributes
  *
  * @return #SAI_STATUS_SUCCESS on success Failure status code on error
  */
 typedef sai_status_t (*sai_get_outbound_routing_entry_attribute_fn)(
-        _In_ sai_object_id_t outbound_routing_entry_id,
+        _In_ const sai_outbound_routing_entry_t *outbound_routing_entry,
         _In_ uint32_t attr_count,
         _Inout_ sai_attribute_t *attr_list);
 
+/**
+ * @brief Bulk create outbound_routing_entry
+ *
+ * @param[in] object_count Number of objects to create
+ * @param[in] outbound_routing_entry List of entries to create
+ * @param[in] attr_count List of attr_count. Caller passes the number
+ *    of attribute for each object to create.
+ * @param[in] attr_list List of attributes for every object.
+ * @param[in] mode Bulk operation error handling mode.
+ * @param[out] object_statuses List of status for every object. Caller needs to
+ *    allocate the buffer
+ *
+ * @return #SAI_STATUS_SUCCESS on success when all objects are created or
+ * #SAI_STATUS_FAILURE when any of the objects fails to create. When there is
+ * failure, Caller is expected to go through the list of returned statuses to
+ * find out which fails and which succeeds.
+ */
+typedef sai_status_t (*sai_bulk_create_outbound_routing_entry_fn)(
+        _In_ uint32_t object_count,
+        _In_ const sai_outbound_routing_entry_t *outbound_routing_entry,
+        _In_ const uint32_t *attr_count,
+        _In_ const sai_attribute_t **attr_list,
+        _In_ sai_bulk_op_error_mode_t mode,
+        _Out_ sai_status_t *object_statuses);
+
+/**
+ * @brief Bulk remove outbound_routing_entry
+ *
+ * @param[in] object_count Number of objects to remove
+ * @param[in] outbound_routing_entry List of entries to remove
+ * @param[in] mode Bulk operation error handling mode.
+ * @param[out] object_statuses List of status for every object. Caller needs to
+ *    allocate the buffer
+ *
+ * @return #SAI_STATUS_SUCCESS on success when all objects are removed or
+ * #SAI_STATUS_FAILURE when any of the objects fails to remove. When there is
+ * failure, Caller is expected to go through the list of returned statuses to
+ * find out which fails and which succeeds.
+ */
+typedef sai_status_t (*sai_bulk_remove_outbound_routing_entry_fn)(
+        _In_ uint32_t object_count,
+        _In_ const sai_outbound_routing_entry_t *outbound_routing_entry,
+        _In_ sai_bulk_op_error_mode_t mode,
+        _Out_ sai_status_t *object_statuses);
+
 /**
  * @brief Create outbound_ca_to_pa_entry
  *
- * @param[out] outbound_ca_to_pa_entry_id Entry id
- * @param[in] switch_id Switch id
+ * @param[in] outbound_ca_to_pa_entry Entry
  * @param[in] attr_count Number of attributes
  * @param[in] attr_list Array of attributes
  *
  * @return #SAI_STATUS_SUCCESS on success Failure status code on error
  */
 typedef sai_status_t (*sai_create_outbound_ca_to_pa_entry_fn)(
-        _Out_ sai_object_id_t *outbound_ca_to_pa_entry_id,
-        _In_ sai_object_id_t switch_id,
+        _In_ const sai_outbound_ca_to_pa_entry_t *outbound_ca_to_pa_entry,
         _In_ uint32_t attr_count,
         _In_ const sai_attribute_t *attr_list);
 
 /**
  * @brief Remove outbound_ca_to_pa_entry
  *
- * @param[in] outbound_ca_to_pa_entry_id Entry id
+ * @param[in] outbound_ca_to_pa_entry Entry
  *
  * @return #SAI_STATUS_SUCCESS on success Failure status code on error
  */
 typedef sai_status_t (*sai_remove_outbound_ca_to_pa_entry_fn)(
-        _In_ sai_object_id_t outbound_ca_to_pa_entry_id);
+        _In_ const sai_outbound_ca_to_pa_entry_t *outbound_ca_to_pa_entry);
 
 /**
  * @brief Set attribute for outbound_ca_to_pa_entry
  *
- * @param[in] outbound_ca_to_pa_entry_id Entry id
+ * @param[in] outbound_ca_to_pa_entry Entry
  * @param[in] attr Attribute
  *
  * @return #SAI_STATUS_SUCCESS on success Failure status code on error
  */
 typedef sai_status_t (*sai_set_outbound_ca_to_pa_entry_attribute_fn)(
-        _In_ sai_object_id_t outbound_ca_to_pa_entry_id,
+        _In_ const sai_outbound_ca_to_pa_entry_t *outbound_ca_to_pa_entry,
         _In_ const sai_attribute_t *attr);
 
 /**
  * @brief Get attribute for outbound_ca_to_pa_entry
  *
- * @param[in] outbound_ca_to_pa_entry_id Entry id
+ * @param[in] outbound_ca_to_pa_entry Entry
  * @param[in] attr_count Number of attributes
  * @param[inout] attr_list Array of attributes
  *
  * @return #SAI_STATUS_SUCCESS on success Failure status code on error
  */
 typedef sai_status_t (*sai_get_outbound_ca_to_pa_entry_attribute_fn)(
-        _In_ sai_object_id_t outbound_ca_to_pa_entry_id,
+        _In_ const sai_outbound_ca_to_pa_entry_t *outbound_ca_to_pa_entry,
         _In_ uint32_t attr_count,
         _Inout_ sai_attribute_t *attr_list);
 
+/**
+ * @brief Bulk create outbound_ca_to_pa_entry
+ *
+ * @param[in] object_count Number of objects to create
+ * @param[in] outbound_ca_to_pa_entry List of entries to create
+ * @param[in] attr_count List of attr_count. Caller passes the number
+ *    of attribute for each object to create.
+ * @param[in] attr_list List of attributes for every object.
+ * @param[in] mode Bulk operation error handling mode.
+ * @param[out] object_statuses List of status for every object. Caller needs to
+ *    allocate the buffer
+ *
+ * @return #SAI_STATUS_SUCCESS on success when all objects are created or
+ * #SAI_STATUS_FAILURE when any of the objects fails to create. When there is
+ * failure, Caller is expected to go through the list of returned statuses to
+ * find out which fails and which succeeds.
+ */
+typedef sai_status_t (*sai_bulk_create_outbound_ca_to_pa_entry_fn)(
+        _In_ uint32_t object_count,
+        _In_ const sai_outbound_ca_to_pa_entry_t *outbound_ca_to_pa_entry,
+        _In_ const uint32_t *attr_count,
+        _In_ const sai_attribute_t **attr_list,
+        _In_ sai_bulk_op_error_mode_t mode,
+        _Out_ sai_status_t *object_statuses);
+
+/**
+ * @brief Bulk remove outbound_ca_to_pa_entry
+ *
+ * @param[in] object_count Number of objects to remove
+ * @param[in] outbound_ca_to_pa_entry List of entries to remove
+ * @param[in] mode Bulk operation error handling mode.
+ * @param[out] object_statuses List of status for every object. Caller needs to
+ *    allocate the buffer
+ *
+ * @return #SAI_STATUS_SUCCESS on success when all objects are removed or
+ * #SAI_STATUS_FAILURE when any of the objects fails to remove. When there is
+ * failure, Caller is expected to go through the list of returned statuses to
+ * find out which fails and which succeeds.
+ */
+typedef sai_status_t (*sai_bulk_remove_outbound_ca_to_pa_entry_fn)(
+        _In_ uint32_t object_count,
+        _In_ const sai_outbound_ca_to_pa_entry_t *outbound_ca_to_pa_entry,
+        _In_ sai_bulk_op_error_mode_t mode,
+        _Out_ sai_status_t *object_statuses);
+
 /**
  * @brief Create inbound_eni_lookup_to_vm_entry
  *
- * @param[out] inbound_eni_lookup_to_vm_entry_id Entry id
- * @param[in] switch_id Switch id
+ * @param[in] inbound_eni_lookup_to_vm_entry Entry
  * @param[in] attr_count Number of attributes
  * @param[in] attr_list Array of attributes
  *
  * @return #SAI_STATUS_SUCCESS on success Failure status code on error
  */
 typedef sai_status_t (*sai_create_inbound_eni_lookup_to_vm_entry_fn)(
-        _Out_ sai_object_id_t *inbound_eni_lookup_to_vm_entry_id,
-        _In_ sai_object_id_t switch_id,
+        _In_ const sai_inbound_eni_lookup_to_vm_entry_t *inbound_eni_lookup_to_vm_entry,
         _In_ uint32_t attr_count,
         _In_ const sai_attribute_t *attr_list);
 
 /**
  * @brief Remove inbound_eni_lookup_to_vm_entry
  *
- * @param[in] inbound_eni_lookup_to_vm_entry_id Entry id
+ * @param[in] inbound_eni_lookup_to_vm_entry Entry
  *
  * @return #SAI_STATUS_SUCCESS on success Failure status code on error
  */
 typedef sai_status_t (*sai_remove_inbound_eni_lookup_to_vm_entry_fn)(
-        _In_ sai_object_id_t inbound_eni_lookup_to_vm_entry_id);
+        _In_ const sai_inbound_eni_lookup_to_vm_entry_t *inbound_eni_lookup_to_vm_entry);
 
 /**
  * @brief Set attribute for inbound_eni_lookup_to_vm_entry
  *
- * @param[in] inbound_eni_lookup_to_vm_entry_id Entry id
+ * @param[in] inbound_eni_lookup_to_vm_entry Entry
  * @param[in] attr Attribute
  *
  * @return #SAI_STATUS_SUCCESS on success Failure status code on error
  */
 typedef sai_status_t (*sai_set_inbound_eni_lookup_to_vm_entry_attribute_fn)(
-        _In_ sai_object_id_t inbound_eni_lookup_to_vm_entry_id,
+        _In_ const sai_inbound_eni_lookup_to_vm_entry_t *inbound_eni_lookup_to_vm_entry,
         _In_ const sai_attribute_t *attr);
 
 /**
  * @brief Get attribute for inbound_eni_lookup_to_vm_entry
  *
- * @param[in] inbound_eni_lookup_to_vm_entry_id Entry id
+ * @param[in] inbound_eni_lookup_to_vm_entry Entry
  * @param[in] attr_count Number of attributes
  * @param[inout] attr_list Array of attributes
  *
  * @return #SAI_STATUS_SUCCESS on success Failure status code on error
  */
 typedef sai_status_t (*sai_get_inbound_eni_lookup_to_vm_entry_attribute_fn)(
-        _In_ sai_object_id_t inbound_eni_lookup_to_vm_entry_id,
+        _In_ const sai_inbound_eni_lookup_to_vm_entry_t *inbound_eni_lookup_to_vm_entry,
         _In_ uint32_t attr_count,
         _Inout_ sai_attribute_t *attr_list);
 
+/**
+ * @brief Bulk create inbound_eni_lookup_to_vm_entry
+ *
+ * @param[in] object_count Number of objects to create
+ * @param[in] inbound_eni_lookup_to_vm_entry List of entries to create
+ * @param[in] attr_count List of attr_count. Caller passes the number
+ *    of attribute for each object to create.
+ * @param[in] attr_list List of attributes for every object.
+ * @param[in] mode Bulk operation error handling mode.
+ * @param[out] object_statuses List of status for every object. Caller needs to
+ *    allocate the buffer
+ *
+ * @return #SAI_STATUS_SUCCESS on success when all objects are created or
+ * #SAI_STATUS_FAILURE when any of the objects fails to create. When there is
+ * failure, Caller is expected to go through the list of returned statuses to
+ * find out which fails and which succeeds.
+ */
+typedef sai_status_t (*sai_bulk_create_inbound_eni_lookup_to_vm_entry_fn)(
+        _In_ uint32_t object_count,
+        _In_ const sai_inbound_eni_lookup_to_vm_entry_t *inbound_eni_lookup_to_vm_entry,
+        _In_ const uint32_t *attr_count,
+        _In_ const sai_attribute_t **attr_list,
+        _In_ sai_bulk_op_error_mode_t mode,
+        _Out_ sai_status_t *object_statuses);
+
+/**
+ * @brief Bulk remove inbound_eni_lookup_to_vm_entry
+ *
+ * @param[in] object_count Number of objects to remove
+ * @param[in] inbound_eni_lookup_to_vm_entry List of entries to remove
+ * @param[in] mode Bulk operation error handling mode.
+ * @param[out] object_statuses List of status for every object. Caller needs to
+ *    allocate the buffer
+ *
+ * @return #SAI_STATUS_SUCCESS on success when all objects are removed or
+ * #SAI_STATUS_FAILURE when any of the objects fails to remove. When there is
+ * failure, Caller is expected to go through the list of returned statuses to
+ * find out which fails and which succeeds.
+ */
+typedef sai_status_t (*sai_bulk_remove_inbound_eni_lookup_to_vm_entry_fn)(
+        _In_ uint32_t object_count,
+        _In_ const sai_inbound_eni_lookup_to_vm_entry_t *inbound_eni_lookup_to_vm_entry,
+        _In_ sai_bulk_op_error_mode_t mode,
+        _Out_ sai_status_t *object_statuses);
+
 /**
  * @brief Create inbound_eni_to_vm_entry
  *
- * @param[out] inbound_eni_to_vm_entry_id Entry id
- * @param[in] switch_id Switch id
+ * @param[in] inbound_eni_to_vm_entry Entry
  * @param[in] attr_count Number of attributes
  * @param[in] attr_list Array of attributes
  *
  * @return #SAI_STATUS_SUCCESS on success Failure status code on error
  */
 typedef sai_status_t (*sai_create_inbound_eni_to_vm_entry_fn)(
-        _Out_ sai_object_id_t *inbound_eni_to_vm_entry_id,
-        _In_ sai_object_id_t switch_id,
+        _In_ const sai_inbound_eni_to_vm_entry_t *inbound_eni_to_vm_entry,
         _In_ uint32_t attr_count,
         _In_ const sai_attribute_t *attr_list);
 
 /**
  * @brief Remove inbound_eni_to_vm_entry
  *
- * @param[in] inbound_eni_to_vm_entry_id Entry id
+ * @param[in] inbound_eni_to_vm_entry Entry
  *
  * @return #SAI_STATUS_SUCCESS on success Failure status code on error
  */
 typedef sai_status_t (*sai_remove_inbound_eni_to_vm_entry_fn)(
-        _In_ sai_object_id_t inbound_eni_to_vm_entry_id);
+        _In_ const sai_inbound_eni_to_vm_entry_t *inbound_eni_to_vm_entry);
 
 /**
  * @brief Set attribute for inbound_eni_to_vm_entry
  *
- * @param[in] inbound_eni_to_vm_entry_id Entry id
+ * @param[in] inbound_eni_to_vm_entry Entry
  * @param[in] attr Attribute
  *
  * @return #SAI_STATUS_SUCCESS on success Failure status code on error
  */
 typedef sai_status_t (*sai_set_inbound_eni_to_vm_entry_attribute_fn)(
-        _In_ sai_object_id_t inbound_eni_to_vm_entry_id,
+        _In_ const sai_inbound_eni_to_vm_entry_t *inbound_eni_to_vm_entry,
         _In_ const sai_attribute_t *attr);
 
 /**
  * @brief Get attribute for inbound_eni_to_vm_entry
  *
- * @param[in] inbound_eni_to_vm_entry_id Entry id
+ * @param[in] inbound_eni_to_vm_entry Entry
  * @param[in] attr_count Number of attributes
  * @param[inout] attr_list Array of attributes
  *
  * @return #SAI_STATUS_SUCCESS on success Failure status code on error
  */
 typedef sai_status_t (*sai_get_inbound_eni_to_vm_entry_attribute_fn)(
-        _In_ sai_object_id_t inbound_eni_to_vm_entry_id,
+        _In_ const sai_inbound_eni_to_vm_entry_t *inbound_eni_to_vm_entry,
         _In_ uint32_t attr_count,
         _Inout_ sai_attribute_t *attr_list);
 
+/**
+ * @brief Bulk create inbound_eni_to_vm_entry
+ *
+ * @param[in] object_count Number of objects to create
+ * @param[in] inbound_eni_to_vm_entry List of entries to create
+ * @param[in] attr_count List of attr_count. Caller passes the number
+ *    of attribute for each object to create.
+ * @param[in] attr_list List of attributes for every object.
+ * @param[in] mode Bulk operation error handling mode.
+ * @param[out] object_statuses List of status for every object. Caller needs to
+ *    allocate the buffer
+ *
+ * @return #SAI_STATUS_SUCCESS on success when all objects are created or
+ * #SAI_STATUS_FAILURE when any of the objects fails to create. When there is
+ * failure, Caller is expected to go through the list of returned statuses to
+ * find out which fails and which succeeds.
+ */
+typedef sai_status_t (*sai_bulk_create_inbound_eni_to_vm_entry_fn)(
+        _In_ uint32_t object_count,
+        _In_ const sai_inbound_eni_to_vm_entry_t *inbound_eni_to_vm_entry,
+        _In_ const uint32_t *attr_count,
+        _In_ const sai_attribute_t **attr_list,
+        _In_ sai_bulk_op_error_mode_t mode,
+        _Out_ sai_status_t *object_statuses);
+
+/**
+ * @brief Bulk remove inbound_eni_to_vm_entry
+ *
+ * @param[in] object_count Number of objects to remove
+ * @param[in] inbound_eni_to_vm_entry List of entries to remove
+ * @param[in] mode Bulk operation error handling mode.
+ * @param[out] object_statuses List of status for every object. Caller needs to
+ *    allocate the buffer
+ *
+ * @return #SAI_STATUS_SUCCESS on success when all objects are removed or
+ * #SAI_STATUS_FAILURE when any of the objects fails to remove. When there is
+ * failure, Caller is expected to go through the list of returned statuses to
+ * find out which fails and which succeeds.
+ */
+typedef sai_status_t (*sai_bulk_remove_inbound_eni_to_vm_entry_fn)(
+        _In_ uint32_t object_count,
+        _In_ const sai_inbound_eni_to_vm_entry_t *inbound_eni_to_vm_entry,
+        _In_ sai_bulk_op_error_mode_t mode,
+        _Out_ sai_status_t *object_statuses);
+
 /**
  * @brief Create inbound_vm
  *
@@ -1611,279 +2548,669 @@ typedef sai_status_t (*sai_get_inbound_vm_attribute_fn)(
         _Inout_ sai_attribute_t *attr_list);
 
 /**
- * @brief Create inbound_acl_stage1_entry
+ * @brief Bulk create inbound_vm
  *
- * @param[out] inbound_acl_stage1_entry_id Entry id
  * @param[in] switch_id Switch id
+ * @param[in] object_count Number of objects to create
+ * @param[in] attr_count List of attr_count. Caller passes the number
+ *    of attribute for each object to create.
+ * @param[in] attr_list List of attributes for every object.
+ * @param[in] mode Bulk operation error handling mode.
+ * @param[out] object_id List of object ids returned
+ * @param[out] object_statuses List of status for every object. Caller needs to
+ *    allocate the buffer
+ *
+ * @return #SAI_STATUS_SUCCESS on success when all objects are created or
+ * #SAI_STATUS_FAILURE when any of the objects fails to create. When there is
+ * failure, Caller is expected to go through the list of returned statuses to
+ * find out which fails and which succeeds.
+ */
+typedef sai_status_t (*sai_bulk_create_inbound_vm_fn)(
+        _In_ sai_object_id_t switch_id,
+        _In_ uint32_t object_count,
+        _In_ const uint32_t *attr_count,
+        _In_ const sai_attribute_t **attr_list,
+        _In_ sai_bulk_op_error_mode_t mode,
+        _Out_ sai_object_id_t *object_id,
+        _Out_ sai_status_t *object_statuses);
+
+/**
+ * @brief Bulk remove inbound_vm
+ *
+ * @param[in] object_count Number of objects to remove
+ * @param[in] object_id List of object ids
+ * @param[in] mode Bulk operation error handling mode.
+ * @param[out] object_statuses List of status for every object. Caller needs to
+ *    allocate the buffer
+ *
+ * @return #SAI_STATUS_SUCCESS on success when all objects are removed or
+ * #SAI_STATUS_FAILURE when any of the objects fails to remove. When there is
+ * failure, Caller is expected to go through the list of returned statuses to
+ * find out which fails and which succeeds.
+ */
+typedef sai_status_t (*sai_bulk_remove_inbound_vm_fn)(
+        _In_ uint32_t object_count,
+        _In_ const sai_object_id_t *object_id,
+        _In_ sai_bulk_op_error_mode_t mode,
+        _Out_ sai_status_t *object_statuses);
+
+/**
+ * @brief Create inbound_acl_stage1_entry
+ *
+ * @param[in] inbound_acl_stage1_entry Entry
  * @param[in] attr_count Number of attributes
  * @param[in] attr_list Array of attributes
  *
  * @return #SAI_STATUS_SUCCESS on success Failure status code on error
  */
 typedef sai_status_t (*sai_create_inbound_acl_stage1_entry_fn)(
-        _Out_ sai_object_id_t *inbound_acl_stage1_entry_id,
-        _In_ sai_object_id_t switch_id,
+        _In_ const sai_inbound_acl_stage1_entry_t *inbound_acl_stage1_entry,
         _In_ uint32_t attr_count,
         _In_ const sai_attribute_t *attr_list);
 
 /**
  * @brief Remove inbound_acl_stage1_entry
  *
- * @param[in] inbound_acl_stage1_entry_id Entry id
+ * @param[in] inbound_acl_stage1_entry Entry
  *
  * @return #SAI_STATUS_SUCCESS on success Failure status code on error
  */
 typedef sai_status_t (*sai_remove_inbound_acl_stage1_entry_fn)(
-        _In_ sai_object_id_t inbound_acl_stage1_entry_id);
+        _In_ const sai_inbound_acl_stage1_entry_t *inbound_acl_stage1_entry);
 
 /**
  * @brief Set attribute for inbound_acl_stage1_entry
  *
- * @param[in] inbound_acl_stage1_entry_id Entry id
+ * @param[in] inbound_acl_stage1_entry Entry
  * @param[in] attr Attribute
  *
  * @return #SAI_STATUS_SUCCESS on success Failure status code on error
  */
 typedef sai_status_t (*sai_set_inbound_acl_stage1_entry_attribute_fn)(
-        _In_ sai_object_id_t inbound_acl_stage1_entry_id,
+        _In_ const sai_inbound_acl_stage1_entry_t *inbound_acl_stage1_entry,
         _In_ const sai_attribute_t *attr);
 
 /**
  * @brief Get attribute for inbound_acl_stage1_entry
  *
- * @param[in] inbound_acl_stage1_entry_id Entry id
+ * @param[in] inbound_acl_stage1_entry Entry
  * @param[in] attr_count Number of attributes
  * @param[inout] attr_list Array of attributes
  *
  * @return #SAI_STATUS_SUCCESS on success Failure status code on error
  */
 typedef sai_status_t (*sai_get_inbound_acl_stage1_entry_attribute_fn)(
-        _In_ sai_object_id_t inbound_acl_stage1_entry_id,
+        _In_ const sai_inbound_acl_stage1_entry_t *inbound_acl_stage1_entry,
         _In_ uint32_t attr_count,
         _Inout_ sai_attribute_t *attr_list);
 
+/**
+ * @brief Bulk create inbound_acl_stage1_entry
+ *
+ * @param[in] object_count Number of objects to create
+ * @param[in] inbound_acl_stage1_entry List of entries to create
+ * @param[in] attr_count List of attr_count. Caller passes the number
+ *    of attribute for each object to create.
+ * @param[in] attr_list List of attributes for every object.
+ * @param[in] mode Bulk operation error handling mode.
+ * @param[out] object_statuses List of status for every object. Caller needs to
+ *    allocate the buffer
+ *
+ * @return #SAI_STATUS_SUCCESS on success when all objects are created or
+ * #SAI_STATUS_FAILURE when any of the objects fails to create. When there is
+ * failure, Caller is expected to go through the list of returned statuses to
+ * find out which fails and which succeeds.
+ */
+typedef sai_status_t (*sai_bulk_create_inbound_acl_stage1_entry_fn)(
+        _In_ uint32_t object_count,
+        _In_ const sai_inbound_acl_stage1_entry_t *inbound_acl_stage1_entry,
+        _In_ const uint32_t *attr_count,
+        _In_ const sai_attribute_t **attr_list,
+        _In_ sai_bulk_op_error_mode_t mode,
+        _Out_ sai_status_t *object_statuses);
+
+/**
+ * @brief Bulk remove inbound_acl_stage1_entry
+ *
+ * @param[in] object_count Number of objects to remove
+ * @param[in] inbound_acl_stage1_entry List of entries to remove
+ * @param[in] mode Bulk operation error handling mode.
+ * @param[out] object_statuses List of status for every object. Caller needs to
+ *    allocate the buffer
+ *
+ * @return #SAI_STATUS_SUCCESS on success when all objects are removed or
+ * #SAI_STATUS_FAILURE when any of the objects fails to remove. When there is
+ * failure, Caller is expected to go through the list of returned statuses to
+ * find out which fails and which succeeds.
+ */
+typedef sai_status_t (*sai_bulk_remove_inbound_acl_stage1_entry_fn)(
+        _In_ uint32_t object_count,
+        _In_ const sai_inbound_acl_stage1_entry_t *inbound_acl_stage1_entry,
+        _In_ sai_bulk_op_error_mode_t mode,
+        _Out_ sai_status_t *object_statuses);
+
 /**
  * @brief Create inbound_acl_stage2_entry
  *
- * @param[out] inbound_acl_stage2_entry_id Entry id
- * @param[in] switch_id Switch id
+ * @param[in] inbound_acl_stage2_entry Entry
  * @param[in] attr_count Number of attributes
  * @param[in] attr_list Array of attributes
  *
  * @return #SAI_STATUS_SUCCESS on success Failure status code on error
  */
 typedef sai_status_t (*sai_create_inbound_acl_stage2_entry_fn)(
-        _Out_ sai_object_id_t *inbound_acl_stage2_entry_id,
-        _In_ sai_object_id_t switch_id,
+        _In_ const sai_inbound_acl_stage2_entry_t *inbound_acl_stage2_entry,
         _In_ uint32_t attr_count,
         _In_ const sai_attribute_t *attr_list);
 
 /**
  * @brief Remove inbound_acl_stage2_entry
  *
- * @param[in] inbound_acl_stage2_entry_id Entry id
+ * @param[in] inbound_acl_stage2_entry Entry
  *
  * @return #SAI_STATUS_SUCCESS on success Failure status code on error
  */
 typedef sai_status_t (*sai_remove_inbound_acl_stage2_entry_fn)(
-        _In_ sai_object_id_t inbound_acl_stage2_entry_id);
+        _In_ const sai_inbound_acl_stage2_entry_t *inbound_acl_stage2_entry);
 
 /**
  * @brief Set attribute for inbound_acl_stage2_entry
  *
- * @param[in] inbound_acl_stage2_entry_id Entry id
+ * @param[in] inbound_acl_stage2_entry Entry
  * @param[in] attr Attribute
  *
  * @return #SAI_STATUS_SUCCESS on success Failure status code on error
  */
 typedef sai_status_t (*sai_set_inbound_acl_stage2_entry_attribute_fn)(
-        _In_ sai_object_id_t inbound_acl_stage2_entry_id,
+        _In_ const sai_inbound_acl_stage2_entry_t *inbound_acl_stage2_entry,
         _In_ const sai_attribute_t *attr);
 
 /**
  * @brief Get attribute for inbound_acl_stage2_entry
  *
- * @param[in] inbound_acl_stage2_entry_id Entry id
+ * @param[in] inbound_acl_stage2_entry Entry
  * @param[in] attr_count Number of attributes
  * @param[inout] attr_list Array of attributes
  *
  * @return #SAI_STATUS_SUCCESS on success Failure status code on error
  */
 typedef sai_status_t (*sai_get_inbound_acl_stage2_entry_attribute_fn)(
-        _In_ sai_object_id_t inbound_acl_stage2_entry_id,
+        _In_ const sai_inbound_acl_stage2_entry_t *inbound_acl_stage2_entry,
         _In_ uint32_t attr_count,
         _Inout_ sai_attribute_t *attr_list);
 
+/**
+ * @brief Bulk create inbound_acl_stage2_entry
+ *
+ * @param[in] object_count Number of objects to create
+ * @param[in] inbound_acl_stage2_entry List of entries to create
+ * @param[in] attr_count List of attr_count. Caller passes the number
+ *    of attribute for each object to create.
+ * @param[in] attr_list List of attributes for every object.
+ * @param[in] mode Bulk operation error handling mode.
+ * @param[out] object_statuses List of status for every object. Caller needs to
+ *    allocate the buffer
+ *
+ * @return #SAI_STATUS_SUCCESS on success when all objects are created or
+ * #SAI_STATUS_FAILURE when any of the objects fails to create. When there is
+ * failure, Caller is expected to go through the list of returned statuses to
+ * find out which fails and which succeeds.
+ */
+typedef sai_status_t (*sai_bulk_create_inbound_acl_stage2_entry_fn)(
+        _In_ uint32_t object_count,
+        _In_ const sai_inbound_acl_stage2_entry_t *inbound_acl_stage2_entry,
+        _In_ const uint32_t *attr_count,
+        _In_ const sai_attribute_t **attr_list,
+        _In_ sai_bulk_op_error_mode_t mode,
+        _Out_ sai_status_t *object_statuses);
+
+/**
+ * @brief Bulk remove inbound_acl_stage2_entry
+ *
+ * @param[in] object_count Number of objects to remove
+ * @param[in] inbound_acl_stage2_entry List of entries to remove
+ * @param[in] mode Bulk operation error handling mode.
+ * @param[out] object_statuses List of status for every object. Caller needs to
+ *    allocate the buffer
+ *
+ * @return #SAI_STATUS_SUCCESS on success when all objects are removed or
+ * #SAI_STATUS_FAILURE when any of the objects fails to remove. When there is
+ * failure, Caller is expected to go through the list of returned statuses to
+ * find out which fails and which succeeds.
+ */
+typedef sai_status_t (*sai_bulk_remove_inbound_acl_stage2_entry_fn)(
+        _In_ uint32_t object_count,
+        _In_ const sai_inbound_acl_stage2_entry_t *inbound_acl_stage2_entry,
+        _In_ sai_bulk_op_error_mode_t mode,
+        _Out_ sai_status_t *object_statuses);
+
 /**
  * @brief Create inbound_acl_stage3_entry
  *
- * @param[out] inbound_acl_stage3_entry_id Entry id
- * @param[in] switch_id Switch id
+ * @param[in] inbound_acl_stage3_entry Entry
  * @param[in] attr_count Number of attributes
  * @param[in] attr_list Array of attributes
  *
  * @return #SAI_STATUS_SUCCESS on success Failure status code on error
  */
 typedef sai_status_t (*sai_create_inbound_acl_stage3_entry_fn)(
-        _Out_ sai_object_id_t *inbound_acl_stage3_entry_id,
-        _In_ sai_object_id_t switch_id,
+        _In_ const sai_inbound_acl_stage3_entry_t *inbound_acl_stage3_entry,
         _In_ uint32_t attr_count,
         _In_ const sai_attribute_t *attr_list);
 
 /**
  * @brief Remove inbound_acl_stage3_entry
  *
- * @param[in] inbound_acl_stage3_entry_id Entry id
+ * @param[in] inbound_acl_stage3_entry Entry
  *
  * @return #SAI_STATUS_SUCCESS on success Failure status code on error
  */
 typedef sai_status_t (*sai_remove_inbound_acl_stage3_entry_fn)(
-        _In_ sai_object_id_t inbound_acl_stage3_entry_id);
+        _In_ const sai_inbound_acl_stage3_entry_t *inbound_acl_stage3_entry);
 
 /**
  * @brief Set attribute for inbound_acl_stage3_entry
  *
- * @param[in] inbound_acl_stage3_entry_id Entry id
+ * @param[in] inbound_acl_stage3_entry Entry
  * @param[in] attr Attribute
  *
  * @return #SAI_STATUS_SUCCESS on success Failure status code on error
  */
 typedef sai_status_t (*sai_set_inbound_acl_stage3_entry_attribute_fn)(
-        _In_ sai_object_id_t inbound_acl_stage3_entry_id,
+        _In_ const sai_inbound_acl_stage3_entry_t *inbound_acl_stage3_entry,
         _In_ const sai_attribute_t *attr);
 
 /**
  * @brief Get attribute for inbound_acl_stage3_entry
  *
- * @param[in] inbound_acl_stage3_entry_id Entry id
+ * @param[in] inbound_acl_stage3_entry Entry
  * @param[in] attr_count Number of attributes
  * @param[inout] attr_list Array of attributes
  *
  * @return #SAI_STATUS_SUCCESS on success Failure status code on error
  */
 typedef sai_status_t (*sai_get_inbound_acl_stage3_entry_attribute_fn)(
-        _In_ sai_object_id_t inbound_acl_stage3_entry_id,
+        _In_ const sai_inbound_acl_stage3_entry_t *inbound_acl_stage3_entry,
         _In_ uint32_t attr_count,
         _Inout_ sai_attribute_t *attr_list);
 
+/**
+ * @brief Bulk create inbound_acl_stage3_entry
+ *
+ * @param[in] object_count Number of objects to create
+ * @param[in] inbound_acl_stage3_entry List of entries to create
+ * @param[in] attr_count List of attr_count. Caller passes the number
+ *    of attribute for each object to create.
+ * @param[in] attr_list List of attributes for every object.
+ * @param[in] mode Bulk operation error handling mode.
+ * @param[out] object_statuses List of status for every object. Caller needs to
+ *    allocate the buffer
+ *
+ * @return #SAI_STATUS_SUCCESS on success when all objects are created or
+ * #SAI_STATUS_FAILURE when any of the objects fails to create. When there is
+ * failure, Caller is expected to go through the list of returned statuses to
+ * find out which fails and which succeeds.
+ */
+typedef sai_status_t (*sai_bulk_create_inbound_acl_stage3_entry_fn)(
+        _In_ uint32_t object_count,
+        _In_ const sai_inbound_acl_stage3_entry_t *inbound_acl_stage3_entry,
+        _In_ const uint32_t *attr_count,
+        _In_ const sai_attribute_t **attr_list,
+        _In_ sai_bulk_op_error_mode_t mode,
+        _Out_ sai_status_t *object_statuses);
+
+/**
+ * @brief Bulk remove inbound_acl_stage3_entry
+ *
+ * @param[in] object_count Number of objects to remove
+ * @param[in] inbound_acl_stage3_entry List of entries to remove
+ * @param[in] mode Bulk operation error handling mode.
+ * @param[out] object_statuses List of status for every object. Caller needs to
+ *    allocate the buffer
+ *
+ * @return #SAI_STATUS_SUCCESS on success when all objects are removed or
+ * #SAI_STATUS_FAILURE when any of the objects fails to remove. When there is
+ * failure, Caller is expected to go through the list of returned statuses to
+ * find out which fails and which succeeds.
+ */
+typedef sai_status_t (*sai_bulk_remove_inbound_acl_stage3_entry_fn)(
+        _In_ uint32_t object_count,
+        _In_ const sai_inbound_acl_stage3_entry_t *inbound_acl_stage3_entry,
+        _In_ sai_bulk_op_error_mode_t mode,
+        _Out_ sai_status_t *object_statuses);
+
 /**
  * @brief Create eni_meter_entry
  *
- * @param[out] eni_meter_entry_id Entry id
- * @param[in] switch_id Switch id
+ * @param[in] eni_meter_entry Entry
  * @param[in] attr_count Number of attributes
  * @param[in] attr_list Array of attributes
  *
  * @return #SAI_STATUS_SUCCESS on success Failure status code on error
  */
 typedef sai_status_t (*sai_create_eni_meter_entry_fn)(
-        _Out_ sai_object_id_t *eni_meter_entry_id,
-        _In_ sai_object_id_t switch_id,
+        _In_ const sai_eni_meter_entry_t *eni_meter_entry,
         _In_ uint32_t attr_count,
         _In_ const sai_attribute_t *attr_list);
 
 /**
  * @brief Remove eni_meter_entry
  *
- * @param[in] eni_meter_entry_id Entry id
+ * @param[in] eni_meter_entry Entry
  *
  * @return #SAI_STATUS_SUCCESS on success Failure status code on error
  */
 typedef sai_status_t (*sai_remove_eni_meter_entry_fn)(
-        _In_ sai_object_id_t eni_meter_entry_id);
+        _In_ const sai_eni_meter_entry_t *eni_meter_entry);
 
 /**
  * @brief Set attribute for eni_meter_entry
  *
- * @param[in] eni_meter_entry_id Entry id
+ * @param[in] eni_meter_entry Entry
  * @param[in] attr Attribute
  *
  * @return #SAI_STATUS_SUCCESS on success Failure status code on error
  */
 typedef sai_status_t (*sai_set_eni_meter_entry_attribute_fn)(
-        _In_ sai_object_id_t eni_meter_entry_id,
+        _In_ const sai_eni_meter_entry_t *eni_meter_entry,
         _In_ const sai_attribute_t *attr);
 
 /**
  * @brief Get attribute for eni_meter_entry
  *
- * @param[in] eni_meter_entry_id Entry id
+ * @param[in] eni_meter_entry Entry
  * @param[in] attr_count Number of attributes
  * @param[inout] attr_list Array of attributes
  *
  * @return #SAI_STATUS_SUCCESS on success Failure status code on error
  */
 typedef sai_status_t (*sai_get_eni_meter_entry_attribute_fn)(
-        _In_ sai_object_id_t eni_meter_entry_id,
+        _In_ const sai_eni_meter_entry_t *eni_meter_entry,
         _In_ uint32_t attr_count,
         _Inout_ sai_attribute_t *attr_list);
 
+/**
+ * @brief Bulk create eni_meter_entry
+ *
+ * @param[in] object_count Number of objects to create
+ * @param[in] eni_meter_entry List of entries to create
+ * @param[in] attr_count List of attr_count. Caller passes the number
+ *    of attribute for each object to create.
+ * @param[in] attr_list List of attributes for every object.
+ * @param[in] mode Bulk operation error handling mode.
+ * @param[out] object_statuses List of status for every object. Caller needs to
+ *    allocate the buffer
+ *
+ * @return #SAI_STATUS_SUCCESS on success when all objects are created or
+ * #SAI_STATUS_FAILURE when any of the objects fails to create. When there is
+ * failure, Caller is expected to go through the list of returned statuses to
+ * find out which fails and which succeeds.
+ */
+typedef sai_status_t (*sai_bulk_create_eni_meter_entry_fn)(
+        _In_ uint32_t object_count,
+        _In_ const sai_eni_meter_entry_t *eni_meter_entry,
+        _In_ const uint32_t *attr_count,
+        _In_ const sai_attribute_t **attr_list,
+        _In_ sai_bulk_op_error_mode_t mode,
+        _Out_ sai_status_t *object_statuses);
+
+/**
+ * @brief Bulk remove eni_meter_entry
+ *
+ * @param[in] object_count Number of objects to remove
+ * @param[in] eni_meter_entry List of entries to remove
+ * @param[in] mode Bulk operation error handling mode.
+ * @param[out] object_statuses List of status for every object. Caller needs to
+ *    allocate the buffer
+ *
+ * @return #SAI_STATUS_SUCCESS on success when all objects are removed or
+ * #SAI_STATUS_FAILURE when any of the objects fails to remove. When there is
+ * failure, Caller is expected to go through the list of returned statuses to
+ * find out which fails and which succeeds.
+ */
+typedef sai_status_t (*sai_bulk_remove_eni_meter_entry_fn)(
+        _In_ uint32_t object_count,
+        _In_ const sai_eni_meter_entry_t *eni_meter_entry,
+        _In_ sai_bulk_op_error_mode_t mode,
+        _Out_ sai_status_t *object_statuses);
+
+/**
+ * @brief Get eni_meter_entry statistics counters
+ *
+ * @param[in] eni_meter_entry Entry
+ * @param[in] number_of_counters Number of counters in the array
+ * @param[in] counter_ids Specifies the array of counter ids
+ * @param[out] counters Array of resulting counter values.
+ *
+ * @return #SAI_STATUS_SUCCESS on success, failure status code on error
+ */
+typedef sai_status_t (*sai_get_eni_meter_entry_stats_fn)(
+        _In_ const sai_eni_meter_entry_t *eni_meter_entry,
+        _In_ uint32_t number_of_counters,
+        _In_ const sai_stat_id_t *counter_ids,
+        _Out_ uint64_t *counters);
+
+/**
+ * @brief Clear eni_meter_entry statistics counters
+ *
+ * @param[in] eni_meter_entry Entry
+ * @param[in] number_of_counters Number of counters in the array
+ * @param[in] counter_ids Specifies the array of counter ids
+ *
+ * @return #SAI_STATUS_SUCCESS on success, failure status code on error
+ */
+typedef sai_status_t (*sai_clear_eni_meter_entry_stats_fn)(
+        _In_ const sai_eni_meter_entry_t *eni_meter_entry,
+        _In_ uint32_t number_of_counters,
+        _In_ const sai_stat_id_t *counter_ids);
+
+/**
+ * @brief Bulk get eni_meter_entry statistics counters
+ *
+ * @param[in] object_count Number of entries to get the counters of
+ * @param[in] eni_meter_entry List of entries
+ * @param[in] number_of_counters Number of counters per entry
+ * @param[in] counter_ids Specifies the array of counter ids, the same for
+ *    every entry
+ * @param[in] mode Statistics mode, #SAI_STATS_MODE_READ_AND_CLEAR clears
+ *    the counters read
+ * @param[out] object_statuses List of status for every entry. Caller needs to
+ *    allocate the buffer
+ * @param[out] counters Counter values, number_of_counters per entry in the
+ *    order of the entries. Caller needs to allocate the buffer
+ *
+ * @return #SAI_STATUS_SUCCESS on success when the counters of all entries are
+ * read or #SAI_STATUS_FAILURE when any of the entries fails.
+ */
+typedef sai_status_t (*sai_bulk_get_eni_meter_entry_stats_fn)(
+        _In_ uint32_t object_count,
+        _In_ const sai_eni_meter_entry_t *eni_meter_entry,
+        _In_ uint32_t number_of_counters,
+        _In_ const sai_stat_id_t *counter_ids,
+        _In_ sai_stats_mode_t mode,
+        _Out_ sai_status_t *object_statuses,
+        _Out_ uint64_t *counters);
+
+/**
+ * @brief Snapshot of the routing_counter and ca_to_pa_counter of all
+ * outbound_routing and outbound_ca_to_pa entries
+ *
+ * Both tables are read while none of their entries is created or
+ * removed, so every entry_id belongs to the entry it had at the time. The counts are
+ * since the creation of the entry.
+ *
+ * @param[inout] routing_count Size of routing_counters on input, the
+ *    number of routing entries on output
+ * @param[out] routing_counters Counters of the routing entries
+ * @param[inout] ca_to_pa_count Size of ca_to_pa_counters on input, the
+ *    number of ca_to_pa entries on output
+ * @param[out] ca_to_pa_counters Counters of the ca_to_pa entries
+ * @param[out] epoch Changes whenever an entry_id is given to an entry or
+ *    freed: while it stays the same, entry_ids map to the same entries
+ *
+ * @return #SAI_STATUS_SUCCESS on success, #SAI_STATUS_BUFFER_OVERFLOW
+ * when a buffer is too small, with both counts set to the sizes needed
+ * and no counter written
+ */
+typedef sai_status_t (*sai_get_outbound_counters_snapshot_fn)(
+        _Inout_ uint32_t *routing_count,
+        _Out_ sai_dash_counter_t *routing_counters,
+        _Inout_ uint32_t *ca_to_pa_count,
+        _Out_ sai_dash_counter_t *ca_to_pa_counters,
+        _Out_ uint64_t *epoch);
+
+/**
+ * @brief Counters of ACL rules of one ENI in one stage
+ *
+ * A rule counts the packets the ACL classifies with it, since the rule
+ * was created. Packets of a flow that follow the flow's first one reuse
+ * its ACL verdict and are not classified again, and neither are packets
+ * of connections conntrack allows.
+ *
+ * @param[in] stage ACL stage of the rules
+ * @param[in] eni ENI of the rules
+ * @param[in] count Number of rules
+ * @param[inout] rule_counters The priority of each rule on input, its
+ *    counts on output
+ * @param[out] object_statuses Status of each rule, #SAI_STATUS_ITEM_NOT_FOUND
+ *    for the rules that do not exist
+ *
+ * @return #SAI_STATUS_SUCCESS when all rules were read, #SAI_STATUS_FAILURE
+ * when some were not
+ */
+typedef sai_status_t (*sai_get_acl_rule_counters_fn)(
+        _In_ sai_dash_acl_stage_t stage,
+        _In_ sai_uint16_t eni,
+        _In_ uint32_t count,
+        _Inout_ sai_dash_acl_rule_counter_t *rule_counters,
+        _Out_ sai_status_t *object_statuses);
+
+/**
+ * @brief The most hit ACL rules of one ENI in one stage
+ *
+ * The candidates come from a sample of the rules' hits, which tracks the
+ * heaviest of them in constant space; they are returned with their exact
+ * counters, most packets first. A rule with more than 1/128 of the
+ * sampled hits of the ENI and stage is always a candidate.
+ *
+ * @param[in] stage ACL stage of the rules
+ * @param[in] eni ENI of the rules
+ * @param[inout] count Rules wanted on input, at most 128 are returned;
+ *    rules returned on output
+ * @param[out] rule_counters The rules
+ *
+ * @return #SAI_STATUS_SUCCESS on success
+ */
+typedef sai_status_t (*sai_get_acl_top_rules_fn)(
+        _In_ sai_dash_acl_stage_t stage,
+        _In_ sai_uint16_t eni,
+        _Inout_ uint32_t *count,
+        _Out_ sai_dash_acl_rule_counter_t *rule_counters);
+
 typedef struct _sai__api_t
 {
     sai_create_direction_lookup_entry_fn                      create_direction_lookup_entry;
     sai_remove_direction_lookup_entry_fn                      remove_direction_lookup_entry;
     sai_set_direction_lookup_entry_attribute_fn               set_direction_lookup_entry_attribute;
     sai_get_direction_lookup_entry_attribute_fn               get_direction_lookup_entry_attribute;
+    sai_bulk_create_direction_lookup_entry_fn                 bulk_create_direction_lookup_entry;
+    sai_bulk_remove_direction_lookup_entry_fn                 bulk_remove_direction_lookup_entry;
     sai_create_appliance_fn                                   create_appliance;
     sai_remove_appliance_fn                                   remove_appliance;
     sai_set_appliance_attribute_fn                            set_appliance_attribute;
     sai_get_appliance_attribute_fn                            get_appliance_attribute;
+    sai_bulk_create_appliance_fn                              bulk_create_appliance;
+    sai_bulk_remove_appliance_fn                              bulk_remove_appliance;
     sai_create_outbound_eni_lookup_from_vm_entry_fn           create_outbound_eni_lookup_from_vm_entry;
     sai_remove_outbound_eni_lookup_from_vm_entry_fn           remove_outbound_eni_lookup_from_vm_entry;
     sai_set_outbound_eni_lookup_from_vm_entry_attribute_fn    set_outbound_eni_lookup_from_vm_entry_attribute;
     sai_get_outbound_eni_lookup_from_vm_entry_attribute_fn    get_outbound_eni_lookup_from_vm_entry_attribute;
+    sai_bulk_create_outbound_eni_lookup_from_vm_entry_fn      bulk_create_outbound_eni_lookup_from_vm_entry;
+    sai_bulk_remove_outbound_eni_lookup_from_vm_entry_fn      bulk_remove_outbound_eni_lookup_from_vm_entry;
     sai_create_outbound_eni_to_vni_entry_fn                   create_outbound_eni_to_vni_entry;
     sai_remove_outbound_eni_to_vni_entry_fn                   remove_outbound_eni_to_vni_entry;
     sai_set_outbound_eni_to_vni_entry_attribute_fn            set_outbound_eni_to_vni_entry_attribute;
     sai_get_outbound_eni_to_vni_entry_attribute_fn            get_outbound_eni_to_vni_entry_attribute;
+    sai_bulk_create_outbound_eni_to_vni_entry_fn              bulk_create_outbound_eni_to_vni_entry;
+    sai_bulk_remove_outbound_eni_to_vni_entry_fn              bulk_remove_outbound_eni_to_vni_entry;
     sai_create_outbound_acl_stage1_entry_fn                   create_outbound_acl_stage1_entry;
     sai_remove_outbound_acl_stage1_entry_fn                   remove_outbound_acl_stage1_entry;
     sai_set_outbound_acl_stage1_entry_attribute_fn            set_outbound_acl_stage1_entry_attribute;
     sai_get_outbound_acl_stage1_entry_attribute_fn            get_outbound_acl_stage1_entry_attribute;
+    sai_bulk_create_outbound_acl_stage1_entry_fn              bulk_create_outbound_acl_stage1_entry;
+    sai_bulk_remove_outbound_acl_stage1_entry_fn              bulk_remove_outbound_acl_stage1_entry;
     sai_create_outbound_acl_stage2_entry_fn                   create_outbound_acl_stage2_entry;
     sai_remove_outbound_acl_stage2_entry_fn                   remove_outbound_acl_stage2_entry;
     sai_set_outbound_acl_stage2_entry_attribute_fn            set_outbound_acl_stage2_entry_attribute;
     sai_get_outbound_acl_stage2_entry_attribute_fn            get_outbound_acl_stage2_entry_attribute;
+    sai_bulk_create_outbound_acl_stage2_entry_fn              bulk_create_outbound_acl_stage2_entry;
+    sai_bulk_remove_outbound_acl_stage2_entry_fn              bulk_remove_outbound_acl_stage2_entry;
     sai_create_outbound_acl_stage3_entry_fn                   create_outbound_acl_stage3_entry;
     sai_remove_outbound_acl_stage3_entry_fn                   remove_outbound_acl_stage3_entry;
     sai_set_outbound_acl_stage3_entry_attribute_fn            set_outbound_acl_stage3_entry_attribute;
     sai_get_outbound_acl_stage3_entry_attribute_fn            get_outbound_acl_stage3_entry_attribute;
+    sai_bulk_create_outbound_acl_stage3_entry_fn              bulk_create_outbound_acl_stage3_entry;
+    sai_bulk_remove_outbound_acl_stage3_entry_fn              bulk_remove_outbound_acl_stage3_entry;
     sai_create_outbound_routing_entry_fn                      create_outbound_routing_entry;
     sai_remove_outbound_routing_entry_fn                      remove_outbound_routing_entry;
     sai_set_outbound_routing_entry_attribute_fn               set_outbound_routing_entry_attribute;
     sai_get_outbound_routing_entry_attribute_fn               get_outbound_routing_entry_attribute;
+    sai_bulk_create_outbound_routing_entry_fn                 bulk_create_outbound_routing_entry;
+    sai_bulk_remove_outbound_routing_entry_fn                 bulk_remove_outbound_routing_entry;
     sai_create_outbound_ca_to_pa_entry_fn                     create_outbound_ca_to_pa_entry;
     sai_remove_outbound_ca_to_pa_entry_fn                     remove_outbound_ca_to_pa_entry;
     sai_set_outbound_ca_to_pa_entry_attribute_fn              set_outbound_ca_to_pa_entry_attribute;
     sai_get_outbound_ca_to_pa_entry_attribute_fn              get_outbound_ca_to_pa_entry_attribute;
+    sai_bulk_create_outbound_ca_to_pa_entry_fn                bulk_create_outbound_ca_to_pa_entry;
+    sai_bulk_remove_outbound_ca_to_pa_entry_fn                bulk_remove_outbound_ca_to_pa_entry;
     sai_create_inbound_eni_lookup_to_vm_entry_fn              create_inbound_eni_lookup_to_vm_entry;
     sai_remove_inbound_eni_lookup_to_vm_entry_fn              remove_inbound_eni_lookup_to_vm_entry;
     sai_set_inbound_eni_lookup_to_vm_entry_attribute_fn       set_inbound_eni_lookup_to_vm_entry_attribute;
     sai_get_inbound_eni_lookup_to_vm_entry_attribute_fn       get_inbound_eni_lookup_to_vm_entry_attribute;
+    sai_bulk_create_inbound_eni_lookup_to_vm_entry_fn         bulk_create_inbound_eni_lookup_to_vm_entry;
+    sai_bulk_remove_inbound_eni_lookup_to_vm_entry_fn         bulk_remove_inbound_eni_lookup_to_vm_entry;
     sai_create_inbound_eni_to_vm_entry_fn                     create_inbound_eni_to_vm_entry;
     sai_remove_inbound_eni_to_vm_entry_fn                     remove_inbound_eni_to_vm_entry;
     sai_set_inbound_eni_to_vm_entry_attribute_fn              set_inbound_eni_to_vm_entry_attribute;
     sai_get_inbound_eni_to_vm_entry_attribute_fn              get_inbound_eni_to_vm_entry_attribute;
+    sai_bulk_create_inbound_eni_to_vm_entry_fn                bulk_create_inbound_eni_to_vm_entry;
+    sai_bulk_remove_inbound_eni_to_vm_entry_fn                bulk_remove_inbound_eni_to_vm_entry;
     sai_create_inbound_vm_fn                                  create_inbound_vm;
     sai_remove_inbound_vm_fn                                  remove_inbound_vm;
     sai_set_inbound_vm_attribute_fn                           set_inbound_vm_attribute;
     sai_get_inbound_vm_attribute_fn                           get_inbound_vm_attribute;
+    sai_bulk_create_inbound_vm_fn                             bulk_create_inbound_vm;
+    sai_bulk_remove_inbound_vm_fn                             bulk_remove_inbound_vm;
     sai_create_inbound_acl_stage1_entry_fn                    create_inbound_acl_stage1_entry;
     sai_remove_inbound_acl_stage1_entry_fn                    remove_inbound_acl_stage1_entry;
     sai_set_inbound_acl_stage1_entry_attribute_fn             set_inbound_acl_stage1_entry_attribute;
     sai_get_inbound_acl_stage1_entry_attribute_fn             get_inbound_acl_stage1_entry_attribute;
+    sai_bulk_create_inbound_acl_stage1_entry_fn               bulk_create_inbound_acl_stage1_entry;
+    sai_bulk_remove_inbound_acl_stage1_entry_fn               bulk_remove_inbound_acl_stage1_entry;
     sai_create_inbound_acl_stage2_entry_fn                    create_inbound_acl_stage2_entry;
     sai_remove_inbound_acl_stage2_entry_fn                    remove_inbound_acl_stage2_entry;
     sai_set_inbound_acl_stage2_entry_attribute_fn             set_inbound_acl_stage2_entry_attribute;
     sai_get_inbound_acl_stage2_entry_attribute_fn             get_inbound_acl_stage2_entry_attribute;
+    sai_bulk_create_inbound_acl_stage2_entry_fn               bulk_create_inbound_acl_stage2_entry;
+    sai_bulk_remove_inbound_acl_stage2_entry_fn               bulk_remove_inbound_acl_stage2_entry;
     sai_create_inbound_acl_stage3_entry_fn                    create_inbound_acl_stage3_entry;
     sai_remove_inbound_acl_stage3_entry_fn                    remove_inbound_acl_stage3_entry;
     sai_set_inbound_acl_stage3_entry_attribute_fn             set_inbound_acl_stage3_entry_attribute;
     sai_get_inbound_acl_stage3_entry_attribute_fn             get_inbound_acl_stage3_entry_attribute;
+    sai_bulk_create_inbound_acl_stage3_entry_fn               bulk_create_inbound_acl_stage3_entry;
+    sai_bulk_remove_inbound_acl_stage3_entry_fn               bulk_remove_inbound_acl_stage3_entry;
     sai_create_eni_meter_entry_fn                             create_eni_meter_entry;
     sai_remove_eni_meter_entry_fn                             remove_eni_meter_entry;
     sai_set_eni_meter_entry_attribute_fn                      set_eni_meter_entry_attribute;
     sai_get_eni_meter_entry_attribute_fn                      get_eni_meter_entry_attribute;
+    sai_bulk_create_eni_meter_entry_fn                        bulk_create_eni_meter_entry;
+    sai_bulk_remove_eni_meter_entry_fn                        bulk_remove_eni_meter_entry;
+    sai_get_eni_meter_entry_stats_fn                          get_eni_meter_entry_stats;
+    sai_clear_eni_meter_entry_stats_fn                        clear_eni_meter_entry_stats;
+    sai_bulk_get_eni_meter_entry_stats_fn                     bulk_get_eni_meter_entry_stats;
+    sai_get_outbound_counters_snapshot_fn                     get_outbound_counters_snapshot;
+    sai_get_acl_rule_counters_fn                              get_acl_rule_counters;
+    sai_get_acl_top_rules_fn                                  get_acl_top_rules;
 } sai__api_t;
 
 /**
@@ -125,6 +125,22 @@ typedef enum _sai_packet_action_t
 
 } sai_packet_action_t;
 
+/**
+ * @brief Attribute data for #SAI_SWITCH_ATTR_TABLE_PAGE_SIZE
+ */
+typedef enum _sai_switch_table_page_size_t
+{
+    /** Pages of the operating system's default size */
+    SAI_SWITCH_TABLE_PAGE_SIZE_DEFAULT,
+
+    /** 2 MB huge pages */
+    SAI_SWITCH_TABLE_PAGE_SIZE_2MB,
+
+    /** 1 GB huge pages */
+    SAI_SWITCH_TABLE_PAGE_SIZE_1GB,
+
+} sai_switch_table_page_size_t;
+
 /**
  * @brief Attribute Id in sai_set_switch_attribute() and
  * sai_get_switch_attribute() calls.
@@ -186,6 +202,40 @@ typedef enum _sai_switch_attr_t
      */
     SAI_SWITCH_ATTR_INIT_SWITCH,
 
+    /**
+     * @brief Page size of the memory of the large tables
+     *
+     * Connection table, flow caches, CA to PA mappings and routing tries.
+     * Huge pages are reserved at create; when the system has too few,
+     * the switch falls back to the next smaller page size.
+     *
+     * @type sai_switch_table_page_size_t
+     * @flags CREATE_ONLY
+     * @default SAI_SWITCH_TABLE_PAGE_SIZE_DEFAULT
+     */
+    SAI_SWITCH_ATTR_TABLE_PAGE_SIZE,
+
+    /**
+     * @brief NUMA node the memory of the tables shared by all cores is bound to
+     *
+     * CA to PA mappings, routing tries and the switch's connection table.
+     * -1 leaves the memory unbound.
+     *
+     * @type sai_int32_t
+     * @flags CREATE_ONLY
+     * @default -1
+     */
+    SAI_SWITCH_ATTR_TABLE_NUMA_NODE,
+
+    /**
+     * @brief Bind every core's connection table partition and flow cache to the NUMA node of the core
+     *
+     * @type bool
+     * @flags CREATE_ONLY
+     * @default false
+     */
+    SAI_SWITCH_ATTR_FLOW_TABLE_NUMA_LOCAL,
+
     /**
      * @brief Port state change notification callback function passed to the adapter.
      *
@@ -0,0 +1,220 @@
+/*
+ * Lookup rate of the compiled ACL classifier.
+ *
+ * usage: bench_acl [lookups]
+ *
+ * Compiles random rule sets of 1k, 10k and 100k rules (dip/sip prefix
+ * lists, protocol lists, sport/dport range lists) for one ENI and looks
+ * up `lookups` packet keys, half of them built to fall inside a random
+ * rule. Reports compile time, classifier memory and tree depth, the
+ * classifier lookup rate and that of a linear scan over the same rules.
+ * Every key looked up by the linear scan is also checked against the
+ * classifier, action and matching rule.
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <random>
+
+#include "../sirius_acl_classifier.h"
+#include "bench_packets.h"
+
+using namespace sirius;
+using namespace sirius::bench;
+
+namespace {
+
+struct rule_gen {
+    std::mt19937 rng{ 1 };
+
+    uint32_t uniform(uint32_t lo, uint32_t hi)
+    {
+        return std::uniform_int_distribution<uint32_t>(lo, hi)(rng);
+    }
+
+    bool chance(unsigned percent)
+    {
+        return uniform(0, 99) < percent;
+    }
+
+    acl_prefix_t prefix(uint8_t min_len, uint8_t max_len)
+    {
+        uint8_t len = (uint8_t)uniform(min_len, max_len);
+        uint32_t mask = ~0u << (32 - len);
+        return { (0x0a000000 | (uniform(0, 0xffffff))) & mask, len };
+    }
+
+    acl_port_range_t ports()
+    {
+        uint16_t lo = (uint16_t)uniform(1, 65535);
+        uint16_t width = chance(50) ? 0 : (uint16_t)uniform(1, 1000);
+        return { lo, (uint16_t)std::min<uint32_t>(65535, lo + width) };
+    }
+
+    acl_rule_t rule()
+    {
+        acl_rule_t r = {};
+        r.action = (acl_action_t)uniform(ACL_ACTION_PERMIT, ACL_ACTION_DENY_AND_CONTINUE);
+        for (uint32_t n = uniform(1, 4); n; n--) {
+            r.dip.push_back(prefix(16, 32));
+        }
+        if (chance(50)) {
+            for (uint32_t n = uniform(1, 2); n; n--) {
+                r.sip.push_back(prefix(8, 24));
+            }
+        }
+        if (chance(60)) {
+            r.protocol.push_back(TCP_PROTO);
+            if (chance(30)) {
+                r.protocol.push_back(UDP_PROTO);
+            }
+        }
+        if (chance(10)) {
+            r.sport.push_back(ports());
+        }
+        if (!chance(30)) {
+            for (uint32_t n = uniform(1, 3); n; n--) {
+                r.dport.push_back(ports());
+            }
+        }
+        return r;
+    }
+
+    /* A key inside rule r (which may still hit an earlier rule first) */
+    acl_key_t key_in(const acl_rule_t &r)
+    {
+        acl_key_t k = random_key();
+        auto in_prefix = [&](const std::vector<acl_prefix_t> &list, ipv4_addr_t &out) {
+            if (!list.empty()) {
+                const acl_prefix_t &p = list[uniform(0, (uint32_t)list.size() - 1)];
+                uint32_t host = p.len >= 32 ? 0 : ~0u >> p.len;
+                out = p.addr | (uniform(0, ~0u) & host);
+            }
+        };
+        auto in_range = [&](const std::vector<acl_port_range_t> &list, uint16_t &out) {
+            if (!list.empty()) {
+                const acl_port_range_t &p = list[uniform(0, (uint32_t)list.size() - 1)];
+                out = (uint16_t)uniform(p.min, p.max);
+            }
+        };
+        in_prefix(r.dip, k.dip);
+        in_prefix(r.sip, k.sip);
+        if (!r.protocol.empty()) {
+            k.protocol = r.protocol[uniform(0, (uint32_t)r.protocol.size() - 1)];
+        }
+        in_range(r.sport, k.sport);
+        in_range(r.dport, k.dport);
+        return k;
+    }
+
+    acl_key_t random_key()
+    {
+        acl_key_t k;
+        k.dip = 0x0a000000 | uniform(0, 0xffffff);
+        k.sip = 0x0a000000 | uniform(0, 0xffffff);
+        k.protocol = chance(80) ? TCP_PROTO : UDP_PROTO;
+        k.sport = (uint16_t)uniform(1024, 65535);
+        k.dport = (uint16_t)uniform(1, 65535);
+        return k;
+    }
+};
+
+/* Reference semantics: first rule in priority order whose every field matches */
+bool linear_classify(const std::vector<acl_rule_t> &rules, const acl_key_t &k, acl_action_t &action, uint32_t &counter)
+{
+    auto prefix_match = [](const std::vector<acl_prefix_t> &list, ipv4_addr_t v) {
+        if (list.empty()) {
+            return true;
+        }
+        for (const acl_prefix_t &p : list) {
+            uint32_t mask = p.len ? ~0u << (32 - p.len) : 0;
+            if ((v & mask) == p.addr) {
+                return true;
+            }
+        }
+        return false;
+    };
+    auto range_match = [](const std::vector<acl_port_range_t> &list, uint16_t v) {
+        if (list.empty()) {
+            return true;
+        }
+        for (const acl_port_range_t &r : list) {
+            if (v >= r.min && v <= r.max) {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    for (const acl_rule_t &r : rules) {
+        if (prefix_match(r.dip, k.dip) && prefix_match(r.sip, k.sip) &&
+            (r.protocol.empty() || std::find(r.protocol.begin(), r.protocol.end(), k.protocol) != r.protocol.end()) &&
+            range_match(r.sport, k.sport) && range_match(r.dport, k.dport)) {
+            action = r.action;
+            counter = r.counter;
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    uint32_t lookups = argc > 1 ? (uint32_t)strtoul(argv[1], nullptr, 0) : 4000000;
+    if (!lookups) {
+        fprintf(stderr, "usage: %s [lookups]\n", argv[0]);
+        return 1;
+    }
+
+    printf("%8s %10s %10s %6s %10s %12s %12s %10s\n",
+           "rules", "compile_ms", "memory_KB", "depth", "hit_%", "classify_ns", "linear_ns", "mismatch");
+
+    for (uint32_t count : { 1000u, 10000u, 100000u }) {
+        rule_gen gen;
+        std::vector<acl_rule_t> rules(count);
+        std::vector<const acl_rule_t *> ordered(count);
+        for (uint32_t i = 0; i < count; i++) {
+            rules[i] = gen.rule();
+            rules[i].counter = i + 1;
+            ordered[i] = &rules[i];
+        }
+
+        std::vector<acl_key_t> keys(lookups);
+        for (uint32_t i = 0; i < lookups; i++) {
+            keys[i] = gen.chance(50) ? gen.key_in(rules[gen.uniform(0, count - 1)]) : gen.random_key();
+        }
+
+        auto start = bench_clock::now();
+        acl_classifier classifier(ordered);
+        double compile = seconds_since(start);
+
+        uint64_t hits = 0;
+        acl_action_t action;
+        uint32_t counter;
+        start = bench_clock::now();
+        for (const acl_key_t &k : keys) {
+            hits += classifier.classify(k, action, counter);
+        }
+        double classify = seconds_since(start);
+
+        /* The linear scan is slow at 100k rules; time it on a sample */
+        uint32_t sample = std::min<uint32_t>(lookups, 20000000 / count);
+        uint64_t mismatch = 0;
+        start = bench_clock::now();
+        for (uint32_t i = 0; i < sample; i++) {
+            acl_action_t expected;
+            uint32_t expected_counter;
+            bool hit = linear_classify(rules, keys[i], expected, expected_counter);
+            mismatch += hit != classifier.classify(keys[i], action, counter) ||
+                        (hit && (action != expected || counter != expected_counter));
+        }
+        double linear = seconds_since(start);
+
+        printf("%8u %10.1f %10.0f %6u %10.1f %12.1f %12.1f %10lu\n",
+               count, compile * 1e3, classifier.memory() / 1024.0, classifier.depth(),
+               100.0 * hits / lookups, classify * 1e9 / lookups, linear * 1e9 / sample, (unsigned long)mismatch);
+    }
+    return 0;
+}
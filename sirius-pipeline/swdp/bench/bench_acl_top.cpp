@@ -0,0 +1,175 @@
+/*
+ * Cost and accuracy of the ACL rule counters and their top rules report.
+ *
+ * usage: bench_acl_top [lookups] [rules] [top]
+ *
+ * Programs `rules` (48000) rules for one ENI in one ACL stage, rule i
+ * matching the destinations of one /32, and classifies `lookups` (10M)
+ * keys whose rules follow a Zipf distribution (s = 1.1), counting every
+ * hit into the rule's counter as the pipeline does. Runs the lookups
+ * twice: without sampling and with the pipeline's sampling for the top
+ * rules, and reports nanoseconds per lookup of both.
+ *
+ * Then reads the `top` (10) rules the report finds hottest and compares
+ * them with the actual top rules of the run, and times the report next
+ * to a read of the counters of all rules.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <random>
+
+#include "../sirius_acl_table.h"
+#include "bench_packets.h"
+
+using namespace sirius;
+using namespace sirius::bench;
+
+namespace {
+
+constexpr uint16_t ENI = 1;
+
+acl_key_t rule_key(uint32_t rule)
+{
+    acl_key_t k = {};
+    k.dip = 0x0a000000 | rule;
+    k.sip = 0x0b000001;
+    k.protocol = TCP_PROTO;
+    k.sport = 40000;
+    k.dport = 443;
+    return k;
+}
+
+/* Rules of the lookups, rank r drawn with weight 1 / (r + 1)^1.1 over shuffled rules */
+std::vector<uint32_t> zipf_rules(uint32_t lookups, uint32_t rules)
+{
+    std::mt19937 rng(1);
+    std::vector<double> weights(rules);
+    for (uint32_t r = 0; r < rules; r++) {
+        weights[r] = 1.0 / std::pow(r + 1.0, 1.1);
+    }
+    std::vector<uint32_t> rank_rule(rules);
+    for (uint32_t r = 0; r < rules; r++) {
+        rank_rule[r] = r;
+    }
+    std::shuffle(rank_rule.begin(), rank_rule.end(), rng);
+
+    std::discrete_distribution<uint32_t> rank(weights.begin(), weights.end());
+    std::vector<uint32_t> out(lookups);
+    for (uint32_t &rule : out) {
+        rule = rank_rule[rank(rng)];
+    }
+    return out;
+}
+
+/* Classifies the keys of lookups as the pipeline does; returns ns per lookup */
+double run(const sirius_acl_table &table, sirius_counters::block *counters, const std::vector<uint32_t> &lookups,
+           bool sampling)
+{
+    uint32_t sample_state = 0x9e3779b9;
+    uint64_t misses = 0;
+    auto start = bench_clock::now();
+    for (uint32_t rule : lookups) {
+        bool sample = false;
+        if (sampling) {
+            sample_state ^= sample_state << 13;
+            sample_state ^= sample_state >> 17;
+            sample_state ^= sample_state << 5;
+            sample = !(sample_state & (sirius_acl_table::TOP_SAMPLE - 1));
+        }
+        acl_action_t action;
+        uint32_t counter;
+        if (table.classify(ENI, rule_key(rule), sample, action, counter)) {
+            counters->count(counter, 100);
+        } else {
+            misses++;
+        }
+    }
+    double ns = seconds_since(start) * 1e9 / lookups.size();
+    if (misses) {
+        fprintf(stderr, "%lu lookups missed\n", (unsigned long)misses);
+    }
+    return ns;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    uint32_t lookups = argc > 1 ? (uint32_t)strtoul(argv[1], nullptr, 0) : 10000000;
+    uint32_t rules = argc > 2 ? (uint32_t)strtoul(argv[2], nullptr, 0) : 48000;
+    uint32_t top = argc > 3 ? (uint32_t)strtoul(argv[3], nullptr, 0) : 10;
+    if (!lookups || !rules || rules > (1u << 24) || !top || top > heavy_hitters::CAPACITY) {
+        fprintf(stderr, "usage: %s [lookups] [rules <= 2^24] [top <= %u]\n", argv[0], heavy_hitters::CAPACITY);
+        return 1;
+    }
+
+    sirius_acl_table table;
+    sai_status_t status = SAI_STATUS_SUCCESS;
+    table.batch([&](sirius_acl_table::writer &w) {
+        for (uint32_t i = 0; i < rules && status == SAI_STATUS_SUCCESS; i++) {
+            acl_rule_t rule = {};
+            rule.action = ACL_ACTION_PERMIT;
+            rule.dip.push_back({ 0x0a000000 | i, 32 });
+            status = w.insert({ ENI, i }, rule);
+        }
+    });
+    if (status != SAI_STATUS_SUCCESS) {
+        fprintf(stderr, "insert failed: %d\n", status);
+        return 1;
+    }
+
+    std::vector<uint32_t> keys = zipf_rules(lookups, rules);
+    sirius_counters::block *counters = table.counters().attach();
+    double plain = run(table, counters, keys, false);
+    double sampled = run(table, counters, keys, true);
+    table.counters().detach(counters);
+
+    /* The actual top rules: both runs looked up the same keys */
+    std::vector<uint64_t> hits(rules);
+    for (uint32_t rule : keys) {
+        hits[rule] += 2;
+    }
+    std::vector<uint32_t> actual(rules);
+    for (uint32_t i = 0; i < rules; i++) {
+        actual[i] = i;
+    }
+    std::partial_sort(actual.begin(), actual.begin() + top, actual.end(),
+                      [&](uint32_t a, uint32_t b) { return hits[a] > hits[b]; });
+    actual.resize(top);
+
+    std::vector<acl_rule_counter_t> reported;
+    auto start = bench_clock::now();
+    table.top_rules(ENI, top, reported);
+    double top_time = seconds_since(start);
+
+    std::vector<uint32_t> priorities(rules);
+    for (uint32_t i = 0; i < rules; i++) {
+        priorities[i] = i;
+    }
+    std::vector<counter_t> all(rules);
+    std::unique_ptr<bool[]> found(new bool[rules]);
+    start = bench_clock::now();
+    table.rule_counters(ENI, priorities.data(), rules, all.data(), found.get());
+    double all_time = seconds_since(start);
+
+    uint32_t recall = 0, wrong_counts = 0;
+    for (const acl_rule_counter_t &r : reported) {
+        recall += std::find(actual.begin(), actual.end(), r.priority) != actual.end();
+        wrong_counts += r.counter.packets != hits[r.priority];
+    }
+
+    printf("%u rules, %u lookups, 1 in %u sampled\n", rules, lookups, sirius_acl_table::TOP_SAMPLE);
+    printf("%-10s %12s\n", "run", "ns/lookup");
+    printf("%-10s %12.1f\n", "counted", plain);
+    printf("%-10s %12.1f\n", "sampled", sampled);
+    printf("top %u: %u of the actual top %u, %u with wrong counts\n", top, recall, top, wrong_counts);
+    printf("%-4s %10s %12s %12s\n", "rank", "priority", "packets", "actual");
+    for (size_t i = 0; i < reported.size(); i++) {
+        printf("%-4zu %10u %12lu %12lu\n", i + 1, reported[i].priority, (unsigned long)reported[i].counter.packets,
+               (unsigned long)hits[actual[i]]);
+    }
+    printf("report: %.3f ms; counters of all rules: %.3f ms\n", top_time * 1e3, all_time * 1e3);
+    return recall == top && !wrong_counts ? 0 : 1;
+}
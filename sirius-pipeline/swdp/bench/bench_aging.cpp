@@ -0,0 +1,146 @@
+/*
+ * Flow aging of a full connection table: the cost of the timer wheel and
+ * the latency it adds to a worker's bursts.
+ *
+ * usage: bench_aging [connections] [active_percent] [seconds]
+ *
+ * Creates `connections` (14M) connections, half TCP and half UDP, spread
+ * over the first second, each with its aging timer, under the 1 second
+ * aging interval of program-scale-testing-requirements-draft.md. Then
+ * runs `seconds` (5) seconds of a simulated clock, tick by tick: every
+ * second, `active_percent` (90) percent of the connections have a packet,
+ * a table hit as the data path makes it, the others idle. After each 32
+ * hits, a burst's worth, the aging polls as the pipeline does.
+ *
+ * Reports the memory of the timers, per second the time spent in the
+ * aging and the connections it removed, then the latency of the polls and
+ * the most due timers left waiting for a later poll, and checks that
+ * exactly the idle connections were removed.
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+#include "../sirius_flow_aging.h"
+#include "bench_packets.h"
+
+using namespace sirius;
+using namespace sirius::bench;
+
+namespace {
+
+constexpr uint32_t PORTS = 50000;
+constexpr uint32_t TIMEOUT_MS = 1000;
+constexpr uint32_t BURST = 32;
+
+/* Ticks of a simulated second: a connection's packets come this many ticks apart */
+constexpr uint32_t SECOND_TICKS = (1000 + sirius_flow_aging::TICK_MS - 1) / sirius_flow_aging::TICK_MS;
+
+flow_key_t connection(uint32_t i)
+{
+    return { 0x0a000000 + i / PORTS, 0x64000001, (uint16_t)(1024 + i % PORTS), 443, (uint16_t)(i % 64),
+             i % 2 ? UDP_PROTO : TCP_PROTO };
+}
+
+/* Connection i is active unless it falls in the idle share */
+bool active(uint32_t i, uint32_t active_percent)
+{
+    return (uint32_t)(hash_mix(i) % 100) < active_percent;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    uint32_t count = argc > 1 ? (uint32_t)strtoul(argv[1], nullptr, 0) : 14000000;
+    uint32_t active_percent = argc > 2 ? (uint32_t)strtoul(argv[2], nullptr, 0) : 90;
+    uint32_t seconds = argc > 3 ? (uint32_t)strtoul(argv[3], nullptr, 0) : 5;
+    if (!count || active_percent > 100 || !seconds) {
+        fprintf(stderr, "usage: %s [connections] [active_percent <= 100] [seconds]\n", argv[0]);
+        return 1;
+    }
+
+    sirius_flow_table table(count + count / 8);
+    sirius_flow_aging aging(table);
+    aging.set_timeouts(TIMEOUT_MS, TIMEOUT_MS);
+
+    std::vector<double> polls;
+    size_t max_due = 0;
+    uint32_t tick = 0;
+    auto poll = [&] {
+        auto begin = bench_clock::now();
+        aging.poll(tick, nullptr);
+        polls.push_back(seconds_since(begin));
+        max_due = std::max(max_due, aging.due());
+    };
+
+    /* The connections of a tick, [first, end): its share of the second */
+    auto first = [&](uint32_t t) { return (uint32_t)((uint64_t)count * (t % SECOND_TICKS) / SECOND_TICKS); };
+    auto end = [&](uint32_t t) { return t % SECOND_TICKS == SECOND_TICKS - 1 ? count : first(t + 1); };
+
+    auto start = bench_clock::now();
+    for (tick = 0; tick < SECOND_TICKS; tick++) {
+        for (uint32_t i = first(tick); i < end(tick); i++) {
+            table.insert(connection(i), 1);
+            aging.inserted(connection(i));
+            if (!(i % BURST)) {
+                poll();
+            }
+        }
+    }
+    printf("%u connections, %u%% active, %u ms timeouts in %u ms ticks\n", count, active_percent, TIMEOUT_MS,
+           sirius_flow_aging::TICK_MS);
+    printf("fill: %.1f s, %zu timers in %.1f MB of blocks, %.1f bytes per timer\n", seconds_since(start),
+           aging.timers(), aging.memory() / 1e6, (double)aging.memory() / aging.timers());
+
+    uint32_t expected_idle = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        expected_idle += !active(i, active_percent);
+    }
+
+    printf("%-8s %12s %12s %12s\n", "second", "aging ms", "removed", "connections");
+    polls.clear();
+    double aging_total = 0;
+    for (uint32_t second = 0; second < seconds; second++) {
+        double aging_time = 0;
+        uint64_t expired = aging.expired();
+        for (uint32_t next = tick + SECOND_TICKS; tick < next; tick++) {
+            uint32_t hits = 0;
+            for (uint32_t i = first(tick); i < end(tick); i++) {
+                uint8_t state;
+                if (active(i, active_percent) && table.lookup(connection(i), state) && !(++hits % BURST)) {
+                    poll();
+                    aging_time += polls.back();
+                }
+            }
+            /* Idle stretches still poll, as a worker polls its queue */
+            do {
+                poll();
+                aging_time += polls.back();
+            } while (aging.due());
+        }
+        aging_total += aging_time;
+        printf("%-8u %12.1f %12lu %12zu\n", second, aging_time * 1e3, (unsigned long)(aging.expired() - expired),
+               table.size());
+    }
+
+    std::sort(polls.begin(), polls.end());
+    auto percentile = [&](double p) { return polls[(size_t)(p * (polls.size() - 1))] * 1e6; };
+    printf("aging: %.1f ms per second, %.1f ns per connection per timeout\n", aging_total * 1e3 / seconds,
+           aging_total * 1e9 / seconds / count);
+    printf("polls: %zu, median %.2f us, p99 %.2f us, p99.99 %.2f us, max %.2f us, most due timers waiting %zu\n",
+           polls.size(), percentile(0.5), percentile(0.99), percentile(0.9999), polls.back() * 1e6, max_due);
+
+    uint64_t idle_left = 0, active_lost = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        uint8_t state;
+        bool found = table.lookup(connection(i), state);
+        idle_left += found && !active(i, active_percent);
+        active_lost += !found && active(i, active_percent);
+    }
+    printf("removed %lu of %u idle connections, %lu idle left, %lu active lost, %lu evictions\n",
+           (unsigned long)aging.expired(), expected_idle, (unsigned long)idle_left, (unsigned long)active_lost,
+           (unsigned long)table.evictions());
+    return idle_left || active_lost || aging.expired() != expected_idle ? 1 : 0;
+}
@@ -0,0 +1,221 @@
+/*
+ * Programming rate of the single-entry versus the bulk DASH API.
+ *
+ * usage: bench_bulk [entries] [batch_size]
+ *
+ * Creates and removes `entries` outbound_ca_to_pa and outbound_routing
+ * entries once through the single-entry create/remove calls and once
+ * through bulk_create/bulk_remove in batches of `batch_size`, and reports
+ * entries per second for each path.
+ */
+
+#include <arpa/inet.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "../sirius_sai.h"
+
+namespace {
+
+using bench_clock = std::chrono::steady_clock;
+
+double seconds_since(bench_clock::time_point start)
+{
+    return std::chrono::duration<double>(bench_clock::now() - start).count();
+}
+
+sai_ip_address_t ipv4(uint32_t host_order)
+{
+    sai_ip_address_t ip = {};
+    ip.addr_family = SAI_IP_ADDR_FAMILY_IPV4;
+    ip.addr.ip4 = htonl(host_order);
+    return ip;
+}
+
+struct ca_to_pa_set {
+    std::vector<sai_outbound_ca_to_pa_entry_t> entries;
+    std::vector<std::vector<sai_attribute_t>> attrs;
+};
+
+ca_to_pa_set make_ca_to_pa(uint32_t count)
+{
+    ca_to_pa_set set;
+    set.entries.resize(count);
+    set.attrs.resize(count);
+    for (uint32_t i = 0; i < count; i++) {
+        auto &e = set.entries[i];
+        e.switch_id = SAI_NULL_OBJECT_ID;
+        e.dest_vni = (uint16_t)(i % 1024);
+        e.dip = ipv4(0x0a000000 + i);
+
+        auto &a = set.attrs[i];
+        a.resize(3);
+        a[0].id = SAI_OUTBOUND_CA_TO_PA_ENTRY_ATTR_UNDERLAY_DIP;
+        a[0].value.ipaddr = ipv4(0x64000000 + (i % 65536));
+        a[1].id = SAI_OUTBOUND_CA_TO_PA_ENTRY_ATTR_OVERLAY_DMAC;
+        for (int b = 0; b < 6; b++) {
+            a[1].value.mac[b] = (uint8_t)(i >> (b * 4));
+        }
+        a[2].id = SAI_OUTBOUND_CA_TO_PA_ENTRY_ATTR_USE_DST_VNI;
+        a[2].value.booldata = i & 1;
+    }
+    return set;
+}
+
+struct routing_set {
+    std::vector<sai_outbound_routing_entry_t> entries;
+    std::vector<sai_attribute_t> attrs;
+};
+
+routing_set make_routing(uint32_t count)
+{
+    routing_set set;
+    set.entries.resize(count);
+    set.attrs.resize(count);
+    for (uint32_t i = 0; i < count; i++) {
+        auto &e = set.entries[i];
+        e.switch_id = SAI_NULL_OBJECT_ID;
+        e.eni = (uint16_t)(i % 64);
+        e.destination.addr_family = SAI_IP_ADDR_FAMILY_IPV4;
+        e.destination.addr.ip4 = htonl(0x0a000000 + ((i / 64) << 8));
+        e.destination.mask.ip4 = htonl(0xffffff00);
+
+        set.attrs[i].id = SAI_OUTBOUND_ROUTING_ENTRY_ATTR_DEST_VNET_VNI;
+        set.attrs[i].value.u32 = 1000 + (i % 4096);
+    }
+    return set;
+}
+
+void report(const char *what, uint32_t count, double single, double bulk)
+{
+    printf("%-22s %12.0f %12.0f %8.2fx\n", what, count / single, count / bulk, single / bulk);
+}
+
+bool check(sai_status_t status, const char *what)
+{
+    if (status != SAI_STATUS_SUCCESS) {
+        fprintf(stderr, "%s failed: %d\n", what, status);
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    uint32_t count = argc > 1 ? (uint32_t)strtoul(argv[1], nullptr, 0) : 2000000;
+    uint32_t batch = argc > 2 ? (uint32_t)strtoul(argv[2], nullptr, 0) : 4096;
+    if (!count || !batch) {
+        fprintf(stderr, "usage: %s [entries] [batch_size]\n", argv[0]);
+        return 1;
+    }
+
+    const sai__api_t *api = sirius_dash_api_query();
+    std::vector<sai_status_t> statuses(batch);
+    std::vector<uint32_t> attr_count(batch);
+    std::vector<const sai_attribute_t *> attr_list(batch);
+
+    printf("%u entries, bulk batch %u\n", count, batch);
+    printf("%-22s %12s %12s %9s\n", "operation", "single/s", "bulk/s", "speedup");
+
+    ca_to_pa_set ca = make_ca_to_pa(count);
+
+    auto start = bench_clock::now();
+    for (uint32_t i = 0; i < count; i++) {
+        if (!check(api->create_outbound_ca_to_pa_entry(&ca.entries[i], 3, ca.attrs[i].data()), "create_outbound_ca_to_pa_entry")) {
+            return 1;
+        }
+    }
+    double single_create = seconds_since(start);
+
+    start = bench_clock::now();
+    for (uint32_t i = 0; i < count; i++) {
+        if (!check(api->remove_outbound_ca_to_pa_entry(&ca.entries[i]), "remove_outbound_ca_to_pa_entry")) {
+            return 1;
+        }
+    }
+    double single_remove = seconds_since(start);
+
+    start = bench_clock::now();
+    for (uint32_t i = 0; i < count; i += batch) {
+        uint32_t n = std::min(batch, count - i);
+        for (uint32_t j = 0; j < n; j++) {
+            attr_count[j] = 3;
+            attr_list[j] = ca.attrs[i + j].data();
+        }
+        if (!check(api->bulk_create_outbound_ca_to_pa_entry(n, &ca.entries[i], attr_count.data(), attr_list.data(),
+                                                            SAI_BULK_OP_ERROR_MODE_STOP_ON_ERROR, statuses.data()),
+                   "bulk_create_outbound_ca_to_pa_entry")) {
+            return 1;
+        }
+    }
+    double bulk_create = seconds_since(start);
+
+    start = bench_clock::now();
+    for (uint32_t i = 0; i < count; i += batch) {
+        uint32_t n = std::min(batch, count - i);
+        if (!check(api->bulk_remove_outbound_ca_to_pa_entry(n, &ca.entries[i], SAI_BULK_OP_ERROR_MODE_STOP_ON_ERROR,
+                                                            statuses.data()),
+                   "bulk_remove_outbound_ca_to_pa_entry")) {
+            return 1;
+        }
+    }
+    double bulk_remove = seconds_since(start);
+
+    report("ca_to_pa create", count, single_create, bulk_create);
+    report("ca_to_pa remove", count, single_remove, bulk_remove);
+
+    routing_set rt = make_routing(count);
+
+    start = bench_clock::now();
+    for (uint32_t i = 0; i < count; i++) {
+        if (!check(api->create_outbound_routing_entry(&rt.entries[i], 1, &rt.attrs[i]), "create_outbound_routing_entry")) {
+            return 1;
+        }
+    }
+    single_create = seconds_since(start);
+
+    start = bench_clock::now();
+    for (uint32_t i = 0; i < count; i++) {
+        if (!check(api->remove_outbound_routing_entry(&rt.entries[i]), "remove_outbound_routing_entry")) {
+            return 1;
+        }
+    }
+    single_remove = seconds_since(start);
+
+    start = bench_clock::now();
+    for (uint32_t i = 0; i < count; i += batch) {
+        uint32_t n = std::min(batch, count - i);
+        for (uint32_t j = 0; j < n; j++) {
+            attr_count[j] = 1;
+            attr_list[j] = &rt.attrs[i + j];
+        }
+        if (!check(api->bulk_create_outbound_routing_entry(n, &rt.entries[i], attr_count.data(), attr_list.data(),
+                                                           SAI_BULK_OP_ERROR_MODE_STOP_ON_ERROR, statuses.data()),
+                   "bulk_create_outbound_routing_entry")) {
+            return 1;
+        }
+    }
+    bulk_create = seconds_since(start);
+
+    start = bench_clock::now();
+    for (uint32_t i = 0; i < count; i += batch) {
+        uint32_t n = std::min(batch, count - i);
+        if (!check(api->bulk_remove_outbound_routing_entry(n, &rt.entries[i], SAI_BULK_OP_ERROR_MODE_STOP_ON_ERROR,
+                                                           statuses.data()),
+                   "bulk_remove_outbound_routing_entry")) {
+            return 1;
+        }
+    }
+    bulk_remove = seconds_since(start);
+
+    report("routing create", count, single_create, bulk_create);
+    report("routing remove", count, single_remove, bulk_remove);
+
+    return 0;
+}
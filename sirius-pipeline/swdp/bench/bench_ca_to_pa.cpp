@@ -0,0 +1,153 @@
+/*
+ * CA to PA mapping table: memory per mapping and lookup latency.
+ *
+ * usage: bench_ca_to_pa [mappings] [lookups] [pages]
+ *
+ * Programs `mappings` ca_to_pa mappings spread over 1024 VNIs in bulk
+ * batches, into the cuckoo table the switch uses and, for reference, into
+ * the sirius_table exact match table. Reports the programming rate, the
+ * cuckoo table's bytes per mapping and load factor, and the latency of
+ * `lookups` random hits and misses on both. `pages` (4k, 2m or 1g) places
+ * the cuckoo table on huge pages.
+ *
+ * Also inserts the mappings one at a time, growing the cuckoo table on
+ * the insert path, and fails if the table ever takes 32 bytes or more per
+ * mapping once it holds a batch.
+ */
+
+#include <cstdlib>
+#include <random>
+
+#include "../sirius_ca_to_pa.h"
+#include "../sirius_table.h"
+#include "bench_packets.h"
+
+using namespace sirius;
+using namespace sirius::bench;
+
+namespace {
+
+constexpr uint32_t BATCH = 65536;
+
+constexpr double MAX_BYTES_PER_MAPPING = 32;
+
+struct ca_to_pa_key_hash {
+    size_t operator()(const ca_to_pa_key_t &k) const
+    {
+        return hash_mix((uint64_t)k.dest_vni << 32 | k.dip);
+    }
+};
+
+ca_to_pa_key_t mapping_key(uint32_t i)
+{
+    return { (uint16_t)(i % 1024), 0x0a000000 + i / 1024 };
+}
+
+ca_to_pa_entry_t mapping_value(uint32_t i)
+{
+    return { 0x64000000 + i % 65536, 0x020000000000ULL | i, (i & 1) != 0, 0 };
+}
+
+template <typename Table>
+double program(Table &table, uint32_t count)
+{
+    auto start = bench_clock::now();
+    for (uint32_t done = 0; done < count;) {
+        uint32_t n = std::min(BATCH, count - done);
+        table.batch([&](typename Table::writer &w) {
+            w.reserve(n);
+            for (uint32_t i = done; i < done + n; i++) {
+                w.insert(mapping_key(i), mapping_value(i));
+            }
+        });
+        done += n;
+    }
+    return count / seconds_since(start);
+}
+
+/* The most bytes per mapping of a cuckoo table filled one insert at a time, from BATCH mappings on */
+double worst_bytes_per_mapping(uint32_t count, page_size_t pages)
+{
+    sirius_ca_to_pa table;
+    table.set_placement({ pages, -1 });
+    double worst = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        table.insert(mapping_key(i), mapping_value(i));
+        if (i + 1 >= BATCH) {
+            worst = std::max(worst, (double)table.memory() / (i + 1));
+        }
+    }
+    return worst;
+}
+
+/* ns per lookup of random keys, hits from [0, count), misses from above it */
+template <typename Table>
+double lookup(const Table &table, uint32_t count, uint32_t lookups, bool hit, uint64_t &found)
+{
+    std::mt19937 rng(hit ? 2 : 3);
+    std::vector<ca_to_pa_key_t> keys(1 << 20);
+    for (auto &k : keys) {
+        k = mapping_key(hit ? rng() % count : count + rng() % count);
+    }
+
+    found = 0;
+    auto start = bench_clock::now();
+    for (uint32_t i = 0; i < lookups; i++) {
+        ca_to_pa_entry_t value;
+        found += table.lookup(keys[i & (keys.size() - 1)], value);
+    }
+    return seconds_since(start) * 1e9 / lookups;
+}
+
+template <typename Table>
+void report(const char *name, const Table &table, double rate, uint32_t count, uint32_t lookups)
+{
+    uint64_t hits, misses;
+    double hit_ns = lookup(table, count, lookups, true, hits);
+    double miss_ns = lookup(table, count, lookups, false, misses);
+    printf("%-14s %14.0f %10.1f %10.1f %8s\n", name, rate, hit_ns, miss_ns,
+           hits == lookups && !misses ? "ok" : "WRONG");
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    uint32_t count = argc > 1 ? (uint32_t)strtoul(argv[1], nullptr, 0) : 10000000;
+    uint32_t lookups = argc > 2 ? (uint32_t)strtoul(argv[2], nullptr, 0) : 20000000;
+    page_size_t pages = PAGE_SIZE_DEFAULT;
+    if (!count || !lookups || (argc > 3 && !parse_page_size(argv[3], pages))) {
+        fprintf(stderr, "usage: %s [mappings] [lookups] [4k|2m|1g]\n", argv[0]);
+        return 1;
+    }
+
+    bool ok = true;
+    printf("%u mappings, %u lookups\n", count, lookups);
+    printf("%-14s %14s %10s %10s %8s\n", "table", "mappings/s", "hit_ns", "miss_ns", "check");
+
+    {
+        sirius_ca_to_pa table;
+        table.set_placement({ pages, -1 });
+        double rate = program(table, count);
+        report("cuckoo", table, rate, count, lookups);
+        printf("cuckoo: %.1f MB on %s pages, %.1f bytes/mapping, load factor %.2f\n", table.memory() / 1048576.0,
+               page_size_name(table.placement().page_size), (double)table.memory() / table.size(),
+               table.load_factor());
+        ok &= count < BATCH || (double)table.memory() / table.size() < MAX_BYTES_PER_MAPPING;
+    }
+    if (count >= BATCH) {
+        double worst = worst_bytes_per_mapping(count, pages);
+        printf("cuckoo: at most %.1f bytes/mapping while growing one insert at a time\n", worst);
+        ok &= worst < MAX_BYTES_PER_MAPPING;
+    }
+    {
+        sirius_table<ca_to_pa_key_t, ca_to_pa_entry_t, ca_to_pa_key_hash> table;
+        double rate = program(table, count);
+        report("sirius_table", table, rate, count, lookups);
+    }
+    if (!ok) {
+        printf("FAILED: %.0f or more bytes/mapping\n", MAX_BYTES_PER_MAPPING);
+        return 1;
+    }
+    return 0;
+}
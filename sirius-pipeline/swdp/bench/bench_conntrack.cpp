@@ -0,0 +1,103 @@
+/*
+ * Connection tracking table: insert rate, lookup latency and eviction.
+ *
+ * usage: bench_conntrack [connections] [lookups] [pages]
+ *
+ * Fills a flow table sized for `connections` with as many connections and
+ * reports the insert rate, bytes per connection and the evictions the
+ * fill caused, then the latency of `lookups` random hits and misses.
+ * Finally inserts another half of `connections` new connections into the
+ * full table while looking up a hot tenth of the first ones, and reports
+ * which share of the hot and of the idle connections survived. `pages`
+ * (4k, 2m or 1g) places the table on huge pages.
+ */
+
+#include <cstdlib>
+#include <random>
+
+#include "../sirius_flow_table.h"
+#include "bench_packets.h"
+
+using namespace sirius;
+using namespace sirius::bench;
+
+namespace {
+
+constexpr uint32_t PORTS = 50000;
+
+flow_key_t connection(uint32_t i)
+{
+    return { 0x0a000000 + i / PORTS, 0x64000001, (uint16_t)(1024 + i % PORTS), 443, (uint16_t)(i % 64), TCP_PROTO };
+}
+
+/* ns per lookup of random keys, hits from [0, count), misses from above it */
+double lookup(const sirius_flow_table &table, uint32_t count, uint32_t lookups, bool hit, uint64_t &found)
+{
+    std::mt19937 rng(hit ? 2 : 3);
+    std::vector<flow_key_t> keys(1 << 20);
+    for (auto &k : keys) {
+        k = connection(hit ? rng() % count : count + rng() % count);
+    }
+
+    found = 0;
+    auto start = bench_clock::now();
+    for (uint32_t i = 0; i < lookups; i++) {
+        uint8_t state;
+        found += table.lookup(keys[i & (keys.size() - 1)], state);
+    }
+    return seconds_since(start) * 1e9 / lookups;
+}
+
+/* Share of the connections in [begin, end) still in the table */
+double survived(const sirius_flow_table &table, uint32_t begin, uint32_t end)
+{
+    uint64_t found = 0;
+    for (uint32_t i = begin; i < end; i++) {
+        uint8_t state;
+        found += table.lookup(connection(i), state);
+    }
+    return 100.0 * found / (end - begin);
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    uint32_t count = argc > 1 ? (uint32_t)strtoul(argv[1], nullptr, 0) : 50000000;
+    uint32_t lookups = argc > 2 ? (uint32_t)strtoul(argv[2], nullptr, 0) : 20000000;
+    page_size_t pages = PAGE_SIZE_DEFAULT;
+    if (count < 10 || !lookups || (argc > 3 && !parse_page_size(argv[3], pages))) {
+        fprintf(stderr, "usage: %s [connections] [lookups] [4k|2m|1g]\n", argv[0]);
+        return 1;
+    }
+
+    sirius_flow_table table(count, { pages, -1 });
+    printf("%u connections, %u lookups, %s pages\n", count, lookups, page_size_name(table.placement().page_size));
+
+    auto start = bench_clock::now();
+    for (uint32_t i = 0; i < count; i++) {
+        table.insert(connection(i), 1);
+    }
+    double rate = count / seconds_since(start);
+    printf("fill: %.0f inserts/s, %.1f MB, %.1f bytes/connection, %lu evictions\n", rate,
+           table.memory() / 1048576.0, (double)table.memory() / table.size(), (unsigned long)table.evictions());
+
+    uint64_t hits, misses;
+    double hit_ns = lookup(table, count, lookups, true, hits);
+    double miss_ns = lookup(table, count, lookups, false, misses);
+    printf("lookup: hit %.1f ns, miss %.1f ns\n", hit_ns, miss_ns);
+
+    uint32_t hot = count / 10;
+    uint64_t evictions = table.evictions();
+    start = bench_clock::now();
+    for (uint32_t i = 0; i < count / 2; i++) {
+        uint8_t state;
+        table.lookup(connection(i % hot), state);
+        table.insert(connection(count + i), 1);
+    }
+    rate = count / 2 / seconds_since(start);
+    printf("churn: %.0f lookups+inserts/s, %lu evictions, %.1f%% of hot and %.1f%% of idle connections left\n",
+           rate, (unsigned long)(table.evictions() - evictions), survived(table, 0, hot),
+           survived(table, hot, count));
+    return 0;
+}
@@ -0,0 +1,449 @@
+/*
+ * Connections per second of the software pipeline on one core, under the
+ * load of program-scale-testing-requirements-draft.md.
+ *
+ * usage: bench_cps [seconds] [tcp_background] [udp_background] [enis] [workers]
+ *
+ * Programs `enis` (8) ENIs as bench_pipeline does, with 2M ca_to_pa
+ * mappings, then sets up `tcp_background` (2M) TCP connections and
+ * `udp_background` (2M) bidirectional UDP flows. For `seconds` (100) it
+ * then sends every background connection and flow one packet in each
+ * direction per second, which keeps them alive under a 1 second aging
+ * interval, and fills the rest of each second with new connections of
+ * six packets: SYN, SYN-ACK, ACK, FIN-ACK, FIN-ACK, ACK.
+ *
+ * The traffic runs through a sirius_dataplane of `workers` (1) workers.
+ * Each worker thread plays its own NIC queue: it generates the background
+ * flows and new connections that hash to it and runs them through its
+ * pipeline.
+ *
+ * Reports per second the connections completed, the packet rate, the
+ * connections in the flow table and the background packets that missed
+ * their second, then the sustained CPS, the flow table high water mark
+ * against the profile's table size (2 * CPS + 2M + 2M), the connections
+ * left in the table after the run that are not background connections or
+ * flows, the memory of the connection state (sirius_dataplane::memory()),
+ * and the packets dropped or connections evicted.
+ *
+ * Then checks the aging: the background goes quiet until its UDP flows
+ * aged out. Reports the background flows the aging removed while they
+ * still got their packets, the idle UDP flows it removed, and how long
+ * after their timeout it removed them (sirius_flow_aging::late()). Closed
+ * connections go with their last ACK, none may be left after teardown.
+ * Exits with 1 when an active flow was removed, an idle or closed one was
+ * not, or one was removed more than LATE_LIMIT_MS after its timeout.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <thread>
+
+#include "../sirius_dataplane.h"
+#include "bench_program.h"
+
+using namespace sirius;
+using namespace sirius::bench;
+
+namespace {
+
+constexpr uint32_t BURST = 32;
+constexpr uint32_t BUF_SIZE = 2048;
+constexpr uint32_t MAPPINGS = 2000000;
+
+/* Background packets are sent ahead of this share of each second */
+constexpr double BACKGROUND_SHARE = 0.9;
+
+/* The most an idle flow may stay past its timeout: a tick of the clock, and the polls of a tick's due timers */
+constexpr uint32_t LATE_LIMIT_MS = 250;
+
+/* How long the background is left idle at most for its UDP flows to age out: well past their timeout */
+constexpr double IDLE_SECONDS = 5;
+
+enum flow_kind_t : uint16_t {
+    BACKGROUND_TCP = 443,
+    BACKGROUND_UDP = 53,
+    CPS_TCP = 80,
+};
+
+/* Flow i of a kind, the kind is its destination port */
+flow_t kind_flow(flow_kind_t kind, uint64_t i, uint32_t enis)
+{
+    flow_t f = vm_flow((uint32_t)(i % MAPPINGS), enis);
+    f.sport = (uint16_t)(1024 + i / MAPPINGS % 60000);
+    f.dport = kind;
+    f.protocol = kind == BACKGROUND_UDP ? UDP_PROTO : TCP_PROTO;
+    return f;
+}
+
+/* The worker the NIC would hand the flow's packets to */
+unsigned worker_of(const sirius_dataplane &dataplane, const flow_t &f)
+{
+    return dataplane.worker_of_hash(
+        sirius_dataplane::flow_hash(htonl(f.sip), htonl(f.dip), htons(f.sport), htons(f.dport), f.protocol));
+}
+
+/* Initial sequence numbers of the VM and the VNET side, the first wraps during the close */
+constexpr uint32_t VM_ISN = 0xfffffffe;
+constexpr uint32_t VNET_ISN = 0x40000000;
+
+/* The six packets of a connection, outbound unless reply */
+struct cps_step_t {
+    bool reply;
+    uint8_t tcp_flags;
+    uint32_t seq;
+    uint32_t ack;
+};
+
+constexpr cps_step_t CPS_STEPS[] = {
+    { false, TCP_FLAG_SYN, VM_ISN, 0 },
+    { true, TCP_FLAG_SYN | TCP_FLAG_ACK, VNET_ISN, VM_ISN + 1 },
+    { false, TCP_FLAG_ACK, VM_ISN + 1, VNET_ISN + 1 },
+    { false, TCP_FLAG_FIN | TCP_FLAG_ACK, VM_ISN + 1, VNET_ISN + 1 },
+    { true, TCP_FLAG_FIN | TCP_FLAG_ACK, VNET_ISN + 1, VM_ISN + 2 },
+    { false, TCP_FLAG_ACK, VM_ISN + 2, VNET_ISN + 2 },
+};
+
+constexpr uint32_t CPS_PACKETS = sizeof(CPS_STEPS) / sizeof(CPS_STEPS[0]);
+
+class traffic_t {
+public:
+    traffic_t(sirius_pipeline &pipeline, uint32_t enis)
+        : m_pipeline(pipeline), m_enis(enis), m_bufs(BURST * BUF_SIZE), m_pkts(BURST)
+    {
+    }
+
+    /* Queues one packet of flow f, in the reply direction if reply; sends the burst once full */
+    void add(flow_t f, bool reply)
+    {
+        packet_t &pkt = m_pkts[m_count];
+        pkt = {};
+        pkt.buf = &m_bufs[m_count * BUF_SIZE];
+        pkt.buf_size = BUF_SIZE;
+        pkt.data_off = PACKET_HEADROOM;
+        pkt.len = reply ? build_vxlan_frame(pkt.data(), INBOUND_TUNNEL, reverse(f))
+                        : build_vxlan_frame(pkt.data(), OUTBOUND_TUNNEL, f);
+        if (++m_count == BURST) {
+            flush();
+        }
+    }
+
+    void flush()
+    {
+        m_pipeline.process_burst(m_pkts.data(), m_count);
+        for (uint32_t i = 0; i < m_count; i++) {
+            dropped += m_pkts[i].drop;
+        }
+        packets += m_count;
+        m_count = 0;
+    }
+
+    uint32_t enis() const { return m_enis; }
+
+    uint64_t packets = 0;
+    uint64_t dropped = 0;
+
+private:
+    sirius_pipeline &m_pipeline;
+    uint32_t m_enis;
+    std::vector<uint8_t> m_bufs;
+    std::vector<packet_t> m_pkts;
+    uint32_t m_count = 0;
+};
+
+/*
+ * Connections in flight, BURST at a time: each call sends the next step
+ * of all of them, so a connection's packets go out in order, one burst
+ * apart, and BURST connections complete every CPS_PACKETS calls. Only
+ * connections of one worker are opened.
+ */
+class cps_t {
+public:
+    cps_t(const sirius_dataplane &dataplane, unsigned worker) : m_dataplane(dataplane), m_worker(worker) {}
+
+    /* Connections completed */
+    uint64_t step(traffic_t &traffic)
+    {
+        if (m_step == 0) {
+            for (uint32_t i = 0; i < BURST; i++) {
+                do {
+                    m_flows[i] = kind_flow(CPS_TCP, m_next++, traffic.enis());
+                } while (worker_of(m_dataplane, m_flows[i]) != m_worker);
+            }
+        }
+        const cps_step_t &s = CPS_STEPS[m_step];
+        for (flow_t &f : m_flows) {
+            f.tcp_flags = s.tcp_flags;
+            f.seq = s.seq;
+            f.ack = s.ack;
+            traffic.add(f, s.reply);
+        }
+        if (++m_step < CPS_PACKETS) {
+            return 0;
+        }
+        m_step = 0;
+        return BURST;
+    }
+
+    /* Whether connections are half way through */
+    bool open() const { return m_step != 0; }
+
+private:
+    const sirius_dataplane &m_dataplane;
+    unsigned m_worker;
+    flow_t m_flows[BURST];
+    uint64_t m_next = 0;
+    uint32_t m_step = 0;
+};
+
+/* Background flows of one worker: TCP connections, then UDP flows */
+struct background_t {
+    std::vector<flow_t> flows;
+    size_t tcp = 0;
+
+    background_t(const sirius_dataplane &dataplane, unsigned worker, uint32_t tcp_flows, uint32_t udp_flows,
+                 uint32_t enis)
+    {
+        for (uint32_t i = 0; i < tcp_flows + udp_flows; i++) {
+            flow_t f = i < tcp_flows ? kind_flow(BACKGROUND_TCP, i, enis) : kind_flow(BACKGROUND_UDP, i - tcp_flows, enis);
+            if (worker_of(dataplane, f) == worker) {
+                flows.push_back(f);
+                tcp += i < tcp_flows;
+            }
+        }
+    }
+
+    size_t udp() const { return flows.size() - tcp; }
+
+    /* Packet i of a second: both directions of each flow */
+    uint64_t packets() const { return 2 * flows.size(); }
+    void add(traffic_t &traffic, uint64_t i) const { traffic.add(flows[i / 2], i % 2); }
+
+    /* SYN, SYN-ACK, ACK of each TCP connection, the first packet of each UDP flow */
+    void setup(traffic_t &traffic) const
+    {
+        for (size_t i = 0; i < flows.size(); i++) {
+            flow_t f = flows[i];
+            if (i >= tcp) {
+                traffic.add(f, false);
+                continue;
+            }
+            for (uint32_t step = 0; step < 3; step++) {
+                f.tcp_flags = CPS_STEPS[step].tcp_flags;
+                f.seq = CPS_STEPS[step].seq;
+                f.ack = CPS_STEPS[step].ack;
+                traffic.add(f, CPS_STEPS[step].reply);
+            }
+        }
+        traffic.flush();
+    }
+};
+
+/* What a worker counted in one second */
+struct second_t {
+    uint64_t connections;
+    uint64_t packets;
+    uint64_t late;
+    size_t table;
+    double elapsed;
+};
+
+struct worker_result_t {
+    std::vector<second_t> seconds;
+    double setup_elapsed;
+    size_t high_water;
+    size_t left; /* connections in the flow table after teardown */
+    uint64_t packets;
+    uint64_t dropped;
+    uint64_t aged_active; /* background flows removed for idling while they got their packets */
+    uint64_t idle_udp;    /* background UDP flows left idle */
+    uint64_t aged_idle;   /* and removed for it */
+};
+
+/* Waits until all workers arrived */
+void barrier(std::atomic<unsigned> &arrived, unsigned workers)
+{
+    arrived.fetch_add(1);
+    while (arrived.load() < workers) {
+        std::this_thread::yield();
+    }
+}
+
+void run_worker(sirius_dataplane &dataplane, unsigned worker, uint32_t seconds, uint32_t tcp, uint32_t udp,
+                uint32_t enis, std::atomic<unsigned> &ready, worker_result_t &result)
+{
+    const sirius_flow_table &table = dataplane.flows(worker);
+    const sirius_flow_aging &aging = dataplane.aging(worker);
+    traffic_t traffic(dataplane.pipeline(worker), enis);
+    background_t background(dataplane, worker, tcp, udp, enis);
+    cps_t cps(dataplane, worker);
+
+    auto start = bench_clock::now();
+    background.setup(traffic);
+    result.setup_elapsed = seconds_since(start);
+    result.high_water = table.size();
+    uint64_t setup_packets = traffic.packets;
+    barrier(ready, dataplane.workers());
+
+    uint64_t total = background.packets();
+    uint64_t expired = aging.expired();
+    for (uint32_t second = 0; second < seconds; second++) {
+        auto second_start = bench_clock::now();
+        uint64_t second_packets = traffic.packets;
+        uint64_t connections = 0;
+        uint64_t sent = 0;
+
+        /* Background packets as they fall due over the second, new connections in between */
+        for (double elapsed = 0; elapsed < 1; elapsed = seconds_since(second_start)) {
+            uint64_t due = std::min<uint64_t>(total, (uint64_t)(total * elapsed / BACKGROUND_SHARE) + BURST);
+            if (sent < due) {
+                for (uint64_t end = std::min<uint64_t>(sent + BURST, total); sent < end; sent++) {
+                    background.add(traffic, sent);
+                }
+            } else {
+                connections += cps.step(traffic);
+            }
+            result.high_water = std::max(result.high_water, table.size());
+        }
+
+        /* Background packets the second had no time for, they would have aged */
+        uint64_t late = total - sent;
+        for (; sent < total; sent++) {
+            background.add(traffic, sent);
+        }
+        traffic.flush();
+        result.seconds.push_back(
+            { connections, traffic.packets - second_packets, late, table.size(), seconds_since(second_start) });
+    }
+
+    /* New connections close, so only the background could have idled */
+    result.aged_active = aging.expired() - expired;
+
+    /* Finish the connections still open */
+    while (cps.open()) {
+        cps.step(traffic);
+    }
+    traffic.flush();
+    result.left = table.size();
+    result.packets = traffic.packets - setup_packets;
+    result.dropped = traffic.dropped;
+    result.idle_udp = background.udp();
+}
+
+/* The background goes quiet: empty bursts poll the aging until its UDP flows are gone */
+void idle_worker(sirius_dataplane &dataplane, unsigned worker, uint32_t enis, worker_result_t &result)
+{
+    const sirius_flow_aging &aging = dataplane.aging(worker);
+    traffic_t traffic(dataplane.pipeline(worker), enis);
+    uint64_t expired = aging.expired();
+    auto start = bench_clock::now();
+    while (aging.expired() - expired < result.idle_udp && seconds_since(start) < IDLE_SECONDS) {
+        traffic.flush();
+    }
+    result.aged_idle = aging.expired() - expired;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    uint32_t seconds = argc > 1 ? (uint32_t)strtoul(argv[1], nullptr, 0) : 100;
+    uint32_t tcp = argc > 2 ? (uint32_t)strtoul(argv[2], nullptr, 0) : 2000000;
+    uint32_t udp = argc > 3 ? (uint32_t)strtoul(argv[3], nullptr, 0) : 2000000;
+    uint32_t enis = argc > 4 ? (uint32_t)strtoul(argv[4], nullptr, 0) : 8;
+    uint32_t workers = argc > 5 ? (uint32_t)strtoul(argv[5], nullptr, 0) : 1;
+    if (!seconds || !enis || enis > 4096 || !workers) {
+        fprintf(stderr, "usage: %s [seconds] [tcp_background] [udp_background] [enis <= 4096] [workers]\n",
+                argv[0]);
+        return 1;
+    }
+
+    auto start = bench_clock::now();
+    if (!program(sirius_dash_api_query(), MAPPINGS, enis)) {
+        return 1;
+    }
+    printf("programmed %u ENIs, %u mappings in %.1f s\n", enis, MAPPINGS, seconds_since(start));
+
+    /* Flow caches sized for both directions of the background flows and as many new connections */
+    sirius_dataplane dataplane(sai_switch(), workers, sirius_flow_table::DEFAULT_CAPACITY,
+                               4 * ((size_t)tcp + udp) + 1000000 * (size_t)workers);
+    std::vector<worker_result_t> results(workers);
+    std::atomic<unsigned> ready{ 0 };
+    dataplane.run([&](unsigned worker) {
+        run_worker(dataplane, worker, seconds, tcp, udp, enis, ready, results[worker]);
+    });
+
+    double setup_elapsed = 0;
+    size_t high_water = 0, left = 0;
+    uint64_t packets = 0, dropped = 0, evicted = 0;
+    for (unsigned w = 0; w < workers; w++) {
+        setup_elapsed = std::max(setup_elapsed, results[w].setup_elapsed);
+        high_water += results[w].high_water;
+        left += results[w].left;
+        packets += results[w].packets;
+        dropped += results[w].dropped;
+        evicted += dataplane.flows(w).evictions();
+    }
+    printf("set up %u TCP connections, %u UDP flows on %u workers in %.1f s\n", tcp, udp, workers, setup_elapsed);
+
+    uint64_t connections = 0, late_packets = 0;
+    uint64_t min_cps = UINT64_MAX;
+    double elapsed = 0;
+    printf("%-8s %12s %10s %14s %10s\n", "second", "CPS", "Mpps", "connections", "late");
+    for (uint32_t second = 0; second < seconds; second++) {
+        second_t sum = {};
+        for (const worker_result_t &r : results) {
+            const second_t &s = r.seconds[second];
+            sum.connections += s.connections;
+            sum.packets += s.packets;
+            sum.late += s.late;
+            sum.table += s.table;
+            sum.elapsed = std::max(sum.elapsed, s.elapsed);
+        }
+        connections += sum.connections;
+        late_packets += sum.late;
+        elapsed += sum.elapsed;
+        min_cps = std::min(min_cps, sum.connections);
+        printf("%-8u %12lu %10.2f %14zu %10lu\n", second, (unsigned long)sum.connections,
+               sum.packets / sum.elapsed / 1e6, sum.table, (unsigned long)sum.late);
+    }
+
+    double sustained = connections / elapsed;
+    flow_memory_t memory = dataplane.memory();
+    printf("sustained CPS %.0f, lowest second %lu\n", sustained, (unsigned long)min_cps);
+    printf("packets %lu, %.2f Mpps\n", (unsigned long)packets, packets / elapsed / 1e6);
+    printf("flow table high water %zu connections, profile table size %.0f\n", high_water,
+           2 * sustained + tcp + udp);
+    printf("connections left after teardown %zd (flow table %zu, background TCP %u, UDP %u)\n",
+           (ssize_t)left - (ssize_t)tcp - (ssize_t)udp, left, tcp, udp);
+    printf("connection state: table %.1f MB, timers %.1f MB, %.1f bytes per connection, %.1f%% of the timer "
+           "blocks unused\n",
+           memory.table_bytes / 1e6, memory.timer_bytes / 1e6, memory.bytes_per_connection(),
+           memory.fragmentation() * 100);
+    printf("background packets late %lu, packets dropped %lu, connections evicted %lu\n",
+           (unsigned long)late_packets, (unsigned long)dropped, (unsigned long)evicted);
+
+    dataplane.run([&](unsigned worker) { idle_worker(dataplane, worker, enis, results[worker]); });
+    uint64_t aged_active = 0, idle_udp = 0, aged_idle = 0, late = 0;
+    uint32_t max_late = 0;
+    for (unsigned w = 0; w < workers; w++) {
+        aged_active += results[w].aged_active;
+        idle_udp += results[w].idle_udp;
+        aged_idle += results[w].aged_idle;
+        late += dataplane.aging(w).late();
+        max_late = std::max(max_late, dataplane.aging(w).max_late());
+    }
+
+    /* Every removal for idling so far was of an active flow or an idle UDP one */
+    uint64_t removed = aged_active + aged_idle;
+    uint32_t max_late_ms = max_late * sirius_flow_aging::TICK_MS;
+    double mean_late_ms = removed ? (double)late * sirius_flow_aging::TICK_MS / removed : 0;
+    printf("aging: active background flows aged out %lu, idle UDP flows aged out %lu of %lu, %u ms past their "
+           "timeout at most, %.1f ms on average\n",
+           (unsigned long)aged_active, (unsigned long)aged_idle, (unsigned long)idle_udp, max_late_ms, mean_late_ms);
+    if (aged_active || aged_idle != idle_udp || max_late_ms > LATE_LIMIT_MS || left != (size_t)tcp + udp) {
+        printf("aging accuracy FAILED\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,193 @@
+/*
+ * Cost of polling the eni_meter counters while the pipeline runs.
+ *
+ * usage: bench_eni_stats [packets] [meter_enis] [interval_ms]
+ *
+ * Programs 64 ENIs as bench_pipeline does and creates the eni_meter
+ * entries of `meter_enis` (16384) ENIs, one per direction and dropped
+ * flag. Then runs `packets` (20M) frames of 65536 flows, outbound and
+ * inbound, through one pipeline twice: once alone and once while another
+ * thread reads the counters of all eni_meter entries with
+ * bulk_get_eni_meter_entry_stats every `interval_ms` (10) milliseconds.
+ *
+ * Reports the packet rate of both runs and the time of a bulk read, on
+ * an idle CPU and while polling (which includes the time the poller waits
+ * for the CPU when it shares one with the pipeline), then
+ * reads and clears all counters and checks them against the packets and
+ * bytes sent.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <thread>
+
+#include "../sirius_pipeline.h"
+#include "bench_program.h"
+
+using namespace sirius;
+using namespace sirius::bench;
+
+namespace {
+
+constexpr uint32_t BURST = 32;
+constexpr uint32_t BUF_SIZE = 2048;
+constexpr uint32_t FLOWS = 65536;
+constexpr uint32_t ENIS = 64;
+
+const sai_stat_id_t COUNTER_IDS[] = { SAI_ENI_METER_ENTRY_STAT_PACKETS, SAI_ENI_METER_ENTRY_STAT_BYTES };
+constexpr uint32_t COUNTERS = 2;
+
+std::vector<sai_eni_meter_entry_t> meter_entries(uint32_t meter_enis)
+{
+    std::vector<sai_eni_meter_entry_t> entries;
+    for (uint32_t eni = 0; eni < meter_enis; eni++) {
+        for (uint16_t direction : { DIRECTION_OUTBOUND, DIRECTION_INBOUND }) {
+            for (uint16_t dropped : { 0, 1 }) {
+                sai_eni_meter_entry_t e = {};
+                e.eni = (uint16_t)eni;
+                e.direction = direction;
+                e.dropped = dropped;
+                entries.push_back(e);
+            }
+        }
+    }
+    return entries;
+}
+
+/* Frames of both directions, interleaved, and their bytes */
+struct traffic_t {
+    std::vector<std::vector<uint8_t>> frames;
+    uint64_t bytes = 0;
+
+    traffic_t()
+    {
+        uint8_t frame[BUF_SIZE];
+        for (uint32_t i = 0; i < FLOWS; i++) {
+            flow_t f = vm_flow(i, ENIS);
+            frames.emplace_back(frame, frame + build_vxlan_frame(frame, OUTBOUND_TUNNEL, f));
+            frames.emplace_back(frame, frame + build_vxlan_frame(frame, INBOUND_TUNNEL, reverse(f)));
+        }
+    }
+
+    /* Sends packets frames round robin, returns Mpps and adds up the bytes sent */
+    double run(sirius_pipeline &pipeline, uint64_t packets)
+    {
+        std::vector<uint8_t> bufs(BURST * BUF_SIZE);
+        std::vector<packet_t> pkts(BURST);
+        size_t next = 0;
+
+        auto start = bench_clock::now();
+        for (uint64_t done = 0; done < packets; done += BURST) {
+            for (uint32_t i = 0; i < BURST; i++) {
+                const auto &frame = frames[next];
+                next = next + 1 == frames.size() ? 0 : next + 1;
+
+                packet_t &pkt = pkts[i];
+                pkt.buf = &bufs[i * BUF_SIZE];
+                pkt.buf_size = BUF_SIZE;
+                pkt.data_off = PACKET_HEADROOM;
+                pkt.len = (uint32_t)frame.size();
+                pkt.ingress_port = 0;
+                memcpy(pkt.data(), frame.data(), frame.size());
+                bytes += frame.size();
+            }
+            pipeline.process_burst(pkts.data(), BURST);
+        }
+        return packets / seconds_since(start) / 1e6;
+    }
+};
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    uint64_t packets = argc > 1 ? strtoull(argv[1], nullptr, 0) : 20000000;
+    uint32_t meter_enis = argc > 2 ? (uint32_t)strtoul(argv[2], nullptr, 0) : 16384;
+    uint32_t interval_ms = argc > 3 ? (uint32_t)strtoul(argv[3], nullptr, 0) : 10;
+    if (!packets || meter_enis < ENIS || meter_enis > 65536 || !interval_ms) {
+        fprintf(stderr, "usage: %s [packets] [64 <= meter_enis <= 65536] [interval_ms]\n", argv[0]);
+        return 1;
+    }
+    packets = (packets + BURST - 1) / BURST * BURST;
+
+    const sai__api_t *api = sirius_dash_api_query();
+    if (!program(api, FLOWS, ENIS)) {
+        return 1;
+    }
+    std::vector<sai_eni_meter_entry_t> entries = meter_entries(meter_enis);
+    uint32_t count = (uint32_t)entries.size();
+    std::vector<sai_status_t> statuses(count);
+    std::vector<uint32_t> attr_count(count, 0);
+    std::vector<const sai_attribute_t *> attr_list(count, nullptr);
+    if (!check(api->bulk_create_eni_meter_entry(count, entries.data(), attr_count.data(), attr_list.data(),
+                                                SAI_BULK_OP_ERROR_MODE_STOP_ON_ERROR, statuses.data()),
+               "bulk_create_eni_meter_entry")) {
+        return 1;
+    }
+
+    traffic_t traffic;
+    sirius_pipeline pipeline(sai_switch(), 2 * (size_t)FLOWS);
+
+    /* A bulk read on an idle CPU */
+    std::vector<uint64_t> counters((size_t)count * COUNTERS);
+    auto idle_start = bench_clock::now();
+    api->bulk_get_eni_meter_entry_stats(count, entries.data(), COUNTERS, COUNTER_IDS, SAI_STATS_MODE_READ,
+                                        statuses.data(), counters.data());
+    double idle_read = seconds_since(idle_start);
+
+    /* Fill the flow cache, then time the pipeline alone */
+    traffic.run(pipeline, traffic.frames.size() / BURST * BURST);
+    double alone = traffic.run(pipeline, packets);
+
+    std::atomic<bool> stop{false};
+    uint64_t reads = 0;
+    double read_total = 0, read_max = 0;
+    std::thread poller([&] {
+        std::vector<sai_status_t> s(count);
+        std::vector<uint64_t> counters((size_t)count * COUNTERS);
+        while (!stop.load(std::memory_order_relaxed)) {
+            auto start = bench_clock::now();
+            api->bulk_get_eni_meter_entry_stats(count, entries.data(), COUNTERS, COUNTER_IDS, SAI_STATS_MODE_READ,
+                                                s.data(), counters.data());
+            double t = seconds_since(start);
+            reads++;
+            read_total += t;
+            read_max = std::max(read_max, t);
+            std::this_thread::sleep_for(std::chrono::milliseconds(interval_ms));
+        }
+    });
+    double polled = traffic.run(pipeline, packets);
+    stop = true;
+    poller.join();
+
+    if (!check(api->bulk_get_eni_meter_entry_stats(count, entries.data(), COUNTERS, COUNTER_IDS,
+                                                   SAI_STATS_MODE_READ_AND_CLEAR, statuses.data(), counters.data()),
+               "bulk_get_eni_meter_entry_stats")) {
+        return 1;
+    }
+    uint64_t counted_packets = 0, counted_bytes = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        counted_packets += counters[(size_t)i * COUNTERS];
+        counted_bytes += counters[(size_t)i * COUNTERS + 1];
+    }
+    uint64_t sent = traffic.frames.size() / BURST * BURST + 2 * packets;
+
+    /* Cleared, with no traffic since */
+    uint64_t left = 0;
+    api->bulk_get_eni_meter_entry_stats(count, entries.data(), COUNTERS, COUNTER_IDS, SAI_STATS_MODE_READ,
+                                        statuses.data(), counters.data());
+    for (uint64_t c : counters) {
+        left += c;
+    }
+
+    printf("%lu packets, %u eni_meter entries, polled every %u ms\n", (unsigned long)packets, count, interval_ms);
+    printf("%-10s %10s\n", "run", "Mpps");
+    printf("%-10s %10.2f\n", "alone", alone);
+    printf("%-10s %10.2f\n", "polled", polled);
+    printf("bulk read: %.3f ms idle; polling %lu reads, %.3f ms avg, %.3f ms max\n", idle_read * 1e3,
+           (unsigned long)reads, reads ? read_total / reads * 1e3 : 0.0, read_max * 1e3);
+    printf("counted %lu/%lu packets, %lu/%lu bytes, %lu left after clear\n", (unsigned long)counted_packets,
+           (unsigned long)sent, (unsigned long)counted_bytes, (unsigned long)traffic.bytes, (unsigned long)left);
+    return counted_packets == sent && counted_bytes == traffic.bytes && !left ? 0 : 1;
+}
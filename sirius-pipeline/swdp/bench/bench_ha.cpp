@@ -0,0 +1,165 @@
+/*
+ * HA flow replication: bulk sync of a full connection table to a loopback
+ * peer while the data path keeps changing it.
+ *
+ * usage: bench_ha [connections] [buckets] [changes]
+ *
+ * Fills the primary's table with `connections` (50M) connections, pairs
+ * its flow sync with a peer table in the same process and polls it until
+ * the bulk sync is done, walking `buckets` (SYNC_BUCKETS) buckets per
+ * poll. Before every poll the data path makes `changes` (4) changes to
+ * the table: new connections, state updates and removes, replicated in
+ * real time. The peer applies each batch as it is sent.
+ *
+ * Reports the time of the bulk sync, split into the primary's side, the
+ * peer's apply and the data path's changes, the first two against the
+ * 2 second budget of an unplanned failover (each side runs on its own
+ * cores, one per worker partition), and the records and bytes sent. Then checks that the peer has exactly
+ * the primary's connections and states.
+ */
+
+#include <cstdlib>
+#include <random>
+
+#include "../sirius_flow_sync.h"
+#include "bench_packets.h"
+
+using namespace sirius;
+using namespace sirius::bench;
+
+namespace {
+
+constexpr uint32_t PORTS = 50000;
+
+/* Downtime an unplanned failover may take, high-availability-and-scale.md */
+constexpr double FAILOVER_BUDGET = 2.0;
+
+/* Changes of the real-time replication after the bulk sync */
+constexpr uint32_t REALTIME_CHANGES = 1000000;
+
+/* Passes a bulk sync takes at most, for sizing: the passes after the first only find what new connections moved */
+constexpr uint64_t SYNC_PASSES = 4;
+
+flow_key_t connection(uint32_t i)
+{
+    return { 0x0a000000 + i / PORTS, 0x64000001, (uint16_t)(1024 + i % PORTS), 443, (uint16_t)(i % 64), TCP_PROTO };
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    uint32_t count = argc > 1 ? (uint32_t)strtoul(argv[1], nullptr, 0) : 50000000;
+    size_t buckets = argc > 2 ? strtoul(argv[2], nullptr, 0) : sirius_flow_sync::SYNC_BUCKETS;
+    uint32_t changes = argc > 3 ? (uint32_t)strtoul(argv[3], nullptr, 0) : 4;
+    if (!count || count > (1u << 31) || !buckets) {
+        fprintf(stderr, "usage: %s [connections] [buckets per poll] [changes per poll]\n", argv[0]);
+        return 1;
+    }
+
+    /*
+     * Room for every connection the changes create, one in three, so
+     * neither side evicts. A table has fewer buckets than half its
+     * connections, which bounds the polls of a pass. Evictions would go to
+     * the peer as removes all the same.
+     */
+    uint64_t inserts = (REALTIME_CHANGES + 2) / 3;
+    uint64_t polls_max = SYNC_PASSES * ((count + inserts) / (2 * buckets) + 1);
+    inserts += (polls_max * changes + 2) / 3;
+    sirius_flow_table primary(count + inserts);
+    sirius_flow_table peer(count + inserts);
+
+    auto start = bench_clock::now();
+    for (uint32_t i = 0; i < count; i++) {
+        primary.insert(connection(i), (uint8_t)(1 + i % 3));
+    }
+    printf("%u connections, %zu buckets and %u changes per poll\n", count, buckets, changes);
+    printf("fill: %.1f s\n", seconds_since(start));
+
+    uint64_t records = 0, batches = 0;
+    double apply_time = 0;
+    sirius_flow_sync sync(primary, [&](const flow_sync_record_t *r, size_t n) {
+        auto begin = bench_clock::now();
+        sirius_flow_sync::apply(peer, r, n);
+        apply_time += seconds_since(begin);
+        records += n;
+        batches++;
+    });
+
+    /* A change of the data path; in turn a new connection, an update and a remove */
+    std::mt19937 rng(1);
+    uint32_t created = 0;
+    auto change = [&](uint32_t i) {
+        uint32_t any = rng() % (count + created);
+        uint8_t state = (uint8_t)(1 + rng() % 3);
+        switch (i % 3) {
+        case 0: {
+            flow_key_t evicted;
+            if (primary.insert(connection(count + created), state, &evicted)) {
+                sync.removed(evicted);
+            }
+            sync.inserted(connection(count + created), state);
+            created++;
+            break;
+        }
+        case 1:
+            if (primary.update(connection(any), state)) {
+                sync.updated(connection(any), state);
+            }
+            break;
+        default:
+            if (primary.remove(connection(any))) {
+                sync.removed(connection(any));
+            }
+            break;
+        }
+    };
+
+    uint64_t polls = 0;
+    uint32_t changed = 0;
+    double change_time = 0;
+    sync.pair();
+    start = bench_clock::now();
+    while (!sync.synced()) {
+        auto begin = bench_clock::now();
+        for (uint32_t i = 0; i < changes; i++) {
+            change(changed++);
+        }
+        change_time += seconds_since(begin);
+        sync.poll(buckets);
+        polls++;
+    }
+    double sync_time = seconds_since(start);
+    double sync_apply_time = apply_time;
+    double sender_time = sync_time - sync_apply_time - change_time;
+
+    /* Real-time replication alone for a while */
+    for (uint32_t i = 0; i < REALTIME_CHANGES; i++) {
+        change(changed++);
+        if (!(i % 32)) {
+            sync.poll(buckets);
+        }
+    }
+    sync.flush();
+
+    printf("bulk sync: %.2f s in %lu polls over %lu passes, %lu connections synced, %u changes\n", sync_time,
+           (unsigned long)polls, (unsigned long)sync.sync_passes(), (unsigned long)sync.synced_flows(), changed);
+    printf("  primary %.2f s (%.1f M connections/s, %.2f us/poll), peer apply %.2f s, data path %.2f s\n",
+           sender_time, sync.synced_flows() / sender_time / 1e6, sender_time * 1e6 / polls, sync_apply_time,
+           change_time);
+    printf("  primary %s, peer %s the %.0f s failover budget\n", sender_time <= FAILOVER_BUDGET ? "within" : "over",
+           sync_apply_time <= FAILOVER_BUDGET ? "within" : "over", FAILOVER_BUDGET);
+    printf("sent: %lu records in %lu batches, %.1f MB\n", (unsigned long)records, (unsigned long)batches,
+           records * sizeof(flow_sync_record_t) / 1048576.0);
+
+    uint64_t mismatches = 0;
+    for (uint32_t i = 0; i < count + created; i++) {
+        uint8_t a = 0, b = 0;
+        bool in_primary = primary.lookup(connection(i), a);
+        bool in_peer = peer.lookup(connection(i), b);
+        mismatches += in_primary != in_peer || a != b;
+    }
+    printf("peer: %zu connections, primary %zu, %lu mismatches, %lu + %lu evictions\n", peer.size(), primary.size(),
+           (unsigned long)mismatches, (unsigned long)primary.evictions(), (unsigned long)peer.evictions());
+    return mismatches || peer.size() != primary.size() ? 1 : 0;
+}
@@ -0,0 +1,247 @@
+/*
+ * Wire format of HA flow replication: bytes per connection and
+ * connections per second through a local socket.
+ *
+ * usage: bench_ha_frames [connections] [enis]
+ *
+ * Fills a flow table with `connections` (4M) connections of `enis` (8)
+ * ENIs, shaped like VM traffic: a VM address in the ENI's /16, one of 256
+ * servers, port 443 or 80 and an ephemeral source port. Captures what its
+ * flow sync sends for two streams: the bulk sync of the full table
+ * (bucket order), then the real-time records of as many new connections
+ * created and ended (arrival order).
+ *
+ * Sends each stream through a Unix stream socket to a receiver thread
+ * that decodes it and checks it against what was sent: as plain records,
+ * as frames, and as LZ4 compressed frames when built with SIRIUS_LZ4.
+ * Reports bytes per connection, frames and connections per second from
+ * the first write to the last record decoded; the peer's apply is left
+ * out, bench_ha measures it.
+ */
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <thread>
+
+#include "../sirius_conntrack.h"
+#include "../sirius_flow_sync_frame.h"
+#include "bench_packets.h"
+
+using namespace sirius;
+using namespace sirius::bench;
+
+namespace {
+
+constexpr size_t READ_SIZE = 65536;
+
+enum format_t {
+    FORMAT_RECORDS,
+    FORMAT_FRAMES,
+    FORMAT_LZ4,
+};
+
+const char *format_name(format_t format)
+{
+    switch (format) {
+    case FORMAT_RECORDS:
+        return "records";
+    case FORMAT_FRAMES:
+        return "frames";
+    default:
+        return "frames+lz4";
+    }
+}
+
+using batches_t = std::vector<std::vector<flow_sync_record_t>>;
+
+flow_key_t vm_connection(std::mt19937 &rng, uint32_t enis)
+{
+    uint16_t eni = (uint16_t)(rng() % enis);
+    flow_key_t key;
+    key.sip = 0x0a000000 | (uint32_t)eni << 16 | (rng() & 0xffff);
+    key.dip = 0x64400000 | (rng() & 0xff);
+    key.sport = (uint16_t)(32768 + rng() % 28232);
+    key.dport = rng() % 4 ? 443 : 80;
+    key.eni = eni;
+    key.protocol = TCP_PROTO;
+    return key;
+}
+
+bool write_all(int fd, const uint8_t *data, size_t len)
+{
+    while (len) {
+        ssize_t n = write(fd, data, len);
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        len -= (size_t)n;
+    }
+    return true;
+}
+
+bool same(const flow_sync_record_t &a, const flow_sync_record_t &b)
+{
+    return a.key == b.key && a.state == b.state && a.op == b.op;
+}
+
+struct result_t {
+    uint64_t records = 0;
+    uint64_t bytes = 0;
+    uint64_t frames = 0;
+    uint64_t mismatches = 0;
+    double seconds = 0;
+};
+
+/* Decodes the stream from fd and compares it with the batches */
+void receive(int fd, format_t format, const batches_t &batches, result_t &result)
+{
+    std::vector<flow_sync_record_t> sent;
+    for (const auto &batch : batches) {
+        sent.insert(sent.end(), batch.begin(), batch.end());
+    }
+
+    std::vector<uint8_t> pending;
+    std::vector<flow_sync_record_t> decoded;
+    uint8_t buf[READ_SIZE];
+    size_t next = 0;
+    ssize_t n;
+    while ((n = read(fd, buf, sizeof(buf))) > 0) {
+        pending.insert(pending.end(), buf, buf + n);
+        size_t used = 0;
+        if (format == FORMAT_RECORDS) {
+            for (; pending.size() - used >= sizeof(flow_sync_record_t); used += sizeof(flow_sync_record_t)) {
+                flow_sync_record_t r;
+                memcpy(&r, pending.data() + used, sizeof(r));
+                result.mismatches += next >= sent.size() || !same(r, sent[next]);
+                next++;
+            }
+        } else {
+            size_t size;
+            while ((size = flow_sync_frame_size(pending.data() + used, pending.size() - used)) &&
+                   size <= pending.size() - used) {
+                decoded.clear();
+                if (!flow_sync_frame_decode(pending.data() + used, size, decoded)) {
+                    result.mismatches++;
+                }
+                for (const flow_sync_record_t &r : decoded) {
+                    result.mismatches += next >= sent.size() || !same(r, sent[next]);
+                    next++;
+                }
+                used += size;
+            }
+        }
+        pending.erase(pending.begin(), pending.begin() + used);
+    }
+    result.mismatches += next != sent.size() || !pending.empty();
+}
+
+result_t run(format_t format, const batches_t &batches)
+{
+    int fds[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds)) {
+        perror("socketpair");
+        exit(1);
+    }
+
+    result_t result;
+    auto start = bench_clock::now();
+    std::thread receiver([&] { receive(fds[1], format, batches, result); });
+
+    auto send = format == FORMAT_RECORDS
+                    ? sirius_flow_sync::send_fn([&](const flow_sync_record_t *r, size_t count) {
+                          write_all(fds[0], (const uint8_t *)r, count * sizeof(*r));
+                          result.bytes += count * sizeof(*r);
+                      })
+                    : flow_sync_frame_sender(
+                          [&](const uint8_t *data, size_t len) {
+                              write_all(fds[0], data, len);
+                              result.bytes += len;
+                              result.frames++;
+                          },
+                          format == FORMAT_LZ4);
+    for (const auto &batch : batches) {
+        send(batch.data(), batch.size());
+        result.records += batch.size();
+    }
+    close(fds[0]);
+    receiver.join();
+    result.seconds = seconds_since(start);
+    close(fds[1]);
+    return result;
+}
+
+void report(const char *stream, const batches_t &batches, uint64_t &mismatches)
+{
+    for (format_t format : { FORMAT_RECORDS, FORMAT_FRAMES, FORMAT_LZ4 }) {
+        if (format == FORMAT_LZ4 && !flow_sync_frame_lz4()) {
+            continue;
+        }
+        result_t r = run(format, batches);
+        printf("%-10s %-11s %10lu %8.1f %12.0f %10.2f %10lu\n", stream, format_name(format),
+               (unsigned long)r.records, (double)r.bytes / r.records, r.frames ? (double)r.records / r.frames : 0,
+               r.records / r.seconds / 1e6, (unsigned long)r.mismatches);
+        mismatches += r.mismatches;
+    }
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    uint32_t count = argc > 1 ? (uint32_t)strtoul(argv[1], nullptr, 0) : 4000000;
+    uint32_t enis = argc > 2 ? (uint32_t)strtoul(argv[2], nullptr, 0) : 8;
+    if (!count || !enis || enis > 256) {
+        fprintf(stderr, "usage: %s [connections] [enis <= 256]\n", argv[0]);
+        return 1;
+    }
+
+    sirius_flow_table table(count + count / 8);
+    std::mt19937 rng(1);
+    for (uint32_t i = 0; i < count; i++) {
+        table.insert(vm_connection(rng, enis), (uint8_t)(1 + i % 3));
+    }
+
+    batches_t batches;
+    sirius_flow_sync sync(table, [&](const flow_sync_record_t *r, size_t n) { batches.emplace_back(r, r + n); });
+    sync.pair();
+    while (!sync.synced()) {
+        sync.poll();
+    }
+    sync.flush();
+    batches_t bulk;
+    std::swap(bulk, batches);
+
+    /* New connections in arrival order, a poll every 8, then their ends in the same order */
+    std::vector<flow_key_t> created(count);
+    for (uint32_t i = 0; i < count; i++) {
+        created[i] = vm_connection(rng, enis);
+        table.insert(created[i], CONNTRACK_ALLOW_IN);
+        sync.inserted(created[i], CONNTRACK_ALLOW_IN);
+        if (i % 8 == 7) {
+            sync.poll();
+        }
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        table.remove(created[i]);
+        sync.removed(created[i]);
+        if (i % 8 == 7) {
+            sync.poll();
+        }
+    }
+    sync.flush();
+    batches_t realtime;
+    std::swap(realtime, batches);
+
+    printf("%u connections of %u ENIs, %zu byte records\n", count, enis, sizeof(flow_sync_record_t));
+    printf("%-10s %-11s %10s %8s %12s %10s %10s\n", "stream", "format", "records", "B/flow", "flows/frame",
+           "Mflows/s", "mismatches");
+    uint64_t mismatches = 0;
+    report("bulk", bulk, mismatches);
+    report("real-time", realtime, mismatches);
+    return mismatches ? 1 : 0;
+}
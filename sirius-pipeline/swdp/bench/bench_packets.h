@@ -0,0 +1,202 @@
+#ifndef _SIRIUS_BENCH_PACKETS_H_
+#define _SIRIUS_BENCH_PACKETS_H_
+
+/* Frame builders and setup helpers shared by the pipeline benchmarks */
+
+#include <arpa/inet.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "../sirius_headers.h"
+#include "../sirius_memory.h"
+#include "../sirius_sai.h"
+
+namespace sirius {
+namespace bench {
+
+using bench_clock = std::chrono::steady_clock;
+
+inline double seconds_since(bench_clock::time_point start)
+{
+    return std::chrono::duration<double>(bench_clock::now() - start).count();
+}
+
+/* Pages argument of the table benchmarks: 4k, 2m or 1g */
+inline bool parse_page_size(const char *arg, page_size_t &page)
+{
+    static const char *const names[] = { "4k", "2m", "1g" };
+    for (unsigned i = 0; i < 3; i++) {
+        if (!strcmp(arg, names[i])) {
+            page = (page_size_t)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+inline const char *page_size_name(page_size_t page)
+{
+    return page == PAGE_SIZE_1GB ? "1g" : page == PAGE_SIZE_2MB ? "2m" : "4k";
+}
+
+inline sai_ip_address_t sai_ipv4(uint32_t host_order)
+{
+    sai_ip_address_t ip = {};
+    ip.addr_family = SAI_IP_ADDR_FAMILY_IPV4;
+    ip.addr.ip4 = htonl(host_order);
+    return ip;
+}
+
+inline sai_ip_prefix_t sai_prefix(uint32_t host_order, uint8_t len)
+{
+    sai_ip_prefix_t prefix = {};
+    uint32_t mask = len ? ~0u << (32 - len) : 0;
+    prefix.addr_family = SAI_IP_ADDR_FAMILY_IPV4;
+    prefix.addr.ip4 = htonl(host_order & mask);
+    prefix.mask.ip4 = htonl(mask);
+    return prefix;
+}
+
+inline bool check(sai_status_t status, const char *what)
+{
+    if (status != SAI_STATUS_SUCCESS) {
+        fprintf(stderr, "%s failed: %d\n", what, status);
+        return false;
+    }
+    return true;
+}
+
+/* Inner 5-tuple of a generated frame, host byte order */
+struct flow_t {
+    mac_t smac;
+    mac_t dmac;
+    ipv4_addr_t sip;
+    ipv4_addr_t dip;
+    uint8_t protocol;
+    uint16_t sport;
+    uint16_t dport;
+    uint8_t tcp_flags;
+    uint32_t seq; /* TCP sequence and acknowledgment numbers */
+    uint32_t ack;
+};
+
+/* Underlay addressing of the VXLAN frame carrying a flow */
+struct tunnel_t {
+    mac_t smac;
+    mac_t dmac;
+    ipv4_addr_t sip;
+    ipv4_addr_t dip;
+    uint32_t vni;
+};
+
+/* Internet checksum of len bytes plus `sum`, the frames' own so the benchmarks need no sources for it */
+inline uint16_t frame_checksum(const uint8_t *p, size_t len, uint32_t sum = 0)
+{
+    for (; len > 1; p += 2, len -= 2) {
+        sum += (uint32_t)p[0] << 8 | p[1];
+    }
+    if (len) {
+        sum += (uint32_t)p[0] << 8;
+    }
+    while (sum >> 16) {
+        sum = (sum & 0xffff) + (sum >> 16);
+    }
+    return htons((uint16_t)~sum);
+}
+
+/*
+ * Writes ethernet/ipv4/udp/vxlan/ethernet/ipv4/tcp|udp with `payload`
+ * bytes of payload into out, returns the frame length. The IPv4 and the
+ * inner TCP/UDP checksums are correct, the outer UDP one is 0.
+ */
+inline uint32_t build_vxlan_frame(uint8_t *out, const tunnel_t &tun, const flow_t &flow, uint16_t payload = 0)
+{
+    uint16_t l4_size = flow.protocol == TCP_PROTO ? TCP_HDR_SIZE : UDP_HDR_SIZE;
+    uint16_t inner_ip_len = IPV4_HDR_SIZE + l4_size + payload;
+    uint8_t *p = out;
+
+    auto eth = reinterpret_cast<ethernet_t *>(p);
+    mac_to_bytes(tun.dmac, eth->dst_addr);
+    mac_to_bytes(tun.smac, eth->src_addr);
+    eth->ether_type = htons(IPV4_ETHTYPE);
+    p += ETHER_HDR_SIZE;
+
+    auto ip = reinterpret_cast<ipv4_t *>(p);
+    memset(ip, 0, IPV4_HDR_SIZE);
+    ip->version_ihl = 0x45;
+    ip->total_len = htons(inner_ip_len + ETHER_HDR_SIZE + IPV4_HDR_SIZE + UDP_HDR_SIZE + VXLAN_HDR_SIZE);
+    ip->ttl = 64;
+    ip->protocol = UDP_PROTO;
+    ip->src_addr = htonl(tun.sip);
+    ip->dst_addr = htonl(tun.dip);
+    ip->hdr_checksum = frame_checksum(p, IPV4_HDR_SIZE);
+    p += IPV4_HDR_SIZE;
+
+    auto udp = reinterpret_cast<udp_t *>(p);
+    udp->src_port = htons(49152);
+    udp->dst_port = htons(UDP_PORT_VXLAN);
+    udp->length = htons(inner_ip_len + ETHER_HDR_SIZE + UDP_HDR_SIZE + VXLAN_HDR_SIZE);
+    udp->checksum = 0;
+    p += UDP_HDR_SIZE;
+
+    auto vxlan = reinterpret_cast<vxlan_t *>(p);
+    memset(vxlan, 0, VXLAN_HDR_SIZE);
+    vxlan->flags = 0x08;
+    vxlan->set_vni(tun.vni);
+    p += VXLAN_HDR_SIZE;
+
+    eth = reinterpret_cast<ethernet_t *>(p);
+    mac_to_bytes(flow.dmac, eth->dst_addr);
+    mac_to_bytes(flow.smac, eth->src_addr);
+    eth->ether_type = htons(IPV4_ETHTYPE);
+    p += ETHER_HDR_SIZE;
+
+    ip = reinterpret_cast<ipv4_t *>(p);
+    memset(ip, 0, IPV4_HDR_SIZE);
+    ip->version_ihl = 0x45;
+    ip->total_len = htons(inner_ip_len);
+    ip->ttl = 64;
+    ip->protocol = flow.protocol;
+    ip->src_addr = htonl(flow.sip);
+    ip->dst_addr = htonl(flow.dip);
+    ip->hdr_checksum = frame_checksum(p, IPV4_HDR_SIZE);
+    p += IPV4_HDR_SIZE;
+
+    if (flow.protocol == TCP_PROTO) {
+        auto tcp = reinterpret_cast<tcp_t *>(p);
+        memset(tcp, 0, TCP_HDR_SIZE);
+        tcp->src_port = htons(flow.sport);
+        tcp->dst_port = htons(flow.dport);
+        tcp->seq_no = htonl(flow.seq);
+        tcp->ack_no = htonl(flow.ack);
+        tcp->data_offset_res = 5 << 4;
+        tcp->ecn_flags = flow.tcp_flags;
+        tcp->window = htons(65535);
+    } else {
+        auto l4 = reinterpret_cast<udp_t *>(p);
+        l4->src_port = htons(flow.sport);
+        l4->dst_port = htons(flow.dport);
+        l4->length = htons(UDP_HDR_SIZE + payload);
+        l4->checksum = 0;
+    }
+    memset(p + l4_size, 0, payload);
+
+    /* Over the pseudo header too: addresses, protocol and segment length */
+    uint32_t pseudo = (flow.sip >> 16) + (flow.sip & 0xffff) + (flow.dip >> 16) + (flow.dip & 0xffff) +
+                      flow.protocol + l4_size + payload;
+    uint16_t csum = frame_checksum(p, l4_size + payload, pseudo);
+    if (flow.protocol == TCP_PROTO) {
+        reinterpret_cast<tcp_t *>(p)->checksum = csum;
+    } else {
+        reinterpret_cast<udp_t *>(p)->checksum = csum ? csum : 0xffff;
+    }
+    return (uint32_t)(p + l4_size + payload - out);
+}
+
+} // namespace bench
+} // namespace sirius
+
+#endif /* _SIRIUS_BENCH_PACKETS_H_ */
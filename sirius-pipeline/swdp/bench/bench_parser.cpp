@@ -0,0 +1,205 @@
+/*
+ * Parser cost per packet for VXLAN/TCP frames.
+ *
+ * usage: bench_parser [packets]
+ *
+ * Parses `packets` VXLAN/TCP frames, cycling through 4096 buffers, with
+ * parse() one packet at a time, reading the fields parse_burst() returns
+ * from the headers it found, and with parse_burst() in bursts of 32 and
+ * 256 with each kernel the CPU supports. Reports cycles (TSC) and nanoseconds per
+ * packet. First checks each kernel against parse() on a mix of frames,
+ * including ones parse_burst() has to hand to parse().
+ */
+
+#include <x86intrin.h>
+
+#include <cstdlib>
+
+#include "../sirius_parser.h"
+#include "bench_packets.h"
+
+using namespace sirius;
+using namespace sirius::bench;
+
+namespace {
+
+constexpr uint32_t FRAMES = 4096;
+constexpr uint32_t BUF_SIZE = 2048;
+
+struct frames_t {
+    std::vector<uint8_t> bufs;
+    std::vector<packet_t> pkts;
+
+    explicit frames_t(uint32_t count) : bufs((size_t)count * BUF_SIZE), pkts(count) {}
+
+    void set(uint32_t i, const uint8_t *frame, uint32_t len)
+    {
+        packet_t &pkt = pkts[i];
+        pkt = {};
+        pkt.buf = &bufs[(size_t)i * BUF_SIZE];
+        pkt.buf_size = BUF_SIZE;
+        pkt.data_off = PACKET_HEADROOM;
+        pkt.len = len;
+        memcpy(pkt.data(), frame, len);
+    }
+};
+
+flow_t tcp_flow(uint32_t i)
+{
+    flow_t f = {};
+    f.smac = 0x00aa00000000ULL | i;
+    f.dmac = 0x00bb00000001ULL;
+    f.sip = 0x0b000000 + i;
+    f.dip = 0x0a000000 + i * 7;
+    f.protocol = TCP_PROTO;
+    f.sport = (uint16_t)(1024 + i);
+    f.dport = 443;
+    f.tcp_flags = TCP_FLAG_ACK;
+    return f;
+}
+
+const tunnel_t TUNNEL = { 0x00f000000001ULL, 0x00cc00000002ULL, 0x0c000001, 0x64000001, 100 };
+
+/* Frame i of the check: VXLAN/TCP and /UDP, and frames parse_burst() hands to parse() */
+uint32_t check_frame(uint32_t i, uint8_t *frame)
+{
+    flow_t f = tcp_flow(i);
+    if (i % 8 == 1) {
+        f.protocol = UDP_PROTO;
+    }
+    uint32_t len = build_vxlan_frame(frame, TUNNEL, f);
+    switch (i % 8) {
+    case 2: /* truncated inner TCP */
+        return len - 1;
+    case 3: /* inner IPv4 options */
+        frame[ETHER_HDR_SIZE * 2 + IPV4_HDR_SIZE + UDP_HDR_SIZE + VXLAN_HDR_SIZE] = 0x46;
+        break;
+    case 4: /* inner IPv6 ether_type */
+        frame[ETHER_HDR_SIZE * 2 + IPV4_HDR_SIZE + UDP_HDR_SIZE + VXLAN_HDR_SIZE - 2] = 0x86;
+        break;
+    case 5: /* UDP, not to the VXLAN port */
+        frame[ETHER_HDR_SIZE + IPV4_HDR_SIZE + 3] ^= 1;
+        break;
+    case 6: /* inner ICMP */
+        frame[ETHER_HDR_SIZE * 2 + IPV4_HDR_SIZE + UDP_HDR_SIZE + VXLAN_HDR_SIZE + 9] = 1;
+        break;
+    case 7: /* truncated Ethernet */
+        return i % 3;
+    }
+    return len;
+}
+
+bool check(parse_kernel_t kernel)
+{
+    frames_t frames(PARSER_MAX_BURST);
+    uint8_t frame[BUF_SIZE];
+    for (uint32_t i = 0; i < PARSER_MAX_BURST; i++) {
+        frames.set(i, frame, check_frame(i, frame));
+    }
+
+    static parsed_burst_t burst;
+    parse_burst(frames.pkts.data(), PARSER_MAX_BURST, burst);
+    for (uint32_t i = 0; i < PARSER_MAX_BURST; i++) {
+        headers_t hdr;
+        bool ok = parse(frames.pkts[i], hdr);
+        if (ok != burst.ok[i] || (ok && memcmp(&hdr, &burst.hdr[i], sizeof(hdr)))) {
+            fprintf(stderr, "%s: parse_burst() differs from parse() on frame %u\n", parse_kernel_name(kernel), i);
+            return false;
+        }
+        uint16_t sport = hdr.inner_tcp ? hdr.inner_tcp->src_port : hdr.inner_udp ? hdr.inner_udp->src_port : 0;
+        if (ok && hdr.inner_ipv4 &&
+            (burst.inner_sip[i] != hdr.inner_ipv4->src_addr || burst.inner_sport[i] != sport ||
+             burst.vni[i] != hdr.vxlan->get_vni() || memcmp(burst.inner_smac[i], hdr.inner_ethernet->src_addr, 6))) {
+            fprintf(stderr, "%s: parse_burst() fields differ on frame %u\n", parse_kernel_name(kernel), i);
+            return false;
+        }
+    }
+    return true;
+}
+
+struct result_t {
+    double cycles;
+    double ns;
+};
+
+template <typename Fn>
+result_t measure(uint64_t packets, Fn fn)
+{
+    auto start = bench_clock::now();
+    uint64_t tsc = __rdtsc();
+    fn();
+    uint64_t cycles = __rdtsc() - tsc;
+    return { (double)cycles / packets, seconds_since(start) * 1e9 / packets };
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    uint64_t packets = argc > 1 ? strtoull(argv[1], nullptr, 0) : 100000000;
+    if (!packets) {
+        fprintf(stderr, "usage: %s [packets]\n", argv[0]);
+        return 1;
+    }
+    std::vector<parse_kernel_t> kernels;
+    for (parse_kernel_t kernel : { PARSE_KERNEL_SCALAR, PARSE_KERNEL_AVX2, PARSE_KERNEL_AVX512 }) {
+        if (parse_burst_use(kernel)) {
+            if (!check(kernel)) {
+                return 1;
+            }
+            kernels.push_back(kernel);
+        }
+    }
+
+    frames_t frames(FRAMES);
+    uint8_t frame[BUF_SIZE];
+    for (uint32_t i = 0; i < FRAMES; i++) {
+        frames.set(i, frame, build_vxlan_frame(frame, TUNNEL, tcp_flow(i)));
+    }
+
+    printf("%lu VXLAN/TCP packets\n", (unsigned long)packets);
+    printf("%-24s %10s %10s\n", "", "cycles/pkt", "ns/pkt");
+
+    /* The same output from parse() and the headers it found */
+    static parsed_burst_t burst;
+    uint64_t sink = 0;
+    result_t r = measure(packets, [&] {
+        for (uint64_t n = 0; n < packets; n++) {
+            uint32_t i = (uint32_t)(n % PARSER_MAX_BURST);
+            headers_t &hdr = burst.hdr[i];
+            burst.ok[i] = parse(frames.pkts[n % FRAMES], hdr);
+            burst.outer_sip[i] = hdr.ipv4->src_addr;
+            burst.outer_dip[i] = hdr.ipv4->dst_addr;
+            burst.outer_protocol[i] = hdr.ipv4->protocol;
+            burst.outer_sport[i] = hdr.udp->src_port;
+            burst.outer_dport[i] = hdr.udp->dst_port;
+            burst.vni[i] = hdr.vxlan->get_vni();
+            memcpy(burst.inner_smac[i], hdr.inner_ethernet->src_addr, 6);
+            memcpy(burst.inner_dmac[i], hdr.inner_ethernet->dst_addr, 6);
+            burst.inner_sip[i] = hdr.inner_ipv4->src_addr;
+            burst.inner_dip[i] = hdr.inner_ipv4->dst_addr;
+            burst.inner_protocol[i] = hdr.inner_ipv4->protocol;
+            burst.inner_sport[i] = hdr.inner_tcp->src_port;
+            burst.inner_dport[i] = hdr.inner_tcp->dst_port;
+            burst.inner_tcp_flags[i] = hdr.inner_tcp->flags();
+            sink += burst.ok[i];
+        }
+    });
+    printf("%-24s %10.1f %10.2f\n", "parse() + fields", r.cycles, r.ns);
+
+    for (parse_kernel_t kernel : kernels) {
+        parse_burst_use(kernel);
+        for (uint32_t size : { 32u, PARSER_MAX_BURST }) {
+            r = measure(packets, [&] {
+                for (uint64_t n = 0; n < packets; n += size) {
+                    parse_burst(&frames.pkts[n % FRAMES], size, burst);
+                    sink += burst.inner_sport[0];
+                }
+            });
+            char name[32];
+            snprintf(name, sizeof(name), "parse_burst(%u) %s", size, parse_kernel_name(kernel));
+            printf("%-24s %10.1f %10.2f\n", name, r.cycles, r.ns);
+        }
+    }
+    return sink == 42;
+}
@@ -0,0 +1,138 @@
+/*
+ * Packet rate of the software pipeline on one core.
+ *
+ * usage: bench_pipeline [packets] [flows] [enis] [burst] [checksum] [payload]
+ *
+ * Programs `enis` ENIs through the DASH API, each with a handful of
+ * routes and two stage1 ACL rules per direction, and one ca_to_pa
+ * mapping per flow.
+ * Then runs `packets` outbound (VM -> VNET) and `packets` inbound
+ * (VNET -> VM) VXLAN/TCP frames with `payload` (0) bytes of payload, spread round robin over `flows` flows,
+ * through sirius_pipeline::process_burst() in bursts of `burst` (32). Each frame is
+ * copied into its receive buffer before the burst, as a NIC would.
+ *
+ * The first packet of every flow takes the slow path through the tables,
+ * the rest hit the flow cache; the first packets are timed on their own.
+ *
+ * `checksum` is what the pipeline does with checksums: "template" (the
+ * default) adjusts the outer IPv4 checksum of the encap template,
+ * "offload" leaves it to the NIC, "verify" also checks the inner IPv4 and
+ * TCP checksums of every packet; it reports whether the TCP segments are
+ * long enough for the AVX2 checksum kernel or take the scalar loop.
+ */
+
+#include <cstdlib>
+#include <cstring>
+
+#include "../sirius_checksum.h"
+#include "../sirius_pipeline.h"
+#include "bench_program.h"
+
+using namespace sirius;
+using namespace sirius::bench;
+
+namespace {
+
+constexpr uint32_t BUF_SIZE = 2048;
+
+struct run_result_t {
+    double mpps;
+    uint64_t dropped;
+};
+
+run_result_t run(sirius_pipeline &pipeline, const std::vector<std::vector<uint8_t>> &frames, uint64_t packets,
+                 uint32_t burst)
+{
+    std::vector<uint8_t> bufs(burst * BUF_SIZE);
+    std::vector<packet_t> pkts(burst);
+    uint64_t dropped = 0;
+    size_t next = 0;
+
+    auto start = bench_clock::now();
+    for (uint64_t done = 0; done < packets; done += burst) {
+        for (uint32_t i = 0; i < burst; i++) {
+            const auto &frame = frames[next];
+            next = next + 1 == frames.size() ? 0 : next + 1;
+
+            packet_t &pkt = pkts[i];
+            pkt.buf = &bufs[i * BUF_SIZE];
+            pkt.buf_size = BUF_SIZE;
+            pkt.data_off = PACKET_HEADROOM;
+            pkt.len = (uint32_t)frame.size();
+            pkt.ingress_port = 0;
+            memcpy(pkt.data(), frame.data(), frame.size());
+        }
+
+        pipeline.process_burst(pkts.data(), burst);
+
+        for (uint32_t i = 0; i < burst; i++) {
+            dropped += pkts[i].drop;
+        }
+    }
+    double elapsed = seconds_since(start);
+    return { packets / elapsed / 1e6, dropped };
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    uint64_t packets = argc > 1 ? strtoull(argv[1], nullptr, 0) : 20000000;
+    uint32_t flows = argc > 2 ? (uint32_t)strtoul(argv[2], nullptr, 0) : 65536;
+    uint32_t enis = argc > 3 ? (uint32_t)strtoul(argv[3], nullptr, 0) : 64;
+    uint32_t burst = argc > 4 ? (uint32_t)strtoul(argv[4], nullptr, 0) : 32;
+    const char *checksum = argc > 5 ? argv[5] : "template";
+    uint32_t payload = argc > 6 ? (uint32_t)strtoul(argv[6], nullptr, 0) : 0;
+    bool offload = !strcmp(checksum, "offload");
+    bool verify = !strcmp(checksum, "verify");
+    if (!packets || !flows || !enis || enis > 4096 || !burst || (!offload && !verify && strcmp(checksum, "template")) ||
+        payload > 1400) {
+        fprintf(stderr, "usage: %s [packets] [flows] [enis <= 4096] [burst] [template|offload|verify] [payload <= 1400]\n",
+                argv[0]);
+        return 1;
+    }
+
+    const sai__api_t *api = sirius_dash_api_query();
+    sai_object_id_t appliance;
+    if (!program(api, flows, enis, &appliance)) {
+        return 1;
+    }
+    sai_attribute_t attr;
+    attr.id = SAI_APPLIANCE_ATTR_VERIFY_INNER_CHECKSUM;
+    attr.value.booldata = verify;
+    if (!check(api->set_appliance_attribute(appliance, &attr), "set_appliance_attribute")) {
+        return 1;
+    }
+
+    std::vector<std::vector<uint8_t>> outbound_frames(flows), inbound_frames(flows);
+    uint8_t frame[BUF_SIZE];
+    for (uint32_t i = 0; i < flows; i++) {
+        flow_t f = vm_flow(i, enis);
+        outbound_frames[i].assign(frame, frame + build_vxlan_frame(frame, OUTBOUND_TUNNEL, f, (uint16_t)payload));
+
+        inbound_frames[i].assign(frame, frame + build_vxlan_frame(frame, INBOUND_TUNNEL, reverse(f), (uint16_t)payload));
+    }
+
+    /* Flow cache sized for the flows of both directions */
+    sirius_pipeline pipeline(sai_switch(), 2 * (size_t)flows);
+    pipeline.offload_checksum(offload);
+
+    printf("%lu packets, %u flows, %u ENIs, burst %u, checksum %s, %u byte inner frames\n", (unsigned long)packets,
+           flows, enis, burst, checksum, ETHER_HDR_SIZE + IPV4_HDR_SIZE + TCP_HDR_SIZE + payload);
+    if (verify) {
+        size_t segment = TCP_HDR_SIZE + payload;
+        printf("inner TCP checksum over %zu bytes: %s\n", segment,
+               !checksum_avx2()                      ? "scalar, no AVX2 on this CPU"
+               : segment >= CHECKSUM_AVX2_MIN_BYTES ? "AVX2 kernel"
+                                                    : "scalar, shorter than the AVX2 kernel's minimum");
+    }
+    printf("%-10s %12s %10s %10s\n", "direction", "first Mpps", "Mpps", "dropped");
+    for (bool outbound : { true, false }) {
+        const auto &frames = outbound ? outbound_frames : inbound_frames;
+        run_result_t first = run(pipeline, frames, (flows + burst - 1) / burst * burst, burst);
+        run_result_t rest = run(pipeline, frames, packets, burst);
+        printf("%-10s %12.2f %10.2f %10lu\n", outbound ? "outbound" : "inbound", first.mpps, rest.mpps,
+               (unsigned long)(first.dropped + rest.dropped));
+    }
+    return 0;
+}
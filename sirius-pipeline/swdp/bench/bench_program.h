@@ -0,0 +1,212 @@
+#ifndef _SIRIUS_BENCH_PROGRAM_H_
+#define _SIRIUS_BENCH_PROGRAM_H_
+
+/* DASH configuration and traffic shared by the pipeline benchmarks */
+
+#include <utility>
+
+#include "bench_packets.h"
+
+namespace sirius {
+namespace bench {
+
+constexpr uint32_t OUTBOUND_VNI = 100;
+constexpr uint32_t INBOUND_VNI = 200;
+constexpr uint32_t VNET_VNI_BASE = 1000;
+
+inline mac_t eni_mac(uint32_t eni)
+{
+    return 0x00aa00000000ULL | eni;
+}
+
+/* VM side of flow i, ENI i % enis: TCP to port 443 of the VNET address with ca_to_pa mapping i */
+inline flow_t vm_flow(uint32_t i, uint32_t enis)
+{
+    flow_t f = {};
+    f.smac = eni_mac(i % enis);
+    f.dmac = 0x00bb00000001ULL;
+    f.sip = 0x0b000000 + (i % enis);
+    f.dip = 0x0a000000 + i;
+    f.protocol = TCP_PROTO;
+    f.sport = (uint16_t)(1024 + i % 60000);
+    f.dport = 443;
+    f.tcp_flags = TCP_FLAG_ACK;
+    return f;
+}
+
+/* stage1: deny SSH, permit TCP/UDP from/to the VNET address space */
+template <typename E, typename Fn>
+bool acl_rules(Fn create, uint16_t eni, sai_attr_id_t attr_start, int32_t permit, int32_t deny, bool outbound)
+{
+    sai_ip_prefix_t vnet = sai_prefix(0x0a000000, 8);
+    uint8_t protocols[] = { TCP_PROTO, UDP_PROTO };
+    sai_u16_range_t ssh = { 22, 22 };
+
+    sai_attribute_t attr[6];
+    for (unsigned i = 0; i < 6; i++) {
+        attr[i].id = attr_start + i;
+        attr[i].value.ipprefixlist = {};
+    }
+
+    E e = {};
+    e.eni = eni;
+    e.priority = 10;
+    attr[0].value.s32 = deny;
+    attr[3].value.u8list = { 1, protocols };
+    attr[4].value.u16rangelist = { 0, nullptr };
+    attr[5].value.u16rangelist = { 1, &ssh };
+    if (!check(create(&e, 6, attr), "create acl stage1 entry")) {
+        return false;
+    }
+
+    e.priority = 100;
+    attr[0].value.s32 = permit;
+    attr[outbound ? 1 : 2].value.ipprefixlist = { 1, &vnet };
+    attr[3].value.u8list = { 2, protocols };
+    attr[5].value.u16rangelist = { 0, nullptr };
+    return check(create(&e, 6, attr), "create acl stage1 entry");
+}
+
+/*
+ * Programs a direction_lookup entry per direction, an appliance and
+ * `enis` ENIs, each with a handful of routes, an inbound VM and two
+ * stage1 ACL rules per direction, plus `mappings` ca_to_pa mappings, the
+ * destinations of vm_flow(0) to vm_flow(mappings - 1). The appliance's
+ * object id goes to *appliance_oid when given.
+ */
+inline bool program(const sai__api_t *api, uint32_t mappings, uint32_t enis, sai_object_id_t *appliance_oid = nullptr)
+{
+    sai_attribute_t attr[3];
+
+    for (uint32_t vni : { OUTBOUND_VNI, INBOUND_VNI }) {
+        sai_direction_lookup_entry_t e = {};
+        e.vni = vni;
+        attr[0].id = SAI_DIRECTION_LOOKUP_ENTRY_ATTR_DIRECTION;
+        attr[0].value.u32 = vni == OUTBOUND_VNI ? DIRECTION_OUTBOUND : DIRECTION_INBOUND;
+        if (!check(api->create_direction_lookup_entry(&e, 1, attr), "create_direction_lookup_entry")) {
+            return false;
+        }
+    }
+
+    sai_object_id_t appliance;
+    attr[0].id = SAI_APPLIANCE_ATTR_NEIGHBOR_MAC;
+    mac_to_bytes(0x00cc00000001ULL, attr[0].value.mac);
+    attr[1].id = SAI_APPLIANCE_ATTR_MAC;
+    mac_to_bytes(0x00cc00000002ULL, attr[1].value.mac);
+    attr[2].id = SAI_APPLIANCE_ATTR_IP;
+    attr[2].value.ipaddr = sai_ipv4(0x64000001);
+    if (!check(api->create_appliance(&appliance, SAI_NULL_OBJECT_ID, 3, attr), "create_appliance")) {
+        return false;
+    }
+    if (appliance_oid) {
+        *appliance_oid = appliance;
+    }
+
+    for (uint32_t eni = 0; eni < enis; eni++) {
+        sai_outbound_eni_lookup_from_vm_entry_t from_vm = {};
+        mac_to_bytes(eni_mac(eni), from_vm.smac);
+        attr[0].id = SAI_OUTBOUND_ENI_LOOKUP_FROM_VM_ENTRY_ATTR_ENI;
+        attr[0].value.u16 = (uint16_t)eni;
+        if (!check(api->create_outbound_eni_lookup_from_vm_entry(&from_vm, 1, attr), "create_outbound_eni_lookup_from_vm_entry")) {
+            return false;
+        }
+
+        sai_outbound_eni_to_vni_entry_t to_vni = {};
+        to_vni.eni = (uint16_t)eni;
+        attr[0].id = SAI_OUTBOUND_ENI_TO_VNI_ENTRY_ATTR_VNI;
+        attr[0].value.u32 = VNET_VNI_BASE + eni;
+        if (!check(api->create_outbound_eni_to_vni_entry(&to_vni, 1, attr), "create_outbound_eni_to_vni_entry")) {
+            return false;
+        }
+
+        /* A default route, the VNET /8 and a few more specific ones */
+        sai_outbound_routing_entry_t route = {};
+        route.eni = (uint16_t)eni;
+        attr[0].id = SAI_OUTBOUND_ROUTING_ENTRY_ATTR_DEST_VNET_VNI;
+        const std::pair<uint32_t, uint8_t> prefixes[] = {
+            { 0, 0 }, { 0x0a000000, 8 }, { 0x0aff0000, 16 }, { 0x0afe0100, 24 }, { 0x0afe0201, 32 },
+        };
+        for (auto &p : prefixes) {
+            route.destination = sai_prefix(p.first, p.second);
+            attr[0].value.u32 = VNET_VNI_BASE + eni;
+            if (!check(api->create_outbound_routing_entry(&route, 1, attr), "create_outbound_routing_entry")) {
+                return false;
+            }
+        }
+
+        sai_object_id_t vm;
+        attr[0].id = SAI_INBOUND_VM_ATTR_UNDERLAY_DMAC;
+        mac_to_bytes(0x00dd00000000ULL | eni, attr[0].value.mac);
+        attr[1].id = SAI_INBOUND_VM_ATTR_UNDERLAY_DIP;
+        attr[1].value.ipaddr = sai_ipv4(0x65000000 + eni);
+        attr[2].id = SAI_INBOUND_VM_ATTR_VNI;
+        attr[2].value.u32 = 2000 + eni;
+        if (!check(api->create_inbound_vm(&vm, SAI_NULL_OBJECT_ID, 3, attr), "create_inbound_vm")) {
+            return false;
+        }
+
+        sai_inbound_eni_lookup_to_vm_entry_t to_vm = {};
+        mac_to_bytes(eni_mac(eni), to_vm.dmac);
+        attr[0].id = SAI_INBOUND_ENI_LOOKUP_TO_VM_ENTRY_ATTR_ENI;
+        attr[0].value.u16 = (uint16_t)eni;
+        if (!check(api->create_inbound_eni_lookup_to_vm_entry(&to_vm, 1, attr), "create_inbound_eni_lookup_to_vm_entry")) {
+            return false;
+        }
+
+        sai_inbound_eni_to_vm_entry_t eni_to_vm = {};
+        eni_to_vm.eni = (uint16_t)eni;
+        attr[0].id = SAI_INBOUND_ENI_TO_VM_ENTRY_ATTR_VM_ID;
+        attr[0].value.u16 = (uint16_t)vm;
+        if (!check(api->create_inbound_eni_to_vm_entry(&eni_to_vm, 1, attr), "create_inbound_eni_to_vm_entry")) {
+            return false;
+        }
+
+        if (!acl_rules<sai_outbound_acl_stage1_entry_t>(api->create_outbound_acl_stage1_entry, (uint16_t)eni,
+                                                        SAI_OUTBOUND_ACL_STAGE1_ENTRY_ATTR_START,
+                                                        SAI_OUTBOUND_ACL_STAGE1_ENTRY_ACTION_PERMIT,
+                                                        SAI_OUTBOUND_ACL_STAGE1_ENTRY_ACTION_DENY, true) ||
+            !acl_rules<sai_inbound_acl_stage1_entry_t>(api->create_inbound_acl_stage1_entry, (uint16_t)eni,
+                                                       SAI_INBOUND_ACL_STAGE1_ENTRY_ATTR_START,
+                                                       SAI_INBOUND_ACL_STAGE1_ENTRY_ACTION_PERMIT,
+                                                       SAI_INBOUND_ACL_STAGE1_ENTRY_ACTION_DENY, false)) {
+            return false;
+        }
+    }
+
+    for (uint32_t i = 0; i < mappings; i++) {
+        flow_t f = vm_flow(i, enis);
+
+        sai_outbound_ca_to_pa_entry_t ca = {};
+        ca.dest_vni = (uint16_t)(VNET_VNI_BASE + i % enis);
+        ca.dip = sai_ipv4(f.dip);
+        attr[0].id = SAI_OUTBOUND_CA_TO_PA_ENTRY_ATTR_UNDERLAY_DIP;
+        attr[0].value.ipaddr = sai_ipv4(0x66000000 + i);
+        attr[1].id = SAI_OUTBOUND_CA_TO_PA_ENTRY_ATTR_OVERLAY_DMAC;
+        mac_to_bytes(0x00ee00000000ULL | i, attr[1].value.mac);
+        attr[2].id = SAI_OUTBOUND_CA_TO_PA_ENTRY_ATTR_USE_DST_VNI;
+        attr[2].value.booldata = true;
+        if (!check(api->create_outbound_ca_to_pa_entry(&ca, 3, attr), "create_outbound_ca_to_pa_entry")) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+/* Underlay of the outbound (VM -> VNET) and inbound (VNET -> VM) frames */
+const tunnel_t OUTBOUND_TUNNEL = { 0x00f000000001ULL, 0x00cc00000002ULL, 0x0c000001, 0x64000001, OUTBOUND_VNI };
+const tunnel_t INBOUND_TUNNEL = { 0x00f000000002ULL, 0x00cc00000002ULL, 0x0c000002, 0x64000001, INBOUND_VNI };
+
+/* The reply direction of a flow */
+inline flow_t reverse(flow_t f)
+{
+    std::swap(f.sip, f.dip);
+    std::swap(f.sport, f.dport);
+    std::swap(f.smac, f.dmac);
+    return f;
+}
+
+} // namespace bench
+} // namespace sirius
+
+#endif /* _SIRIUS_BENCH_PROGRAM_H_ */
@@ -0,0 +1,161 @@
+/*
+ * Outbound routing LPM: programming rate, memory and lookup rate, and
+ * lookups while routes are being updated.
+ *
+ * usage: bench_routing [enis] [routes_per_eni] [lookups] [pages]
+ *
+ * Programs `routes_per_eni` random routes inside 10.0.0.0/8 (mostly /24,
+ * the rest /16 to /32) into each of `enis` ENIs in bulk batches, then
+ * looks up `lookups` destinations, half of them inside a programmed
+ * route. A sample of the lookups is checked against a reference LPM
+ * built from exact lookups. Last, a writer thread removes and re-adds
+ * single routes while the main thread keeps looking up, and both rates
+ * are reported. `pages` (4k, 2m or 1g) places the tries on huge pages.
+ */
+
+#include <atomic>
+#include <cstdlib>
+#include <random>
+#include <thread>
+
+#include "../sirius_routing.h"
+#include "bench_packets.h"
+
+using namespace sirius;
+using namespace sirius::bench;
+
+namespace {
+
+constexpr uint32_t BATCH = 4096;
+constexpr uint32_t CHECKED = 100000;
+
+struct route_gen {
+    std::mt19937 rng{ 1 };
+
+    uint32_t uniform(uint32_t lo, uint32_t hi)
+    {
+        return std::uniform_int_distribution<uint32_t>(lo, hi)(rng);
+    }
+
+    routing_key_t route(uint16_t eni)
+    {
+        uint32_t pick = uniform(0, 99);
+        uint8_t len = pick < 70 ? 24 : pick < 85 ? (uint8_t)uniform(16, 23) : (uint8_t)uniform(25, 32);
+        uint32_t addr = 0x0a000000 | uniform(0, 0xffffff);
+        return { eni, addr & (~0u << (32 - len)), len };
+    }
+};
+
+/* Longest match from exact lookups, the reference for the trie */
+bool reference_lpm(const sirius_routing &routing, uint16_t eni, ipv4_addr_t dip, routing_entry_t &value)
+{
+    for (int len = 32; len >= 0; len--) {
+        routing_key_t key = { eni, len ? dip & (~0u << (32 - len)) : 0, (uint8_t)len };
+        if (routing.lookup(key, value)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    uint32_t enis = argc > 1 ? (uint32_t)strtoul(argv[1], nullptr, 0) : 16;
+    uint32_t per_eni = argc > 2 ? (uint32_t)strtoul(argv[2], nullptr, 0) : 100000;
+    uint32_t lookups = argc > 3 ? (uint32_t)strtoul(argv[3], nullptr, 0) : 10000000;
+    page_size_t pages = PAGE_SIZE_DEFAULT;
+    if (!enis || enis > 65536 || !per_eni || !lookups || (argc > 4 && !parse_page_size(argv[4], pages))) {
+        fprintf(stderr, "usage: %s [enis] [routes_per_eni] [lookups] [4k|2m|1g]\n", argv[0]);
+        return 1;
+    }
+
+    route_gen gen;
+    sirius_routing routing;
+    routing.set_placement({ pages, -1 });
+    std::vector<routing_key_t> routes;
+    routes.reserve((size_t)enis * per_eni);
+
+    auto start = bench_clock::now();
+    for (uint32_t eni = 0; eni < enis; eni++) {
+        for (uint32_t done = 0; done < per_eni;) {
+            uint32_t n = std::min(BATCH, per_eni - done);
+            routing.batch([&](sirius_routing::writer &w) {
+                for (uint32_t i = 0; i < n; i++) {
+                    routing_key_t key = gen.route((uint16_t)eni);
+                    if (w.insert(key, { 1000 + (uint32_t)routes.size() % 4096, 0 }) == SAI_STATUS_SUCCESS) {
+                        routes.push_back(key);
+                    }
+                }
+            });
+            done += n;
+        }
+    }
+    double program = seconds_since(start);
+
+    size_t count = routing.size();
+    size_t bytes = routing.memory();
+    printf("%zu routes in %u ENIs: %.0f routes/s in batches of %u, %.0f KB, %.1f bytes/route\n",
+           count, enis, count / program, BATCH, bytes / 1024.0, (double)bytes / count);
+
+    /* Destinations: half inside a programmed route, half anywhere in 10/8 */
+    std::vector<std::pair<uint16_t, ipv4_addr_t>> dsts(1 << 20);
+    for (auto &d : dsts) {
+        if (gen.uniform(0, 1)) {
+            const routing_key_t &r = routes[gen.uniform(0, (uint32_t)routes.size() - 1)];
+            uint32_t host = r.prefix_len == 32 ? 0 : gen.uniform(0, ~0u >> r.prefix_len);
+            d = { r.eni, r.prefix | host };
+        } else {
+            d = { (uint16_t)gen.uniform(0, enis - 1), 0x0a000000 | gen.uniform(0, 0xffffff) };
+        }
+    }
+
+    uint64_t mismatch = 0;
+    for (uint32_t i = 0; i < CHECKED && i < dsts.size(); i++) {
+        routing_entry_t a = {}, b = {};
+        bool hit_a = routing.lpm(dsts[i].first, dsts[i].second, a);
+        bool hit_b = reference_lpm(routing, dsts[i].first, dsts[i].second, b);
+        mismatch += hit_a != hit_b || (hit_a && (a.dest_vnet_vni != b.dest_vnet_vni || a.counter != b.counter));
+    }
+
+    uint64_t hits = 0;
+    start = bench_clock::now();
+    for (uint32_t i = 0; i < lookups; i++) {
+        const auto &d = dsts[i & (dsts.size() - 1)];
+        routing_entry_t value;
+        hits += routing.lpm(d.first, d.second, value);
+    }
+    double lookup = seconds_since(start);
+    printf("lookup: %.1f ns, %.1f%% hit, %lu mismatches in %u checked\n",
+           lookup * 1e9 / lookups, 100.0 * hits / lookups, mismatch, CHECKED);
+
+    /* Route churn: the writer flaps single routes while lookups go on */
+    std::atomic<bool> stop{ false };
+    std::atomic<uint64_t> updates{ 0 };
+    std::thread writer([&] {
+        std::mt19937 rng(2);
+        while (!stop.load(std::memory_order_relaxed)) {
+            const routing_key_t &key = routes[rng() % routes.size()];
+            routing_entry_t value;
+            routing.lookup(key, value);
+            routing.remove(key);
+            routing.insert(key, value);
+            updates.fetch_add(2, std::memory_order_relaxed);
+        }
+    });
+
+    hits = 0;
+    start = bench_clock::now();
+    for (uint32_t i = 0; i < lookups; i++) {
+        const auto &d = dsts[i & (dsts.size() - 1)];
+        routing_entry_t value;
+        hits += routing.lpm(d.first, d.second, value);
+    }
+    lookup = seconds_since(start);
+    stop = true;
+    writer.join();
+    printf("under churn: lookup %.1f ns, %.0f route updates/s\n", lookup * 1e9 / lookups, updates / lookup);
+
+    return mismatch ? 1 : 0;
+}
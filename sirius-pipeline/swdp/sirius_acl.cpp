@@ -0,0 +1,54 @@
+#include "sirius_acl.h"
+
+namespace sirius {
+
+namespace {
+
+/* Fields of an invalid header read as 0, as in the P4 model */
+acl_key_t acl_key(const headers_t &hdr)
+{
+    acl_key_t key = {};
+    if (hdr.ipv4) {
+        key.dip = ntohl(hdr.ipv4->dst_addr);
+        key.sip = ntohl(hdr.ipv4->src_addr);
+        key.protocol = hdr.ipv4->protocol;
+    }
+    if (hdr.tcp) {
+        key.sport = ntohs(hdr.tcp->src_port);
+        key.dport = ntohs(hdr.tcp->dst_port);
+    } else if (hdr.udp) {
+        key.sport = ntohs(hdr.udp->src_port);
+        key.dport = ntohs(hdr.udp->dst_port);
+    }
+    return key;
+}
+
+} // namespace
+
+void acl_apply(const sirius_acl_table (&stages)[sirius_switch::ACL_STAGES], const headers_t &hdr, metadata_t &meta)
+{
+    acl_key_t key = acl_key(hdr);
+
+    for (unsigned i = 0; i < sirius_switch::ACL_STAGES; i++) {
+        acl_action_t action;
+        if (!stages[i].classify(meta.eni, key, meta.acl_sample, action, meta.acl_counter[i])) {
+            meta.dropped = true;
+            return;
+        }
+
+        switch (action) {
+        case ACL_ACTION_PERMIT:
+            return;
+        case ACL_ACTION_PERMIT_AND_CONTINUE:
+            break;
+        case ACL_ACTION_DENY:
+            meta.dropped = true;
+            return;
+        case ACL_ACTION_DENY_AND_CONTINUE:
+            meta.dropped = true;
+            break;
+        }
+    }
+}
+
+} // namespace sirius
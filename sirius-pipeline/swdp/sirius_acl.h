@@ -0,0 +1,24 @@
+#ifndef _SIRIUS_ACL_H_
+#define _SIRIUS_ACL_H_
+
+#include "sirius_headers.h"
+#include "sirius_metadata.h"
+#include "sirius_switch.h"
+
+namespace sirius {
+
+/*
+ * acl control of sirius_acl.p4: stage1..stage3 in order, each classifying
+ * the packet against the rules of meta.eni. permit and deny end the
+ * control, the *_and_continue actions fall through to the next stage, a
+ * miss takes the default deny. The counter slot of the rule each stage
+ * matched goes to meta.acl_counter, for the caller to count the packet.
+ */
+static_assert(sizeof(metadata_t::acl_counter) / sizeof(uint32_t) == sirius_switch::ACL_STAGES,
+              "a counter slot per stage");
+
+void acl_apply(const sirius_acl_table (&stages)[sirius_switch::ACL_STAGES], const headers_t &hdr, metadata_t &meta);
+
+} // namespace sirius
+
+#endif /* _SIRIUS_ACL_H_ */
@@ -0,0 +1,317 @@
+#include "sirius_acl_classifier.h"
+
+#include <algorithm>
+
+namespace sirius {
+
+namespace {
+
+constexpr uint32_t FIELD_MAX[ACL_FIELDS] = { 0xffffffff, 0xffffffff, 0xff, 0xffff, 0xffff };
+
+/* Bounds the tree on pathological rule sets; every split halves a field at most */
+constexpr unsigned MAX_DEPTH = 128;
+
+/* Rules with up to this many ranges in a field are matched by a linear scan */
+constexpr uint32_t LINEAR_RANGES = 8;
+
+} // namespace
+
+acl_classifier::acl_classifier(const std::vector<const acl_rule_t *> &rules)
+{
+    m_rules.reserve(rules.size());
+    for (const acl_rule_t *rule : rules) {
+        add_rule(*rule);
+    }
+
+    std::vector<uint32_t> all(m_rules.size());
+    for (uint32_t i = 0; i < all.size(); i++) {
+        all[i] = i;
+    }
+
+    box_t box;
+    for (unsigned f = 0; f < ACL_FIELDS; f++) {
+        box.lo[f] = 0;
+        box.hi[f] = FIELD_MAX[f];
+    }
+
+    m_nodes.resize(1);
+    build(0, all, box, 0);
+    m_nodes.shrink_to_fit();
+    m_leaf_entries.shrink_to_fit();
+}
+
+void acl_classifier::add_rule(const acl_rule_t &rule)
+{
+    rule_t compiled;
+    compiled.action = rule.action;
+    compiled.counter = rule.counter;
+
+    std::vector<range_t> ranges;
+    for (unsigned f = 0; f < ACL_FIELDS; f++) {
+        ranges.clear();
+        switch (f) {
+        case ACL_FIELD_DIP:
+        case ACL_FIELD_SIP:
+            for (const acl_prefix_t &p : f == ACL_FIELD_DIP ? rule.dip : rule.sip) {
+                uint32_t host = p.len >= 32 ? 0 : ~0u >> p.len;
+                ranges.push_back({ p.addr & ~host, (p.addr & ~host) | host });
+            }
+            break;
+        case ACL_FIELD_PROTOCOL:
+            for (uint8_t protocol : rule.protocol) {
+                ranges.push_back({ protocol, protocol });
+            }
+            break;
+        default:
+            for (const acl_port_range_t &r : f == ACL_FIELD_SPORT ? rule.sport : rule.dport) {
+                ranges.push_back({ r.min, r.max });
+            }
+            break;
+        }
+
+        if (ranges.empty()) {
+            ranges.push_back({ 0, FIELD_MAX[f] });
+        }
+
+        /* Sort and merge overlapping or adjacent ranges */
+        std::sort(ranges.begin(), ranges.end(), [](const range_t &a, const range_t &b) { return a.lo < b.lo; });
+        compiled.offset[f] = (uint32_t)m_ranges.size();
+        m_ranges.push_back(ranges[0]);
+        for (size_t i = 1; i < ranges.size(); i++) {
+            range_t &last = m_ranges.back();
+            if ((uint64_t)ranges[i].lo <= (uint64_t)last.hi + 1) {
+                last.hi = std::max(last.hi, ranges[i].hi);
+            } else {
+                m_ranges.push_back(ranges[i]);
+            }
+        }
+        compiled.count[f] = (uint32_t)m_ranges.size() - compiled.offset[f];
+    }
+
+    m_rules.push_back(compiled);
+}
+
+const acl_classifier::range_t *acl_classifier::ranges_begin(const rule_t &rule, unsigned field) const
+{
+    return m_ranges.data() + rule.offset[field];
+}
+
+const acl_classifier::range_t *acl_classifier::ranges_end(const rule_t &rule, unsigned field) const
+{
+    return m_ranges.data() + rule.offset[field] + rule.count[field];
+}
+
+/* First range of the rule ending at or above value */
+const acl_classifier::range_t *acl_classifier::first_range(const rule_t &rule, unsigned field, uint32_t value) const
+{
+    return std::lower_bound(ranges_begin(rule, field), ranges_end(rule, field), value,
+                            [](const range_t &r, uint32_t v) { return r.hi < v; });
+}
+
+bool acl_classifier::intersects(const rule_t &rule, unsigned field, uint32_t lo, uint32_t hi) const
+{
+    const range_t *r = first_range(rule, field, lo);
+    return r != ranges_end(rule, field) && r->lo <= hi;
+}
+
+bool acl_classifier::covers(const rule_t &rule, unsigned field, uint32_t lo, uint32_t hi) const
+{
+    const range_t *r = first_range(rule, field, lo);
+    return r != ranges_end(rule, field) && r->lo <= lo && r->hi >= hi;
+}
+
+bool acl_classifier::matches(const rule_t &rule, unsigned field, uint32_t value) const
+{
+    if (rule.count[field] > LINEAR_RANGES) {
+        return covers(rule, field, value, value);
+    }
+    for (const range_t *r = ranges_begin(rule, field), *end = ranges_end(rule, field); r != end; r++) {
+        if (value < r->lo) {
+            return false;
+        }
+        if (value <= r->hi) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void acl_classifier::make_leaf(uint32_t node, const std::vector<uint32_t> &rules, const box_t &box)
+{
+    m_nodes[node] = { (uint32_t)m_leaf_entries.size(), (uint32_t)rules.size(), NODE_LEAF };
+    for (uint32_t r : rules) {
+        const rule_t &rule = m_rules[r];
+        uint32_t lo[ACL_FIELDS], hi[ACL_FIELDS];
+        uint8_t multi = 0;
+        for (unsigned f = 0; f < ACL_FIELDS; f++) {
+            const range_t *first = first_range(rule, f, box.lo[f]);
+            if (first + 1 != ranges_end(rule, f) && first[1].lo <= box.hi[f]) {
+                lo[f] = box.lo[f];
+                hi[f] = box.hi[f];
+                multi |= 1u << f;
+            } else {
+                lo[f] = std::max(first->lo, box.lo[f]);
+                hi[f] = std::min(first->hi, box.hi[f]);
+            }
+        }
+
+        leaf_entry_t entry;
+        entry.dip_lo = lo[ACL_FIELD_DIP];
+        entry.dip_hi = hi[ACL_FIELD_DIP];
+        entry.sip_lo = lo[ACL_FIELD_SIP];
+        entry.sip_hi = hi[ACL_FIELD_SIP];
+        entry.sport_lo = (uint16_t)lo[ACL_FIELD_SPORT];
+        entry.sport_hi = (uint16_t)hi[ACL_FIELD_SPORT];
+        entry.dport_lo = (uint16_t)lo[ACL_FIELD_DPORT];
+        entry.dport_hi = (uint16_t)hi[ACL_FIELD_DPORT];
+        entry.protocol_lo = (uint8_t)lo[ACL_FIELD_PROTOCOL];
+        entry.protocol_hi = (uint8_t)hi[ACL_FIELD_PROTOCOL];
+        entry.multi = multi;
+        entry.action = rule.action;
+        entry.rule = r;
+        m_leaf_entries.push_back(entry);
+    }
+}
+
+void acl_classifier::build(uint32_t node, std::vector<uint32_t> &rules, box_t &box, unsigned depth)
+{
+    m_depth = std::max(m_depth, depth);
+
+    /* Everything behind a rule covering the whole node is unreachable */
+    for (size_t i = 0; i < rules.size(); i++) {
+        unsigned f = 0;
+        while (f < ACL_FIELDS && covers(m_rules[rules[i]], f, box.lo[f], box.hi[f])) {
+            f++;
+        }
+        if (f == ACL_FIELDS) {
+            rules.resize(i + 1);
+            break;
+        }
+    }
+
+    if (rules.size() <= LEAF_RULES || depth >= MAX_DEPTH) {
+        make_leaf(node, rules, box);
+        return;
+    }
+
+    /* Pick the field whose median split replicates the fewest rules */
+    int best_field = -1;
+    uint32_t best_value = 0;
+    size_t best_left = 0, best_right = 0;
+    std::vector<uint32_t> points;
+    for (unsigned f = 0; f < ACL_FIELDS; f++) {
+        if (box.lo[f] == box.hi[f]) {
+            continue;
+        }
+
+        points.clear();
+        for (uint32_t r : rules) {
+            const rule_t &rule = m_rules[r];
+            for (const range_t *it = first_range(rule, f, box.lo[f]), *end = ranges_end(rule, f);
+                 it != end && it->lo <= box.hi[f]; it++) {
+                if (it->lo > box.lo[f]) {
+                    points.push_back(it->lo - 1);
+                }
+                if (it->hi < box.hi[f]) {
+                    points.push_back(it->hi);
+                }
+            }
+        }
+        if (points.empty()) {
+            continue;
+        }
+        std::sort(points.begin(), points.end());
+        points.erase(std::unique(points.begin(), points.end()), points.end());
+        uint32_t value = points[points.size() / 2];
+
+        size_t left = 0, right = 0;
+        for (uint32_t r : rules) {
+            left += intersects(m_rules[r], f, box.lo[f], value);
+            right += intersects(m_rules[r], f, value + 1, box.hi[f]);
+        }
+
+        if (best_field < 0 || left + right < best_left + best_right ||
+            (left + right == best_left + best_right && std::max(left, right) < std::max(best_left, best_right))) {
+            best_field = (int)f;
+            best_value = value;
+            best_left = left;
+            best_right = right;
+        }
+    }
+
+    if (best_field < 0 || (best_left == rules.size() && best_right == rules.size())) {
+        make_leaf(node, rules, box);
+        return;
+    }
+
+    unsigned f = (unsigned)best_field;
+    std::vector<uint32_t> left, right;
+    left.reserve(best_left);
+    right.reserve(best_right);
+    for (uint32_t r : rules) {
+        if (intersects(m_rules[r], f, box.lo[f], best_value)) {
+            left.push_back(r);
+        }
+        if (intersects(m_rules[r], f, best_value + 1, box.hi[f])) {
+            right.push_back(r);
+        }
+    }
+    std::vector<uint32_t>().swap(rules);
+
+    uint32_t child = (uint32_t)m_nodes.size();
+    m_nodes.resize(child + 2);
+    m_nodes[node] = { best_value, child, (uint8_t)f };
+
+    uint32_t saved = box.hi[f];
+    box.hi[f] = best_value;
+    build(child, left, box, depth + 1);
+    box.hi[f] = saved;
+
+    saved = box.lo[f];
+    box.lo[f] = best_value + 1;
+    build(child + 1, right, box, depth + 1);
+    box.lo[f] = saved;
+}
+
+bool acl_classifier::classify(const acl_key_t &key, acl_action_t &action, uint32_t &counter) const
+{
+    const uint32_t value[ACL_FIELDS] = { key.dip, key.sip, key.protocol, key.sport, key.dport };
+
+    const node_t *node = &m_nodes[0];
+    while (node->field != NODE_LEAF) {
+        node = &m_nodes[node->child + (value[node->field] > node->value)];
+    }
+
+    for (const leaf_entry_t *e = &m_leaf_entries[node->value], *end = e + node->child; e != end; e++) {
+        bool in = (uint32_t)(key.dip - e->dip_lo) <= (uint32_t)(e->dip_hi - e->dip_lo);
+        in &= (uint32_t)(key.sip - e->sip_lo) <= (uint32_t)(e->sip_hi - e->sip_lo);
+        in &= (uint32_t)(key.protocol - e->protocol_lo) <= (uint32_t)(e->protocol_hi - e->protocol_lo);
+        in &= (uint32_t)(key.sport - e->sport_lo) <= (uint32_t)(e->sport_hi - e->sport_lo);
+        in &= (uint32_t)(key.dport - e->dport_lo) <= (uint32_t)(e->dport_hi - e->dport_lo);
+        if (!in) {
+            continue;
+        }
+
+        uint32_t multi = e->multi;
+        while (multi && matches(m_rules[e->rule], __builtin_ctz(multi), value[__builtin_ctz(multi)])) {
+            multi &= multi - 1;
+        }
+        if (!multi) {
+            action = e->action;
+            counter = m_rules[e->rule].counter;
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t acl_classifier::memory() const
+{
+    return sizeof(*this) +
+           m_nodes.capacity() * sizeof(node_t) +
+           m_leaf_entries.capacity() * sizeof(leaf_entry_t) +
+           m_rules.capacity() * sizeof(rule_t) +
+           m_ranges.capacity() * sizeof(range_t);
+}
+
+} // namespace sirius
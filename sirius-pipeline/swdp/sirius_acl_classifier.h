@@ -0,0 +1,164 @@
+#ifndef _SIRIUS_ACL_CLASSIFIER_H_
+#define _SIRIUS_ACL_CLASSIFIER_H_
+
+#include <cstddef>
+#include <vector>
+
+#include "sirius_types.h"
+
+namespace sirius {
+
+enum acl_action_t : uint8_t {
+    ACL_ACTION_PERMIT,
+    ACL_ACTION_PERMIT_AND_CONTINUE,
+    ACL_ACTION_DENY,
+    ACL_ACTION_DENY_AND_CONTINUE,
+};
+
+/* Match fields of an ACL_STAGE table, in key order */
+enum acl_field_t : uint8_t {
+    ACL_FIELD_DIP,
+    ACL_FIELD_SIP,
+    ACL_FIELD_PROTOCOL,
+    ACL_FIELD_SPORT,
+    ACL_FIELD_DPORT,
+    ACL_FIELDS,
+};
+
+/* Packet side of an ACL lookup, host byte order */
+struct acl_key_t {
+    ipv4_addr_t dip;
+    ipv4_addr_t sip;
+    uint8_t protocol;
+    uint16_t sport;
+    uint16_t dport;
+};
+
+struct acl_prefix_t {
+    ipv4_addr_t addr;
+    uint8_t len;
+};
+
+struct acl_port_range_t {
+    uint16_t min;
+    uint16_t max;
+};
+
+/*
+ * One rule of an ACL stage as programmed: `list` matches on dip, sip and
+ * protocol, `range_list` matches on sport and dport. An empty list
+ * matches any value. counter is the slot of the rule's direct counter,
+ * given by the table.
+ */
+struct acl_rule_t {
+    acl_action_t action;
+    uint32_t counter;
+    std::vector<acl_prefix_t> dip;
+    std::vector<acl_prefix_t> sip;
+    std::vector<uint8_t> protocol;
+    std::vector<acl_port_range_t> sport;
+    std::vector<acl_port_range_t> dport;
+};
+
+/*
+ * Packet classifier compiled from the rules of one ENI in one stage.
+ *
+ * Every field list is turned into sorted, disjoint [lo, hi] ranges.
+ * The rule set is then cut into a HyperSplit style decision tree: each
+ * inner node splits one field at one value, chosen at the median of the
+ * range end points inside the node so both halves carry a similar share
+ * of the rules. Splitting stops once a node holds at most LEAF_RULES
+ * rules. Rules that are shadowed inside a node by a higher priority rule
+ * covering the whole node are dropped, and a leaf only re-checks the
+ * fields its rules do not fully cover.
+ *
+ * A lookup is a walk down the tree, compare and branch per level, and a
+ * check of at most LEAF_RULES rules, so its cost grows with the depth
+ * of the tree (logarithmic in the rule count), not with the rule count.
+ *
+ * The classifier is immutable; rule changes compile a new one.
+ */
+class acl_classifier {
+public:
+    static constexpr unsigned LEAF_RULES = 8;
+
+    /* rules in priority order, the first matching rule wins */
+    explicit acl_classifier(const std::vector<const acl_rule_t *> &rules);
+
+    /* Returns false when no rule matches; counter is the matching rule's */
+    bool classify(const acl_key_t &key, acl_action_t &action, uint32_t &counter) const;
+
+    size_t memory() const;
+    size_t nodes() const { return m_nodes.size(); }
+    unsigned depth() const { return m_depth; }
+
+private:
+    struct range_t {
+        uint32_t lo;
+        uint32_t hi;
+    };
+
+    struct rule_t {
+        uint32_t offset[ACL_FIELDS];
+        uint32_t count[ACL_FIELDS];
+        uint32_t counter;
+        acl_action_t action;
+    };
+
+    static constexpr uint8_t NODE_LEAF = 0xff;
+
+    /* Inner node: children at child and child + 1. Leaf: leaf entries [value, value + child) */
+    struct node_t {
+        uint32_t value;
+        uint32_t child;
+        uint8_t field;
+    };
+
+    /*
+     * A rule inside one leaf: each field holds the rule's range clipped
+     * to the leaf, so the check is five compares without touching the
+     * rule. Fields where the rule has more than one range inside the leaf
+     * are flagged in `multi` and re-checked against the full range list.
+     */
+    struct leaf_entry_t {
+        uint32_t dip_lo;
+        uint32_t dip_hi;
+        uint32_t sip_lo;
+        uint32_t sip_hi;
+        uint16_t sport_lo;
+        uint16_t sport_hi;
+        uint16_t dport_lo;
+        uint16_t dport_hi;
+        uint8_t protocol_lo;
+        uint8_t protocol_hi;
+        uint8_t multi;
+        acl_action_t action;
+        uint32_t rule;
+    };
+
+    struct box_t {
+        uint32_t lo[ACL_FIELDS];
+        uint32_t hi[ACL_FIELDS];
+    };
+
+    const range_t *ranges_begin(const rule_t &rule, unsigned field) const;
+    const range_t *ranges_end(const rule_t &rule, unsigned field) const;
+    const range_t *first_range(const rule_t &rule, unsigned field, uint32_t value) const;
+    bool intersects(const rule_t &rule, unsigned field, uint32_t lo, uint32_t hi) const;
+    bool covers(const rule_t &rule, unsigned field, uint32_t lo, uint32_t hi) const;
+    bool matches(const rule_t &rule, unsigned field, uint32_t value) const;
+
+    void add_rule(const acl_rule_t &rule);
+    void build(uint32_t node, std::vector<uint32_t> &rules, box_t &box, unsigned depth);
+    void make_leaf(uint32_t node, const std::vector<uint32_t> &rules, const box_t &box);
+
+    std::vector<node_t> m_nodes;
+    std::vector<leaf_entry_t> m_leaf_entries;
+    std::vector<rule_t> m_rules;
+    std::vector<range_t> m_ranges;
+    unsigned m_depth = 0;
+};
+
+} // namespace sirius
+
+#endif /* _SIRIUS_ACL_CLASSIFIER_H_ */
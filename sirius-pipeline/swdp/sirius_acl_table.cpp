@@ -0,0 +1,164 @@
+#include "sirius_acl_table.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace sirius {
+
+bool sirius_acl_table::lookup(const acl_rule_key_t &key, acl_rule_t &rule) const
+{
+    std::lock_guard<std::mutex> lock(m_rules_lock);
+    auto eni = m_rules.find(key.eni);
+    if (eni == m_rules.end()) {
+        return false;
+    }
+    auto it = eni->second.find(key.priority);
+    if (it == eni->second.end()) {
+        return false;
+    }
+    rule = it->second;
+    return true;
+}
+
+void sirius_acl_table::rule_counters(uint16_t eni, const uint32_t *priorities, size_t count, counter_t *out,
+                                     bool *found) const
+{
+    std::lock_guard<std::mutex> lock(m_rules_lock);
+    auto rules = m_rules.find(eni);
+    std::vector<uint32_t> slots;
+    std::vector<size_t> slotted;
+    for (size_t i = 0; i < count; i++) {
+        found[i] = false;
+        if (rules == m_rules.end()) {
+            continue;
+        }
+        auto it = rules->second.find(priorities[i]);
+        if (it != rules->second.end()) {
+            found[i] = true;
+            slots.push_back(it->second.counter);
+            slotted.push_back(i);
+        }
+    }
+
+    std::vector<counter_t> counts(slots.size());
+    m_counters.read(slots.data(), slots.size(), counts.data());
+    for (size_t j = 0; j < slotted.size(); j++) {
+        out[slotted[j]] = counts[j];
+    }
+}
+
+void sirius_acl_table::top_rules(uint16_t eni, size_t n, std::vector<acl_rule_counter_t> &out) const
+{
+    out.clear();
+    std::lock_guard<std::mutex> lock(m_rules_lock);
+    auto acl = m_enis.find(eni);
+    if (acl == m_enis.end()) {
+        return;
+    }
+
+    std::vector<heavy_hitters::item_t> items;
+    acl->second.top->items(items);
+    if (items.empty()) {
+        return;
+    }
+
+    /* The slots of removed rules were erased from top, the others are rules of eni */
+    std::vector<uint32_t> slots;
+    for (const auto &item : items) {
+        slots.push_back(item.key);
+    }
+    std::vector<counter_t> counts(slots.size());
+    m_counters.read(slots.data(), slots.size(), counts.data());
+    for (size_t i = 0; i < slots.size(); i++) {
+        out.push_back({ m_slot_priorities[slots[i]], counts[i] });
+    }
+
+    /* Ranked by their exact counts, the sampled ones only picked them */
+    std::sort(out.begin(), out.end(), [](const acl_rule_counter_t &a, const acl_rule_counter_t &b) {
+        return a.counter.packets > b.counter.packets;
+    });
+    if (out.size() > n) {
+        out.resize(n);
+    }
+}
+
+void sirius_acl_table::commit(const std::unordered_set<uint16_t> &dirty,
+                              const std::vector<std::pair<uint16_t, uint32_t>> &released)
+{
+    /* Only writers change m_enis, and they hold m_rules_lock: it can be read here without m_lock */
+    std::vector<std::pair<uint16_t, eni_acl_t>> compiled;
+    std::vector<const acl_rule_t *> rules;
+
+    for (uint16_t eni : dirty) {
+        auto it = m_rules.find(eni);
+        if (it == m_rules.end()) {
+            compiled.emplace_back(eni, eni_acl_t{});
+            continue;
+        }
+        rules.clear();
+        for (const auto &rule : it->second) {
+            rules.push_back(&rule.second);
+        }
+        eni_acl_t acl;
+        acl.classifier = std::make_unique<const acl_classifier>(rules);
+        if (!m_enis.count(eni)) {
+            acl.top = std::make_unique<heavy_hitters>();
+        }
+        compiled.emplace_back(eni, std::move(acl));
+    }
+
+    /* Swap under the lock; the old classifiers are freed after it is released */
+    {
+        std::lock_guard<rcu_rw_lock> lock(m_lock);
+        for (auto &c : compiled) {
+            if (c.second.classifier) {
+                eni_acl_t &acl = m_enis[c.first];
+                acl.classifier.swap(c.second.classifier);
+                if (c.second.top) {
+                    acl.top.swap(c.second.top);
+                }
+            } else {
+                auto it = m_enis.find(c.first);
+                if (it != m_enis.end()) {
+                    c.second = std::move(it->second);
+                    m_enis.erase(it);
+                }
+            }
+        }
+    }
+
+    /*
+     * The writer waited for the readers of the old classifiers, so no
+     * lookup returns or samples a removed rule's slot any more: it can
+     * go to a new rule, which starts over
+     */
+    for (const auto &r : released) {
+        m_counters.release(r.second);
+        auto it = m_enis.find(r.first);
+        if (it != m_enis.end()) {
+            it->second.top->erase(r.second);
+        }
+    }
+}
+
+size_t sirius_acl_table::memory() const
+{
+    std::shared_lock<rcu_rw_lock> lock(m_lock);
+    size_t bytes = 0;
+    for (const auto &acl : m_enis) {
+        bytes += acl.second.classifier->memory();
+    }
+    return bytes;
+}
+
+size_t sirius_acl_table::size() const
+{
+    std::lock_guard<std::mutex> lock(m_rules_lock);
+    size_t count = 0;
+    for (const auto &eni : m_rules) {
+        count += eni.second.size();
+    }
+    return count;
+}
+
+} // namespace sirius
@@ -0,0 +1,222 @@
+#ifndef _SIRIUS_ACL_TABLE_H_
+#define _SIRIUS_ACL_TABLE_H_
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+extern "C" {
+#include <saitypes.h>
+#include <saistatus.h>
+}
+
+#include "sirius_acl_classifier.h"
+#include "sirius_counters.h"
+#include "sirius_heavy_hitters.h"
+#include "sirius_rcu.h"
+
+namespace sirius {
+
+struct acl_rule_key_t {
+    uint16_t eni;
+    uint32_t priority;
+};
+
+/* A rule of one ENI and its counts, for the counter reports */
+struct acl_rule_counter_t {
+    uint32_t priority;
+    counter_t counter;
+};
+
+/*
+ * One ACL_STAGE table: meta.eni exact plus the list/range_list fields.
+ *
+ * Rules are kept per ENI in priority order. Every write (single call or
+ * batch) recompiles the acl_classifier of the ENIs it touched before it
+ * returns, outside of the lock the data path reads under, and then swaps
+ * the new classifiers in. Lookups write nothing shared but the sampled
+ * hits (rcu_rw_lock). Large rule sets should be programmed with the bulk
+ * calls so they are compiled once.
+ *
+ * Each rule gets a slot of counters(), the stage's direct counter, which
+ * the pipelines count the packets the rule classifies into. Next to its
+ * classifier, every ENI keeps the heavy_hitters of its rules' slots, fed
+ * with the hits the pipelines sample (one in TOP_SAMPLE on average);
+ * top_rules() reads the exact counts of the rules it monitors, so the hot
+ * rules of an ENI are found without reading the counters of all of them.
+ */
+class sirius_acl_table {
+public:
+    using key_type = acl_rule_key_t;
+    using value_type = acl_rule_t;
+    using rule_map = std::unordered_map<uint16_t, std::map<uint32_t, acl_rule_t>>;
+
+    /* Rules the counters have slots for */
+    static constexpr size_t COUNTER_SLOTS = 1u << 20;
+
+    /* A sampled hit stands for this many, a power of two */
+    static constexpr uint32_t TOP_SAMPLE = 16;
+
+    class writer {
+    public:
+        writer(rule_map &rules, std::unordered_set<uint16_t> &dirty, sirius_counters &counters,
+               std::vector<uint32_t> &slot_priorities, std::vector<std::pair<uint16_t, uint32_t>> &released)
+            : m_rules(rules), m_dirty(dirty), m_counters(counters), m_slot_priorities(slot_priorities),
+              m_released(released)
+        {
+        }
+
+        sai_status_t insert(const acl_rule_key_t &key, const acl_rule_t &rule)
+        {
+            if (find(key)) {
+                return SAI_STATUS_ITEM_ALREADY_EXISTS;
+            }
+            acl_rule_t added = rule;
+            added.counter = m_counters.allocate();
+            if (!added.counter) {
+                return SAI_STATUS_TABLE_FULL;
+            }
+            if (added.counter >= m_slot_priorities.size()) {
+                m_slot_priorities.resize(added.counter + 1);
+            }
+            m_slot_priorities[added.counter] = key.priority;
+            m_rules[key.eni].emplace(key.priority, std::move(added));
+            m_dirty.insert(key.eni);
+            return SAI_STATUS_SUCCESS;
+        }
+
+        sai_status_t remove(const acl_rule_key_t &key)
+        {
+            auto eni = m_rules.find(key.eni);
+            if (eni == m_rules.end()) {
+                return SAI_STATUS_ITEM_NOT_FOUND;
+            }
+            auto it = eni->second.find(key.priority);
+            if (it == eni->second.end()) {
+                return SAI_STATUS_ITEM_NOT_FOUND;
+            }
+            m_released.emplace_back(key.eni, it->second.counter);
+            eni->second.erase(it);
+            if (eni->second.empty()) {
+                m_rules.erase(eni);
+            }
+            m_dirty.insert(key.eni);
+            return SAI_STATUS_SUCCESS;
+        }
+
+        acl_rule_t *find(const acl_rule_key_t &key)
+        {
+            auto eni = m_rules.find(key.eni);
+            if (eni == m_rules.end()) {
+                return nullptr;
+            }
+            auto it = eni->second.find(key.priority);
+            return it == eni->second.end() ? nullptr : &it->second;
+        }
+
+        void reserve(size_t)
+        {
+        }
+
+    private:
+        rule_map &m_rules;
+        std::unordered_set<uint16_t> &m_dirty;
+        sirius_counters &m_counters;
+        std::vector<uint32_t> &m_slot_priorities;
+        std::vector<std::pair<uint16_t, uint32_t>> &m_released;
+    };
+
+    sai_status_t insert(const acl_rule_key_t &key, const acl_rule_t &rule)
+    {
+        sai_status_t status;
+        batch([&](writer &w) { status = w.insert(key, rule); });
+        return status;
+    }
+
+    sai_status_t remove(const acl_rule_key_t &key)
+    {
+        sai_status_t status;
+        batch([&](writer &w) { status = w.remove(key); });
+        return status;
+    }
+
+    /* Control plane lookup of one rule */
+    bool lookup(const acl_rule_key_t &key, acl_rule_t &rule) const;
+
+    template <typename Fn>
+    void batch(Fn &&fn)
+    {
+        std::lock_guard<std::mutex> lock(m_rules_lock);
+        std::unordered_set<uint16_t> dirty;
+        std::vector<std::pair<uint16_t, uint32_t>> released;
+        writer w(m_rules, dirty, m_counters, m_slot_priorities, released);
+        fn(w);
+        commit(dirty, released);
+    }
+
+    /*
+     * Data path: classifies key against the rules of eni, false on a miss.
+     * counter is the slot of the rule that matched; sample offers it to
+     * the ENI's top rules.
+     */
+    bool classify(uint16_t eni, const acl_key_t &key, bool sample, acl_action_t &action, uint32_t &counter) const
+    {
+        return m_lock.read([&] {
+            auto it = m_enis.find(eni);
+            if (it == m_enis.end() || !it->second.classifier->classify(key, action, counter)) {
+                return false;
+            }
+            if (sample) {
+                it->second.top->offer(counter, TOP_SAMPLE);
+            }
+            return true;
+        });
+    }
+
+    /* The stage's direct counter, for the pipelines to attach their blocks to */
+    sirius_counters &counters() { return m_counters; }
+
+    /*
+     * Counts of the rules of eni at priorities[0..count), since their
+     * creation; found[i] is false for the ones that do not exist, whose
+     * counts are left alone.
+     */
+    void rule_counters(uint16_t eni, const uint32_t *priorities, size_t count, counter_t *out, bool *found) const;
+
+    /*
+     * Up to n of the rules of eni the sampled hits found hottest, with
+     * their exact counts, most packets first. At most
+     * heavy_hitters::CAPACITY.
+     */
+    void top_rules(uint16_t eni, size_t n, std::vector<acl_rule_counter_t> &out) const;
+
+    /* Compiled classifier memory of all ENIs */
+    size_t memory() const;
+
+    size_t size() const;
+
+private:
+    struct eni_acl_t {
+        std::unique_ptr<const acl_classifier> classifier;
+        std::unique_ptr<heavy_hitters> top;
+    };
+
+    /* Recompiles the dirty ENIs, swaps them in, then frees the counter slots of the released rules */
+    void commit(const std::unordered_set<uint16_t> &dirty, const std::vector<std::pair<uint16_t, uint32_t>> &released);
+
+    mutable std::mutex m_rules_lock;
+    rule_map m_rules;
+    sirius_counters m_counters{ COUNTER_SLOTS };
+    std::vector<uint32_t> m_slot_priorities; /* priority of the rule of each allocated slot */
+
+    mutable rcu_rw_lock m_lock;
+    std::unordered_map<uint16_t, eni_acl_t> m_enis;
+};
+
+} // namespace sirius
+
+#endif /* _SIRIUS_ACL_TABLE_H_ */
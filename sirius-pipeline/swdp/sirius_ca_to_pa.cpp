@@ -0,0 +1,306 @@
+#include "sirius_ca_to_pa.h"
+
+#include <algorithm>
+#include <initializer_list>
+#include <memory>
+
+namespace sirius {
+
+namespace {
+
+constexpr size_t MIN_BUCKETS = 64;
+
+/* Grow when an insert would fill more than this share of the slots */
+constexpr double MAX_LOAD = 0.95;
+
+/* Load reserve() sizes the table for */
+constexpr double RESERVE_LOAD = 0.9;
+
+/*
+ * Buckets after growing from `buckets`: a quarter more, so a table that
+ * grew at MAX_LOAD is still 3/4 full and stays under 32 bytes a mapping
+ */
+size_t grown(size_t buckets)
+{
+    return buckets + buckets / 4;
+}
+
+/* Buckets the cuckoo path search visits, four levels of moves */
+constexpr unsigned SEARCH_BUCKETS = 256;
+
+} // namespace
+
+sirius_ca_to_pa::sirius_ca_to_pa()
+    : m_table(new table_t(MIN_BUCKETS, {}))
+{
+}
+
+sirius_ca_to_pa::~sirius_ca_to_pa()
+{
+    delete m_table.load(std::memory_order_relaxed);
+}
+
+size_t sirius_ca_to_pa::memory() const
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    return m_table.load(std::memory_order_relaxed)->count * sizeof(bucket_t);
+}
+
+size_t sirius_ca_to_pa::size_held() const
+{
+    return m_count;
+}
+
+void sirius_ca_to_pa::snapshot_held(std::vector<uint32_t> &slots, std::vector<counter_t> &counts) const
+{
+    const table_t *table = m_table.load(std::memory_order_relaxed);
+    slots.clear();
+    slots.reserve(m_count);
+    for (size_t b = 0; b < table->count; b++) {
+        const bucket_t &bucket = table->buckets[b];
+        for (unsigned i = 0; i < BUCKET_SLOTS; i++) {
+            if (bucket.used & 1u << i) {
+                ca_to_pa_entry_t value;
+                bucket.get((int)i, value);
+                slots.push_back(value.counter);
+            }
+        }
+    }
+    counts.resize(slots.size());
+    m_counters.read(slots.data(), slots.size(), counts.data());
+}
+
+void sirius_ca_to_pa::set_placement(const memory_placement_t &placement)
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    m_placement = placement;
+    grow(m_table.load(std::memory_order_relaxed)->count);
+    m_reclaim.reclaim();
+}
+
+memory_placement_t sirius_ca_to_pa::placement() const
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    return m_table.load(std::memory_order_relaxed)->memory.placement();
+}
+
+double sirius_ca_to_pa::load_factor() const
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    return (double)m_count / (m_table.load(std::memory_order_relaxed)->count * BUCKET_SLOTS);
+}
+
+void sirius_ca_to_pa::write_slot(bucket_t &bucket, unsigned i, const ca_to_pa_key_t &key,
+                                 const ca_to_pa_entry_t &value)
+{
+    uint32_t seq = bucket.seq.load(std::memory_order_relaxed);
+    bucket.seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot_t &slot = bucket.slots[i];
+    slot.dip = key.dip;
+    slot.dest_vni = key.dest_vni;
+    slot.dmac_hi = (uint16_t)(value.overlay_dmac >> 32);
+    slot.dmac_lo = (uint32_t)value.overlay_dmac;
+    slot.underlay_dip = value.underlay_dip;
+    bucket.counter[i][0] = (uint8_t)value.counter;
+    bucket.counter[i][1] = (uint8_t)(value.counter >> 8);
+    bucket.counter[i][2] = (uint8_t)(value.counter >> 16);
+    bucket.used |= (uint8_t)(1u << i);
+    if (value.use_dst_vni) {
+        bucket.use_dst_vni |= (uint8_t)(1u << i);
+    } else {
+        bucket.use_dst_vni &= (uint8_t)~(1u << i);
+    }
+
+    bucket.seq.store(seq + 2, std::memory_order_release);
+}
+
+void sirius_ca_to_pa::clear_slot(bucket_t &bucket, unsigned i)
+{
+    uint32_t seq = bucket.seq.load(std::memory_order_relaxed);
+    bucket.seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    bucket.used &= (uint8_t)~(1u << i);
+
+    bucket.seq.store(seq + 2, std::memory_order_release);
+}
+
+static inline int free_slot(uint8_t used, unsigned slots)
+{
+    unsigned i = (unsigned)__builtin_ctz(~(unsigned)used);
+    return i < slots ? (int)i : -1;
+}
+
+sai_status_t sirius_ca_to_pa::do_insert(const ca_to_pa_key_t &key, const ca_to_pa_entry_t &value)
+{
+    table_t *table = m_table.load(std::memory_order_relaxed);
+    uint64_t hash = key_hash(key);
+    if (table->buckets[table->first(hash)].find(key) >= 0 || table->buckets[table->second(hash)].find(key) >= 0) {
+        return SAI_STATUS_ITEM_ALREADY_EXISTS;
+    }
+
+    ca_to_pa_entry_t entry = value;
+    entry.counter = m_counters.allocate();
+    if (!entry.counter) {
+        return SAI_STATUS_TABLE_FULL;
+    }
+
+    if (m_count + 1 > MAX_LOAD * table->count * BUCKET_SLOTS) {
+        grow(grown(table->count));
+    }
+    while (!place(*m_table.load(std::memory_order_relaxed), key, entry)) {
+        grow(grown(m_table.load(std::memory_order_relaxed)->count));
+    }
+    m_count++;
+    return SAI_STATUS_SUCCESS;
+}
+
+sai_status_t sirius_ca_to_pa::do_remove(const ca_to_pa_key_t &key)
+{
+    table_t *table = m_table.load(std::memory_order_relaxed);
+    uint64_t hash = key_hash(key);
+    for (size_t b : { table->first(hash), table->second(hash) }) {
+        int slot = table->buckets[b].find(key);
+        if (slot >= 0) {
+            ca_to_pa_entry_t value;
+            table->buckets[b].get(slot, value);
+            m_counters.release(value.counter);
+            clear_slot(table->buckets[b], (unsigned)slot);
+            m_count--;
+            return SAI_STATUS_SUCCESS;
+        }
+    }
+    return SAI_STATUS_ITEM_NOT_FOUND;
+}
+
+/* Grows geometrically so back to back batches do not rehash every time */
+void sirius_ca_to_pa::do_reserve(size_t count)
+{
+    size_t buckets = (size_t)(count / (BUCKET_SLOTS * RESERVE_LOAD)) + 1;
+    size_t current = m_table.load(std::memory_order_relaxed)->count;
+    if (buckets > current) {
+        grow(std::max(buckets, grown(current)));
+    }
+}
+
+/* Stores a mapping known to be absent, false if no cuckoo path frees a slot */
+bool sirius_ca_to_pa::place(table_t &table, const ca_to_pa_key_t &key, const ca_to_pa_entry_t &value)
+{
+    uint64_t hash = key_hash(key);
+    size_t first = table.first(hash);
+    size_t second = table.second(hash);
+
+    for (size_t b : { first, second }) {
+        int slot = free_slot(table.buckets[b].used, BUCKET_SLOTS);
+        if (slot >= 0) {
+            write_slot(table.buckets[b], (unsigned)slot, key, value);
+            return true;
+        }
+    }
+
+    size_t bucket;
+    if (!cuckoo(table, first, second, bucket)) {
+        return false;
+    }
+    write_slot(table.buckets[bucket], (unsigned)free_slot(table.buckets[bucket].used, BUCKET_SLOTS), key, value);
+    return true;
+}
+
+/*
+ * Breadth first search for the shortest chain of moves that frees a slot
+ * in first or second, then performs the moves from the free end back, so
+ * every moved mapping is always present in one of its buckets.
+ */
+bool sirius_ca_to_pa::cuckoo(table_t &table, size_t first, size_t second, size_t &bucket)
+{
+    struct step_t {
+        size_t bucket;
+        int parent;
+        unsigned parent_slot;
+    };
+    step_t steps[SEARCH_BUCKETS];
+    unsigned count = 0;
+    steps[count++] = { first, -1, 0 };
+    steps[count++] = { second, -1, 0 };
+
+    auto read = [&](size_t b, unsigned i, ca_to_pa_key_t &key, ca_to_pa_entry_t &value) {
+        const bucket_t &src = table.buckets[b];
+        key = { src.slots[i].dest_vni, src.slots[i].dip };
+        src.get((int)i, value);
+    };
+    auto on_path = [&](unsigned step, size_t b) {
+        for (int s = (int)step; s >= 0; s = steps[s].parent) {
+            if (steps[s].bucket == b) {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    for (unsigned head = 0; head < count; head++) {
+        for (unsigned i = 0; i < BUCKET_SLOTS; i++) {
+            ca_to_pa_key_t key;
+            ca_to_pa_entry_t value;
+            read(steps[head].bucket, i, key, value);
+            size_t alt = table.other(steps[head].bucket, key_hash(key));
+            if (on_path(head, alt)) {
+                continue;
+            }
+
+            int free = free_slot(table.buckets[alt].used, BUCKET_SLOTS);
+            if (free < 0) {
+                if (count < SEARCH_BUCKETS) {
+                    steps[count++] = { alt, (int)head, i };
+                }
+                continue;
+            }
+
+            /* Found: shift every mapping on the path one step towards the free slot */
+            write_slot(table.buckets[alt], (unsigned)free, key, value);
+            clear_slot(table.buckets[steps[head].bucket], i);
+            int s = (int)head;
+            for (; steps[s].parent >= 0; s = steps[s].parent) {
+                const step_t &from = steps[steps[s].parent];
+                read(from.bucket, steps[s].parent_slot, key, value);
+                bucket_t &to = table.buckets[steps[s].bucket];
+                write_slot(to, (unsigned)free_slot(to.used, BUCKET_SLOTS), key, value);
+                clear_slot(table.buckets[from.bucket], steps[s].parent_slot);
+            }
+            bucket = steps[s].bucket;
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Rehashes into a table of at least `buckets` buckets, placed as m_placement asks, and publishes it */
+void sirius_ca_to_pa::grow(size_t buckets)
+{
+    table_t *old = m_table.load(std::memory_order_relaxed);
+    buckets = std::max(buckets, MIN_BUCKETS);
+
+    for (;;) {
+        std::unique_ptr<table_t> table(new table_t(buckets, m_placement));
+        bool placed = true;
+        for (size_t b = 0; b < old->count && placed; b++) {
+            const bucket_t &src = old->buckets[b];
+            for (unsigned i = 0; i < BUCKET_SLOTS && placed; i++) {
+                if (src.used & 1u << i) {
+                    ca_to_pa_entry_t value;
+                    src.get((int)i, value);
+                    placed = place(*table, { src.slots[i].dest_vni, src.slots[i].dip }, value);
+                }
+            }
+        }
+        if (placed) {
+            m_table.store(table.release(), std::memory_order_release);
+            m_reclaim.retire(old);
+            return;
+        }
+        buckets = grown(buckets);
+    }
+}
+
+} // namespace sirius
@@ -0,0 +1,288 @@
+#ifndef _SIRIUS_CA_TO_PA_H_
+#define _SIRIUS_CA_TO_PA_H_
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+extern "C" {
+#include <saitypes.h>
+#include <saistatus.h>
+}
+
+#include "sirius_counters.h"
+#include "sirius_memory.h"
+#include "sirius_rcu.h"
+#include "sirius_types.h"
+
+namespace sirius {
+
+struct ca_to_pa_key_t {
+    uint16_t dest_vni;
+    ipv4_addr_t dip;
+
+    bool operator==(const ca_to_pa_key_t &o) const
+    {
+        return dest_vni == o.dest_vni && dip == o.dip;
+    }
+};
+
+struct ca_to_pa_entry_t {
+    ipv4_addr_t underlay_dip;
+    mac_t overlay_dmac;
+    bool use_dst_vni;
+    uint32_t counter; /* ca_to_pa_counter slot, assigned by the table on insert */
+};
+
+/*
+ * outbound ca_to_pa table: dest_vni + dip exact.
+ *
+ * A bucketized cuckoo hash. Every mapping lives in one of two candidate
+ * buckets; a bucket is one cache line holding three mappings packed into
+ * 16 bytes each (key, underlay_dip and overlay_dmac, use_dst_vni in the
+ * bucket header). Lookups read the first bucket, and the second one only
+ * if the mapping is not in the first; inserts place the mapping in its
+ * first bucket when there is room, so most hits cost one cache miss.
+ *
+ * Writers are serialized by a mutex. Readers take no lock: each bucket
+ * has a sequence counter that writers make odd while they change it, and
+ * a reader retries when a counter it read moved. When a full bucket
+ * forces a cuckoo move, the mapping is written to its new bucket before
+ * it is cleared from the old one. Growing the table builds a new bucket
+ * array and publishes it through RCU.
+ *
+ * The bucket arrays are sirius_mappings of the placement set with
+ * set_placement(), which moves the current array there the same way.
+ *
+ * Every mapping gets a slot of ca_to_pa_counter when it is inserted,
+ * kept in 24 bits of the bucket header, which lookup() returns with the
+ * mapping for the data path to count the packet in.
+ */
+class sirius_ca_to_pa {
+public:
+    using key_type = ca_to_pa_key_t;
+    using value_type = ca_to_pa_entry_t;
+
+    class writer {
+    public:
+        explicit writer(sirius_ca_to_pa &table) : m_table(table) {}
+
+        sai_status_t insert(const ca_to_pa_key_t &key, const ca_to_pa_entry_t &value)
+        {
+            return m_table.do_insert(key, value);
+        }
+
+        sai_status_t remove(const ca_to_pa_key_t &key) { return m_table.do_remove(key); }
+
+        void reserve(size_t count) { m_table.do_reserve(m_table.m_count + count); }
+
+    private:
+        sirius_ca_to_pa &m_table;
+    };
+
+    sirius_ca_to_pa();
+    ~sirius_ca_to_pa();
+
+    sirius_ca_to_pa(const sirius_ca_to_pa &) = delete;
+    sirius_ca_to_pa &operator=(const sirius_ca_to_pa &) = delete;
+
+    sai_status_t insert(const ca_to_pa_key_t &key, const ca_to_pa_entry_t &value)
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        sai_status_t status = do_insert(key, value);
+        m_reclaim.reclaim();
+        return status;
+    }
+
+    sai_status_t remove(const ca_to_pa_key_t &key)
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        return do_remove(key);
+    }
+
+    template <typename Fn>
+    void batch(Fn &&fn)
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        writer w(*this);
+        fn(w);
+        m_reclaim.reclaim();
+    }
+
+    /* Lock-free, for the data path and the control plane alike */
+    bool lookup(const ca_to_pa_key_t &key, ca_to_pa_entry_t &value) const
+    {
+        rcu_read_guard guard;
+        const table_t *table = m_table.load(std::memory_order_acquire);
+        uint64_t hash = key_hash(key);
+        const bucket_t &first = table->buckets[table->first(hash)];
+        const bucket_t &second = table->buckets[table->second(hash)];
+
+        for (;;) {
+            uint32_t first_seq = first.seq.load(std::memory_order_acquire);
+            if (first_seq & 1) {
+                continue;
+            }
+            int slot = first.find(key);
+            if (slot >= 0) {
+                first.get(slot, value);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (first.seq.load(std::memory_order_relaxed) != first_seq) {
+                continue;
+            }
+            if (slot >= 0) {
+                return true;
+            }
+
+            uint32_t second_seq = second.seq.load(std::memory_order_acquire);
+            if (second_seq & 1) {
+                continue;
+            }
+            slot = second.find(key);
+            if (slot >= 0) {
+                second.get(slot, value);
+            }
+            /* Both counters: a move from second to first in between must not look like a miss */
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (second.seq.load(std::memory_order_relaxed) != second_seq ||
+                first.seq.load(std::memory_order_relaxed) != first_seq) {
+                continue;
+            }
+            return slot >= 0;
+        }
+    }
+
+    size_t size() const
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        return m_count;
+    }
+
+    /* Mappings the counters have slots for, the 24 bits a bucket keeps per mapping */
+    static constexpr size_t COUNTER_SLOTS = 1u << 24;
+
+    /* ca_to_pa_counter, for the pipelines to attach their blocks to */
+    sirius_counters &counters() { return m_counters; }
+
+    /*
+     * Runs fn() while no mapping is inserted or removed, for reads that
+     * have to agree with other tables. fn reads with the *_held calls.
+     */
+    template <typename Fn>
+    void hold(Fn &&fn) const
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        fn();
+    }
+
+    /* Within hold(): the number of mappings */
+    size_t size_held() const;
+
+    /* Within hold(): the counter slots of all mappings and their counts */
+    void snapshot_held(std::vector<uint32_t> &slots, std::vector<counter_t> &counts) const;
+
+    /* Bytes of the bucket array */
+    size_t memory() const;
+
+    /* Moves the bucket array, and the arrays it grows into, to memory placed as placement asks */
+    void set_placement(const memory_placement_t &placement);
+
+    /* Where the bucket array went */
+    memory_placement_t placement() const;
+
+    /* Mappings over slots */
+    double load_factor() const;
+
+private:
+    static constexpr unsigned BUCKET_SLOTS = 3;
+
+    /* 16 bytes of a mapping; use_dst_vni is kept in the bucket header */
+    struct slot_t {
+        ipv4_addr_t dip;
+        uint16_t dest_vni;
+        uint16_t dmac_hi;
+        uint32_t dmac_lo;
+        ipv4_addr_t underlay_dip;
+    };
+
+    struct alignas(64) bucket_t {
+        std::atomic<uint32_t> seq;
+        uint8_t used;        /* bit i: slot i holds a mapping */
+        uint8_t use_dst_vni; /* bit i: use_dst_vni of slot i */
+        uint8_t counter[BUCKET_SLOTS][3]; /* ca_to_pa_counter slot of each mapping, little endian */
+        uint8_t reserved[1];
+        slot_t slots[BUCKET_SLOTS];
+
+        int find(const ca_to_pa_key_t &key) const
+        {
+            for (unsigned i = 0; i < BUCKET_SLOTS; i++) {
+                if ((used & 1u << i) && slots[i].dip == key.dip && slots[i].dest_vni == key.dest_vni) {
+                    return (int)i;
+                }
+            }
+            return -1;
+        }
+
+        void get(int i, ca_to_pa_entry_t &value) const
+        {
+            value.underlay_dip = slots[i].underlay_dip;
+            value.overlay_dmac = (mac_t)slots[i].dmac_hi << 32 | slots[i].dmac_lo;
+            value.use_dst_vni = use_dst_vni & 1u << i;
+            value.counter = (uint32_t)counter[i][0] | (uint32_t)counter[i][1] << 8 | (uint32_t)counter[i][2] << 16;
+        }
+    };
+
+    static_assert(sizeof(bucket_t) == 64, "a bucket is one cache line");
+
+    struct table_t {
+        size_t count;
+        sirius_mapping memory;
+        bucket_t *buckets; /* in memory, zero pages are empty buckets */
+
+        table_t(size_t buckets, const memory_placement_t &placement)
+            : count(buckets), memory(buckets * sizeof(bucket_t), placement),
+              buckets(static_cast<bucket_t *>(memory.data()))
+        {
+        }
+
+        /* Maps a 32 bit hash onto [0, count) without a division */
+        size_t range(uint32_t h) const { return (size_t)((uint64_t)h * count >> 32); }
+        size_t first(uint64_t hash) const { return range((uint32_t)hash); }
+
+        size_t second(uint64_t hash) const
+        {
+            size_t b = range((uint32_t)(hash >> 32));
+            return b != first(hash) ? b : (b + 1) % count;
+        }
+
+        size_t other(size_t bucket, uint64_t hash) const
+        {
+            return bucket == first(hash) ? second(hash) : first(hash);
+        }
+    };
+
+    static uint64_t key_hash(const ca_to_pa_key_t &key) { return hash_mix((uint64_t)key.dest_vni << 32 | key.dip); }
+
+    sai_status_t do_insert(const ca_to_pa_key_t &key, const ca_to_pa_entry_t &value);
+    sai_status_t do_remove(const ca_to_pa_key_t &key);
+    void do_reserve(size_t count);
+
+    bool place(table_t &table, const ca_to_pa_key_t &key, const ca_to_pa_entry_t &value);
+    bool cuckoo(table_t &table, size_t first, size_t second, size_t &bucket);
+    void grow(size_t buckets);
+
+    static void write_slot(bucket_t &bucket, unsigned i, const ca_to_pa_key_t &key, const ca_to_pa_entry_t &value);
+    static void clear_slot(bucket_t &bucket, unsigned i);
+
+    mutable std::mutex m_lock;
+    memory_placement_t m_placement;
+    size_t m_count = 0;
+    std::atomic<table_t *> m_table;
+    rcu_reclaimer m_reclaim;
+    sirius_counters m_counters{ COUNTER_SLOTS };
+};
+
+} // namespace sirius
+
+#endif /* _SIRIUS_CA_TO_PA_H_ */
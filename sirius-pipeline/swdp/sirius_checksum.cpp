@@ -0,0 +1,117 @@
+#include "sirius_checksum.h"
+
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace sirius {
+
+namespace {
+
+uint64_t checksum_add_scalar(const uint8_t *p, size_t len, uint64_t sum)
+{
+    for (; len >= 4; p += 4, len -= 4) {
+        uint32_t v;
+        memcpy(&v, p, sizeof(v));
+        sum += v;
+    }
+    if (len >= 2) {
+        uint16_t v;
+        memcpy(&v, p, sizeof(v));
+        sum += v;
+        p += 2;
+        len -= 2;
+    }
+    if (len) {
+        /* The last byte, padded with a zero byte after it */
+        uint16_t v = 0;
+        memcpy(&v, p, 1);
+        sum += v;
+    }
+    return sum;
+}
+
+#if defined(__x86_64__)
+/* 32 bytes a step, their 32 bit words widened into four 64 bit sums */
+__attribute__((target("avx2"))) uint64_t checksum_add_avx2(const uint8_t *p, size_t len, uint64_t sum)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i acc = zero;
+    for (; len >= 32; p += 32, len -= 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+        acc = _mm256_add_epi64(acc, _mm256_unpacklo_epi32(v, zero));
+        acc = _mm256_add_epi64(acc, _mm256_unpackhi_epi32(v, zero));
+    }
+    alignas(32) uint64_t lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i *>(lanes), acc);
+    sum += lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    return checksum_add_scalar(p, len, sum);
+}
+
+/* Also runs from a static initializer */
+bool has_avx2()
+{
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+}
+
+const bool avx2 = has_avx2();
+#endif
+
+} // namespace
+
+uint64_t checksum_add(const void *data, size_t len, uint64_t sum)
+{
+    const uint8_t *p = static_cast<const uint8_t *>(data);
+#if defined(__x86_64__)
+    if (avx2 && len >= CHECKSUM_AVX2_MIN_BYTES) {
+        return checksum_add_avx2(p, len, sum);
+    }
+#endif
+    return checksum_add_scalar(p, len, sum);
+}
+
+bool checksum_avx2()
+{
+#if defined(__x86_64__)
+    return avx2;
+#else
+    return false;
+#endif
+}
+
+bool l4_checksum_ok(const ipv4_t *ip, const uint8_t *end)
+{
+    if ((ip->protocol != TCP_PROTO && ip->protocol != UDP_PROTO) || (ntohs(ip->flags_frag_offset) & 0x3fff)) {
+        return true;
+    }
+    const uint8_t *l3 = reinterpret_cast<const uint8_t *>(ip);
+    const uint8_t *l4 = l3 + ip->ihl() * 4;
+    size_t total = ntohs(ip->total_len);
+    if (l3 + total > end || l4 > l3 + total) {
+        return false;
+    }
+
+    size_t len = (size_t)(l3 + total - l4);
+    if (ip->protocol == TCP_PROTO) {
+        if (len < TCP_HDR_SIZE) {
+            return false;
+        }
+    } else {
+        if (len < UDP_HDR_SIZE) {
+            return false;
+        }
+        if (reinterpret_cast<const udp_t *>(l4)->checksum == 0) {
+            /* Sent without one */
+            return true;
+        }
+    }
+
+    /* Pseudo header: addresses, protocol and segment length */
+    uint64_t sum = (uint64_t)ip->src_addr + ip->dst_addr + htons(ip->protocol) + htons((uint16_t)len);
+    return checksum_fold(checksum_add(l4, len, sum)) == 0xffff;
+}
+
+} // namespace sirius
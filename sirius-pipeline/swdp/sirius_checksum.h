@@ -0,0 +1,77 @@
+#ifndef _SIRIUS_CHECKSUM_H_
+#define _SIRIUS_CHECKSUM_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "sirius_headers.h"
+
+namespace sirius {
+
+/*
+ * Internet checksum (RFC 1071) of the IPv4, TCP and UDP headers.
+ *
+ * A ones' complement sum comes out the same in either byte order (RFC
+ * 1071 2.B), so sums are of the words as they sit in memory: a checksum
+ * goes into its header as it is, and fields in network byte order add in
+ * without a swap. Sums are kept unfolded in 64 bits and folded to 16 at
+ * the end.
+ */
+
+/*
+ * Adds len bytes to sum. A message may be summed in pieces; every piece
+ * but the last has to be of even length. Pieces of CHECKSUM_AVX2_MIN_BYTES
+ * or more take an AVX2 kernel where the CPU has it. Shorter ones, such as
+ * the 20 byte IPv4 header or the TCP header of a segment without options
+ * or payload, take the scalar loop, which is faster at their length.
+ */
+uint64_t checksum_add(const void *data, size_t len, uint64_t sum = 0);
+
+/* Below this the kernel's setup and final sum of its lanes cost more than it saves */
+constexpr size_t CHECKSUM_AVX2_MIN_BYTES = 32;
+
+/* Whether checksum_add() has the AVX2 kernel on this CPU */
+bool checksum_avx2();
+
+/* The 16 bit ones' complement sum */
+inline uint16_t checksum_fold(uint64_t sum)
+{
+    sum = (sum & 0xffffffff) + (sum >> 32);
+    sum = (sum & 0xffff) + (sum >> 16);
+    sum = (sum & 0xffff) + (sum >> 16);
+    return (uint16_t)((sum & 0xffff) + (sum >> 16));
+}
+
+/* The checksum of len bytes; 0 over a message that carries a correct one */
+inline uint16_t checksum(const void *data, size_t len)
+{
+    return (uint16_t)~checksum_fold(checksum_add(data, len));
+}
+
+/*
+ * Incremental update (RFC 1624 eqn. 3) of the checksum of a message in
+ * which fields that were 0 now sum to `added`: what a header built from
+ * a template with those fields zeroed needs, without reading the rest.
+ */
+inline uint16_t checksum_adjust(uint16_t csum, uint64_t added)
+{
+    return (uint16_t)~checksum_fold((uint16_t)~csum + added);
+}
+
+/* Whether the IPv4 header carries a correct header checksum */
+inline bool ipv4_checksum_ok(const ipv4_t *ip)
+{
+    return checksum(ip, ip->ihl() * 4u) == 0;
+}
+
+/*
+ * Whether the TCP or UDP segment of ip, within [ip, end), carries a
+ * correct checksum over it and its pseudo header. True for UDP without a
+ * checksum, for other protocols and for fragments, which have no segment
+ * to check; false for a segment cut short.
+ */
+bool l4_checksum_ok(const ipv4_t *ip, const uint8_t *end);
+
+} // namespace sirius
+
+#endif /* _SIRIUS_CHECKSUM_H_ */
@@ -0,0 +1,454 @@
+#include "sirius_conntrack.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace sirius {
+
+namespace {
+
+/* The largest window scale option (RFC 7323) */
+constexpr int TCP_MAX_SHIFT = 14;
+
+constexpr uint8_t TCP_OPTION_END = 0;
+constexpr uint8_t TCP_OPTION_NOP = 1;
+constexpr uint8_t TCP_OPTION_WINDOW_SCALE = 3;
+
+constexpr uint8_t CONNTRACK_ALLOW = CONNTRACK_ALLOW_OUT | CONNTRACK_ALLOW_IN;
+constexpr uint8_t CONNTRACK_FINS = CONNTRACK_FIN_OUT | CONNTRACK_FIN_IN;
+constexpr uint8_t CONNTRACK_ACKS = CONNTRACK_ACKED_OUT | CONNTRACK_ACKED_IN;
+
+bool tracked(const headers_t &hdr)
+{
+    return hdr.ipv4 && (hdr.tcp || hdr.udp);
+}
+
+flow_key_t make_key(const headers_t &hdr, uint16_t eni)
+{
+    return conntrack_flow_key(ntohl(hdr.ipv4->src_addr), ntohl(hdr.ipv4->dst_addr),
+                              ntohs(hdr.tcp ? hdr.tcp->src_port : hdr.udp->src_port),
+                              ntohs(hdr.tcp ? hdr.tcp->dst_port : hdr.udp->dst_port), hdr.ipv4->protocol, eni);
+}
+
+/* Graph applied before the ACL of a direction, the other one runs after it */
+uint8_t own_graph(direction_t direction)
+{
+    return direction == DIRECTION_OUTBOUND ? CONNTRACK_ALLOW_OUT : CONNTRACK_ALLOW_IN;
+}
+
+uint8_t other_graph(direction_t direction)
+{
+    return own_graph(direction) ^ CONNTRACK_ALLOW;
+}
+
+direction_t reverse(direction_t direction)
+{
+    return direction == DIRECTION_OUTBOUND ? DIRECTION_INBOUND : DIRECTION_OUTBOUND;
+}
+
+/* The FIN and ACKED bits of a direction sit above its graph bit */
+uint8_t fin_bit(direction_t direction)
+{
+    return (uint8_t)(own_graph(direction) << 2);
+}
+
+uint8_t acked_bit(direction_t direction)
+{
+    return (uint8_t)(own_graph(direction) << 4);
+}
+
+/*
+ * Whether ack acknowledges the SYN or FIN of a direction: nothing follows
+ * either, it is their end. False when the end is unknown.
+ */
+bool acks(const conntrack_seq_cache &seqs, const flow_key_t &key, direction_t direction, uint32_t ack)
+{
+    uint32_t end;
+    return seqs.get(key, direction, end) && ack == end;
+}
+
+/* Sequence space the segment takes: its data, and one each for SYN and FIN */
+uint32_t segment_length(const headers_t &hdr)
+{
+    uint32_t headers = hdr.ipv4->ihl() * 4u + (hdr.tcp->data_offset_res >> 4) * 4u;
+    uint32_t total = ntohs(hdr.ipv4->total_len);
+    uint8_t flags = hdr.tcp->flags();
+    return (total > headers ? total - headers : 0) + !!(flags & TCP_FLAG_SYN) + !!(flags & TCP_FLAG_FIN);
+}
+
+/* The window scale option of a SYN, -1 for none; end is the end of the packet */
+int window_shift(const tcp_t *tcp, const uint8_t *end)
+{
+    const uint8_t *opt = reinterpret_cast<const uint8_t *>(tcp) + TCP_HDR_SIZE;
+    const uint8_t *opts_end = reinterpret_cast<const uint8_t *>(tcp) + (tcp->data_offset_res >> 4) * 4u;
+    opts_end = std::min(opts_end, end);
+    while (opt < opts_end && *opt != TCP_OPTION_END) {
+        if (*opt == TCP_OPTION_NOP) {
+            opt++;
+            continue;
+        }
+        if (opts_end - opt < 2 || opt[1] < 2 || opts_end - opt < opt[1]) {
+            return -1;
+        }
+        if (*opt == TCP_OPTION_WINDOW_SCALE && opt[1] == 3) {
+            return std::min<int>(opt[2], TCP_MAX_SHIFT);
+        }
+        opt += opt[1];
+    }
+    return -1;
+}
+
+/* The TCP state machine on the state of the connection before the packet, returns the state after it */
+uint8_t tcp_update(conntrack_seq_cache &seqs, const headers_t &hdr, const uint8_t *end, const metadata_t &meta,
+                   const flow_key_t &key, uint8_t state)
+{
+    direction_t direction = meta.direction;
+    direction_t back = reverse(direction);
+    uint8_t flags = hdr.tcp->flags();
+    uint32_t seq = ntohl(hdr.tcp->seq_no);
+    uint32_t ack = ntohl(hdr.tcp->ack_no);
+
+    /* A packet the pipeline drops reaches neither end, nothing of the connection changes */
+    if (meta.dropped) {
+        return state;
+    }
+
+    if (flags & TCP_FLAG_RST) {
+        bool valid;
+        if ((state & CONNTRACK_SYN_SENT) && (state & own_graph(direction))) {
+            /* The reply to a SYN: it has to acknowledge the SYN */
+            valid = (flags & TCP_FLAG_ACK) && acks(seqs, key, back, ack);
+        } else {
+            /* Within the receiver's window */
+            valid = seqs.in_window(key, direction, seq);
+        }
+        return valid ? 0 : state;
+    }
+
+    if ((flags & (TCP_FLAG_SYN | TCP_FLAG_ACK)) == TCP_FLAG_SYN) {
+        /* A new connection, possibly on the 5-tuple of one that is closing; an established one only opens its graph */
+        if (!state || (state & (CONNTRACK_SYN_SENT | CONNTRACK_FINS))) {
+            /* Nothing of an earlier connection on the 5-tuple counts */
+            seqs.erase(key);
+            seqs.set(key, direction, seq + segment_length(hdr));
+            seqs.handshake(key, direction, ntohs(hdr.tcp->window), window_shift(hdr.tcp, end));
+            state = (uint8_t)((state & CONNTRACK_ALLOW) | CONNTRACK_SYN_SENT);
+        }
+        return (uint8_t)(state | other_graph(meta.direction));
+    }
+
+    if (flags & TCP_FLAG_SYN) {
+        /* SYN-ACK of the side the SYN allowed */
+        if ((state & CONNTRACK_SYN_SENT) && (state & own_graph(direction)) && (flags & TCP_FLAG_ACK) &&
+            acks(seqs, key, back, ack)) {
+            state &= (uint8_t)~CONNTRACK_SYN_SENT;
+            /* Both directions' numbers stay, for the RSTs of the established connection */
+            seqs.set(key, direction, seq + segment_length(hdr));
+            seqs.handshake(key, direction, ntohs(hdr.tcp->window), window_shift(hdr.tcp, end));
+            seqs.keep(key);
+        }
+        return state;
+    }
+
+    /* Nothing of the direction follows its FIN */
+    if (!(state & fin_bit(direction))) {
+        seqs.advance(key, direction, seq + segment_length(hdr), ntohs(hdr.tcp->window));
+    }
+
+    /* The ACK of the other side's FIN, then the packet's own FIN */
+    if ((flags & TCP_FLAG_ACK) && (state & fin_bit(back)) && !(state & acked_bit(back)) &&
+        acks(seqs, key, back, ack)) {
+        state |= acked_bit(back);
+    }
+    if ((flags & TCP_FLAG_FIN) && !(state & fin_bit(direction))) {
+        seqs.set(key, direction, seq + segment_length(hdr));
+        state = (uint8_t)((state | fin_bit(direction)) & ~CONNTRACK_SYN_SENT);
+    }
+
+    /* CLOSED: both FINs acknowledged */
+    if ((state & CONNTRACK_FINS) == CONNTRACK_FINS && (state & CONNTRACK_ACKS) == CONNTRACK_ACKS) {
+        return 0;
+    }
+    return state;
+}
+
+void set_allow(metadata_t &meta, uint8_t graph)
+{
+    if (graph == CONNTRACK_ALLOW_OUT) {
+        meta.conntrack_data.allow_out = true;
+    } else {
+        meta.conntrack_data.allow_in = true;
+    }
+}
+
+void create(sirius_flow_table &flows, sirius_flow_sync *sync, sirius_flow_aging *aging, const flow_key_t &key,
+            uint8_t state)
+{
+    flow_key_t evicted;
+    bool evicts = flows.insert(key, state, &evicted);
+    if (sync) {
+        /* First, so the peer has the slot free for the insert */
+        if (evicts) {
+            sync->removed(evicted);
+        }
+        sync->inserted(key, state);
+    }
+    if (aging) {
+        aging->inserted(key);
+    }
+}
+
+} // namespace
+
+flow_key_t conntrack_flow_key(ipv4_addr_t sip, ipv4_addr_t dip, uint16_t sport, uint16_t dport, uint8_t protocol,
+                              uint16_t eni)
+{
+    flow_key_t key;
+    key.sip = sip;
+    key.dip = dip;
+    key.sport = sport;
+    key.dport = dport;
+    key.eni = eni;
+    key.protocol = protocol;
+    if (key.sip > key.dip || (key.sip == key.dip && key.sport > key.dport)) {
+        std::swap(key.sip, key.dip);
+        std::swap(key.sport, key.dport);
+    }
+    return key;
+}
+
+void conntrack_lookup(const sirius_flow_table &flows, const headers_t &hdr, metadata_t &meta, conntrack_flow_t &flow)
+{
+    flow.state = 0;
+    flow.tracked = tracked(hdr);
+    if (!flow.tracked) {
+        return;
+    }
+
+    flow.key = make_key(hdr, meta.eni);
+    if (flows.lookup(flow.key, flow.state) && (flow.state & own_graph(meta.direction))) {
+        set_allow(meta, own_graph(meta.direction));
+    }
+}
+
+void conntrack_update(sirius_flow_table &flows, sirius_flow_sync *sync, sirius_flow_aging *aging,
+                      conntrack_seq_cache &seqs, const headers_t &hdr, const uint8_t *end, metadata_t &meta,
+                      conntrack_flow_t &flow)
+{
+    if (!flow.tracked) {
+        return;
+    }
+
+    uint8_t other = other_graph(meta.direction);
+    uint8_t before = flow.state;
+    uint8_t state = before;
+
+    if (state & other) {
+        set_allow(meta, other);
+    }
+
+    if (!hdr.tcp) {
+        /* UDP: a packet that passed the ACL rather than conntrack */
+        if (!meta.dropped && !(state & own_graph(meta.direction))) {
+            state |= other;
+        }
+    } else {
+        state = tcp_update(seqs, hdr, end, meta, flow.key, state);
+    }
+
+    /* No graph in ALLOW, no entry */
+    if (!(state & CONNTRACK_ALLOW)) {
+        state = 0;
+    }
+    flow.state = state;
+    if (state == before) {
+        return;
+    }
+    if (!state) {
+        flows.remove(flow.key);
+        if (hdr.tcp) {
+            seqs.erase(flow.key);
+        }
+        if (sync) {
+            sync->removed(flow.key);
+        }
+        if (aging) {
+            aging->removed();
+        }
+    } else if (!before) {
+        create(flows, sync, aging, flow.key, state);
+    } else {
+        flows.update(flow.key, state);
+        /* The peer only gets the graphs (sirius_flow_sync::STATE_MASK) */
+        if (sync && (state ^ before) & CONNTRACK_ALLOW) {
+            sync->updated(flow.key, state);
+        }
+    }
+}
+
+bool conntrack_allows(const sirius_flow_table &flows, const headers_t &hdr, direction_t direction, uint16_t eni)
+{
+    uint8_t state;
+    return tracked(hdr) && flows.lookup(make_key(hdr, eni), state) && (state & own_graph(direction));
+}
+
+bool conntrack_key(const headers_t &hdr, uint16_t eni, flow_key_t &key)
+{
+    if (!tracked(hdr)) {
+        return false;
+    }
+    key = make_key(hdr, eni);
+    return true;
+}
+
+bool conntrack_segment(const headers_t &hdr, uint16_t eni, direction_t direction, conntrack_segment_t &segment)
+{
+    if (!hdr.ipv4 || !hdr.tcp) {
+        return false;
+    }
+    segment.key = make_key(hdr, eni);
+    segment.direction = direction;
+    segment.end = ntohl(hdr.tcp->seq_no) + segment_length(hdr);
+    segment.window = ntohs(hdr.tcp->window);
+    return true;
+}
+
+void conntrack_refresh(sirius_flow_table &flows, sirius_flow_sync *sync, sirius_flow_aging *aging,
+                       const flow_key_t &key, direction_t direction)
+{
+    uint8_t state;
+    if (!flows.lookup(key, state) && key.protocol == UDP_PROTO) {
+        create(flows, sync, aging, key, other_graph(direction));
+    }
+}
+
+conntrack_seq_cache::conntrack_seq_cache(size_t capacity) : m_sets(std::max<size_t>(capacity / 2, 1)) {}
+
+conntrack_seq_cache::set_t &conntrack_seq_cache::set_of(const flow_key_t &key)
+{
+    return m_sets[flow_key_hash(key) % m_sets.size()];
+}
+
+const conntrack_seq_cache::set_t &conntrack_seq_cache::set_of(const flow_key_t &key) const
+{
+    return m_sets[flow_key_hash(key) % m_sets.size()];
+}
+
+conntrack_seq_cache::entry_t *conntrack_seq_cache::find(const flow_key_t &key, direction_t direction)
+{
+    unsigned i = direction == DIRECTION_INBOUND;
+    for (entry_t &e : set_of(key).ways) {
+        if ((e.valid & 1u << i) && e.key == key) {
+            return &e;
+        }
+    }
+    return nullptr;
+}
+
+const conntrack_seq_cache::entry_t *conntrack_seq_cache::find(const flow_key_t &key, direction_t direction) const
+{
+    unsigned i = direction == DIRECTION_INBOUND;
+    for (const entry_t &e : set_of(key).ways) {
+        if ((e.valid & 1u << i) && e.key == key) {
+            return &e;
+        }
+    }
+    return nullptr;
+}
+
+bool conntrack_seq_cache::get(const flow_key_t &key, direction_t direction, uint32_t &end) const
+{
+    const entry_t *e = find(key, direction);
+    if (!e) {
+        return false;
+    }
+    end = e->end[direction == DIRECTION_INBOUND];
+    return true;
+}
+
+void conntrack_seq_cache::set(const flow_key_t &key, direction_t direction, uint32_t end)
+{
+    unsigned i = direction == DIRECTION_INBOUND;
+    set_t &set = set_of(key);
+    entry_t *entry = nullptr;
+    for (entry_t &e : set.ways) {
+        if (e.valid && e.key == key) {
+            entry = &e;
+            break;
+        }
+    }
+    if (!entry) {
+        /* An empty way, else a kept one, else the one the key's hash picks */
+        entry = !set.ways[0].valid ? &set.ways[0]
+              : !set.ways[1].valid ? &set.ways[1]
+              : set.ways[0].kept   ? &set.ways[0]
+              : set.ways[1].kept   ? &set.ways[1]
+                                   : &set.ways[flow_key_hash(key) >> 63];
+        entry->key = key;
+        entry->valid = 0;
+        entry->window[0] = entry->window[1] = 0;
+        entry->shift[0] = entry->shift[1] = NO_SHIFT;
+        entry->syn_window = 0;
+    }
+    entry->end[i] = end;
+    entry->valid |= (uint8_t)(1u << i);
+    entry->kept = false;
+}
+
+void conntrack_seq_cache::handshake(const flow_key_t &key, direction_t direction, uint16_t window, int shift)
+{
+    entry_t *e = find(key, direction);
+    if (e) {
+        unsigned i = direction == DIRECTION_INBOUND;
+        e->window[i] = window;
+        e->shift[i] = shift < 0 ? NO_SHIFT : (uint8_t)shift;
+        e->syn_window |= 1u << i;
+    }
+}
+
+void conntrack_seq_cache::advance(const flow_key_t &key, direction_t direction, uint32_t end, uint16_t window)
+{
+    entry_t *e = find(key, direction);
+    if (!e) {
+        return;
+    }
+    /* The sender can be at most the receiver's window ahead of what it acknowledged, which is behind the end */
+    unsigned i = direction == DIRECTION_INBOUND;
+    uint32_t ahead = end - e->end[i];
+    if (ahead && ahead <= e->scaled(i ^ 1)) {
+        e->end[i] = end;
+    }
+    e->window[i] = window;
+    e->syn_window &= ~(1u << i);
+}
+
+bool conntrack_seq_cache::in_window(const flow_key_t &key, direction_t direction, uint32_t seq) const
+{
+    const entry_t *e = find(key, direction);
+    if (!e) {
+        return false;
+    }
+    unsigned i = direction == DIRECTION_INBOUND;
+    uint32_t window = e->scaled(i ^ 1);
+    return seq == e->end[i] || seq - (e->end[i] - window) < 2 * (uint64_t)window;
+}
+
+void conntrack_seq_cache::keep(const flow_key_t &key)
+{
+    for (entry_t &e : set_of(key).ways) {
+        if (e.valid && e.key == key) {
+            e.kept = true;
+        }
+    }
+}
+
+void conntrack_seq_cache::erase(const flow_key_t &key)
+{
+    for (entry_t &e : set_of(key).ways) {
+        if (e.valid && e.key == key) {
+            e.valid = 0;
+        }
+    }
+}
+
+} // namespace sirius
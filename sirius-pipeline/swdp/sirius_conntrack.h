@@ -0,0 +1,252 @@
+#ifndef _SIRIUS_CONNTRACK_H_
+#define _SIRIUS_CONNTRACK_H_
+
+#include <vector>
+
+#include "sirius_flow_aging.h"
+#include "sirius_flow_sync.h"
+#include "sirius_flow_table.h"
+#include "sirius_headers.h"
+#include "sirius_metadata.h"
+
+namespace sirius {
+
+/*
+ * State of a connection in sirius_flow_table: one bit per state graph of
+ * sirius_conntrack.p4, set in ALLOW and clear in START. A connection
+ * whose graphs are both in START has no entry.
+ *
+ * TCP connections also keep how far their close got, per direction: the
+ * side of that direction sent its FIN, and the other side acknowledged
+ * it. Only the graph bits go to the HA peer (sirius_flow_sync).
+ */
+enum conntrack_state_t : uint8_t {
+    CONNTRACK_ALLOW_OUT = 1 << 0, /* ConnGraphOut */
+    CONNTRACK_ALLOW_IN = 1 << 1,  /* ConnGraphIn */
+    CONNTRACK_FIN_OUT = 1 << 2,   /* TCP: the outbound side sent its FIN */
+    CONNTRACK_FIN_IN = 1 << 3,
+    CONNTRACK_ACKED_OUT = 1 << 4, /* TCP: the FIN of the outbound side was acknowledged */
+    CONNTRACK_ACKED_IN = 1 << 5,
+    CONNTRACK_SYN_SENT = 1 << 6, /* TCP: a SYN opened the connection, no SYN-ACK acknowledged it yet */
+};
+
+/* The TCP states conntrack tells apart; a CLOSED connection has no entry */
+enum conntrack_tcp_state_t : uint8_t {
+    CONNTRACK_TCP_SYN_SENT,
+    CONNTRACK_TCP_ESTABLISHED,
+    CONNTRACK_TCP_FIN_WAIT,  /* one side sent its FIN */
+    CONNTRACK_TCP_TIME_WAIT, /* both did, waiting for the ACK of the last one */
+};
+
+inline conntrack_tcp_state_t conntrack_tcp_state(uint8_t state)
+{
+    if (state & CONNTRACK_SYN_SENT) {
+        return CONNTRACK_TCP_SYN_SENT;
+    }
+    switch (state & (CONNTRACK_FIN_OUT | CONNTRACK_FIN_IN)) {
+    case 0:
+        return CONNTRACK_TCP_ESTABLISHED;
+    case CONNTRACK_FIN_OUT | CONNTRACK_FIN_IN:
+        return CONNTRACK_TCP_TIME_WAIT;
+    default:
+        return CONNTRACK_TCP_FIN_WAIT;
+    }
+}
+
+/* A packet's connection, carried from conntrack_lookup() to conntrack_update() */
+struct conntrack_flow_t {
+    bool tracked; /* IPv4 TCP and UDP, the packets the graphs act on */
+    flow_key_t key;
+    uint8_t state; /* as conntrack_update() left it */
+};
+
+/*
+ * The sequence numbers conntrack checks the handshake, close and RSTs of
+ * TCP connections against: for each direction, where its sequence space
+ * ends so far, and the window it advertised last. The end is that of the
+ * direction's SYN, then of its latest data, then of its FIN, which the
+ * other side's ACK has to acknowledge; a RST has to fall within the
+ * receiver's window of it. Connections between a SYN and its SYN-ACK, or
+ * between a FIN and the last ACK, need them most, a small share of the
+ * table at any time, so they live next to it in one pipeline's cache
+ * instead of in every connection's slot. An established connection's
+ * numbers are kept for its RSTs, in ways the others replace first, and
+ * move along with its segments, on the flow cache fast path too.
+ *
+ * Two way sets indexed by the key's hash; a new connection replaces one
+ * of the set's when both are taken. conntrack fails closed on a
+ * connection whose numbers were replaced: its ACKs and RSTs change
+ * nothing, and the aging ends it.
+ */
+class conntrack_seq_cache {
+public:
+    /* Connections the cache is sized for */
+    static constexpr size_t DEFAULT_CAPACITY = 65536;
+
+    explicit conntrack_seq_cache(size_t capacity = DEFAULT_CAPACITY);
+
+    /* Where the sequence space of `direction` ends, false if it was not kept */
+    bool get(const flow_key_t &key, direction_t direction, uint32_t &end) const;
+
+    /* Starts the direction over at the end of its SYN or FIN */
+    void set(const flow_key_t &key, direction_t direction, uint32_t end);
+
+    /*
+     * The window a SYN or SYN-ACK of `direction` advertised, and its
+     * window scale option, -1 for none. Windows are scaled once both
+     * directions offered one (RFC 7323), but not this one: the window of
+     * a SYN never is, it stays in bytes until advance() replaces it.
+     */
+    void handshake(const flow_key_t &key, direction_t direction, uint16_t window, int shift);
+
+    /*
+     * A segment of `direction` ending at end that advertised window:
+     * moves the direction's end forward, as far as the other side's
+     * window allows, and takes its window. Nothing for a connection
+     * whose numbers were not kept.
+     */
+    void advance(const flow_key_t &key, direction_t direction, uint32_t end, uint16_t window);
+
+    /*
+     * Whether seq is within the other side's window of the end of
+     * `direction`, either way: the receiver's next expected number lies
+     * there. Exactly the end while the window is unknown, false when the
+     * end is.
+     */
+    bool in_window(const flow_key_t &key, direction_t direction, uint32_t seq) const;
+
+    /* Keeps the connection's numbers for its RSTs only, the first a new connection of the set replaces */
+    void keep(const flow_key_t &key);
+
+    /* Forgets both directions of the connection */
+    void erase(const flow_key_t &key);
+
+    void prefetch(const flow_key_t &key) const { __builtin_prefetch(&set_of(key), 1); }
+
+private:
+    static constexpr uint8_t NO_SHIFT = 0xff;
+
+    struct entry_t {
+        flow_key_t key;
+        uint32_t end[2];    /* outbound, inbound */
+        uint16_t window[2]; /* unscaled, 0 until known */
+        uint8_t shift[2];   /* window scale option of the SYN, NO_SHIFT for none */
+        uint8_t valid;          /* bit i: end[i] is kept */
+        uint8_t kept : 1;       /* established, see keep() */
+        uint8_t syn_window : 2; /* bit i: window[i] is of a SYN, never scaled */
+
+        /* The window direction i advertised, in bytes */
+        uint32_t scaled(unsigned i) const
+        {
+            return shift[0] != NO_SHIFT && shift[1] != NO_SHIFT && !(syn_window & 1u << i)
+                       ? (uint32_t)window[i] << shift[i]
+                       : window[i];
+        }
+    };
+
+    struct alignas(64) set_t {
+        entry_t ways[2];
+    };
+    static_assert(sizeof(set_t) == 64, "a set is one cache line");
+
+    entry_t *find(const flow_key_t &key, direction_t direction);
+    const entry_t *find(const flow_key_t &key, direction_t direction) const;
+
+    set_t &set_of(const flow_key_t &key);
+    const set_t &set_of(const flow_key_t &key) const;
+
+    std::vector<set_t> m_sets;
+};
+
+/* What a TCP segment on the flow cache fast path tells conntrack_seq_cache::advance() */
+struct conntrack_segment_t {
+    flow_key_t key;
+    direction_t direction;
+    uint32_t end;
+    uint16_t window;
+};
+
+/*
+ * ConntrackOut and ConntrackIn of sirius_conntrack.p4. Both state_tables
+ * match the same 5-tuple + ENI in either direction (flow_key[0] and
+ * flow_key[1]), so they share one entry per connection, keyed with the
+ * lower address and port first.
+ *
+ * conntrack_lookup() is the apply(0) in front of the ACL: the graph of
+ * meta.direction sets meta.conntrack_data.allow_out/allow_in when it is
+ * in ALLOW. conntrack_update() is the apply(1) after the ACL: a SYN the
+ * ACL let through moves the graph of the reverse direction to ALLOW, so
+ * the replies skip the other direction's ACL, and both graphs go back to
+ * START, removing the entry, when the TCP connection is closed.
+ *
+ * Closed is where sirius_conntrack.p4 leaves "Sequence # tracking for
+ * FIN and final ACK" to do: a SYN puts the connection in SYN_SENT until
+ * a SYN-ACK acknowledges it, then ESTABLISHED; the first FIN moves it to
+ * FIN_WAIT, the FIN of the other side to TIME_WAIT, and the ACK of the
+ * last FIN closes it, each FIN counting once an ACK of the other side
+ * acknowledges exactly its end. A RST closes it at once when its
+ * sequence number is in the window the receiver accepts (RFC 5961), as
+ * far as conntrack knows it: within the receiver's advertised window of
+ * where the sender's sequence space ends; in SYN_SENT, the reply to the
+ * SYN must acknowledge it. Without the numbers in the
+ * conntrack_seq_cache, its RSTs and the ACKs of its SYN and FINs change
+ * nothing and the aging ends it. A half-closed connection keeps its
+ * graphs, the other side's data still goes through. A TCP packet the
+ * pipeline drops changes nothing of the connection.
+ *
+ * UDP has no handshake, so any UDP packet the ACL let through does what a
+ * SYN does: the first packet meeting the policy sets up the bidirectional
+ * flow, and only the aging ends it. With a flow sync, the changes of the
+ * graphs also go to the HA peer; with an aging, new entries get an idle
+ * timer, and removed ones are counted as leaving a stale timer.
+ */
+void conntrack_lookup(const sirius_flow_table &flows, const headers_t &hdr, metadata_t &meta, conntrack_flow_t &flow);
+
+/* end is the end of the packet, for the TCP options */
+void conntrack_update(sirius_flow_table &flows, sirius_flow_sync *sync, sirius_flow_aging *aging,
+                      conntrack_seq_cache &seqs, const headers_t &hdr, const uint8_t *end, metadata_t &meta,
+                      conntrack_flow_t &flow);
+
+/*
+ * Whether conntrack has to see every packet of the connection after
+ * conntrack_update(): a closing TCP connection waits for the ACK of its
+ * last FIN, which the flow cache must not take past it.
+ */
+inline bool conntrack_closing(const conntrack_flow_t &flow)
+{
+    return flow.state & (CONNTRACK_FIN_OUT | CONNTRACK_FIN_IN);
+}
+
+/*
+ * Whether conntrack_update() opened the connection: its first packet, or
+ * a SYN starting it over. before is flow.state as conntrack_lookup() left it.
+ */
+inline bool conntrack_opened(uint8_t before, const conntrack_flow_t &flow)
+{
+    return flow.state && (!before || (flow.state & ~before & CONNTRACK_SYN_SENT));
+}
+
+/* Whether the graph of `direction` is in ALLOW for the packet's connection, for the flow cache fast path */
+bool conntrack_allows(const sirius_flow_table &flows, const headers_t &hdr, direction_t direction, uint16_t eni);
+
+/* The same key for both directions of a connection, addresses and ports in host byte order */
+flow_key_t conntrack_flow_key(ipv4_addr_t sip, ipv4_addr_t dip, uint16_t sport, uint16_t dport, uint8_t protocol,
+                              uint16_t eni);
+
+/* The entry key of a tracked packet's connection, false for packets conntrack leaves alone */
+bool conntrack_key(const headers_t &hdr, uint16_t eni, flow_key_t &key);
+
+/* The segment of a TCP packet for conntrack_seq_cache::advance(), false for other packets */
+bool conntrack_segment(const headers_t &hdr, uint16_t eni, direction_t direction, conntrack_segment_t &segment);
+
+/*
+ * For a flow cache hit the ACL lets through: the lookup keeps the
+ * connection alive for the aging, and a UDP flow that aged out while its
+ * packets hit the cache is set up again, as conntrack_update() would.
+ */
+void conntrack_refresh(sirius_flow_table &flows, sirius_flow_sync *sync, sirius_flow_aging *aging,
+                       const flow_key_t &key, direction_t direction);
+
+} // namespace sirius
+
+#endif /* _SIRIUS_CONNTRACK_H_ */
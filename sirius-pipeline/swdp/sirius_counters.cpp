@@ -0,0 +1,153 @@
+#include "sirius_counters.h"
+
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace sirius {
+
+sirius_counters::sirius_counters(size_t slots) : m_slot_count(slots)
+{
+    static_assert(sizeof(counter_t) == sizeof(slot_t), "bases are mapped like blocks");
+    m_base = reinterpret_cast<counter_t *>(map());
+}
+
+sirius_counters::~sirius_counters()
+{
+    for (block *b : m_blocks) {
+        unmap(b->m_slots);
+        delete b;
+    }
+    if (m_detached) {
+        unmap(m_detached);
+    }
+    unmap(reinterpret_cast<slot_t *>(m_base));
+}
+
+sirius_counters::slot_t *sirius_counters::map() const
+{
+    /* Zero pages are zero counts, untouched ones cost no memory */
+    void *mem = mmap(nullptr, m_slot_count * sizeof(slot_t), PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (mem == MAP_FAILED) {
+        /* Out of address space, a setup error */
+        abort();
+    }
+    return static_cast<slot_t *>(mem);
+}
+
+void sirius_counters::unmap(slot_t *slots) const
+{
+    munmap(slots, m_slot_count * sizeof(slot_t));
+}
+
+sirius_counters::block *sirius_counters::attach()
+{
+    block *b = new block();
+    b->m_slots = map();
+
+    std::lock_guard<std::mutex> lock(m_lock);
+    m_blocks.push_back(b);
+    return b;
+}
+
+void sirius_counters::detach(block *b)
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    m_blocks.erase(std::find(m_blocks.begin(), m_blocks.end(), b));
+    if (!m_detached) {
+        m_detached = b->m_slots;
+    } else {
+        for (size_t i = 0; i < used(); i++) {
+            slot_t &from = b->m_slots[i];
+            slot_t &to = m_detached[i];
+            /* Skip the slots the block never counted */
+            uint64_t packets = from.packets.load(std::memory_order_relaxed);
+            if (packets) {
+                to.packets.store(to.packets.load(std::memory_order_relaxed) + packets, std::memory_order_relaxed);
+                to.bytes.store(to.bytes.load(std::memory_order_relaxed) + from.bytes.load(std::memory_order_relaxed),
+                               std::memory_order_relaxed);
+            }
+        }
+        unmap(b->m_slots);
+    }
+    delete b;
+}
+
+uint32_t sirius_counters::allocate()
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    uint32_t slot;
+    if (!m_free.empty()) {
+        slot = m_free.back();
+        m_free.pop_back();
+    } else if (m_next < m_slot_count) {
+        slot = m_next++;
+    } else {
+        return 0;
+    }
+    rebase(slot, sum(slot), true, true);
+    m_epoch->fetch_add(1, std::memory_order_relaxed);
+    return slot;
+}
+
+void sirius_counters::release(uint32_t slot)
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    m_free.push_back(slot);
+    m_epoch->fetch_add(1, std::memory_order_relaxed);
+}
+
+counter_t sirius_counters::sum(uint32_t slot) const
+{
+    counter_t total = {};
+    for (const block *b : m_blocks) {
+        total.packets += b->m_slots[slot].packets.load(std::memory_order_relaxed);
+        total.bytes += b->m_slots[slot].bytes.load(std::memory_order_relaxed);
+    }
+    if (m_detached) {
+        total.packets += m_detached[slot].packets.load(std::memory_order_relaxed);
+        total.bytes += m_detached[slot].bytes.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+void sirius_counters::rebase(uint32_t slot, const counter_t &now, bool packets, bool bytes)
+{
+    if (packets) {
+        m_base[slot].packets = now.packets;
+    }
+    if (bytes) {
+        m_base[slot].bytes = now.bytes;
+    }
+}
+
+void sirius_counters::read(const uint32_t *slots, size_t count, counter_t *out) const
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    for (size_t i = 0; i < count; i++) {
+        counter_t now = sum(slots[i]);
+        out[i] = { now.packets - m_base[slots[i]].packets, now.bytes - m_base[slots[i]].bytes };
+    }
+}
+
+void sirius_counters::reset(const uint32_t *slots, size_t count, bool packets, bool bytes)
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    for (size_t i = 0; i < count; i++) {
+        rebase(slots[i], sum(slots[i]), packets, bytes);
+    }
+}
+
+void sirius_counters::read_and_reset(const uint32_t *slots, size_t count, counter_t *out, bool packets, bool bytes)
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    for (size_t i = 0; i < count; i++) {
+        counter_t now = sum(slots[i]);
+        out[i] = { now.packets - m_base[slots[i]].packets, now.bytes - m_base[slots[i]].bytes };
+        rebase(slots[i], now, packets, bytes);
+    }
+}
+
+} // namespace sirius
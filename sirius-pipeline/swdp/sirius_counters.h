@@ -0,0 +1,117 @@
+#ifndef _SIRIUS_COUNTERS_H_
+#define _SIRIUS_COUNTERS_H_
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+#include "sirius_types.h"
+
+namespace sirius {
+
+/* Packets and bytes of one counter */
+struct counter_t {
+    uint64_t packets;
+    uint64_t bytes;
+};
+
+/*
+ * The direct counter of a P4 table (eni_counter, routing_counter,
+ * ca_to_pa_counter): packets and bytes in a fixed number of slots. The
+ * table picks the slot of an entry, from its key (eni_meter) or with
+ * allocate() when the entry is created (routing, ca_to_pa).
+ *
+ * Each pipeline counts into a block of its own, with all the slots, so
+ * counting is an increment at a fixed address and no lookup. Only the
+ * block's pipeline writes it, with plain stores; blocks are separate page
+ * aligned mappings, so no two workers write the same cache line. Reads
+ * sum the slot over all blocks and never write one, so polling the
+ * counters does not slow down the workers beyond the cache lines it
+ * reads. Untouched parts of a block stay on the zero page.
+ *
+ * A slot counts from its last reset(): reset() records the current sums
+ * as the slot's base, which reads subtract. allocate() resets the slot it
+ * hands out, so a new entry does not inherit the counts of an old one.
+ */
+class sirius_counters {
+public:
+    struct slot_t {
+        std::atomic<uint64_t> packets;
+        std::atomic<uint64_t> bytes;
+    };
+
+    /* Counters of one pipeline */
+    class block {
+    public:
+        void count(uint32_t slot, uint32_t bytes)
+        {
+            slot_t &s = m_slots[slot];
+            s.packets.store(s.packets.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            s.bytes.store(s.bytes.load(std::memory_order_relaxed) + bytes, std::memory_order_relaxed);
+        }
+
+    private:
+        friend class sirius_counters;
+
+        slot_t *m_slots;
+    };
+
+    explicit sirius_counters(size_t slots);
+    ~sirius_counters();
+
+    sirius_counters(const sirius_counters &) = delete;
+    sirius_counters &operator=(const sirius_counters &) = delete;
+
+    size_t slots() const { return m_slot_count; }
+
+    /* A new block for a pipeline; detach() folds its counts into the totals */
+    block *attach();
+    void detach(block *b);
+
+    /* A free slot, counting from zero; 0 when all are taken, slot 0 is never handed out */
+    uint32_t allocate();
+    void release(uint32_t slot);
+
+    /* Allocations and releases so far, which tell whether a slot may belong to another entry now */
+    uint64_t epoch() const { return m_epoch->load(std::memory_order_relaxed); }
+
+    /*
+     * Counts the allocations and releases in the epoch of `with` from now
+     * on, for one epoch over the counters of several tables. Before any
+     * slot is allocated.
+     */
+    void share_epoch(sirius_counters &with) { m_epoch = with.m_epoch; }
+
+    /* Counts of the slots since their reset(), all read under one lock */
+    void read(const uint32_t *slots, size_t count, counter_t *out) const;
+
+    /* Starts the slots' counts from zero; packets selects the packet count, bytes the byte count */
+    void reset(const uint32_t *slots, size_t count, bool packets, bool bytes);
+
+    /* read() and reset() in one, no packet counted in between is lost */
+    void read_and_reset(const uint32_t *slots, size_t count, counter_t *out, bool packets, bool bytes);
+
+private:
+    slot_t *map() const;
+    void unmap(slot_t *slots) const;
+
+    counter_t sum(uint32_t slot) const;
+    void rebase(uint32_t slot, const counter_t &now, bool packets, bool bytes);
+
+    /* Slots a block may have counted in: below m_next once slots are allocated, all otherwise */
+    size_t used() const { return m_next > 1 ? m_next : m_slot_count; }
+
+    const size_t m_slot_count;
+    mutable std::mutex m_lock;
+    std::vector<block *> m_blocks;
+    slot_t *m_detached = nullptr; /* counts of the blocks detached so far */
+    counter_t *m_base;
+    uint32_t m_next = 1;
+    std::vector<uint32_t> m_free;
+    std::atomic<uint64_t> m_own_epoch{ 0 };
+    std::atomic<uint64_t> *m_epoch = &m_own_epoch;
+};
+
+} // namespace sirius
+
+#endif /* _SIRIUS_COUNTERS_H_ */
@@ -0,0 +1,117 @@
+#include "sirius_dataplane.h"
+
+#include <pthread.h>
+#include <sched.h>
+
+#include <algorithm>
+#include <thread>
+#include <utility>
+
+namespace sirius {
+
+sirius_dataplane::sirius_dataplane(sirius_switch &sw, unsigned workers, size_t connections, size_t cache_flows)
+{
+    workers = std::max(workers, 1u);
+    unsigned cpus = std::max(std::thread::hardware_concurrency(), 1u);
+    std::vector<memory_placement_t> placements(workers, { sw.table_placement.page_size, -1 });
+    std::map<int, unsigned> node_workers;
+    for (unsigned i = 0; i < workers; i++) {
+        if (sw.flow_numa_local) {
+            placements[i].numa_node = cpu_numa_node(i % cpus);
+        }
+        node_workers[placements[i].numa_node]++;
+    }
+
+    /* A timer slab per node, sized for the partitions of its workers */
+    for (const auto &node : node_workers) {
+        size_t blocks = sirius_flow_aging::slab_blocks(connections / workers * node.second, node.second);
+        m_timers[node.first] = std::make_unique<sirius_slab>(sirius_flow_aging::TIMER_BLOCK, blocks,
+                                                             memory_placement_t{ sw.table_placement.page_size,
+                                                                                 node.first });
+    }
+    for (unsigned i = 0; i < workers; i++) {
+        m_workers.push_back(std::make_unique<worker_t>(sw, connections / workers, cache_flows / workers,
+                                                       *m_timers[placements[i].numa_node], placements[i]));
+    }
+}
+
+unsigned sirius_dataplane::worker_of(const packet_t &pkt) const
+{
+    headers_t hdr;
+    if (!parse(pkt, hdr) || !hdr.inner_ipv4) {
+        return 0;
+    }
+    icmp_redirect_t redirect;
+    if (hdr.inner_ipv4->protocol == ICMP_PROTO &&
+        icmp_redirect_parse(hdr.inner_ipv4, pkt.data() + pkt.len, redirect)) {
+        return worker_of_hash(
+            flow_hash(redirect.sip, redirect.dip, redirect.sport, redirect.dport, redirect.protocol));
+    }
+    uint16_t sport = 0, dport = 0;
+    if (hdr.inner_tcp) {
+        sport = hdr.inner_tcp->src_port;
+        dport = hdr.inner_tcp->dst_port;
+    } else if (hdr.inner_udp) {
+        sport = hdr.inner_udp->src_port;
+        dport = hdr.inner_udp->dst_port;
+    }
+    return worker_of_hash(flow_hash(hdr.inner_ipv4->src_addr, hdr.inner_ipv4->dst_addr, sport, dport,
+                                    hdr.inner_ipv4->protocol));
+}
+
+size_t sirius_dataplane::connections() const
+{
+    size_t count = 0;
+    for (const auto &w : m_workers) {
+        count += w->flows.size();
+    }
+    return count;
+}
+
+flow_memory_t sirius_dataplane::memory() const
+{
+    flow_memory_t memory = {};
+    for (const auto &w : m_workers) {
+        memory.connections += w->flows.size();
+        memory.capacity += w->flows.capacity();
+        memory.table_bytes += w->flows.memory();
+        memory.timer_bytes += w->aging.memory();
+        memory.timer_used += w->aging.timer_memory();
+    }
+    for (const auto &slab : m_timers) {
+        memory.slab_bytes += slab.second->memory();
+        memory.slab_taken += slab.second->taken() * slab.second->block_size();
+    }
+    return memory;
+}
+
+sirius_flow_sync &sirius_dataplane::replicate(unsigned worker, sirius_flow_sync::send_fn send)
+{
+    worker_t &w = *m_workers[worker];
+    w.pipeline.replicate(nullptr);
+    w.sync = std::make_unique<sirius_flow_sync>(w.flows, std::move(send));
+    w.pipeline.replicate(w.sync.get());
+    return *w.sync;
+}
+
+void sirius_dataplane::run(const std::function<void(unsigned)> &fn)
+{
+    unsigned cpus = std::max(std::thread::hardware_concurrency(), 1u);
+    std::vector<std::thread> threads;
+    for (unsigned i = 0; i < workers(); i++) {
+        threads.emplace_back([&fn, i, cpus] {
+            /* Before fn touches its tables, so the first packets already run on its node.
+             * Best effort: without the CPU the thread runs unpinned */
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(i % cpus, &set);
+            pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+            fn(i);
+        });
+    }
+    for (std::thread &t : threads) {
+        t.join();
+    }
+}
+
+} // namespace sirius
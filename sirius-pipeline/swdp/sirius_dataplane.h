@@ -0,0 +1,139 @@
+#ifndef _SIRIUS_DATAPLANE_H_
+#define _SIRIUS_DATAPLANE_H_
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "sirius_pipeline.h"
+
+namespace sirius {
+
+/* Where the memory of a dataplane's connection state goes, see sirius_dataplane::memory() */
+struct flow_memory_t {
+    size_t connections;
+    size_t capacity;    /* connections the flow table partitions are sized for */
+    size_t table_bytes; /* their buckets, reserved at startup */
+    size_t timer_bytes; /* aging timer blocks in use */
+    size_t timer_used;  /* of those, bytes holding a timer */
+    size_t slab_bytes;  /* slabs reserved for the timer blocks */
+    size_t slab_taken;  /* blocks taken from them, in use or cached by a worker */
+
+    /* A connection's share of the table at capacity, and of the timer blocks now */
+    double bytes_per_connection() const
+    {
+        return (capacity ? (double)table_bytes / (double)capacity : 0) +
+               (connections ? (double)timer_bytes / (double)connections : 0);
+    }
+
+    /* Share of the blocks taken from the slabs that holds no timer */
+    double fragmentation() const { return slab_taken ? 1 - (double)timer_used / (double)slab_taken : 0; }
+};
+
+/*
+ * Run-to-completion dataplane on several worker threads, one per core,
+ * each running whole bursts through its own sirius_pipeline.
+ *
+ * Packets are sharded over the workers by a symmetric hash of the inner
+ * IPv4 5-tuple, the tuple flow_key[0] and flow_key[1] of
+ * sirius_conntrack.p4 are built from, so both directions of a connection
+ * go to the same worker. This is what RSS with a symmetric key over the
+ * inner headers does in a NIC; the NIC or a software dispatcher puts each
+ * packet on the queue of worker_of() and each worker polls its own.
+ *
+ * Every worker owns a partition of the connection table that no other
+ * worker writes, with the aging of its connections, and a flow cache, so
+ * connection state is never shared between cores. The agings take their
+ * timer blocks through per-worker caches from a slab per NUMA node,
+ * shared by the workers of the node. The tables
+ * programmed through the DASH API stay in the switch, shared by all
+ * workers: data path reads of them write nothing shared (rcu_rw_lock,
+ * RCU), so they do not contend either.
+ *
+ * The partitions, flow caches and timer slabs are on pages of the size
+ * the switch's table_placement asks for and, with flow_numa_local, bound
+ * to the NUMA node of the CPU run() pins the worker to; without it, all
+ * workers share one unbound slab. The partitions and caches are bucket
+ * arrays made at startup, a connection or flow takes a slot of them, so
+ * the timers are the only per-connection allocations.
+ */
+class sirius_dataplane {
+public:
+    sirius_dataplane(sirius_switch &sw, unsigned workers, size_t connections = sirius_flow_table::DEFAULT_CAPACITY,
+                     size_t cache_flows = sirius_flow_cache::DEFAULT_CAPACITY);
+
+    sirius_dataplane(const sirius_dataplane &) = delete;
+    sirius_dataplane &operator=(const sirius_dataplane &) = delete;
+
+    unsigned workers() const { return (unsigned)m_workers.size(); }
+
+    /* The same for both directions of a flow; addresses and ports in network byte order */
+    static uint32_t flow_hash(ipv4_addr_t sip, ipv4_addr_t dip, uint16_t sport, uint16_t dport, uint8_t protocol)
+    {
+        uint64_t addrs = sip < dip ? (uint64_t)sip << 32 | dip : (uint64_t)dip << 32 | sip;
+        uint32_t ports = sport < dport ? (uint32_t)sport << 16 | dport : (uint32_t)dport << 16 | sport;
+        return (uint32_t)(hash_mix(addrs ^ hash_mix((uint64_t)ports << 8 | protocol)) >> 32);
+    }
+
+    unsigned worker_of_hash(uint32_t hash) const { return (unsigned)((uint64_t)hash * m_workers.size() >> 32); }
+
+    /*
+     * The worker of a packet; an ICMP redirect goes to the worker of the
+     * connection it redirects, packets without inner IPv4 to worker 0
+     */
+    unsigned worker_of(const packet_t &pkt) const;
+
+    /* For the worker's thread only */
+    sirius_pipeline &pipeline(unsigned worker) { return m_workers[worker]->pipeline; }
+
+    const sirius_flow_table &flows(unsigned worker) const { return m_workers[worker]->flows; }
+
+    /* For the worker's thread, and for sirius_flow_sync::apply() of the HA peer's records */
+    sirius_flow_table &flows(unsigned worker) { return m_workers[worker]->flows; }
+
+    /*
+     * HA flow replication of the worker's partition through a flow sync
+     * sending with `send`, to the same worker of the peer: both shard
+     * connections with flow_hash(). Not while run() runs; pair() and
+     * unpair() of the flow sync from any thread.
+     */
+    sirius_flow_sync &replicate(unsigned worker, sirius_flow_sync::send_fn send);
+
+    /* The aging of the worker's partition, with the appliance's timeouts */
+    const sirius_flow_aging &aging(unsigned worker) const { return m_workers[worker]->aging; }
+
+    /* Connections in all partitions */
+    size_t connections() const;
+
+    /* Memory of the connection state; counters of the workers, a snapshot while they run */
+    flow_memory_t memory() const;
+
+    /*
+     * Runs fn(worker) on one thread per worker, pinned to CPU worker
+     * modulo the CPUs there are, and returns when all of them returned.
+     */
+    void run(const std::function<void(unsigned)> &fn);
+
+private:
+    struct worker_t {
+        sirius_flow_table flows;
+        sirius_flow_aging aging;
+        sirius_pipeline pipeline;
+        std::unique_ptr<sirius_flow_sync> sync;
+
+        worker_t(sirius_switch &sw, size_t connections, size_t cache_flows, sirius_slab &timers,
+                 const memory_placement_t &placement)
+            : flows(connections, placement), aging(flows, &timers), pipeline(sw, flows, cache_flows, placement)
+        {
+            pipeline.age(&aging);
+        }
+    };
+
+    std::map<int, std::unique_ptr<sirius_slab>> m_timers; /* by NUMA node, -1 unbound */
+    std::vector<std::unique_ptr<worker_t>> m_workers;
+};
+
+} // namespace sirius
+
+#endif /* _SIRIUS_DATAPLANE_H_ */
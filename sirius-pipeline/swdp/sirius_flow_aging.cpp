@@ -0,0 +1,291 @@
+#include "sirius_flow_aging.h"
+
+#include <algorithm>
+
+#include "sirius_headers.h"
+
+namespace sirius {
+
+namespace {
+
+uint16_t ticks(uint32_t ms)
+{
+    uint32_t t = (ms + sirius_flow_aging::TICK_MS - 1) / sirius_flow_aging::TICK_MS;
+    return (uint16_t)std::min<uint32_t>(t, INT16_MAX);
+}
+
+} // namespace
+
+size_t sirius_flow_aging::slab_blocks(size_t connections, unsigned agings)
+{
+    size_t slots = LEVEL0_SLOTS + 2 * LEVEL_SLOTS + 1;
+    return 4 * connections / BLOCK_TIMERS + agings * (slots + 2 * sirius_slab::BATCH);
+}
+
+sirius_flow_aging::sirius_flow_aging(sirius_flow_table &flows, sirius_slab *slab)
+    : m_flows(flows), m_start(std::chrono::steady_clock::now()),
+      m_slab(slab ? nullptr : std::make_unique<sirius_slab>(TIMER_BLOCK, slab_blocks(flows.capacity()),
+                                                                flows.placement())),
+      m_blocks(slab ? *slab : *m_slab)
+{
+    m_flows.set_tick((uint16_t)m_now);
+}
+
+sirius_flow_aging::~sirius_flow_aging()
+{
+    for (auto *level : { m_level0, m_level1, m_level2 }) {
+        size_t slots = level == m_level0 ? LEVEL0_SLOTS : LEVEL_SLOTS;
+        for (size_t i = 0; i < slots; i++) {
+            release(level[i]);
+        }
+    }
+    release(m_due);
+}
+
+void sirius_flow_aging::set_timeouts(uint32_t tcp_ms, uint32_t udp_ms)
+{
+    m_tcp_timeout = ticks(tcp_ms);
+    m_udp_timeout = ticks(udp_ms);
+}
+
+uint16_t sirius_flow_aging::timeout(uint8_t protocol) const
+{
+    switch (protocol) {
+    case TCP_PROTO:
+        return m_tcp_timeout;
+    case UDP_PROTO:
+        return m_udp_timeout;
+    default:
+        return 0;
+    }
+}
+
+void sirius_flow_aging::inserted(const flow_key_t &key)
+{
+    uint16_t t = timeout(key.protocol);
+    uint8_t token = (uint8_t)(m_flows.tick() % sirius_flow_table::TOKENS);
+    m_timers++;
+    arm({ key.sip, key.dip, key.sport, key.dport, key.eni, key.protocol, token, m_now + (t ? t + 1u : MAX_TICKS) });
+}
+
+bool sirius_flow_aging::push(block_t *&slot, const timer_t &timer)
+{
+    if (!slot || slot->count == BLOCK_TIMERS) {
+        auto *block = static_cast<block_t *>(m_blocks.alloc());
+        if (!block) {
+            return false;
+        }
+        block->next = slot;
+        block->count = 0;
+        slot = block;
+    }
+    slot->timers[slot->count++] = timer;
+    return true;
+}
+
+void sirius_flow_aging::release(block_t *&slot)
+{
+    while (slot) {
+        block_t *next = slot->next;
+        m_blocks.free(slot);
+        slot = next;
+    }
+}
+
+void sirius_flow_aging::arm(const timer_t &timer)
+{
+    uint32_t delta = timer.deadline - m_now;
+    block_t **slot;
+    if (delta < LEVEL0_SLOTS) {
+        slot = &m_level0[timer.deadline % LEVEL0_SLOTS];
+    } else if (delta < LEVEL0_SLOTS * LEVEL_SLOTS) {
+        slot = &m_level1[timer.deadline >> LEVEL1_SHIFT & (LEVEL_SLOTS - 1)];
+    } else {
+        slot = &m_level2[timer.deadline >> LEVEL2_SHIFT & (LEVEL_SLOTS - 1)];
+    }
+    if (!push(*slot, timer)) {
+        m_timers--;
+        m_lost++;
+    }
+}
+
+void sirius_flow_aging::advance()
+{
+    m_now++;
+    m_flows.set_tick((uint16_t)m_now);
+
+    /* A slot of an upper level holds the next turn of the level below, spread it over that level */
+    for (auto [shift, level] : { std::make_pair(LEVEL2_SHIFT, m_level2), std::make_pair(LEVEL1_SHIFT, m_level1) }) {
+        if (m_now & ((1u << shift) - 1)) {
+            continue;
+        }
+        block_t *&slot = level[m_now >> shift & (LEVEL_SLOTS - 1)];
+        block_t *blocks = slot;
+        slot = nullptr;
+        if (m_sweep_link && &sweep_slot(m_sweep_slot) == &slot) {
+            m_sweep_link = &slot;
+            m_sweep_fill = nullptr;
+        }
+        while (blocks) {
+            for (uint32_t i = 0; i < blocks->count; i++) {
+                arm(blocks->timers[i]);
+            }
+            block_t *next = blocks->next;
+            m_blocks.free(blocks);
+            blocks = next;
+        }
+    }
+
+    /* The slot that came due goes in front of the timers still waiting */
+    block_t *&slot = m_level0[m_now % LEVEL0_SLOTS];
+    if (slot) {
+        block_t *last = slot;
+        m_due_count += last->count;
+        for (; last->next; last = last->next) {
+            m_due_count += last->next->count;
+        }
+        last->next = m_due;
+        m_due = slot;
+        slot = nullptr;
+    }
+}
+
+const sirius_flow_aging::timer_t *sirius_flow_aging::due_timer(size_t ahead) const
+{
+    const block_t *block = m_due;
+    for (; block && ahead >= block->count; block = block->next) {
+        ahead -= block->count;
+    }
+    return block ? &block->timers[block->count - 1 - ahead] : nullptr;
+}
+
+size_t sirius_flow_aging::poll(sirius_flow_sync *sync, size_t timers)
+{
+    auto elapsed = std::chrono::steady_clock::now() - m_start;
+    return poll((uint32_t)(std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count() / TICK_MS), sync,
+                timers);
+}
+
+size_t sirius_flow_aging::poll(uint32_t now, sirius_flow_sync *sync, size_t timers)
+{
+    while ((int32_t)(now - m_now) > 0) {
+        advance();
+    }
+
+    size_t count = std::min(m_due_count, timers);
+    for (size_t i = 0; i < std::min(count, PREFETCH); i++) {
+        m_flows.prefetch(due_timer(i)->key());
+    }
+
+    size_t removed = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (i + PREFETCH < count) {
+            m_flows.prefetch(due_timer(PREFETCH)->key());
+        }
+
+        timer_t timer = m_due->timers[--m_due->count];
+        m_due_count--;
+        if (!m_due->count) {
+            block_t *next = m_due->next;
+            m_blocks.free(m_due);
+            m_due = next;
+        }
+
+        flow_key_t key = timer.key();
+        uint16_t t = timeout(key.protocol);
+        uint16_t idle = 0;
+        switch (m_flows.age(key, timer.token, t, idle)) {
+        case sirius_flow_table::AGE_GONE:
+            m_timers--;
+            m_stale -= m_stale > 0;
+            break;
+        case sirius_flow_table::AGE_EXPIRED:
+            m_timers--;
+            expire(idle, t);
+            removed++;
+            if (sync) {
+                sync->removed(key);
+            }
+            break;
+        case sirius_flow_table::AGE_ALIVE:
+            timer.deadline = m_now + (t ? t - idle + 1u : MAX_TICKS);
+            arm(timer);
+            break;
+        }
+    }
+
+    if (count < timers && 2 * m_stale > m_timers) {
+        removed += sweep(sync, timers - count);
+    }
+    return removed;
+}
+
+size_t sirius_flow_aging::sweep(sirius_flow_sync *sync, size_t timers)
+{
+    if (!m_sweep_link) {
+        m_sweep_link = &sweep_slot(m_sweep_slot);
+    }
+
+    size_t removed = 0;
+    while (timers) {
+        block_t *block = *m_sweep_link;
+        if (!block) {
+            /* The end of a pass: whatever stale timers are left are in level 0 and soon due */
+            m_sweep_fill = nullptr;
+            if (++m_sweep_slot == SWEEP_SLOTS) {
+                m_sweep_slot = 0;
+                m_sweep_link = nullptr;
+                m_stale = 0;
+                break;
+            }
+            m_sweep_link = &sweep_slot(m_sweep_slot);
+            continue;
+        }
+
+        for (uint32_t i = 0; i < block->count; i++) {
+            m_flows.prefetch(block->timers[i].key());
+        }
+        uint32_t kept = 0;
+        for (uint32_t i = 0; i < block->count; i++) {
+            timer_t timer = block->timers[i];
+            flow_key_t key = timer.key();
+            uint16_t t = timeout(key.protocol);
+            uint16_t idle = 0;
+            switch (m_flows.age(key, timer.token, t, idle)) {
+            case sirius_flow_table::AGE_GONE:
+                m_timers--;
+                m_stale -= m_stale > 0;
+                break;
+            case sirius_flow_table::AGE_EXPIRED:
+                m_timers--;
+                expire(idle, t);
+                removed++;
+                if (sync) {
+                    sync->removed(key);
+                }
+                break;
+            case sirius_flow_table::AGE_ALIVE:
+                /* Keeps its deadline, with the token age() gave it, packed into the blocks before */
+                if (m_sweep_fill && m_sweep_fill->count < BLOCK_TIMERS) {
+                    m_sweep_fill->timers[m_sweep_fill->count++] = timer;
+                } else {
+                    block->timers[kept++] = timer;
+                }
+                break;
+            }
+        }
+        timers -= std::min<size_t>(timers, block->count);
+        block->count = kept;
+
+        if (kept) {
+            m_sweep_link = &block->next;
+            m_sweep_fill = block;
+        } else {
+            *m_sweep_link = block->next;
+            m_blocks.free(block);
+        }
+    }
+    return removed;
+}
+
+} // namespace sirius
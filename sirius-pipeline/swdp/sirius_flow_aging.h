@@ -0,0 +1,231 @@
+#ifndef _SIRIUS_FLOW_AGING_H_
+#define _SIRIUS_FLOW_AGING_H_
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+#include "sirius_flow_sync.h"
+#include "sirius_flow_table.h"
+#include "sirius_slab.h"
+
+namespace sirius {
+
+/*
+ * Idle timeouts of the connections of one flow table partition: a
+ * connection not used for longer than the timeout of its protocol is
+ * removed, and the removal replicated like one of the data path's.
+ *
+ * A hierarchical timer wheel (256 slots of a tick, then 64 slots of 256
+ * ticks and 64 of 16384) holds one timer per connection, armed when the
+ * data path creates it. Packets do not touch the wheel: a hit in the table
+ * stamps the connection with the current tick (see sirius_flow_table),
+ * which is the whole rearm. When a timer comes due, the aging reads the
+ * stamp: a connection idle for longer is removed, any other gets its
+ * timer back for its last use plus the timeout. A connection is checked
+ * about once per timeout while it lives, however many packets it has.
+ *
+ * Due timers are checked in batches of at most `timers` per poll(), with
+ * the table's buckets prefetched ahead, so a tick that makes a million
+ * timers due spreads over the next polls instead of stalling the worker.
+ *
+ * A timer carries the key and aging token of its connection (see
+ * sirius_flow_table::age()); one left behind by a connection that ended
+ * and came back, or was evicted, finds no connection of its token and is
+ * dropped. Like the flow sync, the aging belongs to the worker that owns
+ * the partition, the only one to advance the table's clock.
+ *
+ * The slots hold their timers in blocks of TIMER_BLOCK bytes from a
+ * sirius_slab, through the aging's own sirius_slab_cache: arming a timer
+ * writes it to the slot's first block, or takes a block when that one is
+ * full, and blocks go back as their timers come due. The cost of a new
+ * connection stays the same however many timers there are, and the
+ * memory follows the connections. Should the slab run out, the timer is
+ * not armed (lost()) and the connection stays until the table evicts it.
+ *
+ * A connection the data path removes, closed or reset, leaves its timer
+ * behind until the timeout. removed() counts them; when they are more
+ * than half the timers, poll() also sweeps the slots of the upper levels
+ * and drops the timers of connections that are gone, packing the others
+ * into fewer blocks, with the same budget of timers per poll, so a high
+ * rate of short connections does not fill the slab with stale timers.
+ */
+class sirius_flow_aging {
+public:
+    /* A tick of the aging clock */
+    static constexpr uint32_t TICK_MS = 16;
+
+    /* Idle times are 16 bits of ticks, timeouts stay below half of that */
+    static constexpr uint32_t MAX_TIMEOUT_MS = INT16_MAX * TICK_MS;
+
+    /* Due timers a poll() checks at most */
+    static constexpr size_t POLL_TIMERS = 256;
+
+    /* Bytes of a block of timers */
+    static constexpr size_t TIMER_BLOCK = 1024;
+
+    /*
+     * Blocks of a slab for the agings of `connections` connections: room
+     * for four timers per connection, for the stale ones, and for the
+     * partly used blocks of each slot.
+     */
+    static size_t slab_blocks(size_t connections, unsigned agings = 1);
+
+    /* Takes its timer blocks from `slab`, shared with other agings, or else from a slab of its own */
+    explicit sirius_flow_aging(sirius_flow_table &flows, sirius_slab *slab = nullptr);
+    ~sirius_flow_aging();
+
+    sirius_flow_aging(const sirius_flow_aging &) = delete;
+    sirius_flow_aging &operator=(const sirius_flow_aging &) = delete;
+
+    /*
+     * Idle timeouts of TCP and UDP connections in milliseconds, 0 for none,
+     * rounded up to ticks; other protocols never age, nothing does before
+     * the first call. As the clock counts whole ticks, a connection goes
+     * between one and two ticks after its timeout, never before. A timer
+     * armed before a change still fires when it was armed for.
+     */
+    void set_timeouts(uint32_t tcp_ms, uint32_t udp_ms);
+
+    /* Arms the timer of a connection the data path just created */
+    void inserted(const flow_key_t &key);
+
+    /* Counts a connection the data path removed, whose timer is now stale */
+    void removed() { m_stale++; }
+
+    /*
+     * Advances the clock to the current time and checks up to `timers` due
+     * timers. Expired connections are removed and, with a flow sync, sent
+     * to the HA peer. Returns the number removed.
+     */
+    size_t poll(sirius_flow_sync *sync, size_t timers = POLL_TIMERS);
+
+    /* The same at tick `now` of a clock of the caller's, which only moves forward */
+    size_t poll(uint32_t now, sirius_flow_sync *sync, size_t timers = POLL_TIMERS);
+
+    /* Ticks since the aging started */
+    uint32_t now() const { return m_now; }
+
+    /* Armed timers, due ones included */
+    size_t timers() const { return m_timers; }
+
+    /* Timers that came due and were not checked yet */
+    size_t due() const { return m_due_count; }
+
+    /* Connections removed for idling */
+    uint64_t expired() const { return m_expired; }
+
+    /* Ticks past their timeout at which those connections were removed: the most, and the sum over them */
+    uint32_t max_late() const { return m_max_late; }
+    uint64_t late() const { return m_late; }
+
+    /* Timers not armed for want of a block */
+    uint64_t lost() const { return m_lost; }
+
+    /* Bytes of the blocks the timers are in, and of the timers themselves */
+    size_t memory() const { return m_blocks.in_use() * TIMER_BLOCK; }
+    size_t timer_memory() const { return m_timers * sizeof(timer_t); }
+
+private:
+    static constexpr unsigned LEVEL0_BITS = 8;
+    static constexpr unsigned LEVEL_BITS = 6;
+    static constexpr uint32_t LEVEL0_SLOTS = 1u << LEVEL0_BITS;
+    static constexpr uint32_t LEVEL_SLOTS = 1u << LEVEL_BITS;
+    static constexpr unsigned LEVEL1_SHIFT = LEVEL0_BITS;
+    static constexpr unsigned LEVEL2_SHIFT = LEVEL0_BITS + LEVEL_BITS;
+
+    /* Timers of connections without a timeout come back this late, to see a new one */
+    static constexpr uint16_t MAX_TICKS = INT16_MAX;
+
+    /* Timers ahead of the one being checked whose buckets are prefetched */
+    static constexpr size_t PREFETCH = 8;
+
+    /* 20 bytes: the key without its padding, the token and the tick it fires at */
+    struct timer_t {
+        ipv4_addr_t sip;
+        ipv4_addr_t dip;
+        uint16_t sport;
+        uint16_t dport;
+        uint16_t eni;
+        uint8_t protocol;
+        uint8_t token;
+        uint32_t deadline;
+
+        flow_key_t key() const { return { sip, dip, sport, dport, eni, protocol }; }
+    };
+
+    static constexpr uint32_t BLOCK_TIMERS = 50;
+
+    /* A slot is a list of blocks, the first one being filled */
+    struct alignas(64) block_t {
+        block_t *next;
+        uint32_t count;
+        timer_t timers[BLOCK_TIMERS];
+    };
+
+    static_assert(sizeof(block_t) == TIMER_BLOCK, "a block is a slab block");
+
+    /* Upper level slots the sweep goes through */
+    static constexpr unsigned SWEEP_SLOTS = 2 * LEVEL_SLOTS;
+
+    uint16_t timeout(uint8_t protocol) const;
+
+    /* Counts a connection removed after `idle` ticks, with a timeout of `timeout` */
+    void expire(uint16_t idle, uint16_t timeout)
+    {
+        m_expired++;
+        m_late += (uint16_t)(idle - timeout);
+        m_max_late = std::max<uint32_t>(m_max_late, (uint16_t)(idle - timeout));
+    }
+
+    /* Adds the timer to a slot, false when no block is left for it */
+    bool push(block_t *&slot, const timer_t &timer);
+
+    /* Gives the blocks of a slot back */
+    void release(block_t *&slot);
+
+    /* Puts the timer in the slot of its deadline, which is after m_now */
+    void arm(const timer_t &timer);
+
+    /* One tick: cascades the upper levels when they turn and queues the slot that came due */
+    void advance();
+
+    /* The due timer `ahead` places behind the next one */
+    const timer_t *due_timer(size_t ahead) const;
+
+    /* Checks up to `timers` timers of the upper levels, drops those of connections that are gone */
+    size_t sweep(sirius_flow_sync *sync, size_t timers);
+
+    block_t *&sweep_slot(unsigned i) { return i < LEVEL_SLOTS ? m_level1[i] : m_level2[i - LEVEL_SLOTS]; }
+
+    sirius_flow_table &m_flows;
+    std::chrono::steady_clock::time_point m_start;
+    uint32_t m_now = 0;
+    uint16_t m_tcp_timeout = 0;
+    uint16_t m_udp_timeout = 0;
+
+    std::unique_ptr<sirius_slab> m_slab;
+    sirius_slab_cache m_blocks;
+    block_t *m_level0[LEVEL0_SLOTS] = {};
+    block_t *m_level1[LEVEL_SLOTS] = {};
+    block_t *m_level2[LEVEL_SLOTS] = {};
+    block_t *m_due = nullptr; /* taken from the back of the first block */
+    size_t m_due_count = 0;
+
+    /* Where the sweep is: a slot, the link to the next block it checks and the last block it kept */
+    unsigned m_sweep_slot = 0;
+    block_t **m_sweep_link = nullptr;
+    block_t *m_sweep_fill = nullptr;
+    size_t m_stale = 0;
+
+    size_t m_timers = 0;
+    uint64_t m_expired = 0;
+    uint64_t m_late = 0;
+    uint32_t m_max_late = 0;
+    uint64_t m_lost = 0;
+};
+
+} // namespace sirius
+
+#endif /* _SIRIUS_FLOW_AGING_H_ */
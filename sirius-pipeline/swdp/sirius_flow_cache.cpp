@@ -0,0 +1,236 @@
+#include "sirius_flow_cache.h"
+
+#include <algorithm>
+
+#include "sirius_ca_to_pa.h"
+#include "sirius_routing.h"
+
+namespace sirius {
+
+namespace {
+
+static_assert(sirius_routing::COUNTER_SLOTS <= 1u << 24 && sirius_ca_to_pa::COUNTER_SLOTS <= 1u << 24,
+              "entries keep counter slots in 24 bits");
+
+void store24(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+}
+
+uint32_t load24(const uint8_t *p)
+{
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16;
+}
+
+/* Share of the entries `capacity` flows fill */
+constexpr double TARGET_LOAD = 0.9;
+
+/* Moves an insert may chain to make room before it replaces a flow */
+constexpr unsigned RELOCATE_DEPTH = 3;
+
+} // namespace
+
+sirius_flow_cache::sirius_flow_cache(const sirius_generations &generations, size_t capacity,
+                                     const memory_placement_t &placement)
+    : m_generations(generations), m_capacity(capacity),
+      m_set_count(std::max<size_t>((size_t)(capacity / (SET_WAYS * TARGET_LOAD)) + 1, 2)),
+      m_memory(memory(), placement)
+{
+    /* Zero pages are empty sets */
+    m_sets = static_cast<set_t *>(m_memory.data());
+    m_tags = reinterpret_cast<uint64_t *>(m_sets + m_set_count);
+}
+
+void sirius_flow_cache::entry_t::set(const flow_cache_key_t &k, uint32_t gen, const flow_action_t &action)
+{
+    key = k;
+    generation = gen;
+    vxlan = action.vxlan;
+    eni = action.eni;
+    refreshed = 0;
+    store24(routing_counter, action.routing_counter);
+    store24(ca_to_pa_counter, action.ca_to_pa_counter);
+    flags = (action.acl_drop ? FLAG_ACL_DROP : 0) | (action.conntrack ? FLAG_CONNTRACK : 0) |
+            (action.encap ? FLAG_ENCAP : 0) | (action.direction == DIRECTION_OUTBOUND ? FLAG_OUTBOUND : 0);
+}
+
+void sirius_flow_cache::entry_t::get(flow_action_t &action) const
+{
+    action.direction = flags & FLAG_OUTBOUND ? DIRECTION_OUTBOUND : DIRECTION_INBOUND;
+    action.eni = eni;
+    action.acl_drop = flags & FLAG_ACL_DROP;
+    action.conntrack = flags & FLAG_CONNTRACK;
+    action.encap = flags & FLAG_ENCAP;
+    action.vxlan = vxlan;
+    action.routing_counter = load24(routing_counter);
+    action.ca_to_pa_counter = load24(ca_to_pa_counter);
+}
+
+/*
+ * An empty entry of the set. Stale entries are left to the insert's own
+ * sets: a relocation passes too many entries to look up their generations.
+ */
+int sirius_flow_cache::free_way(size_t set) const
+{
+    for (unsigned i = 0; i < SET_WAYS; i++) {
+        if (!m_sets[set].entries[i].generation) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+void sirius_flow_cache::write(size_t set, unsigned way, const entry_t &entry, uint16_t tag)
+{
+    m_sets[set].entries[way] = entry;
+    uint64_t &tags = m_tags[set];
+    tags = (tags & ~(0xffffULL << (16 * way))) | (uint64_t)tag << (16 * way);
+}
+
+/*
+ * Frees an entry of the full set by moving one of its flows to its other
+ * set, first making room there the same way, up to `depth` moves deep.
+ * Flows are not moved back into `from`, the set the caller works on, so
+ * with three moves a chain cannot come back to a set it passed.
+ */
+int sirius_flow_cache::relocate(size_t set, size_t from, unsigned depth)
+{
+    for (unsigned i = 0; i < SET_WAYS; i++) {
+        const entry_t &entry = m_sets[set].entries[i];
+        uint64_t hash = key_hash(entry.key);
+        size_t alt = set == first_set(hash) ? second_set(hash) : first_set(hash);
+        if (alt == from) {
+            continue;
+        }
+        int j = free_way(alt);
+        if (j < 0 && depth > 1) {
+            j = relocate(alt, set, depth - 1);
+        }
+        if (j >= 0) {
+            write(alt, (unsigned)j, entry, key_tag(hash));
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+void sirius_flow_cache::insert(const flow_cache_key_t &key, uint32_t generation, const flow_action_t &action)
+{
+    uint64_t hash = key_hash(key);
+    size_t sets[2] = { first_set(hash), second_set(hash) };
+
+    /* All flows of older global generations are stale */
+    if (generation != m_generation) {
+        m_generation = generation;
+        m_count = 0;
+    }
+
+    entry_t entry;
+    entry.set(key, sirius_generations::tag(generation + action.generation), action);
+
+    /* The flow itself, possibly under older generations */
+    for (size_t set : sets) {
+        for (unsigned i = 0; i < SET_WAYS; i++) {
+            entry_t &e = m_sets[set].entries[i];
+            if (e.generation && e.key == key) {
+                m_count += !live(e, generation);
+                e = entry;
+                return;
+            }
+        }
+    }
+
+    /* Empty or stale entries are free, take one in the set with fewer live entries */
+    int free[2] = { -1, -1 };
+    unsigned used[2] = {};
+    for (unsigned s = 0; s < 2; s++) {
+        for (unsigned i = 0; i < SET_WAYS; i++) {
+            if (live(m_sets[sets[s]].entries[i], generation)) {
+                used[s]++;
+            } else if (free[s] < 0) {
+                free[s] = (int)i;
+            }
+        }
+    }
+    unsigned s = used[1] < used[0] && free[1] >= 0 ? 1 : free[0] >= 0 ? 0 : 1;
+    int way = free[s];
+
+    /* Both full: make room by moving flows while the cache is below its capacity */
+    for (unsigned t = 0; way < 0 && t < 2 && m_count < m_capacity; t++) {
+        s = t;
+        way = relocate(sets[t], sets[1 - t], RELOCATE_DEPTH);
+    }
+    if (way >= 0) {
+        m_count++;
+    }
+
+    /* Not recently used: the first entry not hit since the bits were cleared, or else clear them */
+    for (unsigned i = 0; way < 0 && i < 2 * SET_WAYS; i++) {
+        if (!(m_sets[sets[i / SET_WAYS]].entries[i % SET_WAYS].flags & FLAG_REF)) {
+            s = i / SET_WAYS;
+            way = (int)(i % SET_WAYS);
+        }
+    }
+    if (way < 0) {
+        for (size_t set : sets) {
+            for (entry_t &e : m_sets[set].entries) {
+                e.flags &= (uint8_t)~FLAG_REF;
+            }
+        }
+        s = 0;
+        way = 0;
+    }
+
+    write(sets[s], (unsigned)way, entry, key_tag(hash));
+}
+
+void sirius_flow_cache::erase(const flow_cache_key_t &key)
+{
+    uint64_t hash = key_hash(key);
+    for (size_t set : { first_set(hash), second_set(hash) }) {
+        for (entry_t &e : m_sets[set].entries) {
+            if (e.generation && e.key == key) {
+                m_count -= live(e, m_generation);
+                e.generation = 0;
+                e.flags = 0;
+                return;
+            }
+        }
+    }
+}
+
+unsigned sirius_flow_cache::redirect(const flow_key_t &connection, ipv4_addr_t underlay_dip)
+{
+    uint32_t sip = htonl(connection.sip);
+    uint32_t dip = htonl(connection.dip);
+    uint16_t sport = htons(connection.sport);
+    uint16_t dport = htons(connection.dport);
+    uint64_t hash = tuple_hash(sip, dip, sport, dport, connection.protocol);
+
+    unsigned count = 0;
+    for (size_t set : { first_set(hash), second_set(hash) }) {
+        for (uint64_t match = matches(set, key_tag(hash)); match; match &= match - 1) {
+            entry_t &e = m_sets[set].entries[__builtin_ctzll(match) / 16];
+            const flow_cache_key_t &k = e.key;
+            if (!e.generation || !(e.flags & FLAG_OUTBOUND) || e.eni != connection.eni ||
+                (uint8_t)k.vni_protocol != connection.protocol ||
+                !((k.sip == sip && k.dip == dip && k.sport == sport && k.dport == dport) ||
+                  (k.sip == dip && k.dip == sip && k.sport == dport && k.dport == sport))) {
+                continue;
+            }
+            count++;
+            if (underlay_dip) {
+                e.vxlan.underlay_dip = htonl(underlay_dip);
+            } else {
+                m_count -= live(e, m_generation);
+                e.generation = 0;
+                e.flags = 0;
+            }
+        }
+    }
+    return count;
+}
+
+} // namespace sirius
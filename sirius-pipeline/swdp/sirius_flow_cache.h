@@ -0,0 +1,277 @@
+#ifndef _SIRIUS_FLOW_CACHE_H_
+#define _SIRIUS_FLOW_CACHE_H_
+
+#include <cstddef>
+#include <cstring>
+
+#include "sirius_flow_table.h"
+#include "sirius_generations.h"
+#include "sirius_headers.h"
+#include "sirius_memory.h"
+#include "sirius_vxlan.h"
+
+namespace sirius {
+
+/*
+ * Packet fields the outcome of the outbound and inbound controls depends
+ * on, as they are on the wire: the VXLAN VNI picks the direction, the
+ * inner MACs the ENI, the rest feeds ACL, routing and ca_to_pa.
+ */
+struct flow_cache_key_t {
+    uint32_t sip; /* inner IPv4, network byte order */
+    uint32_t dip;
+    uint16_t sport; /* inner TCP/UDP, network byte order, 0 without */
+    uint16_t dport;
+    uint32_t vni_protocol; /* VXLAN VNI << 8 | inner IP protocol */
+    uint8_t smac[6];       /* inner Ethernet */
+    uint8_t dmac[6];
+
+    bool operator==(const flow_cache_key_t &o) const { return memcmp(this, &o, sizeof(*this)) == 0; }
+};
+
+static_assert(sizeof(flow_cache_key_t) == 28, "no padding, keys compare with memcmp");
+
+/* What the outbound or inbound control decided for a flow */
+struct flow_action_t {
+    direction_t direction;
+    uint16_t eni;
+    bool acl_drop;  /* the ACL drops the flow */
+    bool conntrack; /* a tracked connection: conntrack may let it skip the ACL */
+    bool encap;     /* false when the control returned before vxlan_encap */
+    bool refresh;   /* set by a cache hit: the flow's first in the tick given to lookup() */
+    bool uncached;  /* set by the slow path: conntrack has to see the flow's next packets */
+    vxlan_flow_t vxlan; /* the underlay source is the appliance's, in its vxlan_template_t */
+    uint32_t routing_counter;  /* slots of the routing and ca_to_pa entries the flow hit, 0 for none */
+    uint32_t ca_to_pa_counter;
+    uint32_t generation; /* set by the slow path: its ENI's generation plus, outbound, its destination's */
+};
+
+/*
+ * Fast path flow cache: the action the slow path computed for each flow,
+ * so the following packets of the flow skip the table lookups.
+ *
+ * Each action is tagged with the generations of the switch tables it was
+ * computed from (sirius_generations): the global one, the ENI's and, for
+ * outbound flows, the destination's. A lookup compares the tag with the
+ * one the flow's ENI and destination have now and misses on a change, so
+ * a table change invalidates the flows that read it without touching
+ * the cache, and leaves the others alone.
+ *
+ * An entry is one cache line: key and packed action, with the flow's
+ * fields of vxlan_encap as they go on the wire. The underlay source MAC
+ * and IP are the appliance's for every flow, so they stay in its encap
+ * template. Every flow can be
+ * in either of two sets of four entries and goes into the emptier one.
+ * Next to the entries, each set has a 64 bit word of 16 bit tags, one
+ * per entry, taken from the hash of the flow's 5-tuple; a lookup reads the tag words of
+ * both sets and only the entries whose tag matches, so a hit usually
+ * costs one entry line however full the sets are.
+ *
+ * When both sets of a new flow are full, an insert first makes room by
+ * moving flows to their other set (cuckoo hashing, at most three moves
+ * deep) while the cache holds fewer flows than its capacity. Otherwise
+ * the first entry that was not hit since the reference bits were last
+ * cleared is replaced (not recently used), or, when all were, the bits
+ * are cleared and the first one is.
+ *
+ * A cache belongs to one worker, it has no locks. The entry array is a
+ * sirius_mapping: on default pages the capacity costs memory only as
+ * sets get used.
+ */
+class sirius_flow_cache {
+public:
+    /* Flows the cache is sized for */
+    static constexpr size_t DEFAULT_CAPACITY = 50000000;
+
+    explicit sirius_flow_cache(const sirius_generations &generations, size_t capacity = DEFAULT_CAPACITY,
+                               const memory_placement_t &placement = {});
+
+    sirius_flow_cache(const sirius_flow_cache &) = delete;
+    sirius_flow_cache &operator=(const sirius_flow_cache &) = delete;
+
+    /* Where the entry of a flow can be, worked out ahead of the lookup */
+    struct probe_t {
+        size_t sets[2];
+        uint16_t tag;
+    };
+
+    /*
+     * Bursts look up in three passes, so the misses of one packet overlap
+     * those of the others: probe() prefetches the tag words of a flow's
+     * sets, prefetch() the entries whose tags match, lookup() reads them.
+     */
+    void probe(const flow_cache_key_t &key, probe_t &p) const
+    {
+        uint64_t hash = key_hash(key);
+        p.sets[0] = first_set(hash);
+        p.sets[1] = second_set(hash);
+        p.tag = key_tag(hash);
+        __builtin_prefetch(&m_tags[p.sets[0]]);
+        __builtin_prefetch(&m_tags[p.sets[1]]);
+    }
+
+    void prefetch(const probe_t &p) const
+    {
+        for (size_t set : p.sets) {
+            for (uint64_t match = matches(set, p.tag); match; match &= match - 1) {
+                __builtin_prefetch(&m_sets[set].entries[__builtin_ctzll(match) / 16]);
+            }
+        }
+    }
+
+    /*
+     * `generation` is the global generation, read before the tables like
+     * the others. `tick` is the aging clock of the connection table
+     * (sirius_flow_table), so the connections of cache hits are kept
+     * alive once per tick, not once per packet.
+     */
+    bool lookup(const flow_cache_key_t &key, const probe_t &p, uint32_t generation, uint16_t tick,
+                flow_action_t &action)
+    {
+        entry_t *entry = find(p.sets[0], p.tag, key, generation);
+        if (!entry) {
+            entry = find(p.sets[1], p.tag, key, generation);
+        }
+        if (!entry) {
+            return false;
+        }
+        if (!(entry->flags & FLAG_REF)) {
+            entry->flags |= FLAG_REF;
+        }
+        entry->get(action);
+        action.refresh = entry->refreshed != tick;
+        if (action.refresh) {
+            entry->refreshed = tick;
+        }
+        return true;
+    }
+
+    bool lookup(const flow_cache_key_t &key, uint32_t generation, uint16_t tick, flow_action_t &action)
+    {
+        probe_t p;
+        probe(key, p);
+        return lookup(key, p, generation, tick, action);
+    }
+
+    void insert(const flow_cache_key_t &key, uint32_t generation, const flow_action_t &action);
+
+    /* Drops the flow, so its next packet takes the slow path */
+    void erase(const flow_cache_key_t &key);
+
+    /*
+     * Encaps the outbound flows of a connection, whatever their VNI and
+     * MACs, to underlay_dip from now on (sirius_flow_fixup.h); 0 drops
+     * them instead. Returns how many there were.
+     */
+    unsigned redirect(const flow_key_t &connection, ipv4_addr_t underlay_dip);
+
+    /* Bytes of the entry and tag arrays */
+    size_t memory() const { return m_set_count * (sizeof(set_t) + sizeof(uint64_t)); }
+
+private:
+    static constexpr unsigned SET_WAYS = 4;
+
+    enum : uint8_t {
+        FLAG_ACL_DROP = 1 << 0,
+        FLAG_CONNTRACK = 1 << 1,
+        FLAG_ENCAP = 1 << 2,
+        FLAG_REF = 1 << 3,      /* hit since the bits of its set were cleared */
+        FLAG_OUTBOUND = 1 << 4, /* direction, inbound when clear */
+    };
+
+    struct alignas(64) entry_t {
+        flow_cache_key_t key;
+        uint32_t generation; /* tag of the generations it was computed under, 0: empty */
+        vxlan_flow_t vxlan;
+        uint8_t flags;
+        uint16_t eni;
+        uint16_t refreshed; /* tick of the last hit */
+        uint8_t routing_counter[3]; /* little endian, the tables have fewer than 2^24 slots */
+        uint8_t ca_to_pa_counter[3];
+
+        void set(const flow_cache_key_t &k, uint32_t gen, const flow_action_t &action);
+        void get(flow_action_t &action) const;
+    };
+
+    static_assert(sizeof(entry_t) == 64, "an entry is one cache line");
+
+    struct set_t {
+        entry_t entries[SET_WAYS];
+    };
+
+    /* Bit 16 i + 15 set where entry i of the set has tag, or rarely next to one that does */
+    uint64_t matches(size_t set, uint16_t tag) const
+    {
+        /* Lanes equal to tag are zero after the xor */
+        uint64_t lanes = m_tags[set] ^ (tag * 0x0001000100010001ULL);
+        return (lanes - 0x0001000100010001ULL) & ~lanes & 0x8000800080008000ULL;
+    }
+
+    entry_t *find(size_t set, uint16_t tag, const flow_cache_key_t &key, uint32_t generation)
+    {
+        for (uint64_t match = matches(set, tag); match; match &= match - 1) {
+            entry_t &entry = m_sets[set].entries[__builtin_ctzll(match) / 16];
+            if (entry.key == key && live(entry, generation)) {
+                return &entry;
+            }
+        }
+        return nullptr;
+    }
+
+    /*
+     * Of the 5-tuple alone, and the same both ways, so that all flows of
+     * a connection share their sets. Seeded apart from
+     * sirius_dataplane::flow_hash(), whose upper bits picked the worker.
+     */
+    static uint64_t tuple_hash(uint32_t sip, uint32_t dip, uint16_t sport, uint16_t dport, uint8_t protocol)
+    {
+        uint64_t addrs = sip < dip ? (uint64_t)sip << 32 | dip : (uint64_t)dip << 32 | sip;
+        uint32_t ports = sport < dport ? (uint32_t)sport << 16 | dport : (uint32_t)dport << 16 | sport;
+        return hash_mix(addrs ^ hash_mix((uint64_t)ports << 8 | protocol) ^ 0x9e3779b97f4a7c15ULL);
+    }
+
+    static uint64_t key_hash(const flow_cache_key_t &key)
+    {
+        return tuple_hash(key.sip, key.dip, key.sport, key.dport, (uint8_t)key.vni_protocol);
+    }
+
+    /* Never 0, the tag of an empty entry */
+    static uint16_t key_tag(uint64_t hash) { return (uint16_t)((hash * 0x9e3779b97f4a7c15ULL) >> 48) | 1; }
+
+    /* Maps a 32 bit hash onto the sets without a division */
+    size_t range(uint32_t h) const { return (size_t)((uint64_t)h * m_set_count >> 32); }
+    size_t first_set(uint64_t hash) const { return range((uint32_t)hash); }
+
+    size_t second_set(uint64_t hash) const
+    {
+        size_t s = range((uint32_t)(hash >> 32));
+        return s != first_set(hash) ? s : (s + 1) % m_set_count;
+    }
+
+    /* Whether the entry holds a flow whose tables did not change since, under global generation `generation` */
+    bool live(const entry_t &entry, uint32_t generation) const
+    {
+        uint32_t sum = generation + m_generations.eni(entry.eni);
+        if (entry.flags & FLAG_OUTBOUND) {
+            sum += m_generations.dip(ntohl(entry.key.dip));
+        }
+        return entry.generation == sirius_generations::tag(sum);
+    }
+
+    int free_way(size_t set) const;
+    void write(size_t set, unsigned way, const entry_t &entry, uint16_t tag);
+    int relocate(size_t set, size_t from, unsigned depth);
+
+    const sirius_generations &m_generations;
+    size_t m_capacity;
+    size_t m_set_count;
+    sirius_mapping m_memory;
+    set_t *m_sets;
+    uint64_t *m_tags;        /* 16 bit tag of entry i of a set in bits [16 i, 16 i + 16) */
+    uint32_t m_generation{}; /* global generation of the last insert */
+    size_t m_count{};        /* flows since m_generation; a change of an ENI or destination leaves its own in */
+};
+
+} // namespace sirius
+
+#endif /* _SIRIUS_FLOW_CACHE_H_ */
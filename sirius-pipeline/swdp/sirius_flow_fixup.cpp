@@ -0,0 +1,174 @@
+#include "sirius_flow_fixup.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "sirius_checksum.h"
+#include "sirius_conntrack.h"
+#include "sirius_pipeline.h"
+
+namespace sirius {
+
+namespace {
+
+/* Not 0/8, loopback, multicast or the reserved and broadcast addresses above */
+bool unicast(ipv4_addr_t addr)
+{
+    return addr >> 24 != 0 && addr >> 24 != 127 && addr < 0xe0000000;
+}
+
+} // namespace
+
+bool icmp_redirect_parse(const ipv4_t *ip, const uint8_t *end, icmp_redirect_t &redirect)
+{
+    const uint8_t *l3 = reinterpret_cast<const uint8_t *>(ip);
+    if (ip->protocol != ICMP_PROTO || ip->ihl() < 5 || (ntohs(ip->flags_frag_offset) & 0x3fff) ||
+        l3 + ntohs(ip->total_len) > end) {
+        return false;
+    }
+    /* Ethernet padding is not part of the message */
+    end = l3 + ntohs(ip->total_len);
+    const uint8_t *l4 = l3 + ip->ihl() * 4;
+    if (end - l4 < ICMP_HDR_SIZE + IPV4_HDR_SIZE) {
+        return false;
+    }
+
+    auto icmp = reinterpret_cast<const icmp_t *>(l4);
+    auto orig = reinterpret_cast<const ipv4_t *>(l4 + ICMP_HDR_SIZE);
+    const uint8_t *ports = reinterpret_cast<const uint8_t *>(orig) + orig->ihl() * 4;
+    if (icmp->type != ICMP_TYPE_REDIRECT || icmp->code > 3 || orig->version() != 4 || orig->ihl() < 5 ||
+        ports + 4 > end || (orig->protocol != TCP_PROTO && orig->protocol != UDP_PROTO) ||
+        checksum(l4, (size_t)(end - l4)) != 0) {
+        return false;
+    }
+
+    redirect.gateway = ntohl(icmp->rest_of_header);
+    redirect.sip = orig->src_addr;
+    redirect.dip = orig->dst_addr;
+    memcpy(&redirect.sport, ports, 2);
+    memcpy(&redirect.dport, ports + 2, 2);
+    redirect.protocol = orig->protocol;
+    return unicast(redirect.gateway);
+}
+
+flow_fixup_cache::flow_fixup_cache(size_t capacity) : m_sets(std::max<size_t>(capacity / 3, 1)) {}
+
+flow_fixup_cache::set_t &flow_fixup_cache::set_of(const flow_key_t &key)
+{
+    return m_sets[flow_key_hash(key) % m_sets.size()];
+}
+
+const flow_fixup_cache::set_t &flow_fixup_cache::set_of(const flow_key_t &key) const
+{
+    return m_sets[flow_key_hash(key) % m_sets.size()];
+}
+
+bool flow_fixup_cache::get(const flow_key_t &key, ipv4_addr_t &pa) const
+{
+    if (!m_count) {
+        return false;
+    }
+    for (const entry_t &e : set_of(key).ways) {
+        if (e.pa && e.key == key) {
+            pa = e.pa;
+            return true;
+        }
+    }
+    return false;
+}
+
+void flow_fixup_cache::set(const flow_key_t &key, ipv4_addr_t pa)
+{
+    set_t &set = set_of(key);
+    entry_t *entry = nullptr;
+    for (entry_t &e : set.ways) {
+        if (e.pa && e.key == key) {
+            entry = &e;
+            break;
+        }
+    }
+    if (!entry) {
+        /* An empty way, else the one the key's hash picks */
+        for (entry_t &e : set.ways) {
+            if (!e.pa) {
+                entry = &e;
+                break;
+            }
+        }
+        if (entry) {
+            m_count++;
+        } else {
+            entry = &set.ways[(flow_key_hash(key) >> 32) % 3];
+        }
+        entry->key = key;
+    }
+    entry->pa = pa;
+}
+
+bool flow_fixup_cache::erase(const flow_key_t &key)
+{
+    if (!m_count) {
+        return false;
+    }
+    for (entry_t &e : set_of(key).ways) {
+        if (e.pa && e.key == key) {
+            e.pa = 0;
+            m_count--;
+            return true;
+        }
+    }
+    return false;
+}
+
+void sirius_pipeline::redirect(const packet_t &pkt, const headers_t &hdr, uint32_t outer_sip)
+{
+    m_fixup_stats.redirects++;
+
+    /* Sent by the VIP to the VM whose packet it redirects */
+    icmp_redirect_t redirect;
+    eni_entry_t eni;
+    if (!icmp_redirect_parse(hdr.ipv4, pkt.data() + pkt.len, redirect) || redirect.sip != hdr.ipv4->dst_addr ||
+        redirect.dip != hdr.ipv4->src_addr ||
+        !m_switch.eni_lookup_to_vm.lookup(mac_from_bytes(hdr.ethernet->dst_addr), eni)) {
+        m_fixup_stats.rejected++;
+        return;
+    }
+
+    /*
+     * A connection of the VM, to a destination it reaches through a tunnel
+     * to another PA, and from the PA of that tunnel: the MUX, not a host
+     * that only knows the 5-tuple
+     */
+    ipv4_addr_t dip = ntohl(redirect.dip);
+    flow_key_t key = conntrack_flow_key(ntohl(redirect.sip), dip, ntohs(redirect.sport), ntohs(redirect.dport),
+                                        redirect.protocol, eni.eni);
+    uint8_t state;
+    routing_entry_t route;
+    ca_to_pa_entry_t mapping;
+    if (!m_flows.lookup(key, state) || !m_switch.routing.lpm(eni.eni, dip, route) ||
+        !m_switch.ca_to_pa.lookup({ (uint16_t)route.dest_vnet_vni, dip }, mapping) ||
+        mapping.underlay_dip != ntohl(outer_sip) || mapping.underlay_dip == redirect.gateway) {
+        m_fixup_stats.rejected++;
+        return;
+    }
+
+    ipv4_addr_t pa;
+    if (m_fixups.get(key, pa) && pa == redirect.gateway) {
+        m_fixup_stats.duplicates++;
+        return;
+    }
+
+    /* The slow path from now on, and the flows of the connection the fast path already has */
+    m_fixups.set(key, redirect.gateway);
+    m_cache.redirect(key, redirect.gateway);
+    m_fixup_stats.applied++;
+}
+
+void sirius_pipeline::unredirect(uint8_t before, const conntrack_flow_t &flow)
+{
+    if (conntrack_opened(before, flow) && m_fixups.erase(flow.key)) {
+        m_cache.redirect(flow.key, 0);
+    }
+}
+
+} // namespace sirius
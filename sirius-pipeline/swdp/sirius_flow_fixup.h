@@ -0,0 +1,113 @@
+#ifndef _SIRIUS_FLOW_FIXUP_H_
+#define _SIRIUS_FLOW_FIXUP_H_
+
+#include <vector>
+
+#include "sirius_flow_table.h"
+#include "sirius_headers.h"
+
+namespace sirius {
+
+/*
+ * Flow fixup of the load balancer fast path
+ * (documentation/load-bal-service/design/load-balancer-v3.md).
+ *
+ * A VM reaches a VIP through the SLB MUX advertising it: ca_to_pa maps
+ * the VIP to the PA of the MUX. Once the MUX picked the DIP of a
+ * connection, it may send the VM an ICMP redirect carrying the PA of the
+ * DIP's host and the headers of the packet it redirects. The pipeline
+ * traps the redirects of inbound traffic instead of delivering them,
+ * checks them against the connection table and the PA of the MUX they
+ * must come from, and from then on encaps the
+ * connection's outbound packets to that PA, so they no longer hairpin
+ * through the MUX. Only the redirected connection moves: other
+ * connections to the VIP may have other DIPs.
+ *
+ * Redirects may come late, twice, or never. One for a PA the connection
+ * already has changes nothing, one for a connection that is gone is
+ * rejected, and a connection opened again goes back to the VIP until the
+ * MUX redirects it again. Redirects are not replicated: after a
+ * switchover, the HA peer sends the connections to the VIP, and the MUX
+ * redirects them again.
+ */
+
+/* What an ICMP redirect says about the packet it redirects */
+struct icmp_redirect_t {
+    ipv4_addr_t gateway; /* host byte order, the PA the connection moves to */
+    uint32_t sip;        /* the redirected packet's, in network byte order */
+    uint32_t dip;
+    uint16_t sport;
+    uint16_t dport;
+    uint8_t protocol; /* TCP or UDP */
+};
+
+/* Whether ip, an IPv4 header within [ip, end), carries an ICMP redirect; nothing else of it is checked */
+inline bool icmp_redirect_type(const ipv4_t *ip, const uint8_t *end)
+{
+    const uint8_t *l4 = reinterpret_cast<const uint8_t *>(ip) + ip->ihl() * 4;
+    return ip->protocol == ICMP_PROTO && l4 < end && *l4 == ICMP_TYPE_REDIRECT;
+}
+
+/*
+ * Parses an ICMP redirect (RFC 792) of a TCP or UDP packet: unfragmented,
+ * long enough for the redirected packet's IPv4 header and ports, with a
+ * correct ICMP checksum and a unicast gateway. False for anything else.
+ */
+bool icmp_redirect_parse(const ipv4_t *ip, const uint8_t *end, icmp_redirect_t &redirect);
+
+/* What became of the redirects a pipeline trapped */
+struct flow_fixup_stats_t {
+    uint64_t redirects;  /* trapped */
+    uint64_t applied;    /* moved a connection to a new PA */
+    uint64_t duplicates; /* for the PA the connection already had */
+    uint64_t rejected;   /* malformed, not from the VIP's MUX, or for no connection this pipeline tracks */
+};
+
+/*
+ * The PA each redirected connection moved to, for the slow path, keyed
+ * like the connection table. The flow cache keeps the PA of the
+ * connection's flows on the fast path.
+ *
+ * Three way sets indexed by the key's hash; a new connection replaces
+ * one of the set's when all are taken, like conntrack_seq_cache. A
+ * connection that lost its entry goes back to the VIP on its next slow
+ * path packet, and the MUX redirects it again.
+ */
+class flow_fixup_cache {
+public:
+    /* Connections the cache is sized for */
+    static constexpr size_t DEFAULT_CAPACITY = 65536;
+
+    explicit flow_fixup_cache(size_t capacity = DEFAULT_CAPACITY);
+
+    /* The PA the connection was redirected to, false if none */
+    bool get(const flow_key_t &key, ipv4_addr_t &pa) const;
+
+    void set(const flow_key_t &key, ipv4_addr_t pa);
+
+    /* False if the connection had no PA */
+    bool erase(const flow_key_t &key);
+
+    /* Connections with a PA */
+    size_t size() const { return m_count; }
+
+private:
+    struct entry_t {
+        flow_key_t key;
+        ipv4_addr_t pa; /* 0: empty */
+    };
+
+    struct alignas(64) set_t {
+        entry_t ways[3];
+    };
+
+    set_t &set_of(const flow_key_t &key);
+    const set_t &set_of(const flow_key_t &key) const;
+
+    std::vector<set_t> m_sets;
+    size_t m_count = 0;
+};
+
+} // namespace sirius
+
+#endif /* _SIRIUS_FLOW_FIXUP_H_ */
@@ -0,0 +1,101 @@
+#include "sirius_flow_sync.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace sirius {
+
+sirius_flow_sync::sirius_flow_sync(sirius_flow_table &flows, send_fn send) : m_flows(flows), m_send(std::move(send))
+{
+    m_batch.reserve(BATCH);
+}
+
+void sirius_flow_sync::poll(size_t buckets)
+{
+    switch (m_request.exchange(REQUEST_NONE, std::memory_order_acquire)) {
+    case REQUEST_PAIR:
+        m_flows.set_color(m_flows.color() + 1);
+        m_paired = true;
+        m_syncing = true;
+        m_cursor = 0;
+        m_pass_flows = 0;
+        m_sync_pair = m_pairs.load(std::memory_order_acquire);
+        m_paired_status.store(true, std::memory_order_release);
+        m_passes.fetch_add(1, std::memory_order_relaxed);
+        break;
+    case REQUEST_UNPAIR:
+        /* The peer is gone, so is what was meant for it */
+        m_paired = false;
+        m_syncing = false;
+        m_batch.clear();
+        m_batch_seen = {};
+        m_paired_status.store(false, std::memory_order_release);
+        break;
+    default:
+        break;
+    }
+
+    if (m_syncing) {
+        /* Batched like the rest; flush() sends them in BATCH sized pieces */
+        size_t found = m_flows.recolor(m_cursor, buckets, [this](const flow_key_t &key, uint8_t state) {
+            m_batch.push_back({ key, (uint8_t)(state & STATE_MASK), FLOW_SYNC_INSERT });
+        });
+        m_pass_flows += found;
+        m_synced_flows.fetch_add(found, std::memory_order_relaxed);
+        m_cursor += buckets;
+
+        if (m_cursor >= m_flows.buckets()) {
+            if (!m_pass_flows) {
+                m_syncing = false;
+                m_synced_pair.store(m_sync_pair, std::memory_order_release);
+            } else {
+                m_cursor = 0;
+                m_pass_flows = 0;
+                m_passes.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    if (m_batch.empty()) {
+        return;
+    }
+    if (m_batch.size() < FLUSH_RECORDS) {
+        auto now = std::chrono::steady_clock::now();
+        if (m_batch_seen == std::chrono::steady_clock::time_point()) {
+            m_batch_seen = now;
+        }
+        if (now - m_batch_seen < FLUSH_DELAY) {
+            return;
+        }
+    }
+    flush();
+}
+
+void sirius_flow_sync::flush()
+{
+    for (size_t sent = 0; sent < m_batch.size(); sent += BATCH) {
+        m_send(m_batch.data() + sent, std::min(BATCH, m_batch.size() - sent));
+    }
+    m_batch.clear();
+    m_batch_seen = {};
+}
+
+void sirius_flow_sync::apply(sirius_flow_table &flows, const flow_sync_record_t *records, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        const flow_sync_record_t &r = records[i];
+        switch (r.op) {
+        case FLOW_SYNC_INSERT:
+            flows.insert(r.key, r.state);
+            break;
+        case FLOW_SYNC_UPDATE:
+            flows.update(r.key, r.state);
+            break;
+        case FLOW_SYNC_REMOVE:
+            flows.remove(r.key);
+            break;
+        }
+    }
+}
+
+} // namespace sirius
@@ -0,0 +1,169 @@
+#ifndef _SIRIUS_FLOW_SYNC_H_
+#define _SIRIUS_FLOW_SYNC_H_
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <vector>
+
+#include "sirius_flow_table.h"
+
+namespace sirius {
+
+enum flow_sync_op_t : uint8_t {
+    FLOW_SYNC_INSERT, /* creates the connection, or sets its state */
+    FLOW_SYNC_UPDATE, /* sets the state of the connection, if the peer has it */
+    FLOW_SYNC_REMOVE, /* removes the connection, if the peer has it */
+};
+
+/* One change of a connection table, as the paired instance applies it */
+struct flow_sync_record_t {
+    flow_key_t key;
+    uint8_t state;
+    flow_sync_op_t op;
+};
+
+/*
+ * HA flow replication of one connection table to the paired instance,
+ * with the "perfect sync" algorithm of high-availability-and-scale.md.
+ *
+ * While paired, every change conntrack makes to the table is sent in
+ * real time (inserted(), updated(), removed()). pair() moves the table to
+ * a new color and starts the bulk sync: poll() walks a slice of the
+ * bucket array at a time and sends the connections of other colors as
+ * inserts, and recolor() gives them the new color. New connections get
+ * the new color and only go out in real time. The peer ignores updates
+ * and removes of connections it does not have, which the sync has not
+ * reached yet or never will as they ended. A cuckoo move can take a
+ * connection of an old color into a bucket the walk already passed, so
+ * the walk starts over until a whole pass finds none; only new
+ * connections move others, so the passes after the first find few.
+ *
+ * Real-time and sync records go to the peer in one stream, in the order
+ * they were made, batched by up to BATCH: the state a sync record carries
+ * is never overtaken by an older one. A batch waits for FLUSH_RECORDS
+ * records, or FLUSH_DELAY after poll() first saw it, so at high rates
+ * each message carries many connections and at low rates none waits long. This needs every change to the
+ * table to go through the same flow sync, so it belongs to the worker
+ * owning the table (or its partition of the connections, in
+ * sirius_dataplane) and runs on its thread. pair() and unpair() may be
+ * called from any thread; they post a request the next poll() carries
+ * out.
+ *
+ * A connection the table evicts to make room for a new one goes out as a
+ * remove ahead of the insert, so the peer frees the same connection
+ * rather than pick one of its own. Colors stay on this side: the peer
+ * gives what it applies its own table's color.
+ */
+class sirius_flow_sync {
+public:
+    /* Hands one batch to the transport, which delivers batches in order */
+    using send_fn = std::function<void(const flow_sync_record_t *records, size_t count)>;
+
+    /* Records per batch */
+    static constexpr size_t BATCH = 512;
+
+    /* Smallest batch poll() sends before it waited FLUSH_DELAY */
+    static constexpr size_t FLUSH_RECORDS = 64;
+    static constexpr std::chrono::microseconds FLUSH_DELAY{ 100 };
+
+    /*
+     * The state bits the peer gets: the two graphs of conntrack_state_t.
+     * How far a TCP connection's close got stays with the instance that
+     * sees its packets.
+     */
+    static constexpr uint8_t STATE_MASK = 0x03;
+
+    /* Buckets poll() walks by default, up to three connections each */
+    static constexpr size_t SYNC_BUCKETS = 64;
+
+    sirius_flow_sync(sirius_flow_table &flows, send_fn send);
+
+    sirius_flow_sync(const sirius_flow_sync &) = delete;
+    sirius_flow_sync &operator=(const sirius_flow_sync &) = delete;
+
+    /* Pairs with the peer (again): a new color, real-time replication and a bulk sync */
+    void pair()
+    {
+        m_pairs.fetch_add(1, std::memory_order_acq_rel);
+        m_request.store(REQUEST_PAIR, std::memory_order_release);
+    }
+
+    /* Stops replicating, the color stays */
+    void unpair() { m_request.store(REQUEST_UNPAIR, std::memory_order_release); }
+
+    bool paired() const { return m_paired_status.load(std::memory_order_acquire); }
+
+    /* The bulk sync of the current pairing is done: the peer has every connection */
+    bool synced() const
+    {
+        uint32_t pairs = m_pairs.load(std::memory_order_acquire);
+        return pairs && m_synced_pair.load(std::memory_order_acquire) == pairs;
+    }
+
+    /* Connections the bulk syncs sent */
+    uint64_t synced_flows() const { return m_synced_flows.load(std::memory_order_relaxed); }
+
+    /* Walks over the whole bucket array the bulk syncs started */
+    uint64_t sync_passes() const { return m_passes.load(std::memory_order_relaxed); }
+
+    /* Data path: the changes conntrack made to the table, evictions as removes */
+    void inserted(const flow_key_t &key, uint8_t state) { record(key, state, FLOW_SYNC_INSERT); }
+    void updated(const flow_key_t &key, uint8_t state) { record(key, state, FLOW_SYNC_UPDATE); }
+    void removed(const flow_key_t &key) { record(key, 0, FLOW_SYNC_REMOVE); }
+
+    /*
+     * Once per burst, on the worker, and now and then when idle: carries
+     * out a posted pair() or unpair(), walks up to `buckets` buckets of a
+     * running bulk sync and sends the batch if it is due.
+     */
+    void poll(size_t buckets = SYNC_BUCKETS);
+
+    /* Sends the batch now, e.g. before a planned switchover */
+    void flush();
+
+    /* The peer's side: applies the records of a batch to its table */
+    static void apply(sirius_flow_table &flows, const flow_sync_record_t *records, size_t count);
+
+private:
+    enum request_t : uint8_t {
+        REQUEST_NONE,
+        REQUEST_PAIR,
+        REQUEST_UNPAIR,
+    };
+
+    void record(const flow_key_t &key, uint8_t state, flow_sync_op_t op)
+    {
+        if (!m_paired) {
+            return;
+        }
+        m_batch.push_back({ key, (uint8_t)(state & STATE_MASK), op });
+        if (m_batch.size() >= BATCH) {
+            flush();
+        }
+    }
+
+    sirius_flow_table &m_flows;
+    send_fn m_send;
+    std::vector<flow_sync_record_t> m_batch;
+    std::chrono::steady_clock::time_point m_batch_seen; /* poll() first saw the batch, or zero */
+
+    /* Worker side */
+    bool m_paired = false;
+    bool m_syncing = false;
+    size_t m_cursor = 0;        /* next bucket of the walk */
+    size_t m_pass_flows = 0;    /* connections the current pass sent */
+    uint32_t m_sync_pair = 0;   /* pair() the running bulk sync is for */
+
+    /* Counts pair() calls, so synced() is false from the call on, not from the next poll() */
+    std::atomic<uint32_t> m_pairs{ 0 };
+    std::atomic<uint32_t> m_synced_pair{ 0 };
+    std::atomic<uint8_t> m_request{ REQUEST_NONE };
+    std::atomic<bool> m_paired_status{ false };
+    std::atomic<uint64_t> m_synced_flows{ 0 };
+    std::atomic<uint64_t> m_passes{ 0 };
+};
+
+} // namespace sirius
+
+#endif /* _SIRIUS_FLOW_SYNC_H_ */
@@ -0,0 +1,338 @@
+#include "sirius_flow_sync_frame.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#ifdef SIRIUS_LZ4
+#include <lz4.h>
+#endif
+
+namespace sirius {
+
+namespace {
+
+/* Record header byte */
+constexpr uint8_t OP_MASK = 0x03;
+constexpr unsigned STATE_SHIFT = 2;
+constexpr uint8_t STATE_MASK = 0x03;
+constexpr uint8_t SAME_ENI = 1 << 4;
+constexpr uint8_t SAME_PROTOCOL = 1 << 5;
+constexpr uint8_t SAME_DIP = 1 << 6;
+constexpr uint8_t SAME_DPORT = 1 << 7;
+
+/* Header, ENI, protocol, two addresses and two ports */
+constexpr size_t MAX_RECORD = 1 + 3 + 1 + 5 + 5 + 3 + 3;
+
+/* Larger sizes in a header are garbage, not a frame to wait for */
+constexpr size_t MAX_FRAME = FLOW_SYNC_FRAME_HEADER + FLOW_SYNC_FRAME_RECORDS * MAX_RECORD;
+
+/* Previous record of each ENI, direct mapped; encoder and decoder keep the same */
+constexpr size_t CONTEXTS = 64;
+
+struct context_t {
+    flow_key_t keys[CONTEXTS];
+
+    context_t() { memset(keys, 0, sizeof(keys)); }
+
+    /* An ENI not seen in the frame yet starts from zeros */
+    flow_key_t &of(uint16_t eni)
+    {
+        flow_key_t &key = keys[eni % CONTEXTS];
+        if (key.eni != eni) {
+            key = {};
+            key.eni = eni;
+        }
+        return key;
+    }
+};
+
+void put_u16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+void put_u32(uint8_t *p, uint32_t v)
+{
+    put_u16(p, (uint16_t)v);
+    put_u16(p + 2, (uint16_t)(v >> 16));
+}
+
+uint16_t get_u16(const uint8_t *p) { return (uint16_t)(p[0] | p[1] << 8); }
+
+uint32_t get_u32(const uint8_t *p) { return get_u16(p) | (uint32_t)get_u16(p + 2) << 16; }
+
+uint8_t *put_varint(uint8_t *p, uint32_t v)
+{
+    while (v >= 0x80) {
+        *p++ = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    *p++ = (uint8_t)v;
+    return p;
+}
+
+bool get_varint(const uint8_t *&p, const uint8_t *end, uint32_t &v)
+{
+    v = 0;
+    for (unsigned shift = 0; shift < 35; shift += 7) {
+        if (p == end) {
+            return false;
+        }
+        uint8_t b = *p++;
+        v |= (uint32_t)(b & 0x7f) << shift;
+        if (!(b & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+uint32_t zigzag(int32_t v) { return (uint32_t)v << 1 ^ (uint32_t)(v >> 31); }
+
+int32_t unzigzag(uint32_t v) { return (int32_t)(v >> 1) ^ -(int32_t)(v & 1); }
+
+/* Deltas of addresses wrap at 32 bits, of ports at 16 */
+uint32_t delta32(uint32_t v, uint32_t base) { return zigzag((int32_t)(v - base)); }
+
+uint32_t delta16(uint16_t v, uint16_t base) { return zigzag((int16_t)(uint16_t)(v - base)); }
+
+size_t encode_records(const flow_sync_record_t *records, size_t count, uint8_t *out)
+{
+    context_t context;
+    uint8_t *p = out;
+    uint16_t eni = 0;
+    for (size_t i = 0; i < count; i++) {
+        const flow_sync_record_t &r = records[i];
+        flow_key_t &prev = context.of(r.key.eni);
+
+        uint8_t *hdr = p++;
+        *hdr = (uint8_t)(r.op | r.state << STATE_SHIFT);
+        if (i && r.key.eni == eni) {
+            *hdr |= SAME_ENI;
+        } else {
+            p = put_varint(p, r.key.eni);
+        }
+        if (r.key.protocol == prev.protocol) {
+            *hdr |= SAME_PROTOCOL;
+        } else {
+            *p++ = r.key.protocol;
+        }
+        p = put_varint(p, delta32(r.key.sip, prev.sip));
+        if (r.key.dip == prev.dip) {
+            *hdr |= SAME_DIP;
+        } else {
+            p = put_varint(p, delta32(r.key.dip, prev.dip));
+        }
+        p = put_varint(p, delta16(r.key.sport, prev.sport));
+        if (r.key.dport == prev.dport) {
+            *hdr |= SAME_DPORT;
+        } else {
+            p = put_varint(p, delta16(r.key.dport, prev.dport));
+        }
+
+        prev = r.key;
+        eni = r.key.eni;
+    }
+    return (size_t)(p - out);
+}
+
+bool decode_records(const uint8_t *p, const uint8_t *end, size_t count, std::vector<flow_sync_record_t> &records)
+{
+    context_t context;
+    uint16_t eni = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (p == end) {
+            return false;
+        }
+        uint8_t hdr = *p++;
+        flow_sync_record_t r;
+        r.op = (flow_sync_op_t)(hdr & OP_MASK);
+        r.state = (uint8_t)(hdr >> STATE_SHIFT & STATE_MASK);
+        if (r.op > FLOW_SYNC_REMOVE) {
+            return false;
+        }
+
+        uint32_t v;
+        if (hdr & SAME_ENI) {
+            if (!i) {
+                return false;
+            }
+        } else {
+            if (!get_varint(p, end, v) || v > UINT16_MAX) {
+                return false;
+            }
+            eni = (uint16_t)v;
+        }
+        flow_key_t &prev = context.of(eni);
+        r.key.eni = eni;
+
+        if (hdr & SAME_PROTOCOL) {
+            r.key.protocol = prev.protocol;
+        } else {
+            if (p == end) {
+                return false;
+            }
+            r.key.protocol = *p++;
+        }
+        if (!get_varint(p, end, v)) {
+            return false;
+        }
+        r.key.sip = prev.sip + (uint32_t)unzigzag(v);
+        if (hdr & SAME_DIP) {
+            r.key.dip = prev.dip;
+        } else {
+            if (!get_varint(p, end, v)) {
+                return false;
+            }
+            r.key.dip = prev.dip + (uint32_t)unzigzag(v);
+        }
+        if (!get_varint(p, end, v)) {
+            return false;
+        }
+        r.key.sport = (uint16_t)(prev.sport + unzigzag(v));
+        if (hdr & SAME_DPORT) {
+            r.key.dport = prev.dport;
+        } else {
+            if (!get_varint(p, end, v)) {
+                return false;
+            }
+            r.key.dport = (uint16_t)(prev.dport + unzigzag(v));
+        }
+
+        prev = r.key;
+        records.push_back(r);
+    }
+    return p == end;
+}
+
+} // namespace
+
+bool flow_sync_frame_lz4()
+{
+#ifdef SIRIUS_LZ4
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool flow_sync_frame_encode(const flow_sync_record_t *records, size_t count, bool lz4, std::vector<uint8_t> &frame)
+{
+    if (count > FLOW_SYNC_FRAME_RECORDS) {
+        return false;
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (records[i].state & ~STATE_MASK || records[i].op > FLOW_SYNC_REMOVE) {
+            return false;
+        }
+    }
+
+    size_t start = frame.size();
+    frame.resize(start + FLOW_SYNC_FRAME_HEADER + count * MAX_RECORD);
+    uint8_t *body = frame.data() + start + FLOW_SYNC_FRAME_HEADER;
+    size_t raw_length = encode_records(records, count, body);
+    size_t length = raw_length;
+    uint8_t flags = 0;
+
+#ifdef SIRIUS_LZ4
+    if (lz4 && raw_length) {
+        std::vector<uint8_t> compressed((size_t)LZ4_compressBound((int)raw_length));
+        int n = LZ4_compress_default((const char *)body, (char *)compressed.data(), (int)raw_length,
+                                     (int)compressed.size());
+        if (n > 0 && (size_t)n < raw_length) {
+            memcpy(body, compressed.data(), (size_t)n);
+            length = (size_t)n;
+            flags |= FLOW_SYNC_FRAME_LZ4;
+        }
+    }
+#else
+    (void)lz4;
+#endif
+
+    uint8_t *hdr = frame.data() + start;
+    hdr[0] = FLOW_SYNC_FRAME_VERSION;
+    hdr[1] = flags;
+    put_u16(hdr + 2, (uint16_t)count);
+    put_u32(hdr + 4, (uint32_t)length);
+    put_u32(hdr + 8, (uint32_t)raw_length);
+    frame.resize(start + FLOW_SYNC_FRAME_HEADER + length);
+    return true;
+}
+
+size_t flow_sync_frame_size(const uint8_t *data, size_t len)
+{
+    return len < FLOW_SYNC_FRAME_HEADER ? 0 : FLOW_SYNC_FRAME_HEADER + get_u32(data + 4);
+}
+
+bool flow_sync_frame_decode(const uint8_t *data, size_t len, std::vector<flow_sync_record_t> &records)
+{
+    if (len < FLOW_SYNC_FRAME_HEADER || data[0] != FLOW_SYNC_FRAME_VERSION) {
+        return false;
+    }
+    uint8_t flags = data[1];
+    size_t count = get_u16(data + 2);
+    size_t length = get_u32(data + 4);
+    size_t raw_length = get_u32(data + 8);
+    if (count > FLOW_SYNC_FRAME_RECORDS || raw_length > count * MAX_RECORD ||
+        length != len - FLOW_SYNC_FRAME_HEADER || flags & ~FLOW_SYNC_FRAME_LZ4) {
+        return false;
+    }
+
+    const uint8_t *body = data + FLOW_SYNC_FRAME_HEADER;
+    if (!(flags & FLOW_SYNC_FRAME_LZ4)) {
+        return length == raw_length && decode_records(body, body + length, count, records);
+    }
+
+#ifdef SIRIUS_LZ4
+    std::vector<uint8_t> raw(raw_length);
+    if (LZ4_decompress_safe((const char *)body, (char *)raw.data(), (int)length, (int)raw_length) !=
+        (int)raw_length) {
+        return false;
+    }
+    return decode_records(raw.data(), raw.data() + raw_length, count, records);
+#else
+    return false;
+#endif
+}
+
+sirius_flow_sync::send_fn flow_sync_frame_sender(std::function<void(const uint8_t *data, size_t len)> write,
+                                                 bool lz4)
+{
+    return [write = std::move(write), lz4, frame = std::vector<uint8_t>()](const flow_sync_record_t *records,
+                                                                         size_t count) mutable {
+        for (size_t sent = 0; sent < count; sent += FLOW_SYNC_FRAME_RECORDS) {
+            /* Conntrack states always fit the format */
+            frame.clear();
+            flow_sync_frame_encode(records + sent, std::min(FLOW_SYNC_FRAME_RECORDS, count - sent), lz4, frame);
+            write(frame.data(), frame.size());
+        }
+    };
+}
+
+bool flow_sync_frame_receiver::receive(const uint8_t *data, size_t len)
+{
+    if (m_failed) {
+        return false;
+    }
+    m_pending.insert(m_pending.end(), data, data + len);
+
+    size_t used = 0, size;
+    while ((size = flow_sync_frame_size(m_pending.data() + used, m_pending.size() - used)) &&
+           (size > MAX_FRAME || size <= m_pending.size() - used)) {
+        m_records_buf.clear();
+        if (size > MAX_FRAME || !flow_sync_frame_decode(m_pending.data() + used, size, m_records_buf)) {
+            m_failed = true;
+            return false;
+        }
+        sirius_flow_sync::apply(m_flows, m_records_buf.data(), m_records_buf.size());
+        m_frames++;
+        m_records += m_records_buf.size();
+        used += size;
+    }
+    m_pending.erase(m_pending.begin(), m_pending.begin() + used);
+    return true;
+}
+
+} // namespace sirius
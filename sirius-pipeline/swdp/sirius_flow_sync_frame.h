@@ -0,0 +1,89 @@
+#ifndef _SIRIUS_FLOW_SYNC_FRAME_H_
+#define _SIRIUS_FLOW_SYNC_FRAME_H_
+
+#include <functional>
+#include <vector>
+
+#include "sirius_flow_sync.h"
+
+namespace sirius {
+
+/*
+ * Wire format of flow sync records between HA peers: one frame per batch
+ * of up to FLOW_SYNC_FRAME_RECORDS records, real-time and bulk sync alike.
+ *
+ * A frame is a 12 byte header, little endian:
+ *
+ *     uint8_t  version     FLOW_SYNC_FRAME_VERSION
+ *     uint8_t  flags       FLOW_SYNC_FRAME_LZ4
+ *     uint16_t records
+ *     uint32_t length      bytes of the body that follows
+ *     uint32_t raw_length  bytes of the body before compression
+ *
+ * and the records in order, each delta-encoded against the previous
+ * record of its ENI in the frame: the ENI stands for the VNET (the key
+ * has no VNI), whose connections share the destination port, often the
+ * destination and have nearby source addresses. A record is one byte of
+ * op (2 bits), state (2 bits) and four flags for the ENI, protocol,
+ * destination address and destination port being the same, then what
+ * differs: the ENI, the protocol byte and zigzag varints of the address
+ * and port deltas. A conntrack record of VM traffic takes about 10 bytes
+ * instead of the 20 of flow_sync_record_t.
+ *
+ * States are the two conntrack_state_t bits. Built with SIRIUS_LZ4 (and
+ * liblz4), frames may compress the body with LZ4 when it shrinks it;
+ * without, encode ignores the request and decode rejects LZ4 frames.
+ */
+constexpr uint8_t FLOW_SYNC_FRAME_VERSION = 1;
+constexpr uint8_t FLOW_SYNC_FRAME_LZ4 = 1 << 0;
+constexpr size_t FLOW_SYNC_FRAME_HEADER = 12;
+constexpr size_t FLOW_SYNC_FRAME_RECORDS = sirius_flow_sync::BATCH;
+
+/* Whether this build compresses frames */
+bool flow_sync_frame_lz4();
+
+/*
+ * Appends the frame of records[0, count) to frame, count up to
+ * FLOW_SYNC_FRAME_RECORDS. False for states the format does not carry.
+ */
+bool flow_sync_frame_encode(const flow_sync_record_t *records, size_t count, bool lz4, std::vector<uint8_t> &frame);
+
+/* Size of the frame at data, 0 while len holds less than its header */
+size_t flow_sync_frame_size(const uint8_t *data, size_t len);
+
+/* Appends the records of one whole frame to records; false if the frame is malformed */
+bool flow_sync_frame_decode(const uint8_t *data, size_t len, std::vector<flow_sync_record_t> &records);
+
+/*
+ * A send_fn for sirius_flow_sync that encodes each batch into a frame and
+ * hands it to write, e.g. a write() to a stream socket.
+ */
+sirius_flow_sync::send_fn flow_sync_frame_sender(std::function<void(const uint8_t *data, size_t len)> write,
+                                                 bool lz4);
+
+/*
+ * The peer's side of a stream of frames: takes the bytes as they arrive
+ * and applies every complete frame to the table.
+ */
+class flow_sync_frame_receiver {
+public:
+    explicit flow_sync_frame_receiver(sirius_flow_table &flows) : m_flows(flows) {}
+
+    /* False once a malformed frame arrived; the stream cannot be resynchronized */
+    bool receive(const uint8_t *data, size_t len);
+
+    uint64_t frames() const { return m_frames; }
+    uint64_t records() const { return m_records; }
+
+private:
+    sirius_flow_table &m_flows;
+    std::vector<uint8_t> m_pending;
+    std::vector<flow_sync_record_t> m_records_buf;
+    uint64_t m_frames = 0;
+    uint64_t m_records = 0;
+    bool m_failed = false;
+};
+
+} // namespace sirius
+
+#endif /* _SIRIUS_FLOW_SYNC_FRAME_H_ */
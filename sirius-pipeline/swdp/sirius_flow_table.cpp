@@ -0,0 +1,266 @@
+#include "sirius_flow_table.h"
+
+#include <algorithm>
+#include <initializer_list>
+
+namespace sirius {
+
+namespace {
+
+/* Share of the slots `capacity` connections fill */
+constexpr double TARGET_LOAD = 0.9;
+
+/* bucket_t::used with all three slots taken */
+constexpr uint8_t FULL = 0x7;
+
+/* Moves an insert may chain to make room before it evicts */
+constexpr unsigned RELOCATE_DEPTH = 3;
+
+} // namespace
+
+sirius_flow_table::sirius_flow_table(size_t capacity, const memory_placement_t &placement)
+    : m_capacity(capacity),
+      m_bucket_count(std::max<size_t>((size_t)(capacity / (BUCKET_SLOTS * TARGET_LOAD)) + 1, 2)),
+      m_memory(memory(), placement), m_buckets(static_cast<bucket_t *>(m_memory.data()))
+{
+    /* Zero pages are empty buckets */
+}
+
+bool sirius_flow_table::place(const memory_placement_t &placement)
+{
+    if (size()) {
+        return false;
+    }
+    m_memory = sirius_mapping(memory(), placement);
+    m_buckets = static_cast<bucket_t *>(m_memory.data());
+    return true;
+}
+
+bool sirius_flow_table::try_lock(bucket_t &bucket)
+{
+    uint32_t seq = bucket.seq.load(std::memory_order_relaxed);
+    if ((seq & 1) || !bucket.seq.compare_exchange_strong(seq, seq + 1, std::memory_order_acquire)) {
+        return false;
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    return true;
+}
+
+void sirius_flow_table::unlock(bucket_t &bucket)
+{
+    bucket.seq.store(bucket.seq.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+/* Takes both buckets of a key, in index order so two writers cannot deadlock */
+void sirius_flow_table::lock(size_t first, size_t second)
+{
+    for (size_t b : { std::min(first, second), std::max(first, second) }) {
+        while (!try_lock(m_buckets[b])) {
+        }
+    }
+}
+
+void sirius_flow_table::unlock(size_t first, size_t second)
+{
+    unlock(m_buckets[first]);
+    unlock(m_buckets[second]);
+}
+
+void sirius_flow_table::write_slot(bucket_t &bucket, unsigned i, const flow_key_t &key, uint8_t state,
+                                   uint8_t mark, uint16_t seen)
+{
+    bucket.slots[i] = { key.sip, key.dip, key.sport, key.dport, key.eni, key.protocol, state };
+    bucket.mark[i] = mark;
+    bucket.seen[i].store(seen, std::memory_order_relaxed);
+    bucket.used |= (uint8_t)(1u << i);
+    bucket.ref.fetch_and((uint8_t)~(1u << i), std::memory_order_relaxed);
+}
+
+/*
+ * Frees a slot of the full bucket b by moving one of its connections to
+ * its other bucket, first making room there the same way, up to `depth`
+ * moves deep. Buckets are only tried, not waited for, as the caller
+ * already holds some; one this insert holds fails the try, which also
+ * keeps the search off its own path. Each copy is written before the
+ * original is cleared, and lookups recheck the first bucket after a miss
+ * in the second, so a moved connection never looks absent.
+ */
+int sirius_flow_table::relocate(size_t b, unsigned depth)
+{
+    bucket_t &from = m_buckets[b];
+    for (unsigned i = 0; i < BUCKET_SLOTS; i++) {
+        const slot_t &s = from.slots[i];
+        flow_key_t key = { s.sip, s.dip, s.sport, s.dport, s.eni, s.protocol };
+        uint64_t hash = flow_key_hash(key);
+        size_t alt = b == first_bucket(hash) ? second_bucket(hash) : first_bucket(hash);
+
+        bucket_t &to = m_buckets[alt];
+        if (!try_lock(to)) {
+            continue;
+        }
+        int j = to.used != FULL ? __builtin_ctz(~(unsigned)to.used) : -1;
+        if (j < 0 && depth > 1) {
+            j = relocate(alt, depth - 1);
+        }
+        if (j >= 0) {
+            write_slot(to, (unsigned)j, key, s.state, from.mark[i], from.seen[i].load(std::memory_order_relaxed));
+            if (from.ref.load(std::memory_order_relaxed) & 1u << i) {
+                to.ref.fetch_or((uint8_t)(1u << j), std::memory_order_relaxed);
+            }
+            from.used &= (uint8_t)~(1u << i);
+        }
+        unlock(to);
+        if (j >= 0) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+/* CLOCK over the six slots of both buckets, the hand is kept in the first one; returns the evicted key */
+flow_key_t sirius_flow_table::evict(bucket_t &first, bucket_t &second, const flow_key_t &key, uint8_t state,
+                                    uint8_t mark, uint16_t seen)
+{
+    unsigned hand = first.hand % (2 * BUCKET_SLOTS);
+
+    /* Clears at most six reference bits, so it stops within two turns */
+    for (;;) {
+        bucket_t &bucket = hand < BUCKET_SLOTS ? first : second;
+        unsigned i = hand % BUCKET_SLOTS;
+        uint8_t bit = (uint8_t)(1u << i);
+        hand = (hand + 1) % (2 * BUCKET_SLOTS);
+
+        if (bucket.ref.load(std::memory_order_relaxed) & bit) {
+            bucket.ref.fetch_and((uint8_t)~bit, std::memory_order_relaxed);
+            continue;
+        }
+        const slot_t &s = bucket.slots[i];
+        flow_key_t evicted = { s.sip, s.dip, s.sport, s.dport, s.eni, s.protocol };
+        write_slot(bucket, i, key, state, mark, seen);
+        first.hand = (uint8_t)hand;
+        return evicted;
+    }
+}
+
+bool sirius_flow_table::insert(const flow_key_t &key, uint8_t state, flow_key_t *evicted)
+{
+    uint64_t hash = flow_key_hash(key);
+    size_t b1 = first_bucket(hash);
+    size_t b2 = second_bucket(hash);
+    bucket_t &first = m_buckets[b1];
+    bucket_t &second = m_buckets[b2];
+    uint16_t tick = this->tick();
+    uint8_t mark = (uint8_t)(color() | tick % TOKENS << TOKEN_SHIFT);
+    lock(b1, b2);
+
+    bool evicts = false;
+    int slot;
+    if ((slot = first.find(key)) >= 0) {
+        first.slots[slot].state = state;
+    } else if ((slot = second.find(key)) >= 0) {
+        second.slots[slot].state = state;
+    } else if (first.used != FULL || second.used != FULL) {
+        /* The emptier bucket, the first one on a tie so most hits read one line */
+        bucket_t &bucket = __builtin_popcount(second.used) < __builtin_popcount(first.used) ? second : first;
+        write_slot(bucket, (unsigned)__builtin_ctz(~(unsigned)bucket.used), key, state, mark, tick);
+        m_count.fetch_add(1, std::memory_order_relaxed);
+    } else if (m_count.load(std::memory_order_relaxed) < m_capacity && (slot = relocate(b1, RELOCATE_DEPTH)) >= 0) {
+        write_slot(first, (unsigned)slot, key, state, mark, tick);
+        m_count.fetch_add(1, std::memory_order_relaxed);
+    } else if (m_count.load(std::memory_order_relaxed) < m_capacity && (slot = relocate(b2, RELOCATE_DEPTH)) >= 0) {
+        write_slot(second, (unsigned)slot, key, state, mark, tick);
+        m_count.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        flow_key_t victim = evict(first, second, key, state, mark, tick);
+        if (evicted) {
+            *evicted = victim;
+        }
+        evicts = true;
+        m_evictions.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    unlock(b1, b2);
+    return evicts;
+}
+
+bool sirius_flow_table::update(const flow_key_t &key, uint8_t state)
+{
+    uint64_t hash = flow_key_hash(key);
+    size_t b1 = first_bucket(hash);
+    size_t b2 = second_bucket(hash);
+    lock(b1, b2);
+
+    bool found = false;
+    for (size_t b : { b1, b2 }) {
+        int slot = m_buckets[b].find(key);
+        if (slot >= 0) {
+            m_buckets[b].slots[slot].state = state;
+            found = true;
+            break;
+        }
+    }
+
+    unlock(b1, b2);
+    return found;
+}
+
+bool sirius_flow_table::remove(const flow_key_t &key)
+{
+    uint64_t hash = flow_key_hash(key);
+    size_t b1 = first_bucket(hash);
+    size_t b2 = second_bucket(hash);
+    lock(b1, b2);
+
+    bool found = false;
+    for (size_t b : { b1, b2 }) {
+        int slot = m_buckets[b].find(key);
+        if (slot >= 0) {
+            m_buckets[b].used &= (uint8_t)~(1u << slot);
+            m_count.fetch_sub(1, std::memory_order_relaxed);
+            found = true;
+            break;
+        }
+    }
+
+    unlock(b1, b2);
+    return found;
+}
+
+sirius_flow_table::age_t sirius_flow_table::age(const flow_key_t &key, uint8_t &token, uint16_t timeout,
+                                                uint16_t &idle)
+{
+    uint64_t hash = flow_key_hash(key);
+    size_t b1 = first_bucket(hash);
+    size_t b2 = second_bucket(hash);
+    uint16_t tick = this->tick();
+    lock(b1, b2);
+
+    age_t age = AGE_GONE;
+    for (size_t b : { b1, b2 }) {
+        bucket_t &bucket = m_buckets[b];
+        int slot = bucket.find(key);
+        if (slot < 0) {
+            continue;
+        }
+        /* A timer left behind when the connection ended and came back owns nothing */
+        if (bucket.mark[slot] >> TOKEN_SHIFT != token) {
+            break;
+        }
+        idle = (uint16_t)(tick - bucket.seen[slot].load(std::memory_order_relaxed));
+        if (timeout && idle > timeout) {
+            bucket.used &= (uint8_t)~(1u << slot);
+            m_count.fetch_sub(1, std::memory_order_relaxed);
+            age = AGE_EXPIRED;
+        } else {
+            token = (uint8_t)(tick % TOKENS);
+            bucket.mark[slot] = (uint8_t)((bucket.mark[slot] & COLOR_MASK) | token << TOKEN_SHIFT);
+            age = AGE_ALIVE;
+        }
+        break;
+    }
+
+    unlock(b1, b2);
+    return age;
+}
+
+} // namespace sirius
@@ -0,0 +1,322 @@
+#ifndef _SIRIUS_FLOW_TABLE_H_
+#define _SIRIUS_FLOW_TABLE_H_
+
+#include <atomic>
+#include <cstddef>
+
+#include "sirius_memory.h"
+#include "sirius_types.h"
+
+namespace sirius {
+
+/* 5-tuple + ENI of a connection */
+struct flow_key_t {
+    ipv4_addr_t sip;
+    ipv4_addr_t dip;
+    uint16_t sport;
+    uint16_t dport;
+    uint16_t eni;
+    uint8_t protocol;
+
+    bool operator==(const flow_key_t &o) const
+    {
+        return sip == o.sip && dip == o.dip && sport == o.sport && dport == o.dport && eni == o.eni &&
+               protocol == o.protocol;
+    }
+};
+
+static inline uint64_t flow_key_hash(const flow_key_t &key)
+{
+    uint64_t addrs = (uint64_t)key.sip << 32 | key.dip;
+    uint64_t rest = (uint64_t)key.sport << 48 | (uint64_t)key.dport << 32 | (uint32_t)key.eni << 16 | key.protocol;
+    return hash_mix(addrs ^ hash_mix(rest));
+}
+
+/*
+ * Connection table behind the state_tables of sirius_conntrack.p4: one
+ * byte of state per connection, created and changed by the data path.
+ *
+ * A bucketized hash of fixed size. Every connection lives in one of two
+ * candidate buckets; a bucket is one cache line holding three
+ * connections of 16 bytes each. When both buckets of a new connection
+ * are full, an insert first makes room by moving connections to their
+ * other bucket (cuckoo hashing, at most three moves deep), so the table
+ * takes its capacity with next to no evictions.
+ *
+ * Once it holds `capacity` connections, or when no move frees a slot,
+ * the insert replaces one of the six connections of the two buckets,
+ * picked by CLOCK (second chance) over those slots. A hit sets the
+ * reference bit of its slot, the hand skips and clears referenced
+ * slots, so the victim is one that was not used since the hand last
+ * passed it: an approximation of LRU within the two buckets. New
+ * connections start unreferenced, so a flood of one packet connections
+ * evicts itself before it evicts established ones.
+ *
+ * Lookups take no lock and retry when a bucket's sequence counter shows
+ * a concurrent write. Writers lock the two buckets of their key by
+ * making the counters odd, so workers can insert into the same table.
+ *
+ * Every connection also has one of 8 colors, the "perfect sync" colors
+ * of HA flow replication (sirius_flow_sync): insert() gives a new
+ * connection the table's color(), and recolor() hands the connections of
+ * other colors to the bulk sync and gives them the table's color.
+ *
+ * For the aging (sirius_flow_aging), every connection keeps the tick of
+ * the table's clock at which it was last written or hit, stamped like
+ * the reference bit, and the token of the aging timer that owns it:
+ * tick() % TOKENS as of its insert or its last age(). A hit that finds
+ * the stamp current writes nothing, so keeping a connection alive costs
+ * a store once per tick at most.
+ *
+ * The bucket array is a sirius_mapping: on default pages the capacity
+ * costs memory only as buckets get used, on huge pages it is all there
+ * from the start.
+ */
+class sirius_flow_table {
+public:
+    /* Connections the table is sized for */
+    static constexpr size_t DEFAULT_CAPACITY = 50000000;
+
+    /* Colors are 3 bits */
+    static constexpr uint8_t COLORS = 8;
+
+    /* Aging tokens are the other 5 bits of a slot's mark */
+    static constexpr uint8_t TOKENS = 32;
+
+    /* Outcome of age() */
+    enum age_t {
+        AGE_GONE,    /* no such connection, or another timer owns it */
+        AGE_EXPIRED, /* idle for longer than the timeout, removed */
+        AGE_ALIVE,   /* used within the timeout, kept */
+    };
+
+    explicit sirius_flow_table(size_t capacity = DEFAULT_CAPACITY, const memory_placement_t &placement = {});
+
+    sirius_flow_table(const sirius_flow_table &) = delete;
+    sirius_flow_table &operator=(const sirius_flow_table &) = delete;
+
+    bool lookup(const flow_key_t &key, uint8_t &state) const
+    {
+        uint64_t hash = flow_key_hash(key);
+        const bucket_t &first = m_buckets[first_bucket(hash)];
+        const bucket_t &second = m_buckets[second_bucket(hash)];
+
+        for (;;) {
+            uint32_t first_seq = first.seq.load(std::memory_order_acquire);
+            if (first_seq & 1) {
+                continue;
+            }
+            int slot = first.find(key);
+            if (slot >= 0) {
+                state = first.slots[slot].state;
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (first.seq.load(std::memory_order_relaxed) != first_seq) {
+                continue;
+            }
+            if (slot >= 0) {
+                first.touch(slot, tick());
+                return true;
+            }
+
+            uint32_t second_seq = second.seq.load(std::memory_order_acquire);
+            if (second_seq & 1) {
+                continue;
+            }
+            slot = second.find(key);
+            if (slot >= 0) {
+                state = second.slots[slot].state;
+            }
+            /* Both counters: a move from second to first in between must not look like a miss */
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (second.seq.load(std::memory_order_relaxed) != second_seq ||
+                first.seq.load(std::memory_order_relaxed) != first_seq) {
+                continue;
+            }
+            if (slot >= 0) {
+                second.touch(slot, tick());
+                return true;
+            }
+            return false;
+        }
+    }
+
+    /*
+     * Creates the connection with the table's color, or sets the state of
+     * an existing one, which keeps its color. May evict another connection
+     * to make room: returns true if it did, with its key in *evicted.
+     */
+    bool insert(const flow_key_t &key, uint8_t state, flow_key_t *evicted = nullptr);
+
+    /* Sets the state of an existing connection, false if there is none */
+    bool update(const flow_key_t &key, uint8_t state);
+
+    bool remove(const flow_key_t &key);
+
+    size_t size() const { return m_count.load(std::memory_order_relaxed); }
+
+    /* Color of the connections insert() creates from now on */
+    uint8_t color() const { return m_color.load(std::memory_order_relaxed); }
+    void set_color(uint8_t color) { m_color.store(color % COLORS, std::memory_order_relaxed); }
+
+    size_t buckets() const { return m_bucket_count; }
+
+    /* Connections the table was sized for */
+    size_t capacity() const { return m_capacity; }
+
+    /* Where the buckets went */
+    const memory_placement_t &placement() const { return m_memory.placement(); }
+
+    /* Maps the buckets again as placement asks, while the table is empty and unused; false if not empty */
+    bool place(const memory_placement_t &placement);
+
+    /* Aging clock, in ticks of sirius_flow_aging; only the aging advances it */
+    uint16_t tick() const { return m_tick.load(std::memory_order_relaxed); }
+    void set_tick(uint16_t tick) { m_tick.store(tick, std::memory_order_relaxed); }
+
+    /*
+     * For the aging timer that owns the connection with `token`: removes
+     * it when it was idle for more than `timeout` ticks (never when 0),
+     * else gives it and the timer the token of tick() and sets idle to the
+     * ticks since it was last used.
+     */
+    age_t age(const flow_key_t &key, uint8_t &token, uint16_t timeout, uint16_t &idle);
+
+    /* Pulls the buckets of key into the cache ahead of an age() */
+    void prefetch(const flow_key_t &key) const
+    {
+        uint64_t hash = flow_key_hash(key);
+        __builtin_prefetch(&m_buckets[first_bucket(hash)], 1);
+        __builtin_prefetch(&m_buckets[second_bucket(hash)], 1);
+    }
+
+    /*
+     * Calls fn(key, state) for every connection in buckets [first, first +
+     * count) whose color is not color(), and gives it color(), so a later
+     * call skips it. Returns the number of connections passed to fn. The
+     * bucket is held while fn runs, fn must not call back into the table.
+     */
+    template <typename Fn>
+    size_t recolor(size_t first, size_t count, Fn &&fn)
+    {
+        uint8_t color = this->color();
+        size_t found = 0;
+        for (size_t b = first; b < first + count && b < m_bucket_count; b++) {
+            bucket_t &bucket = m_buckets[b];
+
+            /* Most buckets are empty or done, skip them without taking them */
+            uint8_t pending = 0;
+            for (unsigned i = 0; i < BUCKET_SLOTS; i++) {
+                pending |= (uint8_t)((bucket.mark[i] & COLOR_MASK) != color) << i;
+            }
+            if (!(pending & bucket.used)) {
+                continue;
+            }
+
+            while (!try_lock(bucket)) {
+            }
+            for (unsigned i = 0; i < BUCKET_SLOTS; i++) {
+                if ((bucket.used & 1u << i) && (bucket.mark[i] & COLOR_MASK) != color) {
+                    const slot_t &s = bucket.slots[i];
+                    fn(flow_key_t{ s.sip, s.dip, s.sport, s.dport, s.eni, s.protocol }, s.state);
+                    bucket.mark[i] = (uint8_t)((bucket.mark[i] & ~COLOR_MASK) | color);
+                    found++;
+                }
+            }
+            unlock(bucket);
+        }
+        return found;
+    }
+
+    /* Connections replaced by insert() to make room */
+    uint64_t evictions() const { return m_evictions.load(std::memory_order_relaxed); }
+
+    /* Bytes of the bucket array */
+    size_t memory() const { return m_bucket_count * sizeof(bucket_t); }
+
+private:
+    static constexpr unsigned BUCKET_SLOTS = 3;
+    static constexpr uint8_t COLOR_MASK = COLORS - 1;
+    static constexpr unsigned TOKEN_SHIFT = 3;
+
+    struct slot_t {
+        ipv4_addr_t sip;
+        ipv4_addr_t dip;
+        uint16_t sport;
+        uint16_t dport;
+        uint16_t eni;
+        uint8_t protocol;
+        uint8_t state;
+    };
+
+    struct alignas(64) bucket_t {
+        std::atomic<uint32_t> seq;        /* odd while a writer holds the bucket */
+        uint8_t used;                     /* bit i: slot i holds a connection */
+        mutable std::atomic<uint8_t> ref; /* bit i: slot i was used since the hand passed it */
+        uint8_t hand;                     /* next of the six candidate slots CLOCK looks at */
+        uint8_t mark[BUCKET_SLOTS];       /* color and aging token of slot i */
+        mutable std::atomic<uint16_t> seen[BUCKET_SLOTS]; /* tick slot i was last used at */
+        slot_t slots[BUCKET_SLOTS];
+
+        int find(const flow_key_t &key) const
+        {
+            for (unsigned i = 0; i < BUCKET_SLOTS; i++) {
+                const slot_t &s = slots[i];
+                if ((used & 1u << i) && s.sip == key.sip && s.dip == key.dip && s.sport == key.sport &&
+                    s.dport == key.dport && s.eni == key.eni && s.protocol == key.protocol) {
+                    return (int)i;
+                }
+            }
+            return -1;
+        }
+
+        void touch(int slot, uint16_t tick) const
+        {
+            /* Only write the line when the bit or the stamp changes */
+            uint8_t bit = (uint8_t)(1u << slot);
+            if (!(ref.load(std::memory_order_relaxed) & bit)) {
+                ref.fetch_or(bit, std::memory_order_relaxed);
+            }
+            if (seen[slot].load(std::memory_order_relaxed) != tick) {
+                seen[slot].store(tick, std::memory_order_relaxed);
+            }
+        }
+    };
+
+    static_assert(sizeof(bucket_t) == 64, "a bucket is one cache line");
+
+    /* Maps a 32 bit hash onto the buckets without a division */
+    size_t range(uint32_t h) const { return (size_t)((uint64_t)h * m_bucket_count >> 32); }
+    size_t first_bucket(uint64_t hash) const { return range((uint32_t)hash); }
+
+    size_t second_bucket(uint64_t hash) const
+    {
+        size_t b = range((uint32_t)(hash >> 32));
+        return b != first_bucket(hash) ? b : (b + 1) % m_bucket_count;
+    }
+
+    static bool try_lock(bucket_t &bucket);
+    static void unlock(bucket_t &bucket);
+    void lock(size_t first, size_t second);
+    void unlock(size_t first, size_t second);
+
+    int relocate(size_t b, unsigned depth);
+
+    static void write_slot(bucket_t &bucket, unsigned i, const flow_key_t &key, uint8_t state, uint8_t mark,
+                           uint16_t seen);
+    static flow_key_t evict(bucket_t &first, bucket_t &second, const flow_key_t &key, uint8_t state, uint8_t mark,
+                            uint16_t seen);
+
+    size_t m_capacity;
+    size_t m_bucket_count;
+    sirius_mapping m_memory;
+    bucket_t *m_buckets;
+    std::atomic<size_t> m_count{ 0 };
+    std::atomic<uint64_t> m_evictions{ 0 };
+    std::atomic<uint8_t> m_color{ 0 };
+    std::atomic<uint16_t> m_tick{ 0 };
+};
+
+} // namespace sirius
+
+#endif /* _SIRIUS_FLOW_TABLE_H_ */
@@ -0,0 +1,56 @@
+#ifndef _SIRIUS_GENERATIONS_H_
+#define _SIRIUS_GENERATIONS_H_
+
+#include <atomic>
+#include <cstddef>
+
+#include "sirius_types.h"
+
+namespace sirius {
+
+/*
+ * Generations of the switch tables, for caches of results derived from
+ * them (sirius_flow_cache). Every write through the DASH API bumps the
+ * generation of what it changed, after the change:
+ *
+ * - eni_changed() for the tables keyed by ENI: eni_to_vni, eni_to_vm, the
+ *   ACL stages and routing;
+ * - dip_changed() for ca_to_pa, whose mappings are keyed by VNI and
+ *   destination: one generation per stripe of destinations, as a flow
+ *   cannot tell which VNI its ENI's routes will send it to;
+ * - changed() for the tables a flow may reach from any ENI:
+ *   direction_lookup, appliance, the ENI lookups and vm.
+ *
+ * The tag of a flow is tag() of the global generation, its ENI's and,
+ * outbound, its destination's. Generations only grow, so the sum moves
+ * with any of them: a cached flow is valid while its tag is the one the
+ * generations give it now. A flow is computed with generations read
+ * before the tables they cover, so it is never tagged newer than them.
+ */
+class sirius_generations {
+public:
+    static constexpr size_t DIP_STRIPES = 4096;
+
+    uint32_t global() const { return m_global.load(std::memory_order_acquire); }
+    uint32_t eni(uint16_t eni) const { return m_eni[eni].load(std::memory_order_acquire); }
+    uint32_t dip(ipv4_addr_t dip) const { return m_dip[stripe(dip)].load(std::memory_order_acquire); }
+
+    /* The tag of a flow from the sum of its generations; 0 is never used */
+    static uint32_t tag(uint32_t sum) { return sum ? sum : 1; }
+
+    void changed() { m_global.fetch_add(1, std::memory_order_release); }
+    void eni_changed(uint16_t eni) { m_eni[eni].fetch_add(1, std::memory_order_release); }
+    void dip_changed(ipv4_addr_t dip) { m_dip[stripe(dip)].fetch_add(1, std::memory_order_release); }
+
+private:
+    /* The low bits tell apart the hosts of a subnet, the addresses mappings go to */
+    static size_t stripe(ipv4_addr_t dip) { return dip & (DIP_STRIPES - 1); }
+
+    std::atomic<uint32_t> m_global{ 1 };
+    std::atomic<uint32_t> m_eni[65536] = {};
+    std::atomic<uint32_t> m_dip[DIP_STRIPES] = {};
+};
+
+} // namespace sirius
+
+#endif /* _SIRIUS_GENERATIONS_H_ */
@@ -0,0 +1,114 @@
+#include "sirius_hash.h"
+
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace sirius {
+
+namespace {
+
+/* CRC-32C polynomial, bit reversed */
+constexpr uint32_t CRC32C_POLY = 0x82f63b78;
+
+struct crc32c_table_t {
+    uint32_t t[256];
+
+    constexpr crc32c_table_t() : t()
+    {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t crc = i;
+            for (int bit = 0; bit < 8; bit++) {
+                crc = crc & 1 ? crc >> 1 ^ CRC32C_POLY : crc >> 1;
+            }
+            t[i] = crc;
+        }
+    }
+};
+
+constexpr crc32c_table_t CRC32C_TABLE;
+
+uint32_t crc32c_scalar(const uint8_t *p, size_t len, uint32_t crc)
+{
+    for (; len; p++, len--) {
+        crc = CRC32C_TABLE.t[(crc ^ *p) & 0xff] ^ crc >> 8;
+    }
+    return crc;
+}
+
+#if defined(__x86_64__)
+__attribute__((target("sse4.2"))) uint32_t crc32c_sse42(const uint8_t *p, size_t len, uint32_t crc)
+{
+    uint64_t crc64 = crc;
+    for (; len >= 8; p += 8, len -= 8) {
+        uint64_t v;
+        memcpy(&v, p, sizeof(v));
+        crc64 = _mm_crc32_u64(crc64, v);
+    }
+    crc = (uint32_t)crc64;
+    for (; len; p++, len--) {
+        crc = _mm_crc32_u8(crc, *p);
+    }
+    return crc;
+}
+
+/* Also runs from a static initializer */
+bool has_sse42()
+{
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse4.2");
+}
+
+const bool sse42 = has_sse42();
+#endif
+
+/* The default RSS key of Microsoft's RSS specification */
+constexpr uint8_t TOEPLITZ_KEY[40] = {
+    0x6d, 0x5a, 0x56, 0xda, 0x25, 0x5b, 0x0e, 0xc2, 0x41, 0x67, 0x25, 0x3d, 0x43, 0xa3,
+    0x8f, 0xb0, 0xd0, 0xca, 0x2b, 0xcb, 0xae, 0x7b, 0x30, 0xb4, 0x77, 0xcb, 0x2d, 0xa3,
+    0x80, 0x30, 0xf2, 0x0c, 0x6a, 0x42, 0xb7, 0x3b, 0xbe, 0xac, 0x01, 0xfa,
+};
+
+} // namespace
+
+uint32_t crc32c(const void *data, size_t len, uint32_t crc)
+{
+    const uint8_t *p = static_cast<const uint8_t *>(data);
+#if defined(__x86_64__)
+    if (sse42) {
+        return crc32c_sse42(p, len, crc);
+    }
+#endif
+    return crc32c_scalar(p, len, crc);
+}
+
+uint32_t toeplitz_hash(const void *data, size_t len)
+{
+    const uint8_t *p = static_cast<const uint8_t *>(data);
+    if (len > TOEPLITZ_MAX_BYTES) {
+        len = TOEPLITZ_MAX_BYTES;
+    }
+
+    /* The key bits from the current input bit on: each set input bit adds the 32 at the top */
+    uint64_t window = 0;
+    for (size_t i = 0; i < 8; i++) {
+        window = window << 8 | TOEPLITZ_KEY[i];
+    }
+    uint32_t hash = 0;
+    for (size_t i = 0; i < len; i++) {
+        for (int bit = 7; bit >= 0; bit--) {
+            if (p[i] >> bit & 1) {
+                hash ^= (uint32_t)(window >> 32);
+            }
+            window <<= 1;
+        }
+        if (i + 8 < sizeof(TOEPLITZ_KEY)) {
+            window |= TOEPLITZ_KEY[i + 8];
+        }
+    }
+    return hash;
+}
+
+} // namespace sirius
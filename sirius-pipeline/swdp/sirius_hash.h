@@ -0,0 +1,36 @@
+#ifndef _SIRIUS_HASH_H_
+#define _SIRIUS_HASH_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace sirius {
+
+/*
+ * Hashes that have to agree with other equipment on the wire, unlike
+ * hash_mix() of the tables: the underlay's ECMP and the receivers' RSS
+ * spread on them.
+ */
+
+/*
+ * CRC-32C (Castagnoli, the polynomial of the SSE4.2 crc32 instruction) of
+ * len bytes, continuing from crc. Like the instruction, it works on the
+ * register and leaves out the final inversion: the checksum of RFC 3720
+ * is ~crc32c(data, len). Uses the instruction where the CPU has it, else
+ * a table.
+ */
+uint32_t crc32c(const void *data, size_t len, uint32_t crc = 0xffffffff);
+
+/*
+ * Toeplitz hash of RSS, with the default 40 byte key of Microsoft's RSS
+ * specification that NICs ship with, over at most TOEPLITZ_MAX_BYTES
+ * bytes: for a flow its source and destination addresses, then ports, in
+ * network byte order.
+ */
+constexpr size_t TOEPLITZ_MAX_BYTES = 36;
+
+uint32_t toeplitz_hash(const void *data, size_t len);
+
+} // namespace sirius
+
+#endif /* _SIRIUS_HASH_H_ */
@@ -0,0 +1,143 @@
+#ifndef _SIRIUS_HEADERS_H_
+#define _SIRIUS_HEADERS_H_
+
+#include <arpa/inet.h>
+
+#include <cstdint>
+
+#include "sirius_types.h"
+
+namespace sirius {
+
+/*
+ * Wire layout of the headers in sirius_headers.p4. Multi-byte fields are
+ * in network byte order, sub-byte P4 fields share the byte they live in.
+ */
+
+struct __attribute__((packed)) ethernet_t {
+    uint8_t dst_addr[6];
+    uint8_t src_addr[6];
+    uint16_t ether_type;
+};
+
+constexpr uint16_t ETHER_HDR_SIZE = 112 / 8;
+
+struct __attribute__((packed)) ipv4_t {
+    uint8_t version_ihl;
+    uint8_t diffserv;
+    uint16_t total_len;
+    uint16_t identification;
+    uint16_t flags_frag_offset;
+    uint8_t ttl;
+    uint8_t protocol;
+    uint16_t hdr_checksum;
+    uint32_t src_addr;
+    uint32_t dst_addr;
+
+    uint8_t version() const { return version_ihl >> 4; }
+    uint8_t ihl() const { return version_ihl & 0xf; }
+};
+
+constexpr uint16_t IPV4_HDR_SIZE = 160 / 8;
+
+struct __attribute__((packed)) udp_t {
+    uint16_t src_port;
+    uint16_t dst_port;
+    uint16_t length;
+    uint16_t checksum;
+};
+
+constexpr uint16_t UDP_HDR_SIZE = 64 / 8;
+
+struct __attribute__((packed)) vxlan_t {
+    uint8_t flags;
+    uint8_t reserved[3];
+    uint8_t vni[3];
+    uint8_t reserved_2;
+
+    uint32_t get_vni() const { return (uint32_t)vni[0] << 16 | (uint32_t)vni[1] << 8 | vni[2]; }
+
+    void set_vni(uint32_t v)
+    {
+        vni[0] = (uint8_t)(v >> 16);
+        vni[1] = (uint8_t)(v >> 8);
+        vni[2] = (uint8_t)v;
+    }
+};
+
+constexpr uint16_t VXLAN_HDR_SIZE = 64 / 8;
+
+struct __attribute__((packed)) tcp_t {
+    uint16_t src_port;
+    uint16_t dst_port;
+    uint32_t seq_no;
+    uint32_t ack_no;
+    uint8_t data_offset_res;
+    uint8_t ecn_flags;
+    uint16_t window;
+    uint16_t checksum;
+    uint16_t urgent_ptr;
+
+    uint8_t flags() const { return ecn_flags & 0x3f; }
+};
+
+constexpr uint16_t TCP_HDR_SIZE = 160 / 8;
+
+constexpr uint8_t TCP_FLAG_FIN = 0x01;
+constexpr uint8_t TCP_FLAG_SYN = 0x02;
+constexpr uint8_t TCP_FLAG_RST = 0x04;
+constexpr uint8_t TCP_FLAG_PSH = 0x08;
+constexpr uint8_t TCP_FLAG_ACK = 0x10;
+
+/* ICMP header; rest_of_header is the gateway address of a redirect */
+struct __attribute__((packed)) icmp_t {
+    uint8_t type;
+    uint8_t code;
+    uint16_t checksum;
+    uint32_t rest_of_header;
+};
+
+constexpr uint16_t ICMP_HDR_SIZE = 64 / 8;
+
+constexpr uint8_t ICMP_TYPE_REDIRECT = 5;
+
+struct __attribute__((packed)) ipv6_t {
+    uint32_t version_class_label;
+    uint16_t payload_length;
+    uint8_t next_header;
+    uint8_t hop_limit;
+    uint8_t src_addr[16];
+    uint8_t dst_addr[16];
+};
+
+constexpr uint16_t IPV6_HDR_SIZE = 320 / 8;
+
+/* sirius_parser.p4 constants */
+constexpr uint16_t UDP_PORT_VXLAN = 4789;
+constexpr uint8_t UDP_PROTO = 17;
+constexpr uint8_t TCP_PROTO = 6;
+constexpr uint8_t ICMP_PROTO = 1;
+constexpr uint16_t IPV4_ETHTYPE = 0x0800;
+constexpr uint16_t IPV6_ETHTYPE = 0x86dd;
+
+/*
+ * headers_t of sirius_headers.p4. Each member points at the header inside
+ * the packet buffer, nullptr stands for an invalid header.
+ */
+struct headers_t {
+    ethernet_t *ethernet;
+    ipv4_t *ipv4;
+    ipv6_t *ipv6;
+    udp_t *udp;
+    tcp_t *tcp;
+    vxlan_t *vxlan;
+    ethernet_t *inner_ethernet;
+    ipv4_t *inner_ipv4;
+    ipv6_t *inner_ipv6;
+    udp_t *inner_udp;
+    tcp_t *inner_tcp;
+};
+
+} // namespace sirius
+
+#endif /* _SIRIUS_HEADERS_H_ */
@@ -0,0 +1,54 @@
+#include "sirius_heavy_hitters.h"
+
+#include <algorithm>
+
+namespace sirius {
+
+void heavy_hitters::offer(uint32_t key, uint32_t weight)
+{
+    std::unique_lock<std::mutex> lock(m_lock, std::try_to_lock);
+    if (!lock) {
+        return;
+    }
+
+    for (unsigned i = 0; i < CAPACITY; i++) {
+        if (m_keys[i] == key) {
+            m_counts[i] += weight;
+            return;
+        }
+    }
+
+    /* Free places count 0, so they are the first to be taken */
+    unsigned min = (unsigned)(std::min_element(m_counts, m_counts + CAPACITY) - m_counts);
+    m_keys[min] = key;
+    m_errors[min] = m_counts[min];
+    m_counts[min] += weight;
+}
+
+void heavy_hitters::erase(uint32_t key)
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    for (unsigned i = 0; i < CAPACITY; i++) {
+        if (m_keys[i] == key) {
+            m_keys[i] = 0;
+            m_counts[i] = 0;
+            m_errors[i] = 0;
+        }
+    }
+}
+
+void heavy_hitters::items(std::vector<item_t> &out) const
+{
+    out.clear();
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        for (unsigned i = 0; i < CAPACITY; i++) {
+            if (m_keys[i]) {
+                out.push_back({ m_keys[i], m_counts[i], m_errors[i] });
+            }
+        }
+    }
+    std::sort(out.begin(), out.end(), [](const item_t &a, const item_t &b) { return a.count > b.count; });
+}
+
+} // namespace sirius
@@ -0,0 +1,55 @@
+#ifndef _SIRIUS_HEAVY_HITTERS_H_
+#define _SIRIUS_HEAVY_HITTERS_H_
+
+#include <mutex>
+#include <vector>
+
+#include "sirius_types.h"
+
+namespace sirius {
+
+/*
+ * The heaviest keys of a stream of weighted keys, with the space saving
+ * algorithm: CAPACITY keys are monitored with a count each. A monitored
+ * key adds its weight to its count; any other key replaces the monitored
+ * key with the lowest count and carries on from that count, which
+ * becomes its error. Every key with more than 1/CAPACITY of the total
+ * weight is monitored, and a count is at most its error above the key's
+ * weight.
+ *
+ * Key 0 is not a key, it marks free places.
+ *
+ * offer() costs a scan of the CAPACITY keys, and of their counts for a
+ * key that is not monitored, whatever the number of distinct keys in the
+ * stream. It only tries the lock: a key
+ * offered while another thread holds it is dropped, so the data path
+ * never waits on another worker or a reader.
+ */
+class heavy_hitters {
+public:
+    static constexpr unsigned CAPACITY = 128;
+
+    struct item_t {
+        uint32_t key;
+        uint64_t count;
+        uint64_t error;
+    };
+
+    void offer(uint32_t key, uint32_t weight);
+
+    /* Stops monitoring key; its place is free for the next new key */
+    void erase(uint32_t key);
+
+    /* The monitored keys, highest count first */
+    void items(std::vector<item_t> &out) const;
+
+private:
+    mutable std::mutex m_lock;
+    uint32_t m_keys[CAPACITY] = {};
+    uint64_t m_counts[CAPACITY] = {};
+    uint64_t m_errors[CAPACITY] = {};
+};
+
+} // namespace sirius
+
+#endif /* _SIRIUS_HEAVY_HITTERS_H_ */
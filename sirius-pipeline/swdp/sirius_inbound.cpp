@@ -0,0 +1,58 @@
+#include "sirius_acl.h"
+#include "sirius_conntrack.h"
+#include "sirius_pipeline.h"
+
+namespace sirius {
+
+/* inbound control of sirius_inbound.p4 */
+void sirius_pipeline::inbound(const packet_t &pkt, headers_t &hdr, metadata_t &meta, flow_action_t &action)
+{
+    mac_t dmac = mac_from_bytes(hdr.ethernet->dst_addr);
+
+    /* eni_lookup_to_vm */
+    eni_entry_t eni;
+    if (m_switch.eni_lookup_to_vm.lookup(dmac, eni)) {
+        meta.eni = eni.eni;
+    }
+
+    /* Before the tables of the ENI, so the flow cache never tags the flow newer than them */
+    action.generation = m_switch.generations.eni(meta.eni);
+
+    /* eni_to_vm */
+    eni_to_vm_entry_t vm_id;
+    if (m_switch.eni_to_vm.lookup(meta.eni, vm_id)) {
+        meta.vm_id = vm_id.vm_id;
+    }
+
+    /* vm */
+    vm_entry_t vm;
+    if (m_switch.vm.lookup(meta.vm_id, vm)) {
+        /* set_vm_attributes */
+        meta.encap_data.underlay_dmac = vm.underlay_dmac;
+        meta.encap_data.underlay_dip = vm.underlay_dip;
+        meta.encap_data.vni = vm.vni;
+    }
+
+    /* ConntrackIn.apply(0) */
+    conntrack_flow_t flow;
+    conntrack_lookup(m_flows, hdr, meta, flow);
+
+    /* ACL, skipped for connections conntrack already allowed */
+    if (!meta.conntrack_data.allow_in) {
+        acl_apply(m_switch.inbound_acl, hdr, meta);
+    }
+
+    /* ConntrackOut.apply(1) */
+    uint8_t before = flow.state;
+    conntrack_update(m_flows, m_sync, m_aging, m_seqs, hdr, pkt.data() + pkt.len, meta, flow);
+    unredirect(before, flow);
+
+    /* Outcome of ACL and conntrack for the flow cache */
+    action.acl_drop = meta.dropped;
+    action.conntrack = flow.tracked;
+    action.uncached = conntrack_closing(flow);
+
+    encap_action(hdr, meta, dmac, action);
+}
+
+} // namespace sirius
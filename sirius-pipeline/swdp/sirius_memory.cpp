@@ -0,0 +1,250 @@
+#include "sirius_memory.h"
+
+#include <dirent.h>
+#include <setjmp.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT 26
+#endif
+
+#ifndef MADV_POPULATE_WRITE
+#define MADV_POPULATE_WRITE 23
+#endif
+
+namespace sirius {
+
+namespace {
+
+/* MPOL_BIND of numaif.h, which comes with libnuma */
+constexpr int MPOL_BIND_MODE = 2;
+
+constexpr size_t SMALL_PAGE = 4096;
+
+size_t page_bytes(page_size_t page)
+{
+    switch (page) {
+    case PAGE_SIZE_2MB:
+        return 2ul << 20;
+    case PAGE_SIZE_1GB:
+        return 1ul << 30;
+    default:
+        return SMALL_PAGE;
+    }
+}
+
+unsigned page_shift(page_size_t page)
+{
+    return page == PAGE_SIZE_1GB ? 30 : 21;
+}
+
+size_t round_up(size_t bytes, size_t page)
+{
+    return (std::max<size_t>(bytes, 1) + page - 1) / page * page;
+}
+
+bool bind(void *addr, size_t bytes, int node)
+{
+    if (node < 0) {
+        return false;
+    }
+    constexpr size_t BITS = 8 * sizeof(unsigned long);
+    std::vector<unsigned long> mask((size_t)node / BITS + 1);
+    mask[(size_t)node / BITS] = 1ul << ((size_t)node % BITS);
+    return syscall(SYS_mbind, addr, bytes, MPOL_BIND_MODE, mask.data(), mask.size() * BITS + 1, 0) == 0;
+}
+
+/* Where touch() resumes when a page it touches cannot be had */
+thread_local sigjmp_buf *touch_fault;
+
+void touch_sigbus(int)
+{
+    if (touch_fault) {
+        siglongjmp(*touch_fault, 1);
+    }
+    signal(SIGBUS, SIG_DFL);
+    raise(SIGBUS);
+}
+
+/* Writes every page; false when the kernel has none to give, which it signals with SIGBUS */
+bool touch(void *addr, size_t bytes, size_t page)
+{
+    struct sigaction action = {}, old = {};
+    action.sa_handler = touch_sigbus;
+    sigemptyset(&action.sa_mask);
+    if (sigaction(SIGBUS, &action, &old) != 0) {
+        return false;
+    }
+    sigjmp_buf fault;
+    volatile bool touched = false;
+    if (sigsetjmp(fault, 1) == 0) {
+        touch_fault = &fault;
+        /* Set before the first write, which the handler may see */
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+        /* The memory is zero already */
+        for (size_t off = 0; off < bytes; off += page) {
+            static_cast<volatile char *>(addr)[off] = 0;
+        }
+        touched = true;
+    }
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+    touch_fault = nullptr;
+    sigaction(SIGBUS, &old, nullptr);
+    return touched;
+}
+
+/* Faults the pages in, so a node short of huge pages fails here and the data path never faults */
+bool populate(void *addr, size_t bytes, size_t page)
+{
+    if (madvise(addr, bytes, MADV_POPULATE_WRITE) == 0) {
+        return true;
+    }
+    if (errno != EINVAL) {
+        return false;
+    }
+    /* Kernels before 5.14 */
+    return touch(addr, bytes, page);
+}
+
+} // namespace
+
+sirius_mapping::sirius_mapping(size_t bytes, const memory_placement_t &placement)
+{
+    page_size_t page = placement.page_size;
+    while (page != PAGE_SIZE_DEFAULT && bytes < page_bytes(page) / 2) {
+        page = (page_size_t)(page - 1);
+    }
+
+    for (; page != PAGE_SIZE_DEFAULT; page = (page_size_t)(page - 1)) {
+        size_t size = round_up(bytes, page_bytes(page));
+        int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | (int)(page_shift(page) << MAP_HUGE_SHIFT);
+        void *mem = mmap(nullptr, size, PROT_READ | PROT_WRITE, flags, -1, 0);
+        if (mem == MAP_FAILED) {
+            continue;
+        }
+        bool bound = bind(mem, size, placement.numa_node);
+        if (!populate(mem, size, page_bytes(page))) {
+            munmap(mem, size);
+            continue;
+        }
+        m_data = mem;
+        m_size = size;
+        m_placement = { page, bound ? placement.numa_node : -1 };
+        return;
+    }
+
+    m_size = round_up(bytes, SMALL_PAGE);
+    void *mem = mmap(nullptr, m_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (mem == MAP_FAILED) {
+        /* Out of address space, a setup error */
+        abort();
+    }
+    m_data = mem;
+    if (placement.page_size != PAGE_SIZE_DEFAULT) {
+        madvise(m_data, m_size, MADV_HUGEPAGE);
+    }
+    m_placement = { PAGE_SIZE_DEFAULT, bind(m_data, m_size, placement.numa_node) ? placement.numa_node : -1 };
+}
+
+sirius_mapping::~sirius_mapping()
+{
+    if (m_data) {
+        munmap(m_data, m_size);
+    }
+}
+
+sirius_mapping::sirius_mapping(sirius_mapping &&other) noexcept
+    : m_data(std::exchange(other.m_data, nullptr)), m_size(std::exchange(other.m_size, 0)),
+      m_placement(other.m_placement)
+{
+}
+
+sirius_mapping &sirius_mapping::operator=(sirius_mapping &&other) noexcept
+{
+    if (this != &other) {
+        if (m_data) {
+            munmap(m_data, m_size);
+        }
+        m_data = std::exchange(other.m_data, nullptr);
+        m_size = std::exchange(other.m_size, 0);
+        m_placement = other.m_placement;
+    }
+    return *this;
+}
+
+int cpu_numa_node(unsigned cpu)
+{
+    char path[64];
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u", cpu);
+    DIR *dir = opendir(path);
+    if (!dir) {
+        return -1;
+    }
+    int node = -1;
+    while (const dirent *entry = readdir(dir)) {
+        if (!strncmp(entry->d_name, "node", 4) && entry->d_name[4] >= '0' && entry->d_name[4] <= '9') {
+            node = atoi(entry->d_name + 4);
+            break;
+        }
+    }
+    closedir(dir);
+    return node;
+}
+
+void *sirius_heap::alloc(size_t bytes)
+{
+    if (bytes > MAX_BYTES) {
+        return nullptr;
+    }
+    size_t c = (bytes + HEADER + CLASS_BYTES - 1) / CLASS_BYTES;
+    char *block;
+    if (m_free[c]) {
+        block = reinterpret_cast<char *>(m_free[c]);
+        m_free[c] = m_free[c]->next;
+    } else {
+        size_t size = c * CLASS_BYTES;
+        if ((size_t)(m_end - m_next) < size) {
+            m_regions.emplace_back(std::max(REGION, page_bytes(m_placement.page_size)), m_placement);
+            m_next = static_cast<char *>(m_regions.back().data());
+            m_end = m_next + m_regions.back().size();
+        }
+        block = m_next;
+        m_next += size;
+    }
+    *reinterpret_cast<uint64_t *>(block) = c;
+    return block + HEADER;
+}
+
+void sirius_heap::free(void *p)
+{
+    if (!p) {
+        return;
+    }
+    char *block = static_cast<char *>(p) - HEADER;
+    size_t c = (size_t)*reinterpret_cast<uint64_t *>(block);
+    auto *f = reinterpret_cast<free_t *>(block);
+    f->next = m_free[c];
+    m_free[c] = f;
+}
+
+size_t sirius_heap::memory() const
+{
+    size_t bytes = 0;
+    for (const sirius_mapping &region : m_regions) {
+        bytes += region.size();
+    }
+    return bytes;
+}
+
+} // namespace sirius
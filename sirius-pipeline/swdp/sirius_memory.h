@@ -0,0 +1,112 @@
+#ifndef _SIRIUS_MEMORY_H_
+#define _SIRIUS_MEMORY_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace sirius {
+
+/* Pages of a table's memory */
+enum page_size_t : uint8_t {
+    PAGE_SIZE_DEFAULT, /* the kernel's, transparent huge pages where its policy gives them */
+    PAGE_SIZE_2MB,
+    PAGE_SIZE_1GB,
+};
+
+/* Where the memory of a table goes */
+struct memory_placement_t {
+    page_size_t page_size = PAGE_SIZE_DEFAULT;
+    int numa_node = -1; /* -1: not bound, pages come from the node of the core that touches them first */
+};
+
+/*
+ * Zeroed memory for a large table, mapped as a placement asks.
+ *
+ * Huge pages are hugetlb pages reserved when the mapping is made, so a
+ * pool too small for the table fails here rather than when the data path
+ * touches a page: a 1 GB mapping falls back to 2 MB pages, a 2 MB one to
+ * the kernel's pages advised for transparent huge pages, and tables
+ * smaller than half a huge page take the next size down. A NUMA node
+ * binds the pages to it (mbind MPOL_BIND) before any is touched; when the
+ * node does not exist, the mapping is left unbound. placement() tells
+ * what the mapping got. Default pages are reserved without backing, so a
+ * table costs memory only as it fills.
+ */
+class sirius_mapping {
+public:
+    sirius_mapping() = default;
+    sirius_mapping(size_t bytes, const memory_placement_t &placement);
+    ~sirius_mapping();
+
+    sirius_mapping(sirius_mapping &&other) noexcept;
+    sirius_mapping &operator=(sirius_mapping &&other) noexcept;
+
+    sirius_mapping(const sirius_mapping &) = delete;
+    sirius_mapping &operator=(const sirius_mapping &) = delete;
+
+    void *data() const { return m_data; }
+
+    /* Bytes mapped, the bytes asked for rounded up to the page size */
+    size_t size() const { return m_size; }
+
+    const memory_placement_t &placement() const { return m_placement; }
+
+private:
+    void *m_data = nullptr;
+    size_t m_size = 0;
+    memory_placement_t m_placement;
+};
+
+/* The NUMA node of a CPU, -1 when the system does not tell */
+int cpu_numa_node(unsigned cpu);
+
+/*
+ * Small allocations of one writer, from placed mappings of REGION bytes,
+ * or of the huge page size when larger: for tables made of many small
+ * arrays, like the routing tries, whose lookups then stay within a few
+ * huge pages. Sizes go up to MAX_BYTES, rounded up to classes of 32
+ * bytes with an 8 byte header; freed blocks serve the next allocations
+ * of their class, and memory goes back to the system only with the heap.
+ * Not thread safe.
+ */
+class sirius_heap {
+public:
+    static constexpr size_t MAX_BYTES = 4096;
+    static constexpr size_t REGION = 2u << 20;
+
+    sirius_heap() = default;
+
+    sirius_heap(const sirius_heap &) = delete;
+    sirius_heap &operator=(const sirius_heap &) = delete;
+
+    /* Placement of the regions mapped from now on */
+    void set_placement(const memory_placement_t &placement) { m_placement = placement; }
+
+    /* At least `bytes` bytes, 8 byte aligned; nullptr for more than MAX_BYTES */
+    void *alloc(size_t bytes);
+
+    void free(void *block);
+
+    /* Bytes of the regions mapped */
+    size_t memory() const;
+
+private:
+    static constexpr size_t CLASS_BYTES = 32;
+    static constexpr size_t HEADER = 8;
+    static constexpr size_t CLASSES = (MAX_BYTES + HEADER + CLASS_BYTES - 1) / CLASS_BYTES;
+
+    struct free_t {
+        free_t *next;
+    };
+
+    memory_placement_t m_placement;
+    std::vector<sirius_mapping> m_regions;
+    char *m_next = nullptr; /* unused rest of the last region */
+    char *m_end = nullptr;
+    free_t *m_free[CLASSES + 1] = {};
+};
+
+} // namespace sirius
+
+#endif /* _SIRIUS_MEMORY_H_ */
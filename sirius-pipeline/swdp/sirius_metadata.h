@@ -0,0 +1,43 @@
+#ifndef _SIRIUS_METADATA_H_
+#define _SIRIUS_METADATA_H_
+
+#include <cstdint>
+
+#include "sirius_types.h"
+
+namespace sirius {
+
+/* Mirrors the structs of sirius_metadata.p4, addresses in host byte order */
+
+struct encap_data_t {
+    uint32_t vni;
+    uint32_t dest_vnet_vni;
+    ipv4_addr_t underlay_sip;
+    ipv4_addr_t underlay_dip;
+    mac_t underlay_smac;
+    mac_t underlay_dmac;
+    mac_t overlay_dmac;
+};
+
+struct conntrack_data_t {
+    bool allow_in;
+    bool allow_out;
+};
+
+struct metadata_t {
+    bool dropped;
+    direction_t direction;
+    encap_data_t encap_data;
+    uint16_t eni;
+    uint16_t vm_id;
+    uint8_t appliance_id;
+    conntrack_data_t conntrack_data;
+
+    /* Not in sirius_metadata.p4: the direct counters of the ACL_STAGE tables */
+    bool acl_sample;          /* offer the rules hit to the stages' top rules */
+    uint32_t acl_counter[3];  /* slot of the rule stage1..stage3 matched, 0 for none */
+};
+
+} // namespace sirius
+
+#endif /* _SIRIUS_METADATA_H_ */
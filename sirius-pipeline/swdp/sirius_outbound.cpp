@@ -0,0 +1,74 @@
+#include "sirius_acl.h"
+#include "sirius_conntrack.h"
+#include "sirius_pipeline.h"
+
+namespace sirius {
+
+/* outbound control of sirius_outbound.p4 */
+void sirius_pipeline::outbound(const packet_t &pkt, headers_t &hdr, metadata_t &meta, flow_action_t &action)
+{
+    /* eni_lookup_from_vm */
+    eni_entry_t eni;
+    if (m_switch.eni_lookup_from_vm.lookup(mac_from_bytes(hdr.ethernet->src_addr), eni)) {
+        meta.eni = eni.eni;
+    }
+
+    /* Before the tables of the ENI and ca_to_pa, so the flow cache never tags the flow newer than them */
+    ipv4_addr_t dip = hdr.ipv4 ? ntohl(hdr.ipv4->dst_addr) : 0;
+    action.generation = m_switch.generations.eni(meta.eni) + m_switch.generations.dip(dip);
+
+    /* eni_to_vni */
+    eni_to_vni_entry_t vni;
+    if (m_switch.eni_to_vni.lookup(meta.eni, vni)) {
+        meta.encap_data.vni = vni.vni;
+    }
+
+    /* ConntrackOut.apply(0) */
+    conntrack_flow_t flow;
+    conntrack_lookup(m_flows, hdr, meta, flow);
+
+    /* ACL, skipped for connections conntrack already allowed */
+    if (!meta.conntrack_data.allow_out) {
+        acl_apply(m_switch.outbound_acl, hdr, meta);
+    }
+
+    /* ConntrackIn.apply(1) */
+    uint8_t before = flow.state;
+    conntrack_update(m_flows, m_sync, m_aging, m_seqs, hdr, pkt.data() + pkt.len, meta, flow);
+    unredirect(before, flow);
+
+    /* Outcome of ACL and conntrack for the flow cache */
+    action.acl_drop = meta.dropped;
+    action.conntrack = flow.tracked;
+    action.uncached = conntrack_closing(flow);
+
+    /* routing */
+    routing_entry_t route;
+    if (!m_switch.routing.lpm(meta.eni, dip, route)) {
+        return;
+    }
+    meta.encap_data.dest_vnet_vni = route.dest_vnet_vni;
+    action.routing_counter = route.counter;
+
+    /* ca_to_pa */
+    ca_to_pa_entry_t mapping;
+    if (m_switch.ca_to_pa.lookup({ (uint16_t)meta.encap_data.dest_vnet_vni, dip }, mapping)) {
+        /* set_tunnel_mapping */
+        if (mapping.use_dst_vni) {
+            meta.encap_data.vni = meta.encap_data.dest_vnet_vni;
+        }
+        meta.encap_data.overlay_dmac = mapping.overlay_dmac;
+        meta.encap_data.underlay_dip = mapping.underlay_dip;
+        action.ca_to_pa_counter = mapping.counter;
+
+        /* A connection the SLB MUX redirected to the PA of its DIP */
+        ipv4_addr_t pa;
+        if (flow.state && m_fixups.get(flow.key, pa)) {
+            meta.encap_data.underlay_dip = pa;
+        }
+    }
+
+    encap_action(hdr, meta, meta.encap_data.overlay_dmac, action);
+}
+
+} // namespace sirius
@@ -0,0 +1,40 @@
+#ifndef _SIRIUS_PACKET_H_
+#define _SIRIUS_PACKET_H_
+
+#include <cstdint>
+
+namespace sirius {
+
+/* Room kept in front of a received frame so vxlan_encap can prepend in place */
+constexpr uint32_t PACKET_HEADROOM = 128;
+
+/* Checksum offloads of packet_t::ol_flags, as NIC drivers report and take them per packet */
+enum : uint8_t {
+    PACKET_RX_CSUM_GOOD = 1 << 0, /* in: the NIC found the inner IPv4 and TCP/UDP checksums correct */
+    PACKET_RX_CSUM_BAD = 1 << 1,  /* in: the NIC found one of them wrong */
+    PACKET_TX_IPV4_CSUM = 1 << 2, /* out: the NIC is to fill in the outer IPv4 header checksum */
+};
+
+/*
+ * One packet handed to the pipeline. The frame occupies
+ * buf[data_off, data_off + len); the pipeline moves data_off to strip or
+ * prepend headers and fills in the standard_metadata outputs.
+ */
+struct packet_t {
+    uint8_t *buf;
+    uint32_t buf_size;
+    uint32_t data_off;
+    uint32_t len;
+
+    /* standard_metadata */
+    uint16_t ingress_port;
+    uint16_t egress_port;
+    bool drop;
+    uint8_t ol_flags;
+
+    uint8_t *data() const { return buf + data_off; }
+};
+
+} // namespace sirius
+
+#endif /* _SIRIUS_PACKET_H_ */
@@ -0,0 +1,457 @@
+#include "sirius_parser.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace sirius {
+
+namespace {
+
+/* packet_in: hands out consecutive headers while they fit in the frame */
+class packet_in {
+public:
+    explicit packet_in(const packet_t &pkt) : m_pos(pkt.data()), m_end(pkt.data() + pkt.len) {}
+
+    template <typename H>
+    H *extract()
+    {
+        if (m_end - m_pos < (ptrdiff_t)sizeof(H)) {
+            return nullptr;
+        }
+        H *h = reinterpret_cast<H *>(m_pos);
+        m_pos += sizeof(H);
+        return h;
+    }
+
+private:
+    uint8_t *m_pos;
+    uint8_t *m_end;
+};
+
+bool verify_ipv4(const ipv4_t *ip)
+{
+    return ip->version() == 4 && ip->ihl() == 5;
+}
+
+/* Header offsets in a VXLAN over IPv4 frame without IP options */
+constexpr uint32_t OUTER_IPV4_OFF = ETHER_HDR_SIZE;
+constexpr uint32_t OUTER_UDP_OFF = OUTER_IPV4_OFF + IPV4_HDR_SIZE;
+constexpr uint32_t VXLAN_OFF = OUTER_UDP_OFF + UDP_HDR_SIZE;
+constexpr uint32_t INNER_ETHERNET_OFF = VXLAN_OFF + VXLAN_HDR_SIZE;
+constexpr uint32_t INNER_IPV4_OFF = INNER_ETHERNET_OFF + ETHER_HDR_SIZE;
+constexpr uint32_t INNER_L4_OFF = INNER_IPV4_OFF + IPV4_HDR_SIZE;
+
+/*
+ * Bytes the first 64 of such a frame must have: outer ether_type,
+ * version and ihl, protocol UDP, destination port VXLAN, inner
+ * ether_type. The inner IPv4 header starts at byte 64.
+ */
+struct frame_template_t {
+    alignas(64) uint8_t value[64];
+    alignas(64) uint8_t mask[64];
+
+    constexpr frame_template_t() : value(), mask()
+    {
+        set16(offsetof(ethernet_t, ether_type), IPV4_ETHTYPE);
+        set8(OUTER_IPV4_OFF + offsetof(ipv4_t, version_ihl), 0x45);
+        set8(OUTER_IPV4_OFF + offsetof(ipv4_t, protocol), UDP_PROTO);
+        set16(OUTER_UDP_OFF + offsetof(udp_t, dst_port), UDP_PORT_VXLAN);
+        set16(INNER_ETHERNET_OFF + offsetof(ethernet_t, ether_type), IPV4_ETHTYPE);
+    }
+
+    constexpr void set8(size_t off, uint8_t v)
+    {
+        value[off] = v;
+        mask[off] = 0xff;
+    }
+
+    constexpr void set16(size_t off, uint16_t v)
+    {
+        set8(off, (uint8_t)(v >> 8));
+        set8(off + 1, (uint8_t)v);
+    }
+};
+
+constexpr frame_template_t VXLAN_TEMPLATE;
+
+static_assert(INNER_IPV4_OFF == sizeof(VXLAN_TEMPLATE.value), "the template covers the headers up to the inner IPv4");
+
+template <typename T>
+T load(const uint8_t *p)
+{
+    T v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+/* Headers of a frame with that layout carrying TCP, or else UDP */
+void vxlan_headers(uint8_t *data, bool tcp, headers_t &hdr)
+{
+    hdr.ethernet = reinterpret_cast<ethernet_t *>(data);
+    hdr.ipv4 = reinterpret_cast<ipv4_t *>(data + OUTER_IPV4_OFF);
+    hdr.ipv6 = nullptr;
+    hdr.udp = reinterpret_cast<udp_t *>(data + OUTER_UDP_OFF);
+    hdr.tcp = nullptr;
+    hdr.vxlan = reinterpret_cast<vxlan_t *>(data + VXLAN_OFF);
+    hdr.inner_ethernet = reinterpret_cast<ethernet_t *>(data + INNER_ETHERNET_OFF);
+    hdr.inner_ipv4 = reinterpret_cast<ipv4_t *>(data + INNER_IPV4_OFF);
+    hdr.inner_ipv6 = nullptr;
+    hdr.inner_udp = tcp ? nullptr : reinterpret_cast<udp_t *>(data + INNER_L4_OFF);
+    hdr.inner_tcp = tcp ? reinterpret_cast<tcp_t *>(data + INNER_L4_OFF) : nullptr;
+}
+
+/* The burst's fields at i for a frame with that layout */
+void vxlan_fields(const uint8_t *data, parsed_burst_t &burst, uint32_t i)
+{
+    const uint8_t *ip = data + OUTER_IPV4_OFF;
+    const uint8_t *inner_ip = data + INNER_IPV4_OFF;
+    const uint8_t *inner_l4 = data + INNER_L4_OFF;
+    const uint8_t *vni = data + VXLAN_OFF + offsetof(vxlan_t, vni);
+
+    burst.outer_sip[i] = load<uint32_t>(ip + offsetof(ipv4_t, src_addr));
+    burst.outer_dip[i] = load<uint32_t>(ip + offsetof(ipv4_t, dst_addr));
+    burst.outer_protocol[i] = UDP_PROTO;
+    burst.outer_sport[i] = load<uint16_t>(data + OUTER_UDP_OFF + offsetof(udp_t, src_port));
+    burst.outer_dport[i] = load<uint16_t>(data + OUTER_UDP_OFF + offsetof(udp_t, dst_port));
+    burst.vni[i] = (uint32_t)vni[0] << 16 | (uint32_t)vni[1] << 8 | vni[2];
+    burst.inner_sip[i] = load<uint32_t>(inner_ip + offsetof(ipv4_t, src_addr));
+    burst.inner_dip[i] = load<uint32_t>(inner_ip + offsetof(ipv4_t, dst_addr));
+
+    /* TCP and UDP ports are at the same offsets */
+    uint8_t protocol = inner_ip[offsetof(ipv4_t, protocol)];
+    burst.inner_protocol[i] = protocol;
+    burst.inner_sport[i] = load<uint16_t>(inner_l4 + offsetof(tcp_t, src_port));
+    burst.inner_dport[i] = load<uint16_t>(inner_l4 + offsetof(tcp_t, dst_port));
+    burst.inner_tcp_flags[i] = protocol == TCP_PROTO ? inner_l4[offsetof(tcp_t, ecn_flags)] & 0x3f : 0;
+}
+
+void vxlan_macs(const uint8_t *data, parsed_burst_t &burst, uint32_t i)
+{
+    memcpy(burst.inner_dmac[i], data + INNER_ETHERNET_OFF + offsetof(ethernet_t, dst_addr), 6);
+    memcpy(burst.inner_smac[i], data + INNER_ETHERNET_OFF + offsetof(ethernet_t, src_addr), 6);
+}
+
+/* The burst's fields at i, from the headers parse() found */
+void header_fields(const headers_t &hdr, parsed_burst_t &burst, uint32_t i)
+{
+    burst.outer_sip[i] = hdr.ipv4 ? hdr.ipv4->src_addr : 0;
+    burst.outer_dip[i] = hdr.ipv4 ? hdr.ipv4->dst_addr : 0;
+    burst.outer_protocol[i] = hdr.ipv4 ? hdr.ipv4->protocol : 0;
+    burst.outer_sport[i] = hdr.udp ? hdr.udp->src_port : hdr.tcp ? hdr.tcp->src_port : 0;
+    burst.outer_dport[i] = hdr.udp ? hdr.udp->dst_port : hdr.tcp ? hdr.tcp->dst_port : 0;
+    burst.vni[i] = hdr.vxlan ? hdr.vxlan->get_vni() : 0;
+
+    if (hdr.inner_ethernet) {
+        memcpy(burst.inner_smac[i], hdr.inner_ethernet->src_addr, 6);
+        memcpy(burst.inner_dmac[i], hdr.inner_ethernet->dst_addr, 6);
+    } else {
+        memset(burst.inner_smac[i], 0, 6);
+        memset(burst.inner_dmac[i], 0, 6);
+    }
+
+    burst.inner_sip[i] = hdr.inner_ipv4 ? hdr.inner_ipv4->src_addr : 0;
+    burst.inner_dip[i] = hdr.inner_ipv4 ? hdr.inner_ipv4->dst_addr : 0;
+    burst.inner_protocol[i] = hdr.inner_ipv4 ? hdr.inner_ipv4->protocol : 0;
+    burst.inner_sport[i] = hdr.inner_udp ? hdr.inner_udp->src_port : hdr.inner_tcp ? hdr.inner_tcp->src_port : 0;
+    burst.inner_dport[i] = hdr.inner_udp ? hdr.inner_udp->dst_port : hdr.inner_tcp ? hdr.inner_tcp->dst_port : 0;
+    burst.inner_tcp_flags[i] = hdr.inner_tcp ? hdr.inner_tcp->flags() : 0;
+}
+
+/*
+ * A kernel of parse_burst() for one instruction set:
+ *   match(data)  the masked bytes of the first 64 of data equal the template
+ *   fill(data, vxlan, tcp, burst, first)
+ *                headers, fields and ok of the packets at first + j for
+ *                each bit j of vxlan, all of that layout, carrying TCP
+ *                where bit j of tcp is set and UDP otherwise
+ */
+struct scalar_kernel {
+    static bool match(const uint8_t *data)
+    {
+        uint64_t diff = 0;
+        for (unsigned i = 0; i < 64; i += 8) {
+            diff |= (load<uint64_t>(data + i) ^ load<uint64_t>(VXLAN_TEMPLATE.value + i)) &
+                    load<uint64_t>(VXLAN_TEMPLATE.mask + i);
+        }
+        return !diff;
+    }
+
+    static void fill(uint8_t *const *data, unsigned vxlan, unsigned tcp, parsed_burst_t &burst, uint32_t first)
+    {
+        for (; vxlan; vxlan &= vxlan - 1) {
+            unsigned j = (unsigned)__builtin_ctz(vxlan);
+            vxlan_headers(data[j], tcp & 1u << j, burst.hdr[first + j]);
+            vxlan_fields(data[j], burst, first + j);
+            vxlan_macs(data[j], burst, first + j);
+            burst.ok[first + j] = true;
+        }
+    }
+};
+
+#if defined(__x86_64__)
+
+/*
+ * Not always_inline: parse_burst_with() is instantiated without a target.
+ * The flatten of parse_burst_avx2/avx512() inlines them there instead.
+ */
+#define SIRIUS_AVX2 __attribute__((target("avx2"))) inline
+#define SIRIUS_AVX512 __attribute__((target("avx2,avx512f,avx512bw,avx512vl"))) inline
+
+static_assert(sizeof(headers_t) == 11 * sizeof(void *) && offsetof(headers_t, inner_tcp) == 10 * sizeof(void *),
+              "the kernels store headers_t as 11 pointers in declaration order");
+
+/* Two 32 byte compares, the header pointers in three stores */
+struct avx2_kernel {
+    static SIRIUS_AVX2 bool match(const uint8_t *data)
+    {
+        const __m256i *value = reinterpret_cast<const __m256i *>(VXLAN_TEMPLATE.value);
+        const __m256i *mask = reinterpret_cast<const __m256i *>(VXLAN_TEMPLATE.mask);
+        __m256i lo = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(data)), value[0]);
+        __m256i hi = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + 32)), value[1]);
+        return _mm256_testz_si256(lo, mask[0]) && _mm256_testz_si256(hi, mask[1]);
+    }
+
+    /* vxlan_headers(): frame start plus each header's offset, 0 for the absent ones */
+    static SIRIUS_AVX2 void headers(uint8_t *data, bool tcp, headers_t &hdr)
+    {
+        __m256i *out = reinterpret_cast<__m256i *>(&hdr);
+        __m256i start = _mm256_set1_epi64x((long long)data);
+        __m256i l4 = tcp ? _mm256_setr_epi64x(0, 0, -1, 0) : _mm256_setr_epi64x(0, -1, 0, 0);
+        _mm256_storeu_si256(out, _mm256_and_si256(_mm256_add_epi64(start, _mm256_setr_epi64x(0, OUTER_IPV4_OFF, 0, OUTER_UDP_OFF)),
+                                                  _mm256_setr_epi64x(-1, -1, 0, -1)));
+        _mm256_storeu_si256(out + 1, _mm256_and_si256(_mm256_add_epi64(start, _mm256_setr_epi64x(0, VXLAN_OFF, INNER_ETHERNET_OFF, INNER_IPV4_OFF)),
+                                                      _mm256_setr_epi64x(0, -1, -1, -1)));
+        _mm256_maskstore_epi64(reinterpret_cast<long long *>(out + 2), _mm256_setr_epi64x(-1, -1, -1, 0),
+                               _mm256_and_si256(_mm256_add_epi64(start, _mm256_setr_epi64x(0, INNER_L4_OFF, INNER_L4_OFF, 0)), l4));
+    }
+
+    static SIRIUS_AVX2 void fill(uint8_t *const *data, unsigned vxlan, unsigned tcp, parsed_burst_t &burst,
+                                 uint32_t first)
+    {
+        for (; vxlan; vxlan &= vxlan - 1) {
+            unsigned j = (unsigned)__builtin_ctz(vxlan);
+            headers(data[j], tcp & 1u << j, burst.hdr[first + j]);
+            vxlan_fields(data[j], burst, first + j);
+            vxlan_macs(data[j], burst, first + j);
+            burst.ok[first + j] = true;
+        }
+    }
+};
+
+/*
+ * One 64 byte compare, the header pointers in two stores. The fields are
+ * read one by one as in the other kernels: gathering a field of eight
+ * frames into one vector for a single store measured no faster than the
+ * scalar loads and stores it replaces.
+ */
+struct avx512_kernel {
+    static SIRIUS_AVX512 bool match(const uint8_t *data)
+    {
+        __m512i diff = _mm512_xor_si512(_mm512_loadu_si512(data), _mm512_load_si512(VXLAN_TEMPLATE.value));
+        return !_mm512_test_epi8_mask(diff, _mm512_load_si512(VXLAN_TEMPLATE.mask));
+    }
+
+    static SIRIUS_AVX512 void headers(uint8_t *data, bool tcp, headers_t &hdr)
+    {
+        __m512i start = _mm512_set1_epi64((long long)data);
+        __m512i offsets = _mm512_setr_epi64(0, OUTER_IPV4_OFF, 0, OUTER_UDP_OFF, 0, VXLAN_OFF, INNER_ETHERNET_OFF, INNER_IPV4_OFF);
+        _mm512_storeu_si512(&hdr, _mm512_maskz_add_epi64(0xeb, start, offsets));
+        _mm256_mask_storeu_epi64(&hdr.inner_ipv6, 0x7,
+                                 _mm256_maskz_add_epi64(tcp ? 0x4 : 0x2, _mm256_set1_epi64x((long long)data),
+                                                        _mm256_setr_epi64x(0, INNER_L4_OFF, INNER_L4_OFF, 0)));
+    }
+
+    static SIRIUS_AVX512 void fill(uint8_t *const *data, unsigned vxlan, unsigned tcp, parsed_burst_t &burst,
+                                   uint32_t first)
+    {
+        for (; vxlan; vxlan &= vxlan - 1) {
+            unsigned j = (unsigned)__builtin_ctz(vxlan);
+            headers(data[j], tcp & 1u << j, burst.hdr[first + j]);
+            vxlan_fields(data[j], burst, first + j);
+            vxlan_macs(data[j], burst, first + j);
+            burst.ok[first + j] = true;
+        }
+    }
+};
+
+#endif
+
+} // namespace
+
+bool parse(const packet_t &pkt, headers_t &hdr)
+{
+    packet_in packet(pkt);
+    memset(&hdr, 0, sizeof(hdr));
+
+    /* start */
+    if (!(hdr.ethernet = packet.extract<ethernet_t>())) {
+        return false;
+    }
+    if (ntohs(hdr.ethernet->ether_type) != IPV4_ETHTYPE) {
+        return true;
+    }
+
+    /* parse_ipv4 */
+    if (!(hdr.ipv4 = packet.extract<ipv4_t>()) || !verify_ipv4(hdr.ipv4)) {
+        return false;
+    }
+    if (hdr.ipv4->protocol == TCP_PROTO) {
+        /* parse_tcp */
+        return (hdr.tcp = packet.extract<tcp_t>()) != nullptr;
+    }
+    if (hdr.ipv4->protocol != UDP_PROTO) {
+        return true;
+    }
+
+    /* parse_udp */
+    if (!(hdr.udp = packet.extract<udp_t>())) {
+        return false;
+    }
+    if (ntohs(hdr.udp->dst_port) != UDP_PORT_VXLAN) {
+        return true;
+    }
+
+    /* parse_vxlan, parse_inner_ethernet (selects on the inner ether_type) */
+    if (!(hdr.vxlan = packet.extract<vxlan_t>()) || !(hdr.inner_ethernet = packet.extract<ethernet_t>())) {
+        return false;
+    }
+    if (ntohs(hdr.inner_ethernet->ether_type) != IPV4_ETHTYPE) {
+        return true;
+    }
+
+    /* parse_inner_ipv4 */
+    if (!(hdr.inner_ipv4 = packet.extract<ipv4_t>()) || !verify_ipv4(hdr.inner_ipv4)) {
+        return false;
+    }
+    if (hdr.inner_ipv4->protocol == TCP_PROTO) {
+        return (hdr.inner_tcp = packet.extract<tcp_t>()) != nullptr;
+    }
+    if (hdr.inner_ipv4->protocol == UDP_PROTO) {
+        return (hdr.inner_udp = packet.extract<udp_t>()) != nullptr;
+    }
+    return true;
+}
+
+namespace {
+
+/* Packets a kernel fills at once */
+constexpr uint32_t GROUP = 8;
+
+/*
+ * parse_burst() with kernel K. Frames of the VXLAN layout are collected
+ * per group of eight and filled by the kernel, the others go through
+ * parse() as they come.
+ */
+template <typename K>
+inline void parse_burst_with(const packet_t *pkts, uint32_t count, parsed_burst_t &burst)
+{
+    for (uint32_t first = 0; first < count; first += GROUP) {
+        uint32_t n = std::min(GROUP, count - first);
+        uint8_t *data[GROUP];
+        unsigned vxlan = 0;
+        unsigned tcp = 0;
+
+        for (uint32_t j = 0; j < n; j++) {
+            const packet_t &pkt = pkts[first + j];
+            data[j] = pkt.data();
+            if (pkt.len >= INNER_L4_OFF + TCP_HDR_SIZE && K::match(data[j])) {
+                const ipv4_t *inner_ipv4 = reinterpret_cast<const ipv4_t *>(data[j] + INNER_IPV4_OFF);
+                if (inner_ipv4->version_ihl == 0x45 &&
+                    (inner_ipv4->protocol == TCP_PROTO || inner_ipv4->protocol == UDP_PROTO)) {
+                    vxlan |= 1u << j;
+                    tcp |= (unsigned)(inner_ipv4->protocol == TCP_PROTO) << j;
+                    continue;
+                }
+            }
+            burst.ok[first + j] = parse(pkt, burst.hdr[first + j]);
+            header_fields(burst.hdr[first + j], burst, first + j);
+        }
+
+        K::fill(data, vxlan, tcp, burst, first);
+    }
+}
+
+void parse_burst_scalar(const packet_t *pkts, uint32_t count, parsed_burst_t &burst)
+{
+    parse_burst_with<scalar_kernel>(pkts, count, burst);
+}
+
+#if defined(__x86_64__)
+__attribute__((target("avx2"), flatten)) void parse_burst_avx2(const packet_t *pkts, uint32_t count, parsed_burst_t &burst)
+{
+    parse_burst_with<avx2_kernel>(pkts, count, burst);
+}
+
+__attribute__((target("avx2,avx512f,avx512bw,avx512vl"), flatten)) void parse_burst_avx512(const packet_t *pkts,
+                                                                                          uint32_t count,
+                                                                                          parsed_burst_t &burst)
+{
+    parse_burst_with<avx512_kernel>(pkts, count, burst);
+}
+#endif
+
+parse_kernel_t best_kernel()
+{
+#if defined(__x86_64__)
+    /* Also runs from a static initializer */
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("avx512vl")) {
+        return PARSE_KERNEL_AVX512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return PARSE_KERNEL_AVX2;
+    }
+#endif
+    return PARSE_KERNEL_SCALAR;
+}
+
+parse_kernel_t kernel_in_use = best_kernel();
+
+} // namespace
+
+void parse_burst(const packet_t *pkts, uint32_t count, parsed_burst_t &burst)
+{
+    switch (kernel_in_use) {
+#if defined(__x86_64__)
+    case PARSE_KERNEL_AVX512:
+        return parse_burst_avx512(pkts, count, burst);
+    case PARSE_KERNEL_AVX2:
+        return parse_burst_avx2(pkts, count, burst);
+#endif
+    default:
+        return parse_burst_scalar(pkts, count, burst);
+    }
+}
+
+parse_kernel_t parse_burst_kernel()
+{
+    return kernel_in_use;
+}
+
+bool parse_burst_use(parse_kernel_t kernel)
+{
+    if (kernel > best_kernel()) {
+        return false;
+    }
+    kernel_in_use = kernel;
+    return true;
+}
+
+const char *parse_kernel_name(parse_kernel_t kernel)
+{
+    switch (kernel) {
+    case PARSE_KERNEL_AVX2:
+        return "avx2";
+    case PARSE_KERNEL_AVX512:
+        return "avx512";
+    default:
+        return "scalar";
+    }
+}
+
+} // namespace sirius
@@ -0,0 +1,71 @@
+#ifndef _SIRIUS_PARSER_H_
+#define _SIRIUS_PARSER_H_
+
+#include "sirius_headers.h"
+#include "sirius_packet.h"
+
+namespace sirius {
+
+/*
+ * sirius_parser of sirius_parser.p4. Fills hdr with pointers into the
+ * packet; returns false on a truncated frame or a failed verify()
+ * (IPv4IncorrectVersion, IPv4OptionsNotSupported).
+ */
+bool parse(const packet_t &pkt, headers_t &hdr);
+
+/* Packets parse_burst() takes at once */
+constexpr uint32_t PARSER_MAX_BURST = 256;
+
+/*
+ * A parsed burst: the headers of each packet, and the fields the tables
+ * key on, one array per field so a stage can stream through one field
+ * of the whole burst. Addresses and ports are in network byte order, the
+ * VNI is decoded; fields of headers a packet does not have are 0.
+ */
+struct parsed_burst_t {
+    headers_t hdr[PARSER_MAX_BURST];
+    bool ok[PARSER_MAX_BURST]; /* false where parse() would return false */
+
+    uint32_t outer_sip[PARSER_MAX_BURST];
+    uint32_t outer_dip[PARSER_MAX_BURST];
+    uint16_t outer_sport[PARSER_MAX_BURST];
+    uint16_t outer_dport[PARSER_MAX_BURST];
+    uint8_t outer_protocol[PARSER_MAX_BURST];
+    uint32_t vni[PARSER_MAX_BURST];
+    uint8_t inner_smac[PARSER_MAX_BURST][6];
+    uint8_t inner_dmac[PARSER_MAX_BURST][6];
+    uint32_t inner_sip[PARSER_MAX_BURST];
+    uint32_t inner_dip[PARSER_MAX_BURST];
+    uint16_t inner_sport[PARSER_MAX_BURST];
+    uint16_t inner_dport[PARSER_MAX_BURST];
+    uint8_t inner_protocol[PARSER_MAX_BURST];
+    uint8_t inner_tcp_flags[PARSER_MAX_BURST];
+};
+
+/*
+ * parse() over up to PARSER_MAX_BURST packets. Frames laid out as
+ * VXLAN over IPv4 carrying IPv4 TCP or UDP, without IP options, are
+ * recognised by comparing their first 64 bytes against a template and
+ * get their headers and fields from fixed offsets; other frames go
+ * through parse().
+ */
+void parse_burst(const packet_t *pkts, uint32_t count, parsed_burst_t &burst);
+
+/* Instruction sets the template compare of parse_burst() comes in */
+enum parse_kernel_t {
+    PARSE_KERNEL_SCALAR,
+    PARSE_KERNEL_AVX2,   /* two 32 byte compares */
+    PARSE_KERNEL_AVX512, /* one 64 byte compare */
+};
+
+/* The kernel parse_burst() runs, by default the widest the CPU has */
+parse_kernel_t parse_burst_kernel();
+
+/* Switches parse_burst() to kernel, false if the CPU lacks it; call before workers start */
+bool parse_burst_use(parse_kernel_t kernel);
+
+const char *parse_kernel_name(parse_kernel_t kernel);
+
+} // namespace sirius
+
+#endif /* _SIRIUS_PARSER_H_ */
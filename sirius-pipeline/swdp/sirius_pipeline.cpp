@@ -0,0 +1,274 @@
+#include "sirius_pipeline.h"
+
+#include "sirius_acl.h"
+#include "sirius_checksum.h"
+#include "sirius_conntrack.h"
+#include "sirius_parser.h"
+#include "sirius_vxlan.h"
+
+namespace sirius {
+
+namespace {
+
+/* Flow cache key of a VXLAN packet with an inner IPv4 header */
+bool flow_cache_key(const parsed_burst_t &burst, uint32_t i, flow_cache_key_t &key)
+{
+    if (!burst.hdr[i].vxlan || !burst.hdr[i].inner_ipv4) {
+        return false;
+    }
+
+    key.sip = burst.inner_sip[i];
+    key.dip = burst.inner_dip[i];
+    key.sport = burst.inner_sport[i];
+    key.dport = burst.inner_dport[i];
+    key.vni_protocol = burst.vni[i] << 8 | burst.inner_protocol[i];
+    memcpy(key.smac, burst.inner_smac[i], sizeof(key.smac));
+    memcpy(key.dmac, burst.inner_dmac[i], sizeof(key.dmac));
+    return true;
+}
+
+/*
+ * TCP packets with SYN, FIN or RST move conntrack state, and the pipeline
+ * traps ICMP redirects, they always take the slow path
+ */
+bool cacheable(const parsed_burst_t &burst, uint32_t i, const packet_t &pkt)
+{
+    if (burst.inner_protocol[i] == ICMP_PROTO) {
+        return !icmp_redirect_type(burst.hdr[i].inner_ipv4, pkt.data() + pkt.len);
+    }
+    return !(burst.inner_tcp_flags[i] & (TCP_FLAG_SYN | TCP_FLAG_FIN | TCP_FLAG_RST));
+}
+
+/* The inner IPv4 and TCP/UDP checksums, unless the NIC checked them */
+bool inner_checksums_ok(const packet_t &pkt, const headers_t &hdr)
+{
+    if (pkt.ol_flags & (PACKET_RX_CSUM_GOOD | PACKET_RX_CSUM_BAD)) {
+        return !(pkt.ol_flags & PACKET_RX_CSUM_BAD);
+    }
+    return !hdr.inner_ipv4 ||
+           (ipv4_checksum_ok(hdr.inner_ipv4) && l4_checksum_ok(hdr.inner_ipv4, pkt.data() + pkt.len));
+}
+
+} // namespace
+
+void sirius_pipeline::process_burst(packet_t *pkts, uint32_t count)
+{
+    for (; count > PIPELINE_MAX_BURST; pkts += PIPELINE_MAX_BURST, count -= PIPELINE_MAX_BURST) {
+        process_burst(pkts, PIPELINE_MAX_BURST);
+    }
+
+    parsed_burst_t burst;
+    flow_cache_key_t key[PIPELINE_MAX_BURST];
+    sirius_flow_cache::probe_t probe[PIPELINE_MAX_BURST];
+    bool keyed[PIPELINE_MAX_BURST];
+    bool hit[PIPELINE_MAX_BURST];
+
+    /* Read before the tables, so a result is never tagged newer than the tables it came from */
+    uint32_t generation = m_switch.generations.global();
+    if (generation != m_appliance_generation) {
+        m_appliance = {};
+        if (!m_switch.appliance.lookup(0, m_appliance)) {
+            appliance_compile(m_appliance);
+        }
+        m_appliance_generation = generation;
+    }
+
+    parse_burst(pkts, count, burst);
+
+    /* The flow cache key and the tag words of its sets */
+    for (uint32_t i = 0; i < count; i++) {
+        pkts[i].drop = !burst.ok[i];
+        if (burst.ok[i] && m_appliance.verify_inner_checksum && !inner_checksums_ok(pkts[i], burst.hdr[i])) {
+            pkts[i].drop = true;
+            m_checksum_drops++;
+        }
+        keyed[i] = !pkts[i].drop && flow_cache_key(burst, i, key[i]);
+        hit[i] = keyed[i] && cacheable(burst, i, pkts[i]);
+        if (hit[i]) {
+            m_cache.probe(key[i], probe[i]);
+        }
+    }
+
+    /* The entries whose tags match */
+    for (uint32_t i = 0; i < count; i++) {
+        if (hit[i]) {
+            m_cache.prefetch(probe[i]);
+        }
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        if (!pkts[i].drop) {
+            forward(pkts[i], burst.hdr[i], keyed[i] ? &key[i] : nullptr, hit[i] ? &probe[i] : nullptr, generation);
+        }
+    }
+
+    /* The connections of the cache hits, their buckets prefetched first so the misses overlap */
+    for (uint32_t i = 0; i < m_refresh_count; i++) {
+        conntrack_refresh(m_flows, m_sync, m_aging, m_refresh[i].key, m_refresh[i].direction);
+    }
+    m_refresh_count = 0;
+    for (uint32_t i = 0; i < m_segment_count; i++) {
+        const conntrack_segment_t &segment = m_segments[i];
+        m_seqs.advance(segment.key, segment.direction, segment.end, segment.window);
+    }
+    m_segment_count = 0;
+
+    /* Aging first, so its removals go out with this poll of the sync */
+    if (m_aging) {
+        m_aging->set_timeouts(m_appliance.tcp_flow_timeout, m_appliance.udp_flow_timeout);
+        m_aging->poll(m_sync);
+    }
+    if (m_sync) {
+        m_sync->poll();
+    }
+}
+
+void sirius_pipeline::forward(packet_t &pkt, headers_t &hdr, const flow_cache_key_t *key,
+                              const sirius_flow_cache::probe_t *probe, uint32_t generation)
+{
+    uint32_t bytes = pkt.len;
+    flow_action_t action;
+    bool dropped;
+    if (probe && m_cache.lookup(*key, *probe, generation, m_flows.tick(), action)) {
+        /* Fast path; only conntrack can overrule the cached ACL verdict */
+        vxlan_decap(pkt, hdr);
+        dropped = action.acl_drop &&
+                  !(action.conntrack && conntrack_allows(m_flows, hdr, action.direction, action.eni));
+
+        /* Connections the ACL lets through only need to be kept alive, at the end of the burst */
+        if (m_aging && action.conntrack && action.refresh && !action.acl_drop &&
+            conntrack_key(hdr, action.eni, m_refresh[m_refresh_count].key)) {
+            m_flows.prefetch(m_refresh[m_refresh_count].key);
+            m_refresh[m_refresh_count++].direction = action.direction;
+        }
+
+        /* The segments move their connection's sequence numbers along, for its RSTs */
+        if (action.conntrack && !dropped &&
+            conntrack_segment(hdr, action.eni, action.direction, m_segments[m_segment_count])) {
+            m_seqs.prefetch(m_segments[m_segment_count++].key);
+        }
+    } else {
+        metadata_t meta = {};
+        meta.acl_sample = sample_acl();
+        if (!ingress(pkt, hdr, meta, action)) {
+            pkt.drop = true;
+            return;
+        }
+        dropped = meta.dropped;
+
+        /* The <stage>_counter of the ACL rules that classified the packet; cache hits skip the ACL */
+        sirius_counters::block *const *acl =
+            meta.direction == DIRECTION_OUTBOUND ? m_outbound_acl_counters : m_inbound_acl_counters;
+        for (unsigned i = 0; i < sirius_switch::ACL_STAGES; i++) {
+            if (meta.acl_counter[i]) {
+                acl[i]->count(meta.acl_counter[i], bytes);
+            }
+        }
+
+        if (key && action.uncached) {
+            /* A closing connection: conntrack waits for its last ACK */
+            m_cache.erase(*key);
+        } else if (probe) {
+            /* The ACL was skipped for a connection conntrack allowed, the cache needs its verdict */
+            bool outbound = meta.direction == DIRECTION_OUTBOUND;
+            if (outbound ? meta.conntrack_data.allow_out : meta.conntrack_data.allow_in) {
+                metadata_t acl_meta = {};
+                acl_meta.eni = meta.eni;
+                acl_apply(outbound ? m_switch.outbound_acl : m_switch.inbound_acl, hdr, acl_meta);
+                action.acl_drop = acl_meta.dropped;
+            }
+            m_cache.insert(*key, generation, action);
+        }
+    }
+
+    /* Dropped packets skip the encap, nobody sees it */
+    if (!dropped && action.encap &&
+        !vxlan_encap(pkt, hdr, m_appliance.encap, action.vxlan, m_offload_checksum)) {
+        pkt.drop = true;
+    }
+
+    /* The direct counters of the routing and ca_to_pa entries the packet hit */
+    if (action.routing_counter) {
+        m_routing_counters->count(action.routing_counter, bytes);
+    }
+    if (action.ca_to_pa_counter) {
+        m_ca_to_pa_counters->count(action.ca_to_pa_counter, bytes);
+    }
+
+    /* eni_meter: NoAction and its direct counter, which counts the packet as received */
+    m_eni_counters->count(eni_counter_slot(action.eni, action.direction, dropped), bytes);
+
+    pkt.egress_port = PIPELINE_EGRESS_PORT;
+    pkt.drop |= dropped;
+}
+
+bool sirius_pipeline::ingress(packet_t &pkt, headers_t &hdr, metadata_t &meta, flow_action_t &action)
+{
+    action = {};
+
+    /* direction_lookup */
+    direction_lookup_entry_t direction;
+    if (hdr.vxlan && m_switch.direction_lookup.lookup(hdr.vxlan->get_vni(), direction)) {
+        meta.direction = direction.direction;
+    }
+
+    /* appliance */
+    appliance_entry_t appliance;
+    if (m_switch.appliance.lookup(meta.appliance_id, appliance)) {
+        meta.encap_data.underlay_dmac = appliance.neighbor_mac;
+        meta.encap_data.underlay_smac = appliance.mac;
+        meta.encap_data.underlay_sip = appliance.ip;
+    }
+
+    /*
+     * Outer header processing. slb_decap, inbound_routing and
+     * pa_validation have no DASH API yet, inbound traffic takes the
+     * plain vxlan_decap action of inbound_routing.
+     */
+    if (meta.direction == DIRECTION_OUTBOUND) {
+        vxlan_decap(pkt, hdr);
+        outbound(pkt, hdr, meta, action);
+    } else if (meta.direction == DIRECTION_INBOUND) {
+        uint32_t outer_sip = hdr.ipv4 ? hdr.ipv4->src_addr : 0;
+        vxlan_decap(pkt, hdr);
+        if (hdr.ipv4 && icmp_redirect_type(hdr.ipv4, pkt.data() + pkt.len)) {
+            /* Load balancer fast path: the redirect is for the pipeline, not the VM */
+            redirect(pkt, hdr, outer_sip);
+            return false;
+        }
+        inbound(pkt, hdr, meta, action);
+    } else {
+        /* Not addressed to a VNI of this appliance */
+        return false;
+    }
+
+    action.direction = meta.direction;
+    action.eni = meta.eni;
+    return true;
+}
+
+void sirius_pipeline::encap_action(const headers_t &hdr, const metadata_t &meta, mac_t overlay_dmac,
+                                   flow_action_t &action) const
+{
+    /* The outer source port spreads the flows of the tunnel over the underlay's paths */
+    uint32_t sip = hdr.ipv4 ? hdr.ipv4->src_addr : 0;
+    uint32_t dip = hdr.ipv4 ? hdr.ipv4->dst_addr : 0;
+    uint8_t protocol = hdr.ipv4 ? hdr.ipv4->protocol : 0;
+    uint16_t sport = 0;
+    uint16_t dport = 0;
+    if (hdr.tcp) {
+        sport = hdr.tcp->src_port;
+        dport = hdr.tcp->dst_port;
+    } else if (hdr.udp) {
+        sport = hdr.udp->src_port;
+        dport = hdr.udp->dst_port;
+    }
+    uint16_t src_port = vxlan_src_port(m_appliance.encap_sport_hash, m_appliance.encap_sport_min,
+                                       m_appliance.encap_sport_max, sip, dip, sport, dport, protocol);
+
+    action.encap = true;
+    vxlan_flow(action.vxlan, meta.encap_data.underlay_dmac, meta.encap_data.underlay_dip, overlay_dmac,
+               meta.encap_data.vni, src_port);
+}
+
+} // namespace sirius
@@ -0,0 +1,206 @@
+#ifndef _SIRIUS_PIPELINE_H_
+#define _SIRIUS_PIPELINE_H_
+
+#include "sirius_conntrack.h"
+#include "sirius_flow_aging.h"
+#include "sirius_flow_cache.h"
+#include "sirius_flow_fixup.h"
+#include "sirius_flow_sync.h"
+#include "sirius_headers.h"
+#include "sirius_metadata.h"
+#include "sirius_packet.h"
+#include "sirius_parser.h"
+#include "sirius_switch.h"
+#include "sirius_vxlan.h"
+
+namespace sirius {
+
+/* standard_metadata.egress_spec at the end of sirius_ingress */
+constexpr uint16_t PIPELINE_EGRESS_PORT = 1;
+
+/* Packets process_burst() takes through each stage at once, larger bursts are split */
+constexpr uint32_t PIPELINE_MAX_BURST = PARSER_MAX_BURST;
+
+/*
+ * Software execution of sirius_pipeline.p4 against the tables of one
+ * sirius_switch: parser, sirius_ingress (direction_lookup, appliance,
+ * outbound/inbound, eni_meter) and deparser. Headers are rewritten in
+ * place, so the deparser is a no-op. Packets need PACKET_HEADROOM in
+ * front of them: vxlan_decap only moves the start of the packet past the
+ * outer headers, and vxlan_encap copies the outer headers the control
+ * plane compiled for the appliance into the headroom, with the fields of
+ * the flow the slow path compiled for the flow cache.
+ *
+ * The first packet of a flow takes the slow path through the tables and
+ * leaves the outcome in the pipeline's flow cache. The following packets
+ * of the flow take the fast path: one cache lookup, vxlan_decap and
+ * vxlan_encap with the cached parameters. A change to a table moves the
+ * flows that read it back to the slow path for one packet.
+ *
+ * process_burst() runs a burst stage by stage rather than packet by
+ * packet: it parses all packets with parse_burst(), then probes the
+ * flow cache for all of them, prefetching the cache lines the next stage
+ * reads, so the cache misses of a burst overlap instead of following
+ * each other.
+ *
+ * Inbound ICMP redirects of the SLB MUX go to the pipeline itself
+ * rather than to the VM: they move the connection they redirect off the
+ * MUX, on the slow and the fast path (sirius_flow_fixup.h).
+ *
+ * The flow cache, the sequence numbers of the TCP connections conntrack
+ * watches open and close, the PAs of the redirected connections and the
+ * counter blocks (eni_counter, routing_counter, ca_to_pa_counter, the
+ * <stage>_counter of the ACL stages) are the only state of a pipeline
+ * and have no locks;
+ * use one pipeline per worker thread. Connection state goes to the
+ * switch's flow table, or to the partition of it a worker owns
+ * (sirius_dataplane). replicate() sends the changes the pipeline makes
+ * to it to the HA peer; the flow sync has to see all of them, so it
+ * takes a table only this pipeline writes.
+ */
+class sirius_pipeline {
+public:
+    explicit sirius_pipeline(sirius_switch &sw, size_t cache_flows = sirius_flow_cache::DEFAULT_CAPACITY)
+        : sirius_pipeline(sw, sw.flows, cache_flows)
+    {
+    }
+
+    sirius_pipeline(sirius_switch &sw, sirius_flow_table &flows, size_t cache_flows,
+                    const memory_placement_t &cache_placement = {})
+        : m_switch(sw), m_flows(flows), m_cache(sw.generations, cache_flows, cache_placement),
+          m_eni_counters(sw.eni_counters.attach()),
+          m_routing_counters(sw.routing.counters().attach()),
+          m_ca_to_pa_counters(sw.ca_to_pa.counters().attach())
+    {
+        for (unsigned i = 0; i < sirius_switch::ACL_STAGES; i++) {
+            m_outbound_acl_counters[i] = sw.outbound_acl[i].counters().attach();
+            m_inbound_acl_counters[i] = sw.inbound_acl[i].counters().attach();
+        }
+        appliance_compile(m_appliance);
+    }
+
+    ~sirius_pipeline()
+    {
+        m_switch.eni_counters.detach(m_eni_counters);
+        m_switch.routing.counters().detach(m_routing_counters);
+        m_switch.ca_to_pa.counters().detach(m_ca_to_pa_counters);
+        for (unsigned i = 0; i < sirius_switch::ACL_STAGES; i++) {
+            m_switch.outbound_acl[i].counters().detach(m_outbound_acl_counters[i]);
+            m_switch.inbound_acl[i].counters().detach(m_inbound_acl_counters[i]);
+        }
+    }
+
+    /* Runs one packet, sets pkt.egress_port or pkt.drop */
+    void process(packet_t &pkt) { process_burst(&pkt, 1); }
+
+    void process_burst(packet_t *pkts, uint32_t count);
+
+    /*
+     * Replicates the connection table through `sync`, which the pipeline
+     * polls after every burst; nullptr stops. Not while a burst runs.
+     */
+    void replicate(sirius_flow_sync *sync) { m_sync = sync; }
+
+    /*
+     * Ages the connections this pipeline creates with `aging`, which it
+     * polls after every burst with the timeouts of the appliance; nullptr
+     * stops. Not while a burst runs.
+     */
+    void age(sirius_flow_aging *aging) { m_aging = aging; }
+
+    /*
+     * Leaves the outer IPv4 checksum of the encap to the NIC, which
+     * computes it for packets with PACKET_TX_IPV4_CSUM. Not while a burst
+     * runs.
+     */
+    void offload_checksum(bool offload) { m_offload_checksum = offload; }
+
+    /* The ICMP redirects the pipeline trapped, a snapshot while a burst runs */
+    const flow_fixup_stats_t &fixup_stats() const { return m_fixup_stats; }
+
+    /* Packets dropped for a wrong inner checksum, a snapshot while a burst runs */
+    uint64_t checksum_drops() const { return m_checksum_drops; }
+
+private:
+    /*
+     * Everything after the flow cache probe for one parsed packet: the
+     * fast path on a hit, else the slow path, then vxlan_encap. key is
+     * the packet's flow cache key, if it has one, probe its probe if the
+     * packet may take the fast path.
+     */
+    void forward(packet_t &pkt, headers_t &hdr, const flow_cache_key_t *key, const sirius_flow_cache::probe_t *probe,
+                 uint32_t generation);
+
+    /*
+     * Slow path: direction_lookup, appliance, decap and the outbound or
+     * inbound control, up to the final vxlan_encap, which is left in
+     * action. False for packets not addressed to this appliance, and for
+     * the ICMP redirects it traps.
+     */
+    bool ingress(packet_t &pkt, headers_t &hdr, metadata_t &meta, flow_action_t &action);
+
+    /* sirius_outbound.cpp */
+    void outbound(const packet_t &pkt, headers_t &hdr, metadata_t &meta, flow_action_t &action);
+
+    /* sirius_inbound.cpp */
+    void inbound(const packet_t &pkt, headers_t &hdr, metadata_t &meta, flow_action_t &action);
+
+    /*
+     * sirius_flow_fixup.cpp: the flow fixup for an ICMP redirect, after
+     * vxlan_decap; outer_sip is the PA it came from, in network byte order
+     */
+    void redirect(const packet_t &pkt, const headers_t &hdr, uint32_t outer_sip);
+
+    /* Sends a connection conntrack_update() opened again back to the VIP, forgetting its redirect */
+    void unredirect(uint8_t before, const conntrack_flow_t &flow);
+
+    /* Whether the ACL hits of the next slow path packet are sampled for the top rules */
+    bool sample_acl()
+    {
+        /* xorshift32 */
+        m_acl_sample ^= m_acl_sample << 13;
+        m_acl_sample ^= m_acl_sample >> 17;
+        m_acl_sample ^= m_acl_sample << 5;
+        return !(m_acl_sample & (sirius_acl_table::TOP_SAMPLE - 1));
+    }
+
+    /* Parameters of the vxlan_encap ending both controls, for the packet in hdr */
+    void encap_action(const headers_t &hdr, const metadata_t &meta, mac_t overlay_dmac, flow_action_t &action) const;
+
+    sirius_switch &m_switch;
+    sirius_flow_table &m_flows;
+    sirius_flow_sync *m_sync = nullptr;
+    sirius_flow_aging *m_aging = nullptr;
+
+    /* Connections of the burst's cache hits the ACL let through, kept alive for the aging after it */
+    struct refresh_t {
+        flow_key_t key;
+        direction_t direction;
+    };
+    refresh_t m_refresh[PIPELINE_MAX_BURST];
+    uint32_t m_refresh_count = 0;
+
+    /* TCP segments of the burst's cache hits, for the sequence numbers of their connections after it */
+    conntrack_segment_t m_segments[PIPELINE_MAX_BURST];
+    uint32_t m_segment_count = 0;
+    sirius_flow_cache m_cache;
+    conntrack_seq_cache m_seqs;
+    flow_fixup_cache m_fixups;
+    flow_fixup_stats_t m_fixup_stats = {};
+    bool m_offload_checksum = false;
+    uint64_t m_checksum_drops = 0;
+    sirius_counters::block *m_eni_counters;
+    sirius_counters::block *m_routing_counters;
+    sirius_counters::block *m_ca_to_pa_counters;
+    sirius_counters::block *m_outbound_acl_counters[sirius_switch::ACL_STAGES];
+    sirius_counters::block *m_inbound_acl_counters[sirius_switch::ACL_STAGES];
+    uint32_t m_acl_sample = 0x9e3779b9;
+
+    /* The appliance as of m_appliance_generation, for the outer headers of the encap, the timeouts and checksums */
+    appliance_entry_t m_appliance = {};
+    uint32_t m_appliance_generation = 0;
+};
+
+} // namespace sirius
+
+#endif /* _SIRIUS_PIPELINE_H_ */
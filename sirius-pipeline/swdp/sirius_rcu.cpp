@@ -0,0 +1,93 @@
+#include "sirius_rcu.h"
+
+#include <cstdlib>
+#include <thread>
+
+namespace sirius {
+
+sirius_rcu &sirius_rcu::instance()
+{
+    static sirius_rcu rcu;
+    return rcu;
+}
+
+sirius_rcu::reader_t *sirius_rcu::attach()
+{
+    /* Gives the slot back when the thread exits */
+    struct detach_t {
+        reader_t *slot = nullptr;
+
+        ~detach_t()
+        {
+            if (slot) {
+                slot->epoch.store(0, std::memory_order_relaxed);
+                slot->used.store(false, std::memory_order_release);
+            }
+        }
+    };
+    static thread_local detach_t detach;
+
+    for (reader_t &r : m_readers) {
+        bool expected = false;
+        if (!r.used.load(std::memory_order_relaxed) &&
+            r.used.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+            detach.slot = &r;
+            return &r;
+        }
+    }
+    /* More live reader threads than slots is a setup error */
+    abort();
+}
+
+bool sirius_rcu::poll(uint64_t grace) const
+{
+    for (const reader_t &r : m_readers) {
+        uint64_t epoch = r.epoch.load(std::memory_order_seq_cst);
+        if (epoch && epoch < grace) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void sirius_rcu::synchronize()
+{
+    uint64_t grace = start_grace_period();
+    while (!poll(grace)) {
+        std::this_thread::yield();
+    }
+}
+
+rcu_reclaimer::~rcu_reclaimer()
+{
+    if (!m_waiting.empty() || !m_retired.empty()) {
+        sirius_rcu::instance().synchronize();
+    }
+    for (batch_t &batch : m_waiting) {
+        free_all(batch.objects);
+    }
+    free_all(m_retired);
+}
+
+void rcu_reclaimer::reclaim()
+{
+    sirius_rcu &rcu = sirius_rcu::instance();
+    if (!m_retired.empty()) {
+        m_waiting.push_back({ rcu.start_grace_period(), std::move(m_retired) });
+        m_retired.clear();
+    }
+    while (!m_waiting.empty() && rcu.poll(m_waiting.front().grace)) {
+        free_all(m_waiting.front().objects);
+        m_waiting.pop_front();
+    }
+}
+
+void rcu_reclaimer::free_all(std::vector<object_t> &objects)
+{
+    for (const object_t &object : objects) {
+        object.free(object.context, object.ptr);
+    }
+    objects.clear();
+}
+
+} // namespace sirius
@@ -0,0 +1,192 @@
+#ifndef _SIRIUS_RCU_H_
+#define _SIRIUS_RCU_H_
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <shared_mutex>
+#include <vector>
+
+namespace sirius {
+
+/*
+ * Epoch based read-copy-update for structures the data path reads
+ * without locks.
+ *
+ * A reader brackets its accesses with read_lock()/read_unlock() (or an
+ * rcu_read_guard). Read-side sections nest and never block: entering
+ * one is a store of the current epoch and a fence. A writer publishes a
+ * new version with an atomic pointer store, then calls synchronize()
+ * before it frees the old version; synchronize() returns once every
+ * reader that entered its section before the store has left it.
+ *
+ * Reader threads get a slot on their first read_lock() and give it back
+ * when they exit.
+ */
+class sirius_rcu {
+public:
+    static constexpr unsigned MAX_READERS = 1024;
+
+    static sirius_rcu &instance();
+
+    void read_lock()
+    {
+        thread_state &t = t_state;
+        if (t.depth++ == 0) {
+            if (!t.slot) {
+                t.slot = attach();
+            }
+            t.slot->epoch.store(m_epoch.load(std::memory_order_acquire), std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+        }
+    }
+
+    void read_unlock()
+    {
+        thread_state &t = t_state;
+        if (--t.depth == 0) {
+            t.slot->epoch.store(0, std::memory_order_release);
+        }
+    }
+
+    /* Waits until no reader is in a section entered before the call */
+    void synchronize();
+
+    uint64_t start_grace_period() { return m_epoch.fetch_add(1, std::memory_order_seq_cst) + 1; }
+
+    /* True once the grace period returned by start_grace_period() has elapsed */
+    bool poll(uint64_t grace) const;
+
+private:
+    struct alignas(64) reader_t {
+        std::atomic<uint64_t> epoch{ 0 };
+        std::atomic<bool> used{ false };
+    };
+
+    /* Trivial and zero initialized, so the read side needs no TLS init call */
+    struct thread_state {
+        reader_t *slot;
+        unsigned depth;
+    };
+
+    reader_t *attach();
+
+    static inline thread_local thread_state t_state;
+
+    std::atomic<uint64_t> m_epoch{ 1 };
+    reader_t m_readers[MAX_READERS];
+};
+
+class rcu_read_guard {
+public:
+    rcu_read_guard() { sirius_rcu::instance().read_lock(); }
+    ~rcu_read_guard() { sirius_rcu::instance().read_unlock(); }
+
+    rcu_read_guard(const rcu_read_guard &) = delete;
+    rcu_read_guard &operator=(const rcu_read_guard &) = delete;
+};
+
+/*
+ * Reader-writer lock for tables the control plane writes in place and the
+ * data path reads on every packet. read() runs inside an RCU read-side
+ * section and writes no shared cache line while no writer is active, so
+ * readers on different cores do not contend. A writer raises a flag and
+ * waits for a grace period, after which readers that missed the flag
+ * have left and new ones wait on the lock until the write is done.
+ *
+ * Writes cost a grace period. read() must not be called from inside
+ * another read-side section, a writer would wait for it forever.
+ */
+class rcu_rw_lock {
+public:
+    /* Returns fn(), which sees no write in progress */
+    template <typename Fn>
+    auto read(Fn &&fn) const
+    {
+        {
+            rcu_read_guard guard;
+            if (!m_writing.load(std::memory_order_acquire)) {
+                return fn();
+            }
+        }
+        std::shared_lock<std::shared_mutex> lock(m_lock);
+        return fn();
+    }
+
+    void lock()
+    {
+        m_lock.lock();
+        m_writing.store(true, std::memory_order_seq_cst);
+        sirius_rcu::instance().synchronize();
+    }
+
+    void unlock()
+    {
+        m_writing.store(false, std::memory_order_release);
+        m_lock.unlock();
+    }
+
+    /* Control plane reads */
+    void lock_shared() const { m_lock.lock_shared(); }
+    void unlock_shared() const { m_lock.unlock_shared(); }
+
+private:
+    mutable std::shared_mutex m_lock;
+    std::atomic<bool> m_writing{ false };
+};
+
+/*
+ * Deferred free of the objects one writer unpublished. Objects retired
+ * since the last reclaim() share one grace period; reclaim() starts it
+ * and frees the earlier batches whose grace period has elapsed, so the
+ * writer never waits for readers.
+ */
+class rcu_reclaimer {
+public:
+    rcu_reclaimer() = default;
+    ~rcu_reclaimer();
+
+    rcu_reclaimer(const rcu_reclaimer &) = delete;
+    rcu_reclaimer &operator=(const rcu_reclaimer &) = delete;
+
+    template <typename T>
+    void retire(T *object)
+    {
+        m_retired.push_back({ object, nullptr, [](void *, void *p) { delete static_cast<T *>(p); } });
+    }
+
+    template <typename T>
+    void retire_array(T *array)
+    {
+        m_retired.push_back({ array, nullptr, [](void *, void *p) { delete[] static_cast<T *>(p); } });
+    }
+
+    /* For objects of an allocator: free(context, object) */
+    void retire(void *object, void (*free)(void *context, void *object), void *context)
+    {
+        m_retired.push_back({ object, context, free });
+    }
+
+    void reclaim();
+
+private:
+    struct object_t {
+        void *ptr;
+        void *context;
+        void (*free)(void *context, void *ptr);
+    };
+
+    struct batch_t {
+        uint64_t grace;
+        std::vector<object_t> objects;
+    };
+
+    static void free_all(std::vector<object_t> &objects);
+
+    std::vector<object_t> m_retired;
+    std::deque<batch_t> m_waiting;
+};
+
+} // namespace sirius
+
+#endif /* _SIRIUS_RCU_H_ */
@@ -0,0 +1,353 @@
+#include "sirius_routing.h"
+
+#include <algorithm>
+#include <unordered_map>
+
+namespace sirius {
+
+namespace {
+
+constexpr size_t ENI_COUNT = 1u << 16;
+
+/* A batch touching more than 1/FULL_REBUILD_RATIO of an ENI's routes rebuilds its trie */
+constexpr size_t FULL_REBUILD_RATIO = 64;
+
+} // namespace
+
+sirius_routing::sirius_routing() : m_roots(new std::atomic<node_t *>[ENI_COUNT]())
+{
+}
+
+sirius_routing::~sirius_routing()
+{
+    for (size_t eni = 0; eni < ENI_COUNT; eni++) {
+        node_t *root = m_roots[eni].load(std::memory_order_relaxed);
+        if (root) {
+            free_tree(*root);
+            m_heap.free(root);
+        }
+    }
+}
+
+bool sirius_routing::lookup(const routing_key_t &key, routing_entry_t &value) const
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    auto eni = m_routes.find(key.eni);
+    if (eni == m_routes.end()) {
+        return false;
+    }
+    auto it = eni->second.find(route_id(key));
+    if (it == eni->second.end()) {
+        return false;
+    }
+    value = it->second;
+    return true;
+}
+
+size_t sirius_routing::size() const
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    return size_held();
+}
+
+size_t sirius_routing::size_held() const
+{
+    size_t count = 0;
+    for (const auto &eni : m_routes) {
+        count += eni.second.size();
+    }
+    return count;
+}
+
+void sirius_routing::snapshot_held(std::vector<uint32_t> &slots, std::vector<counter_t> &counts) const
+{
+    slots.clear();
+    for (const auto &eni : m_routes) {
+        for (const auto &route : eni.second) {
+            slots.push_back(route.second.counter);
+        }
+    }
+    counts.resize(slots.size());
+    m_counters.read(slots.data(), slots.size(), counts.data());
+}
+
+size_t sirius_routing::memory() const
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    return m_bytes;
+}
+
+bool sirius_routing::set_placement(const memory_placement_t &placement)
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    if (!m_routes.empty()) {
+        return false;
+    }
+    m_heap.set_placement(placement);
+    return true;
+}
+
+void sirius_routing::commit(const std::vector<routing_key_t> &changes)
+{
+    if (changes.empty()) {
+        return;
+    }
+
+    std::unordered_map<uint16_t, std::vector<const routing_key_t *>> by_eni;
+    for (const routing_key_t &key : changes) {
+        by_eni[key.eni].push_back(&key);
+    }
+
+    for (const auto &eni : by_eni) {
+        auto routes = m_routes.find(eni.first);
+        size_t count = routes == m_routes.end() ? 0 : routes->second.size();
+        if (eni.second.size() * FULL_REBUILD_RATIO >= count) {
+            rebuild(eni.first, 0, 0);
+            continue;
+        }
+        for (const routing_key_t *key : eni.second) {
+            rebuild(eni.first, key->prefix, key->prefix_len ? (key->prefix_len - 1) / STRIDE : 0);
+        }
+    }
+
+    m_reclaim.reclaim();
+}
+
+/* Longest route of at most max_len bits covering addr */
+sirius_routing::leaf_t sirius_routing::covering(const eni_routes &routes, ipv4_addr_t addr, unsigned max_len) const
+{
+    for (int len = (int)std::min(max_len, 32u); len >= 0; len--) {
+        ipv4_addr_t prefix = len ? addr & (~0u << (32 - len)) : 0;
+        auto it = routes.find((uint64_t)prefix << 8 | (unsigned)len);
+        if (it != routes.end()) {
+            return it->second;
+        }
+    }
+    return {};
+}
+
+/*
+ * Builds the node at depth whose region contains addr from the routes
+ * longer than the ones its parent resolves. False if there are none, the
+ * parent slot is then a leaf.
+ */
+bool sirius_routing::build_region(const eni_routes &routes, unsigned depth, ipv4_addr_t addr, node_t &out)
+{
+    unsigned fixed = STRIDE * depth;
+    uint64_t base = fixed ? addr & (~0u << (32 - fixed)) : 0;
+    uint64_t end = base + (1ULL << (32 - fixed));
+
+    std::vector<route_t> region;
+    for (auto it = routes.lower_bound(base << 8); it != routes.end() && it->first >> 8 < end; ++it) {
+        uint8_t len = (uint8_t)it->first;
+        if (!depth || len > fixed) {
+            region.push_back({ (ipv4_addr_t)(it->first >> 8), len, it->second });
+        }
+    }
+    if (region.empty()) {
+        return false;
+    }
+
+    leaf_t inherited = depth ? covering(routes, addr, fixed) : leaf_t{};
+    out = build(depth, region.data(), region.data() + region.size(), inherited);
+    return true;
+}
+
+/* [first, last) are the routes of the node's region in prefix order */
+sirius_routing::node_t sirius_routing::build(unsigned depth, const route_t *first, const route_t *last,
+                                             const leaf_t &inherited)
+{
+    unsigned lo = depth ? STRIDE * depth + 1 : 0;
+    unsigned hi = STRIDE * (depth + 1);
+
+    /* Leaf pushing: the routes ending at this level paint their slots, shortest first */
+    std::vector<const route_t *> level;
+    for (const route_t *r = first; r != last; r++) {
+        if (r->prefix_len >= lo && r->prefix_len <= hi) {
+            level.push_back(r);
+        }
+    }
+    std::sort(level.begin(), level.end(),
+              [](const route_t *a, const route_t *b) { return a->prefix_len < b->prefix_len; });
+
+    slot_t slots[SLOTS];
+    for (slot_t &slot : slots) {
+        slot.child = false;
+        slot.leaf = inherited;
+    }
+    for (const route_t *r : level) {
+        unsigned slot = slot_of(r->prefix, depth);
+        for (unsigned i = 0; i < 1u << (hi - r->prefix_len); i++) {
+            slots[slot + i].leaf = r->entry;
+        }
+    }
+
+    /* Slots with longer routes become children, inheriting the slot's leaf */
+    for (const route_t *r = first; r != last;) {
+        unsigned slot = slot_of(r->prefix, depth);
+        const route_t *next = r;
+        bool deeper = false;
+        for (; next != last && slot_of(next->prefix, depth) == slot; next++) {
+            deeper |= next->prefix_len > hi;
+        }
+        if (deeper) {
+            slots[slot].node = build(depth + 1, r, next, slots[slot].leaf);
+            slots[slot].child = true;
+        }
+        r = next;
+    }
+
+    return encode(slots);
+}
+
+/*
+ * Returns the copy of node (at depth, on the path to addr) in which the
+ * node at target depth is rebuilt from routes. False if the node is no
+ * longer needed because all of its slots resolve to what its parent
+ * gives it.
+ */
+bool sirius_routing::update(const eni_routes &routes, const node_t &node, unsigned depth, ipv4_addr_t addr,
+                            unsigned target, node_t &out)
+{
+    if (depth == target) {
+        retire_tree(node);
+        return build_region(routes, depth, addr, out);
+    }
+
+    slot_t slots[SLOTS];
+    decode(node, slots);
+
+    unsigned slot = slot_of(addr, depth);
+    node_t child;
+    bool has_child = slots[slot].child ? update(routes, slots[slot].node, depth + 1, addr, target, child)
+                                       : build_region(routes, depth + 1, addr, child);
+    slots[slot].child = has_child;
+    if (has_child) {
+        slots[slot].node = child;
+    } else {
+        slots[slot].leaf = covering(routes, addr, STRIDE * (depth + 1));
+    }
+
+    retire(node);
+    out = encode(slots);
+
+    if (!out.vector && out.leafvec == 1) {
+        leaf_t inherited = depth ? covering(routes, addr, STRIDE * depth) : leaf_t{};
+        if (same_leaf(out.leaves[0], inherited)) {
+            /* Not published yet, free it right away */
+            m_bytes -= sizeof(leaf_t);
+            m_heap.free(out.leaves);
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Rebuilds the node at target depth on the path to addr and publishes the new root of eni */
+void sirius_routing::rebuild(uint16_t eni, ipv4_addr_t addr, unsigned target)
+{
+    static const eni_routes none;
+    auto it = m_routes.find(eni);
+    const eni_routes &routes = it == m_routes.end() ? none : it->second;
+
+    node_t *old = m_roots[eni].load(std::memory_order_relaxed);
+    node_t fresh;
+    bool has_root = old ? update(routes, *old, 0, addr, target, fresh) : build_region(routes, 0, addr, fresh);
+
+    node_t *root = nullptr;
+    if (has_root) {
+        root = allocate<node_t>(1);
+        *root = fresh;
+    }
+    m_roots[eni].store(root, std::memory_order_release);
+
+    if (old) {
+        retire_array(old);
+        m_bytes -= sizeof(node_t);
+    }
+}
+
+sirius_routing::node_t sirius_routing::encode(const slot_t (&slots)[SLOTS])
+{
+    node_t node = {};
+    unsigned children = 0;
+    unsigned leaves = 0;
+    const leaf_t *prev = nullptr;
+
+    for (unsigned s = 0; s < SLOTS; s++) {
+        if (slots[s].child) {
+            node.vector |= 1ULL << s;
+            children++;
+            continue;
+        }
+        if (!prev || !same_leaf(*prev, slots[s].leaf)) {
+            node.leafvec |= 1ULL << s;
+            leaves++;
+        }
+        prev = &slots[s].leaf;
+    }
+
+    node.children = children ? allocate<node_t>(children) : nullptr;
+    node.leaves = leaves ? allocate<leaf_t>(leaves) : nullptr;
+
+    unsigned c = 0;
+    unsigned l = 0;
+    for (unsigned s = 0; s < SLOTS; s++) {
+        if (slots[s].child) {
+            node.children[c++] = slots[s].node;
+        } else if (node.leafvec & 1ULL << s) {
+            node.leaves[l++] = slots[s].leaf;
+        }
+    }
+    return node;
+}
+
+void sirius_routing::decode(const node_t &node, slot_t (&slots)[SLOTS]) const
+{
+    unsigned c = 0;
+    unsigned l = 0;
+    for (unsigned s = 0; s < SLOTS; s++) {
+        if (node.vector & 1ULL << s) {
+            slots[s].child = true;
+            slots[s].node = node.children[c++];
+            continue;
+        }
+        if (node.leafvec & 1ULL << s) {
+            l++;
+        }
+        slots[s].child = false;
+        slots[s].leaf = node.leaves[l - 1];
+    }
+}
+
+/* Retires the arrays of node; its children's arrays stay in use */
+void sirius_routing::retire(const node_t &node)
+{
+    if (node.children) {
+        retire_array(node.children);
+        m_bytes -= __builtin_popcountll(node.vector) * sizeof(node_t);
+    }
+    if (node.leaves) {
+        retire_array(node.leaves);
+        m_bytes -= __builtin_popcountll(node.leafvec) * sizeof(leaf_t);
+    }
+}
+
+void sirius_routing::retire_tree(const node_t &node)
+{
+    for (unsigned i = 0; i < (unsigned)__builtin_popcountll(node.vector); i++) {
+        retire_tree(node.children[i]);
+    }
+    retire(node);
+}
+
+void sirius_routing::free_tree(const node_t &node)
+{
+    for (unsigned i = 0; i < (unsigned)__builtin_popcountll(node.vector); i++) {
+        free_tree(node.children[i]);
+    }
+    m_heap.free(node.children);
+    m_heap.free(node.leaves);
+}
+
+} // namespace sirius
@@ -0,0 +1,302 @@
+#ifndef _SIRIUS_ROUTING_H_
+#define _SIRIUS_ROUTING_H_
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+extern "C" {
+#include <saitypes.h>
+#include <saistatus.h>
+}
+
+#include "sirius_counters.h"
+#include "sirius_memory.h"
+#include "sirius_rcu.h"
+#include "sirius_types.h"
+
+namespace sirius {
+
+struct routing_key_t {
+    uint16_t eni;
+    ipv4_addr_t prefix;
+    uint8_t prefix_len;
+};
+
+struct routing_entry_t {
+    uint32_t dest_vnet_vni;
+    uint32_t counter; /* routing_counter slot, assigned by the table on insert */
+};
+
+/*
+ * outbound routing table: meta.eni exact + hdr.ipv4.dst_addr lpm.
+ *
+ * Each ENI has its own Poptrie: a multibit trie of 6 bit strides (six
+ * levels cover the 32 bit address), whose nodes store their children
+ * and their leaves in dense arrays indexed by the popcount of a 64 bit
+ * slot bitmap. Runs of slots resolving to the same route share one leaf,
+ * so a node costs 32 bytes plus 8 per distinct leaf run.
+ *
+ * The data path walks the trie of meta.eni inside an RCU read-side
+ * section and never takes a lock. Writers keep the routes of every ENI
+ * in an ordered map, rebuild the smallest subtree a change touches, copy
+ * the path from it up to the root, and publish the new root with one
+ * atomic store. Replaced arrays are freed once an RCU grace period has
+ * elapsed, without making the writer wait for it. The arrays come from
+ * a sirius_heap rather than malloc, so the tries of all ENIs sit packed
+ * in a few regions, on huge pages when set_placement() asks for them.
+ * A batch rebuilds the tries it touches once at the end, either path by
+ * path or, for large changes, from scratch.
+ *
+ * Every route gets a slot of routing_counter when it is inserted, which
+ * lpm() returns with the route, for the data path to count the packet in.
+ */
+class sirius_routing {
+public:
+    using key_type = routing_key_t;
+    using value_type = routing_entry_t;
+
+    /* Routes of one ENI by (prefix << 8 | prefix_len), i.e. prefix order */
+    using eni_routes = std::map<uint64_t, routing_entry_t>;
+    using route_map = std::unordered_map<uint16_t, eni_routes>;
+
+    class writer {
+    public:
+        writer(route_map &routes, std::vector<routing_key_t> &changes, sirius_counters &counters)
+            : m_routes(routes), m_changes(changes), m_counters(counters)
+        {
+        }
+
+        sai_status_t insert(const routing_key_t &key, const routing_entry_t &value)
+        {
+            eni_routes &routes = m_routes[key.eni];
+            if (routes.count(route_id(key))) {
+                return SAI_STATUS_ITEM_ALREADY_EXISTS;
+            }
+            routing_entry_t entry = value;
+            entry.counter = m_counters.allocate();
+            if (!entry.counter) {
+                if (routes.empty()) {
+                    m_routes.erase(key.eni);
+                }
+                return SAI_STATUS_TABLE_FULL;
+            }
+            routes.emplace(route_id(key), entry);
+            m_changes.push_back(key);
+            return SAI_STATUS_SUCCESS;
+        }
+
+        sai_status_t remove(const routing_key_t &key)
+        {
+            auto eni = m_routes.find(key.eni);
+            if (eni == m_routes.end()) {
+                return SAI_STATUS_ITEM_NOT_FOUND;
+            }
+            auto it = eni->second.find(route_id(key));
+            if (it == eni->second.end()) {
+                return SAI_STATUS_ITEM_NOT_FOUND;
+            }
+            m_counters.release(it->second.counter);
+            eni->second.erase(it);
+            if (eni->second.empty()) {
+                m_routes.erase(eni);
+            }
+            m_changes.push_back(key);
+            return SAI_STATUS_SUCCESS;
+        }
+
+        const routing_entry_t *find(const routing_key_t &key) const
+        {
+            auto eni = m_routes.find(key.eni);
+            if (eni == m_routes.end()) {
+                return nullptr;
+            }
+            auto it = eni->second.find(route_id(key));
+            return it == eni->second.end() ? nullptr : &it->second;
+        }
+
+        void reserve(size_t count) { m_changes.reserve(m_changes.size() + count); }
+
+    private:
+        route_map &m_routes;
+        std::vector<routing_key_t> &m_changes;
+        sirius_counters &m_counters;
+    };
+
+    /* Routes the counters have slots for */
+    static constexpr size_t COUNTER_SLOTS = 1u << 22;
+
+    sirius_routing();
+    ~sirius_routing();
+
+    sirius_routing(const sirius_routing &) = delete;
+    sirius_routing &operator=(const sirius_routing &) = delete;
+
+    sai_status_t insert(const routing_key_t &key, const routing_entry_t &value)
+    {
+        sai_status_t status;
+        batch([&](writer &w) { status = w.insert(key, value); });
+        return status;
+    }
+
+    sai_status_t remove(const routing_key_t &key)
+    {
+        sai_status_t status;
+        batch([&](writer &w) { status = w.remove(key); });
+        return status;
+    }
+
+    /* Exact lookup of one route, for the get/set attribute calls */
+    bool lookup(const routing_key_t &key, routing_entry_t &value) const;
+
+    template <typename Fn>
+    void batch(Fn &&fn)
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        std::vector<routing_key_t> changes;
+        writer w(m_routes, changes, m_counters);
+        fn(w);
+        commit(changes);
+    }
+
+    /* Longest prefix match of dip among the routes of eni */
+    bool lpm(uint16_t eni, ipv4_addr_t dip, routing_entry_t &value) const
+    {
+        rcu_read_guard guard;
+        const node_t *node = m_roots[eni].load(std::memory_order_acquire);
+        if (!node) {
+            return false;
+        }
+        uint64_t addr = (uint64_t)dip << PAD_BITS;
+        for (unsigned shift = TOP_SHIFT;; shift -= STRIDE) {
+            uint64_t bit = 1ULL << (addr >> shift & (SLOTS - 1));
+            uint64_t upto = (bit << 1) - 1;
+            if (node->vector & bit) {
+                node = &node->children[__builtin_popcountll(node->vector & upto) - 1];
+                continue;
+            }
+            const leaf_t &leaf = node->leaves[__builtin_popcountll(node->leafvec & upto) - 1];
+            value = leaf;
+            return leaf.counter != 0;
+        }
+    }
+
+    size_t size() const;
+
+    /* routing_counter, for the pipelines to attach their blocks to */
+    sirius_counters &counters() { return m_counters; }
+
+    /*
+     * Runs fn() while no route is inserted or removed, for reads that
+     * have to agree with other tables. fn reads with the *_held calls.
+     */
+    template <typename Fn>
+    void hold(Fn &&fn) const
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        fn();
+    }
+
+    /* Within hold(): the number of routes */
+    size_t size_held() const;
+
+    /* Within hold(): the counter slots of all routes and their counts */
+    void snapshot_held(std::vector<uint32_t> &slots, std::vector<counter_t> &counts) const;
+
+    /* Bytes held by the tries of all ENIs (nodes and leaves) */
+    size_t memory() const;
+
+    /* Placement of the memory of the tries; only while there are no routes, false otherwise */
+    bool set_placement(const memory_placement_t &placement);
+
+private:
+    static constexpr unsigned STRIDE = 6;
+    static constexpr unsigned SLOTS = 1u << STRIDE;
+    static constexpr unsigned LEVELS = 6;
+    /* The address is padded to LEVELS * STRIDE bits, the last level uses 2 */
+    static constexpr unsigned PAD_BITS = LEVELS * STRIDE - 32;
+    static constexpr unsigned TOP_SHIFT = (LEVELS - 1) * STRIDE;
+
+    /* The route a slot resolves to; counter is 0 where no route covers it */
+    using leaf_t = routing_entry_t;
+
+    /*
+     * Slot s is a child if bit s of vector is set, the child is
+     * children[popcount(vector & bits 0..s) - 1]. Otherwise it resolves
+     * to leaves[popcount(leafvec & bits 0..s) - 1]: leafvec marks the
+     * first slot of every run of leaf slots with the same leaf.
+     */
+    struct node_t {
+        uint64_t vector;
+        uint64_t leafvec;
+        node_t *children;
+        leaf_t *leaves;
+    };
+
+    struct route_t {
+        ipv4_addr_t prefix;
+        uint8_t prefix_len;
+        routing_entry_t entry;
+    };
+
+    struct slot_t {
+        bool child;
+        node_t node;
+        leaf_t leaf;
+    };
+
+    static uint64_t route_id(const routing_key_t &key) { return (uint64_t)key.prefix << 8 | key.prefix_len; }
+
+    /* Slot of addr in a node at depth */
+    static unsigned slot_of(ipv4_addr_t addr, unsigned depth)
+    {
+        return (unsigned)((uint64_t)addr << PAD_BITS >> (TOP_SHIFT - STRIDE * depth) & (SLOTS - 1));
+    }
+
+    /* The counter tells the routes apart: slots of different routes count separately */
+    static bool same_leaf(const leaf_t &a, const leaf_t &b) { return a.counter == b.counter; }
+
+    void commit(const std::vector<routing_key_t> &changes);
+
+    leaf_t covering(const eni_routes &routes, ipv4_addr_t addr, unsigned max_len) const;
+    bool build_region(const eni_routes &routes, unsigned depth, ipv4_addr_t addr, node_t &out);
+    node_t build(unsigned depth, const route_t *first, const route_t *last, const leaf_t &inherited);
+    bool update(const eni_routes &routes, const node_t &node, unsigned depth, ipv4_addr_t addr, unsigned target,
+                node_t &out);
+    void rebuild(uint16_t eni, ipv4_addr_t addr, unsigned target);
+
+    node_t encode(const slot_t (&slots)[SLOTS]);
+    void decode(const node_t &node, slot_t (&slots)[SLOTS]) const;
+    void retire(const node_t &node);
+    void retire_tree(const node_t &node);
+    void free_tree(const node_t &node);
+
+    template <typename T>
+    T *allocate(unsigned count)
+    {
+        m_bytes += count * sizeof(T);
+        return static_cast<T *>(m_heap.alloc(count * sizeof(T)));
+    }
+
+    /* An array readers may still walk */
+    void retire_array(void *array)
+    {
+        m_reclaim.retire(array, [](void *heap, void *p) { static_cast<sirius_heap *>(heap)->free(p); }, &m_heap);
+    }
+
+    mutable std::mutex m_lock;
+    route_map m_routes;
+    sirius_counters m_counters{ COUNTER_SLOTS };
+    size_t m_bytes = 0;
+    sirius_heap m_heap;      /* node and leaf arrays, written under m_lock */
+    rcu_reclaimer m_reclaim; /* frees into m_heap, so goes first */
+
+    std::unique_ptr<std::atomic<node_t *>[]> m_roots;
+};
+
+} // namespace sirius
+
+#endif /* _SIRIUS_ROUTING_H_ */
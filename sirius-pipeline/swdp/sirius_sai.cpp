@@ -0,0 +1,1576 @@
+#include "sirius_sai.h"
+
+#include <arpa/inet.h>
+
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "sirius_flow_aging.h"
+#include "sirius_switch.h"
+
+namespace sirius {
+
+sirius_switch &sai_switch()
+{
+    static sirius_switch sw;
+    return sw;
+}
+
+namespace {
+
+/* Object ids handed out for the tables that are not keyed by an entry struct */
+enum oid_type_t : uint64_t {
+    OID_TYPE_APPLIANCE = 1,
+    OID_TYPE_INBOUND_VM = 2,
+    OID_TYPE_SWITCH = 3,
+};
+
+constexpr unsigned OID_TYPE_SHIFT = 48;
+
+sai_object_id_t oid_encode(oid_type_t type, uint32_t index)
+{
+    return (uint64_t)type << OID_TYPE_SHIFT | index;
+}
+
+bool oid_decode(sai_object_id_t oid, oid_type_t type, uint32_t &index)
+{
+    if ((oid >> OID_TYPE_SHIFT) != type) {
+        return false;
+    }
+    index = (uint32_t)(oid & ((1ULL << OID_TYPE_SHIFT) - 1));
+    return true;
+}
+
+/* Status code for attribute number index, see saistatus.h */
+sai_status_t attr_status(sai_status_t base, uint32_t index)
+{
+    return base - (sai_status_t)index;
+}
+
+bool ipv4_from_sai(const sai_ip_address_t &ip, ipv4_addr_t &out)
+{
+    if (ip.addr_family != SAI_IP_ADDR_FAMILY_IPV4) {
+        return false;
+    }
+    out = ntohl(ip.addr.ip4);
+    return true;
+}
+
+void ipv4_to_sai(ipv4_addr_t ip, sai_ip_address_t &out)
+{
+    out.addr_family = SAI_IP_ADDR_FAMILY_IPV4;
+    out.addr.ip4 = htonl(ip);
+}
+
+bool prefix_from_sai(const sai_ip_prefix_t &prefix, ipv4_addr_t &addr, uint8_t &len)
+{
+    if (prefix.addr_family != SAI_IP_ADDR_FAMILY_IPV4) {
+        return false;
+    }
+    uint32_t mask = ntohl(prefix.mask.ip4);
+    len = (uint8_t)__builtin_popcount(mask);
+    if (mask != (len ? ~0u << (32 - len) : 0)) {
+        return false;
+    }
+    addr = ntohl(prefix.addr.ip4) & mask;
+    return true;
+}
+
+/*
+ * Attribute decoding shared by all tables. Traits list the attribute ids
+ * of the table in T::attrs (all MANDATORY_ON_CREATE | CREATE_ONLY in
+ * saidash.h) and convert single attributes with T::parse()/T::get().
+ * Some also list READ_ONLY attributes in T::read_only_attrs, which only
+ * T::get() converts, or CREATE_AND_SET attributes in T::settable_attrs,
+ * which keep the default of value_type when a create leaves them out.
+ */
+template <typename T>
+int attr_index(sai_attr_id_t id)
+{
+    for (size_t i = 0; i < T::attrs.size(); i++) {
+        if (T::attrs[i] == id) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+template <typename T, typename = void>
+struct read_only_attrs {
+    static bool contains(sai_attr_id_t) { return false; }
+};
+
+template <typename T>
+struct read_only_attrs<T, std::void_t<decltype(T::read_only_attrs)>> {
+    static bool contains(sai_attr_id_t id)
+    {
+        return std::find(T::read_only_attrs.begin(), T::read_only_attrs.end(), id) != T::read_only_attrs.end();
+    }
+};
+
+template <typename T, typename = void>
+struct settable_attrs {
+    static bool contains(sai_attr_id_t) { return false; }
+};
+
+template <typename T>
+struct settable_attrs<T, std::void_t<decltype(T::settable_attrs)>> {
+    static bool contains(sai_attr_id_t id)
+    {
+        return std::find(T::settable_attrs.begin(), T::settable_attrs.end(), id) != T::settable_attrs.end();
+    }
+};
+
+template <typename T>
+sai_status_t decode_attrs(uint32_t attr_count, const sai_attribute_t *attr_list, typename T::value_type &value)
+{
+    if (attr_count && !attr_list) {
+        return SAI_STATUS_INVALID_PARAMETER;
+    }
+
+    uint32_t seen = 0;
+    for (uint32_t i = 0; i < attr_count; i++) {
+        int idx = attr_index<T>(attr_list[i].id);
+        if (idx < 0 && !settable_attrs<T>::contains(attr_list[i].id)) {
+            return attr_status(SAI_STATUS_UNKNOWN_ATTRIBUTE_0, i);
+        }
+        if (!T::parse(attr_list[i], value)) {
+            return attr_status(SAI_STATUS_INVALID_ATTR_VALUE_0, i);
+        }
+        if (idx >= 0) {
+            seen |= 1u << idx;
+        }
+    }
+
+    if (seen != (1u << T::attrs.size()) - 1) {
+        return SAI_STATUS_MANDATORY_ATTRIBUTE_MISSING;
+    }
+    return SAI_STATUS_SUCCESS;
+}
+
+/* T::get() returns a status for list attributes that can overflow the caller's buffer */
+template <typename T>
+sai_status_t get_attr(const typename T::value_type &value, sai_attribute_t &attr)
+{
+    if constexpr (std::is_void_v<decltype(T::get(value, attr))>) {
+        T::get(value, attr);
+        return SAI_STATUS_SUCCESS;
+    } else {
+        return T::get(value, attr);
+    }
+}
+
+template <typename T>
+sai_status_t encode_attrs(const typename T::value_type &value, uint32_t attr_count, sai_attribute_t *attr_list)
+{
+    if (!attr_count || !attr_list) {
+        return SAI_STATUS_INVALID_PARAMETER;
+    }
+    for (uint32_t i = 0; i < attr_count; i++) {
+        sai_attr_id_t id = attr_list[i].id;
+        if (attr_index<T>(id) < 0 && !read_only_attrs<T>::contains(id) && !settable_attrs<T>::contains(id)) {
+            return attr_status(SAI_STATUS_UNKNOWN_ATTRIBUTE_0, i);
+        }
+        sai_status_t status = get_attr<T>(value, attr_list[i]);
+        if (status != SAI_STATUS_SUCCESS) {
+            return status;
+        }
+    }
+    return SAI_STATUS_SUCCESS;
+}
+
+template <typename T>
+sai_status_t check_set_attr(const sai_attribute_t *attr)
+{
+    if (!attr) {
+        return SAI_STATUS_INVALID_PARAMETER;
+    }
+    if (settable_attrs<T>::contains(attr->id)) {
+        return SAI_STATUS_SUCCESS;
+    }
+    if (attr_index<T>(attr->id) < 0 && !read_only_attrs<T>::contains(attr->id)) {
+        return SAI_STATUS_UNKNOWN_ATTRIBUTE_0;
+    }
+    /* Every action parameter is CREATE_ONLY, the others READ_ONLY */
+    return SAI_STATUS_INVALID_ATTRIBUTE_0;
+}
+
+/*
+ * Runs op(i) for every object of a bulk call, filling object_statuses.
+ * In SAI_BULK_OP_ERROR_MODE_STOP_ON_ERROR the objects after the first
+ * failure are reported as SAI_STATUS_NOT_EXECUTED.
+ */
+template <typename Op>
+sai_status_t run_bulk(uint32_t object_count, sai_bulk_op_error_mode_t mode,
+                      sai_status_t *object_statuses, Op &&op)
+{
+    bool failed = false;
+    for (uint32_t i = 0; i < object_count; i++) {
+        if (failed && mode == SAI_BULK_OP_ERROR_MODE_STOP_ON_ERROR) {
+            object_statuses[i] = SAI_STATUS_NOT_EXECUTED;
+            continue;
+        }
+        object_statuses[i] = op(i);
+        failed |= object_statuses[i] != SAI_STATUS_SUCCESS;
+    }
+    return failed ? SAI_STATUS_FAILURE : SAI_STATUS_SUCCESS;
+}
+
+/* Passes the status of a single object write through, invalidating caches on success */
+sai_status_t changed(sai_status_t status)
+{
+    if (status == SAI_STATUS_SUCCESS) {
+        sai_switch().generations.changed();
+    }
+    return status;
+}
+
+/* Invalidates caches once if any object of a bulk call was written */
+void changed_any(uint32_t object_count, const sai_status_t *object_statuses)
+{
+    if (std::find(object_statuses, object_statuses + object_count, SAI_STATUS_SUCCESS) !=
+        object_statuses + object_count) {
+        sai_switch().generations.changed();
+    }
+}
+
+bool valid_bulk_mode(sai_bulk_op_error_mode_t mode)
+{
+    return mode == SAI_BULK_OP_ERROR_MODE_STOP_ON_ERROR || mode == SAI_BULK_OP_ERROR_MODE_IGNORE_ERROR;
+}
+
+/* T::inserted(key), for the traits with state besides the entry that starts over with a new entry */
+template <typename T, typename = void>
+struct insert_hook {
+    static void inserted(const typename T::key_type &) {}
+};
+
+template <typename T>
+struct insert_hook<T, std::void_t<decltype(T::inserted(std::declval<const typename T::key_type &>()))>> {
+    static void inserted(const typename T::key_type &key) { T::inserted(key); }
+};
+
+/* T::compile(value), for the traits whose entries carry data compiled from their attributes */
+template <typename T, typename = void>
+struct compile_hook {
+    static void compile(typename T::value_type &) {}
+};
+
+template <typename T>
+struct compile_hook<T, std::void_t<decltype(T::compile(std::declval<typename T::value_type &>()))>> {
+    static void compile(typename T::value_type &value) { T::compile(value); }
+};
+
+/* T::check(value, ...), for the traits whose attributes have to agree with each other */
+template <typename T, typename = void>
+struct check_hook {
+    static sai_status_t check(const typename T::value_type &, uint32_t, const sai_attribute_t *)
+    {
+        return SAI_STATUS_SUCCESS;
+    }
+};
+
+template <typename T>
+struct check_hook<T, std::void_t<decltype(T::check(std::declval<const typename T::value_type &>(), 0u,
+                                                   std::declval<const sai_attribute_t *>()))>> {
+    static sai_status_t check(const typename T::value_type &value, uint32_t attr_count,
+                              const sai_attribute_t *attr_list)
+    {
+        return T::check(value, attr_count, attr_list);
+    }
+};
+
+/* T::changed(key), for the traits whose entries only the flows of one ENI or destination read */
+template <typename T, typename = void>
+struct change_hook {
+    static void changed(const typename T::key_type &) { sai_switch().generations.changed(); }
+};
+
+template <typename T>
+struct change_hook<T, std::void_t<decltype(T::changed(std::declval<const typename T::key_type &>()))>> {
+    static void changed(const typename T::key_type &key) { T::changed(key); }
+};
+
+/* API of the tables keyed by a sai_*_entry_t struct */
+template <typename T>
+struct entry_api {
+    using sai_entry_t = typename T::sai_entry_t;
+    using key_type = typename T::key_type;
+    using value_type = typename T::value_type;
+
+    static sai_status_t create(const sai_entry_t *entry, uint32_t attr_count, const sai_attribute_t *attr_list)
+    {
+        key_type key;
+        value_type value{};
+        if (!entry || !T::key(*entry, key)) {
+            return SAI_STATUS_INVALID_PARAMETER;
+        }
+        sai_status_t status = decode_attrs<T>(attr_count, attr_list, value);
+        if (status != SAI_STATUS_SUCCESS) {
+            return status;
+        }
+        status = T::table(sai_switch()).insert(key, value);
+        if (status == SAI_STATUS_SUCCESS) {
+            insert_hook<T>::inserted(key);
+            change_hook<T>::changed(key);
+        }
+        return status;
+    }
+
+    static sai_status_t remove(const sai_entry_t *entry)
+    {
+        key_type key;
+        if (!entry || !T::key(*entry, key)) {
+            return SAI_STATUS_INVALID_PARAMETER;
+        }
+        sai_status_t status = T::table(sai_switch()).remove(key);
+        if (status == SAI_STATUS_SUCCESS) {
+            change_hook<T>::changed(key);
+        }
+        return status;
+    }
+
+    static sai_status_t set(const sai_entry_t *entry, const sai_attribute_t *attr)
+    {
+        key_type key;
+        value_type value;
+        if (!entry || !T::key(*entry, key)) {
+            return SAI_STATUS_INVALID_PARAMETER;
+        }
+        if (!T::table(sai_switch()).lookup(key, value)) {
+            return SAI_STATUS_ITEM_NOT_FOUND;
+        }
+        /* No entry table has a CREATE_AND_SET attribute: an entry changes by remove and create */
+        sai_status_t status = check_set_attr<T>(attr);
+        return status == SAI_STATUS_SUCCESS ? SAI_STATUS_NOT_SUPPORTED : status;
+    }
+
+    static sai_status_t get(const sai_entry_t *entry, uint32_t attr_count, sai_attribute_t *attr_list)
+    {
+        key_type key;
+        value_type value;
+        if (!entry || !T::key(*entry, key)) {
+            return SAI_STATUS_INVALID_PARAMETER;
+        }
+        if (!T::table(sai_switch()).lookup(key, value)) {
+            return SAI_STATUS_ITEM_NOT_FOUND;
+        }
+        return encode_attrs<T>(value, attr_count, attr_list);
+    }
+
+    static sai_status_t bulk_create(uint32_t object_count, const sai_entry_t *entries,
+                                    const uint32_t *attr_count, const sai_attribute_t **attr_list,
+                                    sai_bulk_op_error_mode_t mode, sai_status_t *object_statuses)
+    {
+        if (!object_count || !entries || !attr_count || !attr_list || !object_statuses || !valid_bulk_mode(mode)) {
+            return SAI_STATUS_INVALID_PARAMETER;
+        }
+
+        /* Decode outside of the table lock, then insert the batch in one go */
+        std::vector<key_type> keys(object_count);
+        std::vector<value_type> values(object_count);
+        std::vector<sai_status_t> decoded(object_count);
+        for (uint32_t i = 0; i < object_count; i++) {
+            decoded[i] = T::key(entries[i], keys[i]) ?
+                         decode_attrs<T>(attr_count[i], attr_list[i], values[i]) :
+                         SAI_STATUS_INVALID_PARAMETER;
+        }
+
+        sai_status_t status = SAI_STATUS_SUCCESS;
+        T::table(sai_switch()).batch([&](auto &w) {
+            w.reserve(object_count);
+            status = run_bulk(object_count, mode, object_statuses, [&](uint32_t i) {
+                return decoded[i] != SAI_STATUS_SUCCESS ? decoded[i] : w.insert(keys[i], values[i]);
+            });
+        });
+        for (uint32_t i = 0; i < object_count; i++) {
+            if (object_statuses[i] == SAI_STATUS_SUCCESS) {
+                insert_hook<T>::inserted(keys[i]);
+                change_hook<T>::changed(keys[i]);
+            }
+        }
+        return status;
+    }
+
+    static sai_status_t bulk_remove(uint32_t object_count, const sai_entry_t *entries,
+                                    sai_bulk_op_error_mode_t mode, sai_status_t *object_statuses)
+    {
+        if (!object_count || !entries || !object_statuses || !valid_bulk_mode(mode)) {
+            return SAI_STATUS_INVALID_PARAMETER;
+        }
+
+        std::vector<key_type> keys(object_count);
+        std::vector<bool> valid(object_count);
+        for (uint32_t i = 0; i < object_count; i++) {
+            valid[i] = T::key(entries[i], keys[i]);
+        }
+
+        sai_status_t status = SAI_STATUS_SUCCESS;
+        T::table(sai_switch()).batch([&](auto &w) {
+            status = run_bulk(object_count, mode, object_statuses, [&](uint32_t i) {
+                return valid[i] ? w.remove(keys[i]) : SAI_STATUS_INVALID_PARAMETER;
+            });
+        });
+        for (uint32_t i = 0; i < object_count; i++) {
+            if (object_statuses[i] == SAI_STATUS_SUCCESS) {
+                change_hook<T>::changed(keys[i]);
+            }
+        }
+        return status;
+    }
+};
+
+/* API of the tables addressed by an object id (appliance, inbound_vm) */
+template <typename T>
+struct object_api {
+    using value_type = typename T::value_type;
+
+    static sai_status_t create_locked(typename T::table_type::writer &w, sai_object_id_t *oid,
+                                      uint32_t attr_count, const sai_attribute_t *attr_list)
+    {
+        value_type value{};
+        sai_status_t status = decode_attrs<T>(attr_count, attr_list, value);
+        if (status == SAI_STATUS_SUCCESS) {
+            status = check_hook<T>::check(value, attr_count, attr_list);
+        }
+        if (status != SAI_STATUS_SUCCESS) {
+            return status;
+        }
+        compile_hook<T>::compile(value);
+
+        uint32_t index;
+        if (!T::ids(sai_switch()).alloc(index)) {
+            return SAI_STATUS_TABLE_FULL;
+        }
+        w.insert((typename T::key_type)index, value);
+        *oid = oid_encode(T::oid_type, index);
+        return SAI_STATUS_SUCCESS;
+    }
+
+    static sai_status_t remove_locked(typename T::table_type::writer &w, sai_object_id_t oid)
+    {
+        uint32_t index;
+        if (!oid_decode(oid, T::oid_type, index)) {
+            return SAI_STATUS_INVALID_OBJECT_ID;
+        }
+        sai_status_t status = w.remove((typename T::key_type)index);
+        if (status == SAI_STATUS_SUCCESS) {
+            T::ids(sai_switch()).free(index);
+        }
+        return status;
+    }
+
+    static sai_status_t create(sai_object_id_t *oid, sai_object_id_t switch_id,
+                               uint32_t attr_count, const sai_attribute_t *attr_list)
+    {
+        (void)switch_id;
+        if (!oid) {
+            return SAI_STATUS_INVALID_PARAMETER;
+        }
+        sai_status_t status;
+        T::table(sai_switch()).batch([&](auto &w) {
+            status = create_locked(w, oid, attr_count, attr_list);
+        });
+        return changed(status);
+    }
+
+    static sai_status_t remove(sai_object_id_t oid)
+    {
+        sai_status_t status;
+        T::table(sai_switch()).batch([&](auto &w) {
+            status = remove_locked(w, oid);
+        });
+        return changed(status);
+    }
+
+    static sai_status_t set(sai_object_id_t oid, const sai_attribute_t *attr)
+    {
+        uint32_t index;
+        if (!oid_decode(oid, T::oid_type, index)) {
+            return SAI_STATUS_INVALID_OBJECT_ID;
+        }
+        sai_status_t status;
+        T::table(sai_switch()).batch([&](auto &w) {
+            value_type *entry = w.find((typename T::key_type)index);
+            if (!entry) {
+                status = SAI_STATUS_ITEM_NOT_FOUND;
+                return;
+            }
+            status = check_set_attr<T>(attr);
+            value_type value = *entry;
+            if (status == SAI_STATUS_SUCCESS && !T::parse(*attr, value)) {
+                status = SAI_STATUS_INVALID_ATTR_VALUE_0;
+            }
+            if (status == SAI_STATUS_SUCCESS) {
+                status = check_hook<T>::check(value, 1, attr);
+            }
+            if (status == SAI_STATUS_SUCCESS) {
+                compile_hook<T>::compile(value);
+                *entry = value;
+            }
+        });
+        return changed(status);
+    }
+
+    static sai_status_t get(sai_object_id_t oid, uint32_t attr_count, sai_attribute_t *attr_list)
+    {
+        uint32_t index;
+        value_type value;
+        if (!oid_decode(oid, T::oid_type, index)) {
+            return SAI_STATUS_INVALID_OBJECT_ID;
+        }
+        if (!T::table(sai_switch()).lookup((typename T::key_type)index, value)) {
+            return SAI_STATUS_ITEM_NOT_FOUND;
+        }
+        return encode_attrs<T>(value, attr_count, attr_list);
+    }
+
+    static sai_status_t bulk_create(sai_object_id_t switch_id, uint32_t object_count,
+                                    const uint32_t *attr_count, const sai_attribute_t **attr_list,
+                                    sai_bulk_op_error_mode_t mode, sai_object_id_t *object_id,
+                                    sai_status_t *object_statuses)
+    {
+        (void)switch_id;
+        if (!object_count || !attr_count || !attr_list || !object_id || !object_statuses || !valid_bulk_mode(mode)) {
+            return SAI_STATUS_INVALID_PARAMETER;
+        }
+
+        sai_status_t status = SAI_STATUS_SUCCESS;
+        T::table(sai_switch()).batch([&](auto &w) {
+            w.reserve(object_count);
+            status = run_bulk(object_count, mode, object_statuses, [&](uint32_t i) {
+                object_id[i] = SAI_NULL_OBJECT_ID;
+                return create_locked(w, &object_id[i], attr_count[i], attr_list[i]);
+            });
+        });
+        changed_any(object_count, object_statuses);
+        return status;
+    }
+
+    static sai_status_t bulk_remove(uint32_t object_count, const sai_object_id_t *object_id,
+                                    sai_bulk_op_error_mode_t mode, sai_status_t *object_statuses)
+    {
+        if (!object_count || !object_id || !object_statuses || !valid_bulk_mode(mode)) {
+            return SAI_STATUS_INVALID_PARAMETER;
+        }
+
+        sai_status_t status = SAI_STATUS_SUCCESS;
+        T::table(sai_switch()).batch([&](auto &w) {
+            status = run_bulk(object_count, mode, object_statuses, [&](uint32_t i) {
+                return remove_locked(w, object_id[i]);
+            });
+        });
+        changed_any(object_count, object_statuses);
+        return status;
+    }
+};
+
+/* Table traits: key conversion and attribute <-> action data mapping */
+
+struct direction_lookup_traits {
+    using sai_entry_t = sai_direction_lookup_entry_t;
+    using key_type = uint32_t;
+    using value_type = direction_lookup_entry_t;
+
+    static constexpr std::array<sai_attr_id_t, 1> attrs = {
+        SAI_DIRECTION_LOOKUP_ENTRY_ATTR_DIRECTION,
+    };
+
+    static auto &table(sirius_switch &sw) { return sw.direction_lookup; }
+
+    static bool key(const sai_entry_t &e, key_type &k)
+    {
+        k = e.vni;
+        return e.vni < (1u << 24);
+    }
+
+    static bool parse(const sai_attribute_t &attr, value_type &v)
+    {
+        if (attr.value.u32 != DIRECTION_OUTBOUND && attr.value.u32 != DIRECTION_INBOUND) {
+            return false;
+        }
+        v.direction = (direction_t)attr.value.u32;
+        return true;
+    }
+
+    static void get(const value_type &v, sai_attribute_t &attr)
+    {
+        attr.value.u32 = v.direction;
+    }
+};
+
+struct appliance_traits {
+    using key_type = uint8_t;
+    using value_type = appliance_entry_t;
+    using table_type = decltype(sirius_switch::appliance);
+
+    static constexpr oid_type_t oid_type = OID_TYPE_APPLIANCE;
+    static constexpr std::array<sai_attr_id_t, 3> attrs = {
+        SAI_APPLIANCE_ATTR_NEIGHBOR_MAC,
+        SAI_APPLIANCE_ATTR_MAC,
+        SAI_APPLIANCE_ATTR_IP,
+    };
+    static constexpr std::array<sai_attr_id_t, 6> settable_attrs = {
+        SAI_APPLIANCE_ATTR_TCP_FLOW_TIMEOUT,
+        SAI_APPLIANCE_ATTR_UDP_FLOW_TIMEOUT,
+        SAI_APPLIANCE_ATTR_ENCAP_SPORT_HASH,
+        SAI_APPLIANCE_ATTR_ENCAP_SPORT_MIN,
+        SAI_APPLIANCE_ATTR_ENCAP_SPORT_MAX,
+        SAI_APPLIANCE_ATTR_VERIFY_INNER_CHECKSUM,
+    };
+
+    static auto &table(sirius_switch &sw) { return sw.appliance; }
+    static auto &ids(sirius_switch &sw) { return sw.appliance_ids; }
+
+    static void compile(value_type &v) { appliance_compile(v); }
+
+    /* The source port range, from the attributes given and the defaults or the current value, is in order */
+    static sai_status_t check(const value_type &v, uint32_t attr_count, const sai_attribute_t *attr_list)
+    {
+        if (v.encap_sport_min <= v.encap_sport_max) {
+            return SAI_STATUS_SUCCESS;
+        }
+        uint32_t i = attr_count;
+        while (i-- > 0) {
+            if (attr_list[i].id == SAI_APPLIANCE_ATTR_ENCAP_SPORT_MIN ||
+                attr_list[i].id == SAI_APPLIANCE_ATTR_ENCAP_SPORT_MAX) {
+                break;
+            }
+        }
+        return attr_status(SAI_STATUS_INVALID_ATTR_VALUE_0, i < attr_count ? i : 0);
+    }
+
+    static bool parse(const sai_attribute_t &attr, value_type &v)
+    {
+        switch (attr.id) {
+        case SAI_APPLIANCE_ATTR_NEIGHBOR_MAC:
+            v.neighbor_mac = mac_from_bytes(attr.value.mac);
+            return true;
+        case SAI_APPLIANCE_ATTR_MAC:
+            v.mac = mac_from_bytes(attr.value.mac);
+            return true;
+        case SAI_APPLIANCE_ATTR_TCP_FLOW_TIMEOUT:
+            v.tcp_flow_timeout = attr.value.u32;
+            return attr.value.u32 <= sirius_flow_aging::MAX_TIMEOUT_MS;
+        case SAI_APPLIANCE_ATTR_UDP_FLOW_TIMEOUT:
+            v.udp_flow_timeout = attr.value.u32;
+            return attr.value.u32 <= sirius_flow_aging::MAX_TIMEOUT_MS;
+        case SAI_APPLIANCE_ATTR_ENCAP_SPORT_HASH:
+            v.encap_sport_hash = (vxlan_sport_hash_t)attr.value.s32;
+            return attr.value.s32 >= SAI_DASH_ENCAP_SPORT_HASH_NONE &&
+                   attr.value.s32 <= SAI_DASH_ENCAP_SPORT_HASH_TOEPLITZ;
+        case SAI_APPLIANCE_ATTR_ENCAP_SPORT_MIN:
+            v.encap_sport_min = attr.value.u16;
+            return true;
+        case SAI_APPLIANCE_ATTR_ENCAP_SPORT_MAX:
+            v.encap_sport_max = attr.value.u16;
+            return true;
+        case SAI_APPLIANCE_ATTR_VERIFY_INNER_CHECKSUM:
+            v.verify_inner_checksum = attr.value.booldata;
+            return true;
+        default:
+            return ipv4_from_sai(attr.value.ipaddr, v.ip);
+        }
+    }
+
+    static void get(const value_type &v, sai_attribute_t &attr)
+    {
+        switch (attr.id) {
+        case SAI_APPLIANCE_ATTR_NEIGHBOR_MAC:
+            mac_to_bytes(v.neighbor_mac, attr.value.mac);
+            break;
+        case SAI_APPLIANCE_ATTR_MAC:
+            mac_to_bytes(v.mac, attr.value.mac);
+            break;
+        case SAI_APPLIANCE_ATTR_TCP_FLOW_TIMEOUT:
+            attr.value.u32 = v.tcp_flow_timeout;
+            break;
+        case SAI_APPLIANCE_ATTR_UDP_FLOW_TIMEOUT:
+            attr.value.u32 = v.udp_flow_timeout;
+            break;
+        case SAI_APPLIANCE_ATTR_ENCAP_SPORT_HASH:
+            attr.value.s32 = v.encap_sport_hash;
+            break;
+        case SAI_APPLIANCE_ATTR_ENCAP_SPORT_MIN:
+            attr.value.u16 = v.encap_sport_min;
+            break;
+        case SAI_APPLIANCE_ATTR_ENCAP_SPORT_MAX:
+            attr.value.u16 = v.encap_sport_max;
+            break;
+        case SAI_APPLIANCE_ATTR_VERIFY_INNER_CHECKSUM:
+            attr.value.booldata = v.verify_inner_checksum;
+            break;
+        default:
+            ipv4_to_sai(v.ip, attr.value.ipaddr);
+            break;
+        }
+    }
+};
+
+template <typename E, sai_attr_id_t ATTR_ENI>
+struct eni_lookup_traits {
+    using sai_entry_t = E;
+    using key_type = mac_t;
+    using value_type = eni_entry_t;
+
+    static constexpr std::array<sai_attr_id_t, 1> attrs = { ATTR_ENI };
+
+    static bool parse(const sai_attribute_t &attr, value_type &v)
+    {
+        v.eni = attr.value.u16;
+        return true;
+    }
+
+    static void get(const value_type &v, sai_attribute_t &attr)
+    {
+        attr.value.u16 = v.eni;
+    }
+};
+
+struct outbound_eni_lookup_from_vm_traits :
+    eni_lookup_traits<sai_outbound_eni_lookup_from_vm_entry_t, SAI_OUTBOUND_ENI_LOOKUP_FROM_VM_ENTRY_ATTR_ENI> {
+    static auto &table(sirius_switch &sw) { return sw.eni_lookup_from_vm; }
+
+    static bool key(const sai_entry_t &e, key_type &k)
+    {
+        k = mac_from_bytes(e.smac);
+        return true;
+    }
+};
+
+struct inbound_eni_lookup_to_vm_traits :
+    eni_lookup_traits<sai_inbound_eni_lookup_to_vm_entry_t, SAI_INBOUND_ENI_LOOKUP_TO_VM_ENTRY_ATTR_ENI> {
+    static auto &table(sirius_switch &sw) { return sw.eni_lookup_to_vm; }
+
+    static bool key(const sai_entry_t &e, key_type &k)
+    {
+        k = mac_from_bytes(e.dmac);
+        return true;
+    }
+};
+
+struct outbound_eni_to_vni_traits {
+    using sai_entry_t = sai_outbound_eni_to_vni_entry_t;
+    using key_type = uint16_t;
+    using value_type = eni_to_vni_entry_t;
+
+    static constexpr std::array<sai_attr_id_t, 1> attrs = {
+        SAI_OUTBOUND_ENI_TO_VNI_ENTRY_ATTR_VNI,
+    };
+
+    static auto &table(sirius_switch &sw) { return sw.eni_to_vni; }
+
+    static bool key(const sai_entry_t &e, key_type &k)
+    {
+        k = e.eni;
+        return true;
+    }
+
+    static void changed(const key_type &k) { sai_switch().generations.eni_changed(k); }
+
+    static bool parse(const sai_attribute_t &attr, value_type &v)
+    {
+        v.vni = attr.value.u32;
+        return attr.value.u32 < (1u << 24);
+    }
+
+    static void get(const value_type &v, sai_attribute_t &attr)
+    {
+        attr.value.u32 = v.vni;
+    }
+};
+
+/* Copies a list into a SAI list attribute, see SAI_STATUS_BUFFER_OVERFLOW */
+template <typename L, typename V, typename Fn>
+sai_status_t list_to_sai(const std::vector<V> &values, L &list, Fn &&convert)
+{
+    uint32_t count = list.count;
+    list.count = (uint32_t)values.size();
+    if (count < values.size()) {
+        return SAI_STATUS_BUFFER_OVERFLOW;
+    }
+    if (!values.empty() && !list.list) {
+        return SAI_STATUS_INVALID_PARAMETER;
+    }
+    for (size_t i = 0; i < values.size(); i++) {
+        convert(values[i], list.list[i]);
+    }
+    return SAI_STATUS_SUCCESS;
+}
+
+template <typename L, typename V, typename Fn>
+bool list_from_sai(const L &list, std::vector<V> &values, Fn &&convert)
+{
+    if (list.count && !list.list) {
+        return false;
+    }
+    values.resize(list.count);
+    for (uint32_t i = 0; i < list.count; i++) {
+        if (!convert(list.list[i], values[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool acl_prefix_from_sai(const sai_ip_prefix_t &prefix, acl_prefix_t &out)
+{
+    return prefix_from_sai(prefix, out.addr, out.len);
+}
+
+void acl_prefix_to_sai(const acl_prefix_t &prefix, sai_ip_prefix_t &out)
+{
+    out.addr_family = SAI_IP_ADDR_FAMILY_IPV4;
+    out.addr.ip4 = htonl(prefix.addr);
+    out.mask.ip4 = htonl(prefix.len ? ~0u << (32 - prefix.len) : 0);
+}
+
+bool acl_port_range_from_sai(const sai_u16_range_t &range, acl_port_range_t &out)
+{
+    out.min = range.min;
+    out.max = range.max;
+    return range.min <= range.max;
+}
+
+void acl_port_range_to_sai(const acl_port_range_t &range, sai_u16_range_t &out)
+{
+    out.min = range.min;
+    out.max = range.max;
+}
+
+/* The stage entries and their attribute enums of saidash.h all share one layout */
+template <typename E, sai_attr_id_t ATTR_START, bool OUTBOUND, unsigned STAGE>
+struct acl_traits {
+    using sai_entry_t = E;
+    using key_type = acl_rule_key_t;
+    using value_type = acl_rule_t;
+
+    enum : sai_attr_id_t {
+        ATTR_ACTION = ATTR_START,
+        ATTR_DIP,
+        ATTR_SIP,
+        ATTR_PROTOCOL,
+        ATTR_SPORT,
+        ATTR_DPORT,
+    };
+
+    static constexpr std::array<sai_attr_id_t, 6> attrs = {
+        ATTR_ACTION, ATTR_DIP, ATTR_SIP, ATTR_PROTOCOL, ATTR_SPORT, ATTR_DPORT,
+    };
+
+    static auto &table(sirius_switch &sw)
+    {
+        return OUTBOUND ? sw.outbound_acl[STAGE] : sw.inbound_acl[STAGE];
+    }
+
+    static bool key(const sai_entry_t &e, key_type &k)
+    {
+        k.eni = e.eni;
+        k.priority = e.priority;
+        return true;
+    }
+
+    static void changed(const key_type &k) { sai_switch().generations.eni_changed(k.eni); }
+
+    static bool parse(const sai_attribute_t &attr, value_type &v)
+    {
+        switch (attr.id) {
+        case ATTR_ACTION:
+            /* The stage action enums of saidash.h all share this order */
+            if (attr.value.s32 < ACL_ACTION_PERMIT || attr.value.s32 > ACL_ACTION_DENY_AND_CONTINUE) {
+                return false;
+            }
+            v.action = (acl_action_t)attr.value.s32;
+            return true;
+        case ATTR_DIP:
+            return list_from_sai(attr.value.ipprefixlist, v.dip, acl_prefix_from_sai);
+        case ATTR_SIP:
+            return list_from_sai(attr.value.ipprefixlist, v.sip, acl_prefix_from_sai);
+        case ATTR_PROTOCOL:
+            return list_from_sai(attr.value.u8list, v.protocol, [](uint8_t p, uint8_t &out) {
+                out = p;
+                return true;
+            });
+        case ATTR_SPORT:
+            return list_from_sai(attr.value.u16rangelist, v.sport, acl_port_range_from_sai);
+        default:
+            return list_from_sai(attr.value.u16rangelist, v.dport, acl_port_range_from_sai);
+        }
+    }
+
+    static sai_status_t get(const value_type &v, sai_attribute_t &attr)
+    {
+        switch (attr.id) {
+        case ATTR_ACTION:
+            attr.value.s32 = v.action;
+            return SAI_STATUS_SUCCESS;
+        case ATTR_DIP:
+            return list_to_sai(v.dip, attr.value.ipprefixlist, acl_prefix_to_sai);
+        case ATTR_SIP:
+            return list_to_sai(v.sip, attr.value.ipprefixlist, acl_prefix_to_sai);
+        case ATTR_PROTOCOL:
+            return list_to_sai(v.protocol, attr.value.u8list, [](uint8_t p, uint8_t &out) { out = p; });
+        case ATTR_SPORT:
+            return list_to_sai(v.sport, attr.value.u16rangelist, acl_port_range_to_sai);
+        default:
+            return list_to_sai(v.dport, attr.value.u16rangelist, acl_port_range_to_sai);
+        }
+    }
+};
+
+using outbound_acl_stage1_traits = acl_traits<sai_outbound_acl_stage1_entry_t, SAI_OUTBOUND_ACL_STAGE1_ENTRY_ATTR_START, true, 0>;
+using outbound_acl_stage2_traits = acl_traits<sai_outbound_acl_stage2_entry_t, SAI_OUTBOUND_ACL_STAGE2_ENTRY_ATTR_START, true, 1>;
+using outbound_acl_stage3_traits = acl_traits<sai_outbound_acl_stage3_entry_t, SAI_OUTBOUND_ACL_STAGE3_ENTRY_ATTR_START, true, 2>;
+using inbound_acl_stage1_traits = acl_traits<sai_inbound_acl_stage1_entry_t, SAI_INBOUND_ACL_STAGE1_ENTRY_ATTR_START, false, 0>;
+using inbound_acl_stage2_traits = acl_traits<sai_inbound_acl_stage2_entry_t, SAI_INBOUND_ACL_STAGE2_ENTRY_ATTR_START, false, 1>;
+using inbound_acl_stage3_traits = acl_traits<sai_inbound_acl_stage3_entry_t, SAI_INBOUND_ACL_STAGE3_ENTRY_ATTR_START, false, 2>;
+
+struct outbound_routing_traits {
+    using sai_entry_t = sai_outbound_routing_entry_t;
+    using key_type = routing_key_t;
+    using value_type = routing_entry_t;
+
+    static constexpr std::array<sai_attr_id_t, 1> attrs = {
+        SAI_OUTBOUND_ROUTING_ENTRY_ATTR_DEST_VNET_VNI,
+    };
+
+    static constexpr std::array<sai_attr_id_t, 1> read_only_attrs = {
+        SAI_OUTBOUND_ROUTING_ENTRY_ATTR_COUNTER_ID,
+    };
+
+    static auto &table(sirius_switch &sw) { return sw.routing; }
+
+    static bool key(const sai_entry_t &e, key_type &k)
+    {
+        k.eni = e.eni;
+        return prefix_from_sai(e.destination, k.prefix, k.prefix_len);
+    }
+
+    static void changed(const key_type &k) { sai_switch().generations.eni_changed(k.eni); }
+
+    static bool parse(const sai_attribute_t &attr, value_type &v)
+    {
+        v.dest_vnet_vni = attr.value.u32;
+        return attr.value.u32 < (1u << 24);
+    }
+
+    static void get(const value_type &v, sai_attribute_t &attr)
+    {
+        attr.value.u32 = attr.id == SAI_OUTBOUND_ROUTING_ENTRY_ATTR_COUNTER_ID ? v.counter : v.dest_vnet_vni;
+    }
+};
+
+struct outbound_ca_to_pa_traits {
+    using sai_entry_t = sai_outbound_ca_to_pa_entry_t;
+    using key_type = ca_to_pa_key_t;
+    using value_type = ca_to_pa_entry_t;
+
+    static constexpr std::array<sai_attr_id_t, 3> attrs = {
+        SAI_OUTBOUND_CA_TO_PA_ENTRY_ATTR_UNDERLAY_DIP,
+        SAI_OUTBOUND_CA_TO_PA_ENTRY_ATTR_OVERLAY_DMAC,
+        SAI_OUTBOUND_CA_TO_PA_ENTRY_ATTR_USE_DST_VNI,
+    };
+
+    static constexpr std::array<sai_attr_id_t, 1> read_only_attrs = {
+        SAI_OUTBOUND_CA_TO_PA_ENTRY_ATTR_COUNTER_ID,
+    };
+
+    static auto &table(sirius_switch &sw) { return sw.ca_to_pa; }
+
+    static bool key(const sai_entry_t &e, key_type &k)
+    {
+        k.dest_vni = e.dest_vni;
+        return ipv4_from_sai(e.dip, k.dip);
+    }
+
+    static void changed(const key_type &k) { sai_switch().generations.dip_changed(k.dip); }
+
+    static bool parse(const sai_attribute_t &attr, value_type &v)
+    {
+        switch (attr.id) {
+        case SAI_OUTBOUND_CA_TO_PA_ENTRY_ATTR_UNDERLAY_DIP:
+            return ipv4_from_sai(attr.value.ipaddr, v.underlay_dip);
+        case SAI_OUTBOUND_CA_TO_PA_ENTRY_ATTR_OVERLAY_DMAC:
+            v.overlay_dmac = mac_from_bytes(attr.value.mac);
+            return true;
+        default:
+            v.use_dst_vni = attr.value.booldata;
+            return true;
+        }
+    }
+
+    static void get(const value_type &v, sai_attribute_t &attr)
+    {
+        switch (attr.id) {
+        case SAI_OUTBOUND_CA_TO_PA_ENTRY_ATTR_UNDERLAY_DIP:
+            ipv4_to_sai(v.underlay_dip, attr.value.ipaddr);
+            break;
+        case SAI_OUTBOUND_CA_TO_PA_ENTRY_ATTR_OVERLAY_DMAC:
+            mac_to_bytes(v.overlay_dmac, attr.value.mac);
+            break;
+        case SAI_OUTBOUND_CA_TO_PA_ENTRY_ATTR_COUNTER_ID:
+            attr.value.u32 = v.counter;
+            break;
+        default:
+            attr.value.booldata = v.use_dst_vni;
+            break;
+        }
+    }
+};
+
+struct inbound_eni_to_vm_traits {
+    using sai_entry_t = sai_inbound_eni_to_vm_entry_t;
+    using key_type = uint16_t;
+    using value_type = eni_to_vm_entry_t;
+
+    static constexpr std::array<sai_attr_id_t, 1> attrs = {
+        SAI_INBOUND_ENI_TO_VM_ENTRY_ATTR_VM_ID,
+    };
+
+    static auto &table(sirius_switch &sw) { return sw.eni_to_vm; }
+
+    static bool key(const sai_entry_t &e, key_type &k)
+    {
+        k = e.eni;
+        return true;
+    }
+
+    static void changed(const key_type &k) { sai_switch().generations.eni_changed(k); }
+
+    static bool parse(const sai_attribute_t &attr, value_type &v)
+    {
+        v.vm_id = attr.value.u16;
+        return true;
+    }
+
+    static void get(const value_type &v, sai_attribute_t &attr)
+    {
+        attr.value.u16 = v.vm_id;
+    }
+};
+
+struct inbound_vm_traits {
+    using key_type = uint16_t;
+    using value_type = vm_entry_t;
+    using table_type = decltype(sirius_switch::vm);
+
+    static constexpr oid_type_t oid_type = OID_TYPE_INBOUND_VM;
+    static constexpr std::array<sai_attr_id_t, 3> attrs = {
+        SAI_INBOUND_VM_ATTR_UNDERLAY_DMAC,
+        SAI_INBOUND_VM_ATTR_UNDERLAY_DIP,
+        SAI_INBOUND_VM_ATTR_VNI,
+    };
+
+    static auto &table(sirius_switch &sw) { return sw.vm; }
+    static auto &ids(sirius_switch &sw) { return sw.vm_ids; }
+
+    static bool parse(const sai_attribute_t &attr, value_type &v)
+    {
+        switch (attr.id) {
+        case SAI_INBOUND_VM_ATTR_UNDERLAY_DMAC:
+            v.underlay_dmac = mac_from_bytes(attr.value.mac);
+            return true;
+        case SAI_INBOUND_VM_ATTR_UNDERLAY_DIP:
+            return ipv4_from_sai(attr.value.ipaddr, v.underlay_dip);
+        default:
+            v.vni = attr.value.u32;
+            return attr.value.u32 < (1u << 24);
+        }
+    }
+
+    static void get(const value_type &v, sai_attribute_t &attr)
+    {
+        switch (attr.id) {
+        case SAI_INBOUND_VM_ATTR_UNDERLAY_DMAC:
+            mac_to_bytes(v.underlay_dmac, attr.value.mac);
+            break;
+        case SAI_INBOUND_VM_ATTR_UNDERLAY_DIP:
+            ipv4_to_sai(v.underlay_dip, attr.value.ipaddr);
+            break;
+        default:
+            attr.value.u32 = v.vni;
+            break;
+        }
+    }
+};
+
+struct eni_meter_traits {
+    using sai_entry_t = sai_eni_meter_entry_t;
+    using key_type = eni_meter_key_t;
+    using value_type = eni_meter_entry_t;
+
+    static constexpr std::array<sai_attr_id_t, 0> attrs = {};
+
+    static auto &table(sirius_switch &sw) { return sw.eni_meter; }
+
+    static bool key(const sai_entry_t &e, key_type &k)
+    {
+        k.eni = e.eni;
+        k.direction = e.direction;
+        k.dropped = e.dropped;
+        return true;
+    }
+
+    /* No flow reads eni_meter, packets count by their ENI whatever it holds */
+    static void changed(const key_type &) {}
+
+    static bool parse(const sai_attribute_t &, value_type &)
+    {
+        return false;
+    }
+
+    static void get(const value_type &, sai_attribute_t &)
+    {
+    }
+
+    /* The eni_counter slot of a key; false for the keys no packet matches */
+    static bool slot(const key_type &k, uint32_t &slot)
+    {
+        if ((k.direction != DIRECTION_OUTBOUND && k.direction != DIRECTION_INBOUND) || k.dropped > 1) {
+            return false;
+        }
+        slot = eni_counter_slot(k.eni, (direction_t)k.direction, k.dropped);
+        return true;
+    }
+
+    /* A new entry counts from zero, not from what an earlier one with its key counted */
+    static void inserted(const key_type &k)
+    {
+        uint32_t s;
+        if (slot(k, s)) {
+            sai_switch().eni_counters.reset(&s, 1, true, true);
+        }
+    }
+};
+
+/* Statistics of eni_meter entries, the eni_counter direct counter */
+struct eni_meter_stats {
+    using T = eni_meter_traits;
+
+    /* Which of the two counts counter_ids asks for */
+    static bool decode_ids(uint32_t number_of_counters, const sai_stat_id_t *counter_ids, bool &packets, bool &bytes)
+    {
+        packets = bytes = false;
+        if (!number_of_counters || !counter_ids) {
+            return false;
+        }
+        for (uint32_t i = 0; i < number_of_counters; i++) {
+            switch (counter_ids[i]) {
+            case SAI_ENI_METER_ENTRY_STAT_PACKETS:
+                packets = true;
+                break;
+            case SAI_ENI_METER_ENTRY_STAT_BYTES:
+                bytes = true;
+                break;
+            default:
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static void encode(const counter_t &c, uint32_t number_of_counters, const sai_stat_id_t *counter_ids,
+                       uint64_t *counters)
+    {
+        for (uint32_t i = 0; i < number_of_counters; i++) {
+            counters[i] = counter_ids[i] == SAI_ENI_METER_ENTRY_STAT_PACKETS ? c.packets : c.bytes;
+        }
+    }
+
+    /*
+     * Reads the counts of a batch of entries with one lock of the
+     * counters; statuses[i] is ITEM_NOT_FOUND for the entries that do not
+     * exist, whose counts are left alone.
+     */
+    static void read(uint32_t count, const sai_eni_meter_entry_t *entries, sai_status_t *statuses,
+                     counter_t *out, bool clear, bool packets, bool bytes)
+    {
+        sirius_switch &sw = sai_switch();
+        std::vector<T::key_type> keys(count);
+        std::unique_ptr<bool[]> found(new bool[count]);
+        for (uint32_t i = 0; i < count; i++) {
+            T::key(entries[i], keys[i]);
+        }
+        T::table(sw).contains(keys.data(), count, found.get());
+
+        std::vector<uint32_t> slots;
+        std::vector<uint32_t> slotted;
+        slots.reserve(count);
+        slotted.reserve(count);
+        for (uint32_t i = 0; i < count; i++) {
+            if (!found[i]) {
+                statuses[i] = SAI_STATUS_ITEM_NOT_FOUND;
+                continue;
+            }
+            statuses[i] = SAI_STATUS_SUCCESS;
+            out[i] = {};
+            uint32_t s;
+            if (T::slot(keys[i], s)) {
+                slots.push_back(s);
+                slotted.push_back(i);
+            }
+        }
+
+        std::vector<counter_t> counts(slots.size());
+        if (clear) {
+            sw.eni_counters.read_and_reset(slots.data(), slots.size(), counts.data(), packets, bytes);
+        } else {
+            sw.eni_counters.read(slots.data(), slots.size(), counts.data());
+        }
+        for (size_t j = 0; j < slotted.size(); j++) {
+            out[slotted[j]] = counts[j];
+        }
+    }
+
+    static sai_status_t get(const sai_eni_meter_entry_t *entry, uint32_t number_of_counters,
+                            const sai_stat_id_t *counter_ids, uint64_t *counters)
+    {
+        bool packets, bytes;
+        if (!entry || !counters || !decode_ids(number_of_counters, counter_ids, packets, bytes)) {
+            return SAI_STATUS_INVALID_PARAMETER;
+        }
+        sai_status_t status;
+        counter_t c;
+        read(1, entry, &status, &c, false, packets, bytes);
+        if (status == SAI_STATUS_SUCCESS) {
+            encode(c, number_of_counters, counter_ids, counters);
+        }
+        return status;
+    }
+
+    static sai_status_t clear(const sai_eni_meter_entry_t *entry, uint32_t number_of_counters,
+                              const sai_stat_id_t *counter_ids)
+    {
+        bool packets, bytes;
+        if (!entry || !decode_ids(number_of_counters, counter_ids, packets, bytes)) {
+            return SAI_STATUS_INVALID_PARAMETER;
+        }
+        T::key_type key;
+        T::value_type value;
+        T::key(*entry, key);
+        if (!T::table(sai_switch()).lookup(key, value)) {
+            return SAI_STATUS_ITEM_NOT_FOUND;
+        }
+        uint32_t s;
+        if (T::slot(key, s)) {
+            sai_switch().eni_counters.reset(&s, 1, packets, bytes);
+        }
+        return SAI_STATUS_SUCCESS;
+    }
+
+    static sai_status_t bulk_get(uint32_t object_count, const sai_eni_meter_entry_t *entries,
+                                 uint32_t number_of_counters, const sai_stat_id_t *counter_ids,
+                                 sai_stats_mode_t mode, sai_status_t *object_statuses, uint64_t *counters)
+    {
+        bool packets, bytes;
+        if (!object_count || !entries || !object_statuses || !counters ||
+            !decode_ids(number_of_counters, counter_ids, packets, bytes) ||
+            (mode != SAI_STATS_MODE_READ && mode != SAI_STATS_MODE_READ_AND_CLEAR)) {
+            return SAI_STATUS_INVALID_PARAMETER;
+        }
+        std::vector<counter_t> counts(object_count);
+        read(object_count, entries, object_statuses, counts.data(), mode == SAI_STATS_MODE_READ_AND_CLEAR, packets,
+             bytes);
+
+        sai_status_t status = SAI_STATUS_SUCCESS;
+        for (uint32_t i = 0; i < object_count; i++) {
+            if (object_statuses[i] != SAI_STATUS_SUCCESS) {
+                status = SAI_STATUS_FAILURE;
+                continue;
+            }
+            encode(counts[i], number_of_counters, counter_ids, counters + (size_t)i * number_of_counters);
+        }
+        return status;
+    }
+};
+
+/* get_outbound_counters_snapshot: routing_counter and ca_to_pa_counter of all entries */
+struct outbound_counters {
+    static void fill(const std::vector<uint32_t> &slots, const std::vector<counter_t> &counts,
+                     sai_dash_counter_t *out)
+    {
+        for (size_t i = 0; i < slots.size(); i++) {
+            out[i].entry_id = slots[i];
+            out[i].packets = counts[i].packets;
+            out[i].bytes = counts[i].bytes;
+        }
+    }
+
+    static sai_status_t snapshot(uint32_t *routing_count, sai_dash_counter_t *routing_counters,
+                                 uint32_t *ca_to_pa_count, sai_dash_counter_t *ca_to_pa_counters, uint64_t *epoch)
+    {
+        if (!routing_count || !ca_to_pa_count || !epoch || (*routing_count && !routing_counters) ||
+            (*ca_to_pa_count && !ca_to_pa_counters)) {
+            return SAI_STATUS_INVALID_PARAMETER;
+        }
+
+        sirius_switch &sw = sai_switch();
+        std::vector<uint32_t> routing_slots, ca_to_pa_slots;
+        std::vector<counter_t> routing_counts, ca_to_pa_counts;
+        bool fits = false;
+
+        /* Both tables held at once, routing first, so the entries and the epoch they share are of one moment */
+        sw.routing.hold([&] {
+            sw.ca_to_pa.hold([&] {
+                size_t routes = sw.routing.size_held();
+                size_t mappings = sw.ca_to_pa.size_held();
+                fits = routes <= *routing_count && mappings <= *ca_to_pa_count;
+                *routing_count = (uint32_t)routes;
+                *ca_to_pa_count = (uint32_t)mappings;
+                if (fits) {
+                    sw.routing.snapshot_held(routing_slots, routing_counts);
+                    sw.ca_to_pa.snapshot_held(ca_to_pa_slots, ca_to_pa_counts);
+                    *epoch = sw.routing.counters().epoch();
+                }
+            });
+        });
+        if (!fits) {
+            return SAI_STATUS_BUFFER_OVERFLOW;
+        }
+        fill(routing_slots, routing_counts, routing_counters);
+        fill(ca_to_pa_slots, ca_to_pa_counts, ca_to_pa_counters);
+        return SAI_STATUS_SUCCESS;
+    }
+};
+
+/* get_acl_rule_counters and get_acl_top_rules: the <stage>_counter of the ACL rules */
+struct acl_counters {
+    static sirius_acl_table *table(sai_dash_acl_stage_t stage)
+    {
+        sirius_switch &sw = sai_switch();
+        switch (stage) {
+        case SAI_DASH_ACL_STAGE_OUTBOUND_STAGE1:
+        case SAI_DASH_ACL_STAGE_OUTBOUND_STAGE2:
+        case SAI_DASH_ACL_STAGE_OUTBOUND_STAGE3:
+            return &sw.outbound_acl[stage - SAI_DASH_ACL_STAGE_OUTBOUND_STAGE1];
+        case SAI_DASH_ACL_STAGE_INBOUND_STAGE1:
+        case SAI_DASH_ACL_STAGE_INBOUND_STAGE2:
+        case SAI_DASH_ACL_STAGE_INBOUND_STAGE3:
+            return &sw.inbound_acl[stage - SAI_DASH_ACL_STAGE_INBOUND_STAGE1];
+        default:
+            return nullptr;
+        }
+    }
+
+    static sai_status_t rules(sai_dash_acl_stage_t stage, sai_uint16_t eni, uint32_t count,
+                              sai_dash_acl_rule_counter_t *rule_counters, sai_status_t *object_statuses)
+    {
+        sirius_acl_table *acl = table(stage);
+        if (!acl || !count || !rule_counters || !object_statuses) {
+            return SAI_STATUS_INVALID_PARAMETER;
+        }
+
+        std::vector<uint32_t> priorities(count);
+        for (uint32_t i = 0; i < count; i++) {
+            priorities[i] = rule_counters[i].priority;
+        }
+        std::vector<counter_t> counts(count);
+        std::unique_ptr<bool[]> found(new bool[count]);
+        acl->rule_counters(eni, priorities.data(), count, counts.data(), found.get());
+
+        sai_status_t status = SAI_STATUS_SUCCESS;
+        for (uint32_t i = 0; i < count; i++) {
+            if (!found[i]) {
+                object_statuses[i] = SAI_STATUS_ITEM_NOT_FOUND;
+                status = SAI_STATUS_FAILURE;
+                continue;
+            }
+            object_statuses[i] = SAI_STATUS_SUCCESS;
+            rule_counters[i].packets = counts[i].packets;
+            rule_counters[i].bytes = counts[i].bytes;
+        }
+        return status;
+    }
+
+    static sai_status_t top(sai_dash_acl_stage_t stage, sai_uint16_t eni, uint32_t *count,
+                            sai_dash_acl_rule_counter_t *rule_counters)
+    {
+        sirius_acl_table *acl = table(stage);
+        if (!acl || !count || (*count && !rule_counters)) {
+            return SAI_STATUS_INVALID_PARAMETER;
+        }
+
+        std::vector<acl_rule_counter_t> top;
+        acl->top_rules(eni, *count, top);
+        for (size_t i = 0; i < top.size(); i++) {
+            rule_counters[i].priority = top[i].priority;
+            rule_counters[i].packets = top[i].counter.packets;
+            rule_counters[i].bytes = top[i].counter.bytes;
+        }
+        *count = (uint32_t)top.size();
+        return SAI_STATUS_SUCCESS;
+    }
+};
+
+/* The switch object: placement of the large tables, set on create */
+struct switch_object {
+    static sai_status_t create(sai_object_id_t *switch_id, uint32_t attr_count, const sai_attribute_t *attr_list)
+    {
+        if (!switch_id || (attr_count && !attr_list)) {
+            return SAI_STATUS_INVALID_PARAMETER;
+        }
+        bool init = false;
+        bool has_init = false;
+        bool numa_local = false;
+        memory_placement_t placement;
+        for (uint32_t i = 0; i < attr_count; i++) {
+            const sai_attribute_value_t &v = attr_list[i].value;
+            switch (attr_list[i].id) {
+            case SAI_SWITCH_ATTR_INIT_SWITCH:
+                init = v.booldata;
+                has_init = true;
+                break;
+            case SAI_SWITCH_ATTR_TABLE_PAGE_SIZE:
+                if (v.s32 < SAI_SWITCH_TABLE_PAGE_SIZE_DEFAULT || v.s32 > SAI_SWITCH_TABLE_PAGE_SIZE_1GB) {
+                    return attr_status(SAI_STATUS_INVALID_ATTR_VALUE_0, i);
+                }
+                placement.page_size = (page_size_t)v.s32;
+                break;
+            case SAI_SWITCH_ATTR_TABLE_NUMA_NODE:
+                if (v.s32 < -1) {
+                    return attr_status(SAI_STATUS_INVALID_ATTR_VALUE_0, i);
+                }
+                placement.numa_node = v.s32;
+                break;
+            case SAI_SWITCH_ATTR_FLOW_TABLE_NUMA_LOCAL:
+                numa_local = v.booldata;
+                break;
+            default:
+                return attr_status(SAI_STATUS_ATTR_NOT_SUPPORTED_0, i);
+            }
+        }
+        if (!has_init) {
+            return SAI_STATUS_MANDATORY_ATTRIBUTE_MISSING;
+        }
+        /* Connecting leaves the tables where they are */
+        if (init && !sai_switch().place(placement, numa_local)) {
+            return SAI_STATUS_OBJECT_IN_USE;
+        }
+        *switch_id = oid_encode(OID_TYPE_SWITCH, 0);
+        return SAI_STATUS_SUCCESS;
+    }
+
+    static sai_status_t remove(sai_object_id_t switch_id)
+    {
+        uint32_t index;
+        return oid_decode(switch_id, OID_TYPE_SWITCH, index) ? SAI_STATUS_SUCCESS : SAI_STATUS_INVALID_OBJECT_ID;
+    }
+
+    static sai_status_t set(sai_object_id_t switch_id, const sai_attribute_t *attr)
+    {
+        uint32_t index;
+        if (!oid_decode(switch_id, OID_TYPE_SWITCH, index)) {
+            return SAI_STATUS_INVALID_OBJECT_ID;
+        }
+        if (!attr) {
+            return SAI_STATUS_INVALID_PARAMETER;
+        }
+        switch (attr->id) {
+        case SAI_SWITCH_ATTR_INIT_SWITCH:
+        case SAI_SWITCH_ATTR_TABLE_PAGE_SIZE:
+        case SAI_SWITCH_ATTR_TABLE_NUMA_NODE:
+        case SAI_SWITCH_ATTR_FLOW_TABLE_NUMA_LOCAL:
+            return SAI_STATUS_INVALID_ATTRIBUTE_0;
+        default:
+            return SAI_STATUS_ATTR_NOT_SUPPORTED_0;
+        }
+    }
+
+    static sai_status_t get(sai_object_id_t switch_id, uint32_t attr_count, sai_attribute_t *attr_list)
+    {
+        uint32_t index;
+        if (!oid_decode(switch_id, OID_TYPE_SWITCH, index)) {
+            return SAI_STATUS_INVALID_OBJECT_ID;
+        }
+        if (!attr_count || !attr_list) {
+            return SAI_STATUS_INVALID_PARAMETER;
+        }
+        const sirius_switch &sw = sai_switch();
+        for (uint32_t i = 0; i < attr_count; i++) {
+            sai_attribute_value_t &v = attr_list[i].value;
+            switch (attr_list[i].id) {
+            case SAI_SWITCH_ATTR_INIT_SWITCH:
+                v.booldata = true;
+                break;
+            case SAI_SWITCH_ATTR_TABLE_PAGE_SIZE:
+                v.s32 = sw.table_placement.page_size;
+                break;
+            case SAI_SWITCH_ATTR_TABLE_NUMA_NODE:
+                v.s32 = sw.table_placement.numa_node;
+                break;
+            case SAI_SWITCH_ATTR_FLOW_TABLE_NUMA_LOCAL:
+                v.booldata = sw.flow_numa_local;
+                break;
+            default:
+                return attr_status(SAI_STATUS_ATTR_NOT_SUPPORTED_0, i);
+            }
+        }
+        return SAI_STATUS_SUCCESS;
+    }
+};
+
+#define SIRIUS_ENTRY_API(traits) \
+    entry_api<traits>::create, \
+    entry_api<traits>::remove, \
+    entry_api<traits>::set, \
+    entry_api<traits>::get, \
+    entry_api<traits>::bulk_create, \
+    entry_api<traits>::bulk_remove
+
+#define SIRIUS_OBJECT_API(traits) \
+    object_api<traits>::create, \
+    object_api<traits>::remove, \
+    object_api<traits>::set, \
+    object_api<traits>::get, \
+    object_api<traits>::bulk_create, \
+    object_api<traits>::bulk_remove
+
+const sai__api_t dash_api = {
+    SIRIUS_ENTRY_API(direction_lookup_traits),
+    SIRIUS_OBJECT_API(appliance_traits),
+    SIRIUS_ENTRY_API(outbound_eni_lookup_from_vm_traits),
+    SIRIUS_ENTRY_API(outbound_eni_to_vni_traits),
+    SIRIUS_ENTRY_API(outbound_acl_stage1_traits),
+    SIRIUS_ENTRY_API(outbound_acl_stage2_traits),
+    SIRIUS_ENTRY_API(outbound_acl_stage3_traits),
+    SIRIUS_ENTRY_API(outbound_routing_traits),
+    SIRIUS_ENTRY_API(outbound_ca_to_pa_traits),
+    SIRIUS_ENTRY_API(inbound_eni_lookup_to_vm_traits),
+    SIRIUS_ENTRY_API(inbound_eni_to_vm_traits),
+    SIRIUS_OBJECT_API(inbound_vm_traits),
+    SIRIUS_ENTRY_API(inbound_acl_stage1_traits),
+    SIRIUS_ENTRY_API(inbound_acl_stage2_traits),
+    SIRIUS_ENTRY_API(inbound_acl_stage3_traits),
+    SIRIUS_ENTRY_API(eni_meter_traits),
+    eni_meter_stats::get,
+    eni_meter_stats::clear,
+    eni_meter_stats::bulk_get,
+    outbound_counters::snapshot,
+    acl_counters::rules,
+    acl_counters::top,
+};
+
+const sai_switch_api_t switch_api = {
+    switch_object::create,
+    switch_object::remove,
+    switch_object::set,
+    switch_object::get,
+};
+
+} // namespace
+
+} // namespace sirius
+
+extern "C" const sai__api_t *sirius_dash_api_query(void)
+{
+    return &sirius::dash_api;
+}
+
+extern "C" const sai_switch_api_t *sirius_switch_api_query(void)
+{
+    return &sirius::switch_api;
+}
@@ -0,0 +1,38 @@
+#ifndef _SIRIUS_SAI_H_
+#define _SIRIUS_SAI_H_
+
+extern "C" {
+#include <saitypes.h>
+#include <saistatus.h>
+#include <saidash.h>
+#include <saiswitch.h>
+}
+
+namespace sirius {
+
+class sirius_switch;
+
+/* Switch instance programmed by the sai__api_t functions below */
+sirius_switch &sai_switch();
+
+} // namespace sirius
+
+/**
+ * @brief Reference implementation of the DASH API function table
+ *
+ * Every create/remove/set/get and bulk_create/bulk_remove entry point
+ * writes straight into the tables of sirius::sai_switch().
+ */
+extern "C" const sai__api_t *sirius_dash_api_query(void);
+
+/**
+ * @brief Switch API of sirius::sai_switch()
+ *
+ * create_switch() with SAI_SWITCH_ATTR_INIT_SWITCH places the large
+ * tables as SAI_SWITCH_ATTR_TABLE_PAGE_SIZE, SAI_SWITCH_ATTR_TABLE_NUMA_NODE
+ * and SAI_SWITCH_ATTR_FLOW_TABLE_NUMA_LOCAL ask, before any entry is
+ * created; those are the only attributes supported.
+ */
+extern "C" const sai_switch_api_t *sirius_switch_api_query(void);
+
+#endif /* _SIRIUS_SAI_H_ */
@@ -0,0 +1,69 @@
+#include "sirius_slab.h"
+
+namespace sirius {
+
+sirius_slab::sirius_slab(size_t block_size, size_t blocks, const memory_placement_t &placement)
+    : m_block_size(block_size), m_blocks(blocks), m_mapping(memory(), placement),
+      m_memory(static_cast<char *>(m_mapping.data()))
+{
+}
+
+size_t sirius_slab::taken() const
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    return m_taken;
+}
+
+size_t sirius_slab::get(free_t *&head, size_t n)
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    size_t got = 0;
+    for (; got < n && m_free; got++) {
+        free_t *block = m_free;
+        m_free = block->next;
+        block->next = head;
+        head = block;
+    }
+    for (; got < n && m_next < m_blocks; got++) {
+        auto *block = reinterpret_cast<free_t *>(m_memory + m_next++ * m_block_size);
+        block->next = head;
+        head = block;
+    }
+    m_taken += got;
+    return got;
+}
+
+void sirius_slab::put(free_t *head, free_t *tail, size_t n)
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    tail->next = m_free;
+    m_free = head;
+    m_taken -= n;
+}
+
+sirius_slab_cache::~sirius_slab_cache()
+{
+    if (m_cached) {
+        drain(m_cached);
+    }
+}
+
+bool sirius_slab_cache::refill()
+{
+    m_cached += m_slab.get(m_free, sirius_slab::BATCH);
+    return m_free != nullptr;
+}
+
+void sirius_slab_cache::drain(size_t n)
+{
+    sirius_slab::free_t *head = m_free;
+    sirius_slab::free_t *tail = head;
+    for (size_t i = 1; i < n; i++) {
+        tail = tail->next;
+    }
+    m_free = tail->next;
+    m_cached -= n;
+    m_slab.put(head, tail, n);
+}
+
+} // namespace sirius
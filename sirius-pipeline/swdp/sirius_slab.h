@@ -0,0 +1,134 @@
+#ifndef _SIRIUS_SLAB_H_
+#define _SIRIUS_SLAB_H_
+
+#include <cstddef>
+#include <mutex>
+
+#include "sirius_memory.h"
+
+namespace sirius {
+
+/*
+ * Pool of fixed-size blocks for state the data path allocates per
+ * connection, the aging timers (sirius_flow_aging), so that creating a
+ * connection never calls into malloc.
+ *
+ * All blocks are one sirius_mapping made with the pool, on the pages and
+ * NUMA node its placement asks for: on default pages blocks cost memory
+ * only once used, huge pages are reserved up front. The pool never
+ * grows, so a block costs the same whether it is the first or the last. Workers do
+ * not take blocks one by one from the pool but through their own
+ * sirius_slab_cache, which moves them BATCH at a time, so the pool's lock
+ * is taken once per BATCH blocks and never contended on the way of a
+ * packet.
+ */
+class sirius_slab {
+public:
+    /* Blocks a cache takes from or gives back to the pool at once */
+    static constexpr size_t BATCH = 32;
+
+    /* `blocks` blocks of `block_size` bytes, a multiple of 64 */
+    sirius_slab(size_t block_size, size_t blocks, const memory_placement_t &placement = {});
+
+    sirius_slab(const sirius_slab &) = delete;
+    sirius_slab &operator=(const sirius_slab &) = delete;
+
+    size_t block_size() const { return m_block_size; }
+
+    size_t blocks() const { return m_blocks; }
+
+    /* Blocks handed to caches, in use or free in a cache */
+    size_t taken() const;
+
+    /* Bytes reserved for the blocks */
+    size_t memory() const { return m_block_size * m_blocks; }
+
+    /* Where the blocks went */
+    const memory_placement_t &placement() const { return m_mapping.placement(); }
+
+private:
+    friend class sirius_slab_cache;
+
+    struct free_t {
+        free_t *next;
+    };
+
+    /* Links up to n free blocks into *head, returns how many; fewer when the pool runs out */
+    size_t get(free_t *&head, size_t n);
+
+    /* Takes back the n blocks from head to tail */
+    void put(free_t *head, free_t *tail, size_t n);
+
+    size_t m_block_size;
+    size_t m_blocks;
+    sirius_mapping m_mapping;
+    char *m_memory;
+
+    mutable std::mutex m_lock;
+    free_t *m_free = nullptr; /* blocks given back */
+    size_t m_next = 0;        /* blocks from here on were never handed out */
+    size_t m_taken = 0;
+};
+
+/*
+ * One worker's blocks of a sirius_slab: allocates from its own free list,
+ * refilled from the pool BATCH blocks at a time, and gives BATCH back
+ * when it holds twice that, so blocks freed on one worker serve the
+ * others. Not thread safe, like everything else a worker owns.
+ */
+class sirius_slab_cache {
+public:
+    explicit sirius_slab_cache(sirius_slab &slab) : m_slab(slab) {}
+    ~sirius_slab_cache();
+
+    sirius_slab_cache(const sirius_slab_cache &) = delete;
+    sirius_slab_cache &operator=(const sirius_slab_cache &) = delete;
+
+    /* A block of block_size() bytes, nullptr when the pool has none left */
+    void *alloc()
+    {
+        if (!m_free && !refill()) {
+            return nullptr;
+        }
+        sirius_slab::free_t *block = m_free;
+        m_free = block->next;
+        m_cached--;
+        m_in_use++;
+        return block;
+    }
+
+    void free(void *block)
+    {
+        auto *b = static_cast<sirius_slab::free_t *>(block);
+        b->next = m_free;
+        m_free = b;
+        m_cached++;
+        m_in_use--;
+        if (m_cached >= 2 * sirius_slab::BATCH) {
+            drain(sirius_slab::BATCH);
+        }
+    }
+
+    size_t block_size() const { return m_slab.block_size(); }
+
+    /* Blocks allocated and not freed */
+    size_t in_use() const { return m_in_use; }
+
+    /* Free blocks held for the next allocations */
+    size_t cached() const { return m_cached; }
+
+private:
+    bool refill();
+
+    /* Gives n of the cached blocks back to the pool */
+    void drain(size_t n);
+
+    sirius_slab &m_slab;
+    sirius_slab::free_t *m_free = nullptr;
+    size_t m_cached = 0;
+    size_t m_in_use = 0;
+};
+
+} // namespace sirius
+
+#endif /* _SIRIUS_SLAB_H_ */
@@ -0,0 +1,205 @@
+#ifndef _SIRIUS_SWITCH_H_
+#define _SIRIUS_SWITCH_H_
+
+#include <atomic>
+#include <bitset>
+#include <mutex>
+
+#include "sirius_acl_table.h"
+#include "sirius_ca_to_pa.h"
+#include "sirius_counters.h"
+#include "sirius_flow_table.h"
+#include "sirius_generations.h"
+#include "sirius_memory.h"
+#include "sirius_routing.h"
+#include "sirius_table.h"
+#include "sirius_types.h"
+#include "sirius_vxlan.h"
+
+namespace sirius {
+
+/*
+ * Keys and action data of every table in sirius_pipeline.p4, in host
+ * byte order. Field names follow the P4 action parameters.
+ */
+
+struct direction_lookup_entry_t {
+    direction_t direction;
+};
+
+struct appliance_entry_t {
+    mac_t neighbor_mac;
+    mac_t mac;
+    ipv4_addr_t ip;
+    /* Idle timeouts of the connection table in milliseconds, 0 for none */
+    uint32_t tcp_flow_timeout = 240000;
+    uint32_t udp_flow_timeout = 1000;
+    /* Outer UDP source port of each flow, vxlan_src_port(); the range of RFC 7348 by default */
+    vxlan_sport_hash_t encap_sport_hash = VXLAN_SPORT_HASH_CRC32;
+    uint16_t encap_sport_min = 49152;
+    uint16_t encap_sport_max = 65535;
+    /* Drop packets with a wrong inner IPv4, TCP or UDP checksum, unless the NIC checked them */
+    bool verify_inner_checksum = false;
+    /* Outer headers of vxlan_encap from mac and ip, compiled by appliance_compile() */
+    vxlan_template_t encap;
+};
+
+/* Compiles what the data path takes from the appliance, whenever it is set */
+inline void appliance_compile(appliance_entry_t &appliance)
+{
+    vxlan_template(appliance.encap, appliance.mac, appliance.ip);
+}
+
+struct eni_entry_t {
+    uint16_t eni;
+};
+
+struct eni_to_vni_entry_t {
+    uint32_t vni;
+};
+
+struct eni_to_vm_entry_t {
+    uint16_t vm_id;
+};
+
+struct vm_entry_t {
+    mac_t underlay_dmac;
+    ipv4_addr_t underlay_dip;
+    uint32_t vni;
+};
+
+struct eni_meter_key_t {
+    uint16_t eni;
+    uint16_t direction;
+    uint16_t dropped;
+
+    bool operator==(const eni_meter_key_t &o) const
+    {
+        return eni == o.eni && direction == o.direction && dropped == o.dropped;
+    }
+};
+
+struct eni_meter_key_hash {
+    size_t operator()(const eni_meter_key_t &k) const
+    {
+        return hash_mix((uint64_t)k.eni << 32 | (uint32_t)k.direction << 16 | k.dropped);
+    }
+};
+
+struct eni_meter_entry_t {
+};
+
+/* eni_counter has a slot for every eni_meter key a packet can match */
+constexpr size_t ENI_COUNTER_SLOTS = 65536 * 4;
+
+inline uint32_t eni_counter_slot(uint16_t eni, direction_t direction, bool dropped)
+{
+    return (uint32_t)eni << 2 | (uint32_t)(direction == DIRECTION_INBOUND) << 1 | (uint32_t)dropped;
+}
+
+/* Allocator for the small index spaces behind object ids (appliance_id, vm_id) */
+template <size_t N>
+class sirius_id_pool {
+public:
+    bool alloc(uint32_t &id)
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        for (size_t i = 0; i < N; i++) {
+            size_t candidate = (m_next + i) % N;
+            if (!m_used.test(candidate)) {
+                m_used.set(candidate);
+                m_next = candidate + 1;
+                id = (uint32_t)candidate;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void free(uint32_t id)
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        m_used.reset(id);
+    }
+
+    bool used(uint32_t id) const
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        return id < N && m_used.test(id);
+    }
+
+private:
+    mutable std::mutex m_lock;
+    std::bitset<N> m_used;
+    size_t m_next = 0;
+};
+
+/*
+ * State of one DASH switch: every table of sirius_pipeline.p4, as
+ * programmed through the sai__api_t functions.
+ */
+class sirius_switch {
+public:
+    static constexpr unsigned ACL_STAGES = 3;
+
+    /* One epoch over routing_counter and ca_to_pa_counter, for get_outbound_counters_snapshot */
+    sirius_switch() { ca_to_pa.counters().share_epoch(routing.counters()); }
+
+    sirius_table<uint32_t, direction_lookup_entry_t> direction_lookup;
+    sirius_table<uint8_t, appliance_entry_t> appliance;
+    sirius_id_pool<256> appliance_ids;
+
+    /* outbound */
+    sirius_table<mac_t, eni_entry_t> eni_lookup_from_vm;
+    sirius_table<uint16_t, eni_to_vni_entry_t> eni_to_vni;
+    sirius_acl_table outbound_acl[ACL_STAGES];
+    sirius_routing routing;
+    sirius_ca_to_pa ca_to_pa;
+
+    /* inbound */
+    sirius_table<mac_t, eni_entry_t> eni_lookup_to_vm;
+    sirius_table<uint16_t, eni_to_vm_entry_t> eni_to_vm;
+    sirius_table<uint16_t, vm_entry_t> vm;
+    sirius_id_pool<65536> vm_ids;
+    sirius_acl_table inbound_acl[ACL_STAGES];
+
+    /* ConntrackOut and ConntrackIn, written by the data path */
+    sirius_flow_table flows;
+
+    /* Where the tables above went, SAI_SWITCH_ATTR_TABLE_PAGE_SIZE and SAI_SWITCH_ATTR_TABLE_NUMA_NODE */
+    memory_placement_t table_placement;
+
+    /*
+     * SAI_SWITCH_ATTR_FLOW_TABLE_NUMA_LOCAL: a sirius_dataplane binds the
+     * flow table partition and flow cache of every worker to the node of
+     * the worker's core, on pages of table_placement's size.
+     */
+    bool flow_numa_local = false;
+
+    /*
+     * Moves ca_to_pa, the routing tries and flows to memory placed as
+     * placement asks, when the switch is created. False, changing nothing,
+     * once routing or flows hold entries.
+     */
+    bool place(const memory_placement_t &placement, bool numa_local)
+    {
+        if (flows.size() || !routing.set_placement(placement)) {
+            return false;
+        }
+        flows.place(placement);
+        ca_to_pa.set_placement(placement);
+        table_placement = placement;
+        flow_numa_local = numa_local;
+        return true;
+    }
+
+    sirius_table<eni_meter_key_t, eni_meter_entry_t, eni_meter_key_hash> eni_meter;
+    sirius_counters eni_counters{ ENI_COUNTER_SLOTS }; /* eni_counter of eni_meter, written by the data path */
+
+    /* Generations of the tables above, bumped after every write through the DASH API */
+    sirius_generations generations;
+};
+
+} // namespace sirius
+
+#endif /* _SIRIUS_SWITCH_H_ */
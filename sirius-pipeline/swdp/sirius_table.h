@@ -0,0 +1,121 @@
+#ifndef _SIRIUS_TABLE_H_
+#define _SIRIUS_TABLE_H_
+
+#include <algorithm>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+extern "C" {
+#include <saitypes.h>
+#include <saistatus.h>
+}
+
+#include "sirius_rcu.h"
+
+namespace sirius {
+
+/*
+ * Exact match table backing one P4 table of the pipeline.
+ *
+ * Control plane writes take the table lock exclusively, data path
+ * lookups read under it without writing to it (rcu_rw_lock), so workers
+ * on different cores look up without contending. Bulk operations go
+ * through batch(), which holds the lock once for the whole batch instead
+ * of once per entry.
+ */
+template <typename K, typename V, typename H = std::hash<K>>
+class sirius_table {
+public:
+    using key_type = K;
+    using value_type = V;
+
+    /* Writer handle passed to batch(); only valid inside the callback */
+    class writer {
+    public:
+        explicit writer(std::unordered_map<K, V, H> &entries) : m_entries(entries) {}
+
+        sai_status_t insert(const K &key, const V &value)
+        {
+            return m_entries.emplace(key, value).second ? SAI_STATUS_SUCCESS : SAI_STATUS_ITEM_ALREADY_EXISTS;
+        }
+
+        sai_status_t remove(const K &key)
+        {
+            return m_entries.erase(key) ? SAI_STATUS_SUCCESS : SAI_STATUS_ITEM_NOT_FOUND;
+        }
+
+        V *find(const K &key)
+        {
+            auto it = m_entries.find(key);
+            return it == m_entries.end() ? nullptr : &it->second;
+        }
+
+        /* Grow geometrically so back to back batches do not rehash every time */
+        void reserve(size_t count)
+        {
+            size_t want = m_entries.size() + count;
+            if (want > m_entries.bucket_count() * m_entries.max_load_factor()) {
+                m_entries.reserve(std::max(want, 2 * m_entries.size()));
+            }
+        }
+
+    private:
+        std::unordered_map<K, V, H> &m_entries;
+    };
+
+    sai_status_t insert(const K &key, const V &value)
+    {
+        std::lock_guard<rcu_rw_lock> lock(m_lock);
+        return writer(m_entries).insert(key, value);
+    }
+
+    sai_status_t remove(const K &key)
+    {
+        std::lock_guard<rcu_rw_lock> lock(m_lock);
+        return writer(m_entries).remove(key);
+    }
+
+    bool lookup(const K &key, V &value) const
+    {
+        return m_lock.read([&] {
+            auto it = m_entries.find(key);
+            if (it == m_entries.end()) {
+                return false;
+            }
+            value = it->second;
+            return true;
+        });
+    }
+
+    /* Control plane lookup of many keys under one hold of the lock: found[i] is whether keys[i] is in the table */
+    void contains(const K *keys, size_t count, bool *found) const
+    {
+        std::shared_lock<rcu_rw_lock> lock(m_lock);
+        for (size_t i = 0; i < count; i++) {
+            found[i] = m_entries.count(keys[i]) != 0;
+        }
+    }
+
+    template <typename Fn>
+    void batch(Fn &&fn)
+    {
+        std::lock_guard<rcu_rw_lock> lock(m_lock);
+        writer w(m_entries);
+        fn(w);
+    }
+
+    size_t size() const
+    {
+        std::shared_lock<rcu_rw_lock> lock(m_lock);
+        return m_entries.size();
+    }
+
+private:
+    mutable rcu_rw_lock m_lock;
+    std::unordered_map<K, V, H> m_entries;
+};
+
+} // namespace sirius
+
+#endif /* _SIRIUS_TABLE_H_ */
@@ -0,0 +1,52 @@
+#ifndef _SIRIUS_TYPES_H_
+#define _SIRIUS_TYPES_H_
+
+#include <cstdint>
+#include <cstring>
+
+namespace sirius {
+
+/* bit<48> EthernetAddress, first octet in the most significant byte */
+typedef uint64_t mac_t;
+
+/* IPv4Address in host byte order */
+typedef uint32_t ipv4_addr_t;
+
+/* Mirrors direction_t in sirius_metadata.p4 */
+enum direction_t : uint8_t {
+    DIRECTION_INVALID = 0,
+    DIRECTION_OUTBOUND = 1,
+    DIRECTION_INBOUND = 2,
+};
+
+static inline mac_t mac_from_bytes(const uint8_t *bytes)
+{
+    mac_t mac = 0;
+    for (int i = 0; i < 6; i++) {
+        mac = (mac << 8) | bytes[i];
+    }
+    return mac;
+}
+
+static inline void mac_to_bytes(mac_t mac, uint8_t *bytes)
+{
+    for (int i = 5; i >= 0; i--) {
+        bytes[i] = (uint8_t)mac;
+        mac >>= 8;
+    }
+}
+
+/* 64-bit finalizer (murmur3 fmix64), good enough to spread table keys */
+static inline uint64_t hash_mix(uint64_t h)
+{
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+} // namespace sirius
+
+#endif /* _SIRIUS_TYPES_H_ */
@@ -0,0 +1,174 @@
+#include "sirius_vxlan.h"
+
+#include <cstddef>
+#include <cstring>
+
+#include "sirius_checksum.h"
+#include "sirius_hash.h"
+
+namespace sirius {
+
+namespace {
+
+template <typename H>
+void rebase(H *&h, ptrdiff_t delta)
+{
+    if (h) {
+        h = reinterpret_cast<H *>(reinterpret_cast<uint8_t *>(h) + delta);
+    }
+}
+
+/* Moves the frame back to PACKET_HEADROOM when a previous decap/encap ate the headroom */
+bool make_headroom(packet_t &pkt, headers_t &hdr)
+{
+    if (pkt.data_off >= VXLAN_ENCAP_SIZE) {
+        return true;
+    }
+    if (PACKET_HEADROOM + pkt.len > pkt.buf_size) {
+        return false;
+    }
+
+    ptrdiff_t delta = (ptrdiff_t)PACKET_HEADROOM - (ptrdiff_t)pkt.data_off;
+    memmove(pkt.buf + PACKET_HEADROOM, pkt.data(), pkt.len);
+    pkt.data_off = PACKET_HEADROOM;
+
+    rebase(hdr.ethernet, delta);
+    rebase(hdr.ipv4, delta);
+    rebase(hdr.ipv6, delta);
+    rebase(hdr.udp, delta);
+    rebase(hdr.tcp, delta);
+    rebase(hdr.vxlan, delta);
+    rebase(hdr.inner_ethernet, delta);
+    rebase(hdr.inner_ipv4, delta);
+    rebase(hdr.inner_ipv6, delta);
+    rebase(hdr.inner_udp, delta);
+    rebase(hdr.inner_tcp, delta);
+    return true;
+}
+
+} // namespace
+
+void vxlan_template(vxlan_template_t &tmpl, mac_t underlay_smac, ipv4_addr_t underlay_sip)
+{
+    memset(&tmpl, 0, sizeof(tmpl));
+    mac_to_bytes(underlay_smac, tmpl.ethernet.src_addr);
+    tmpl.ethernet.ether_type = htons(IPV4_ETHTYPE);
+
+    tmpl.ipv4.version_ihl = 4 << 4 | 5;
+    tmpl.ipv4.identification = htons(1);
+    tmpl.ipv4.ttl = 64;
+    tmpl.ipv4.protocol = UDP_PROTO;
+    tmpl.ipv4.src_addr = htonl(underlay_sip);
+
+    tmpl.ipv4.hdr_checksum = checksum(&tmpl.ipv4, IPV4_HDR_SIZE);
+
+    tmpl.udp.dst_port = htons(UDP_PORT_VXLAN);
+}
+
+void vxlan_flow(vxlan_flow_t &flow, mac_t underlay_dmac, ipv4_addr_t underlay_dip, mac_t overlay_dmac, uint32_t vni,
+                uint16_t src_port)
+{
+    mac_to_bytes(underlay_dmac, flow.underlay_dmac);
+    mac_to_bytes(overlay_dmac, flow.overlay_dmac);
+    flow.underlay_dip = htonl(underlay_dip);
+    flow.src_port = htons(src_port);
+    flow.vni[0] = (uint8_t)(vni >> 16);
+    flow.vni[1] = (uint8_t)(vni >> 8);
+    flow.vni[2] = (uint8_t)vni;
+}
+
+uint16_t vxlan_src_port(vxlan_sport_hash_t hash, uint16_t port_min, uint16_t port_max, uint32_t sip, uint32_t dip,
+                        uint16_t sport, uint16_t dport, uint8_t protocol)
+{
+    /* The inner flow as RSS takes it: addresses, then ports */
+    uint8_t tuple[13];
+    memcpy(tuple, &sip, 4);
+    memcpy(tuple + 4, &dip, 4);
+    memcpy(tuple + 8, &sport, 2);
+    memcpy(tuple + 10, &dport, 2);
+    tuple[12] = protocol;
+
+    uint32_t h;
+    switch (hash) {
+    case VXLAN_SPORT_HASH_CRC32:
+        h = crc32c(tuple, sizeof(tuple));
+        break;
+    case VXLAN_SPORT_HASH_TOEPLITZ:
+        h = toeplitz_hash(tuple, 12);
+        break;
+    default:
+        return port_min;
+    }
+    /* Onto the range without a division, the hash's upper bits pick the port */
+    return (uint16_t)(port_min + ((uint64_t)h * ((uint32_t)port_max - port_min + 1) >> 32));
+}
+
+bool vxlan_encap(packet_t &pkt, headers_t &hdr, const vxlan_template_t &tmpl, const vxlan_flow_t &flow,
+                 bool offload_checksum)
+{
+    if (!hdr.ethernet || !make_headroom(pkt, hdr)) {
+        return false;
+    }
+
+    hdr.inner_ethernet = hdr.ethernet;
+    memcpy(hdr.inner_ethernet->dst_addr, flow.overlay_dmac, sizeof(flow.overlay_dmac));
+    hdr.inner_ipv4 = hdr.ipv4;
+    hdr.inner_ipv6 = hdr.ipv6;
+    hdr.inner_tcp = hdr.tcp;
+    hdr.inner_udp = hdr.udp;
+    hdr.ipv6 = nullptr;
+    hdr.tcp = nullptr;
+
+    uint16_t inner_len = 0;
+    if (hdr.inner_ipv4) {
+        inner_len = ntohs(hdr.inner_ipv4->total_len);
+    } else if (hdr.inner_ipv6) {
+        inner_len = ntohs(hdr.inner_ipv6->payload_length) + IPV6_HDR_SIZE;
+    }
+
+    pkt.data_off -= VXLAN_ENCAP_SIZE;
+    pkt.len += VXLAN_ENCAP_SIZE;
+    auto outer = reinterpret_cast<vxlan_template_t *>(pkt.data());
+    memcpy(outer, &tmpl, sizeof(tmpl));
+
+    memcpy(outer->ethernet.dst_addr, flow.underlay_dmac, sizeof(flow.underlay_dmac));
+    outer->ipv4.total_len = htons(inner_len + VXLAN_ENCAP_SIZE);
+    outer->ipv4.dst_addr = flow.underlay_dip;
+    outer->udp.src_port = flow.src_port;
+    outer->udp.length = htons(inner_len + UDP_HDR_SIZE + VXLAN_HDR_SIZE + ETHER_HDR_SIZE);
+    memcpy(outer->vxlan.vni, flow.vni, sizeof(flow.vni));
+
+    if (offload_checksum) {
+        outer->ipv4.hdr_checksum = 0;
+        pkt.ol_flags |= PACKET_TX_IPV4_CSUM;
+    } else {
+        outer->ipv4.hdr_checksum =
+            checksum_adjust(tmpl.ipv4.hdr_checksum, (uint64_t)outer->ipv4.total_len + flow.underlay_dip);
+        pkt.ol_flags &= (uint8_t)~PACKET_TX_IPV4_CSUM;
+    }
+
+    hdr.ethernet = &outer->ethernet;
+    hdr.ipv4 = &outer->ipv4;
+    hdr.udp = &outer->udp;
+    hdr.vxlan = &outer->vxlan;
+    return true;
+}
+
+void vxlan_decap(packet_t &pkt, headers_t &hdr)
+{
+    uint32_t outer_len = (uint32_t)(reinterpret_cast<uint8_t *>(hdr.inner_ethernet) - pkt.data());
+    pkt.data_off += outer_len;
+    pkt.len -= outer_len;
+
+    hdr.ethernet = hdr.inner_ethernet;
+    hdr.inner_ethernet = nullptr;
+    hdr.ipv4 = hdr.inner_ipv4;
+    hdr.inner_ipv4 = nullptr;
+    hdr.vxlan = nullptr;
+    hdr.tcp = hdr.inner_tcp;
+    hdr.inner_tcp = nullptr;
+    hdr.udp = hdr.inner_udp;
+    hdr.inner_udp = nullptr;
+}
+
+} // namespace sirius
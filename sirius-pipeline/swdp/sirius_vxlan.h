@@ -0,0 +1,91 @@
+#ifndef _SIRIUS_VXLAN_H_
+#define _SIRIUS_VXLAN_H_
+
+#include "sirius_headers.h"
+#include "sirius_packet.h"
+
+namespace sirius {
+
+/* Ethernet + IPv4 + UDP + VXLAN prepended by vxlan_encap */
+constexpr uint32_t VXLAN_ENCAP_SIZE = ETHER_HDR_SIZE + IPV4_HDR_SIZE + UDP_HDR_SIZE + VXLAN_HDR_SIZE;
+
+/*
+ * The outer headers vxlan_encap prepends, for one appliance: its MAC and
+ * IP as underlay source, and the fields every encap writes the same. The
+ * control plane compiles it into the appliance's entry when the
+ * appliance is set (appliance_entry_t), the encap copies it in front of
+ * the frame. The IPv4 header checksum is that of the template, with
+ * length and destination 0, for the encap to adjust.
+ */
+struct __attribute__((packed)) vxlan_template_t {
+    ethernet_t ethernet;
+    ipv4_t ipv4;
+    udp_t udp;
+    vxlan_t vxlan;
+};
+
+static_assert(sizeof(vxlan_template_t) == VXLAN_ENCAP_SIZE, "the outer headers, back to back");
+
+void vxlan_template(vxlan_template_t &tmpl, mac_t underlay_smac, ipv4_addr_t underlay_sip);
+
+/*
+ * The rest of vxlan_encap's parameters, those of one flow, as they go on
+ * the wire: the slow path compiles them once from the ENI's VNI, the
+ * ca_to_pa mapping or the VM and the inner headers, and the flow cache
+ * keeps them.
+ */
+struct __attribute__((packed)) vxlan_flow_t {
+    uint8_t underlay_dmac[6];
+    uint8_t overlay_dmac[6];
+    uint32_t underlay_dip; /* network byte order */
+    uint16_t src_port;     /* network byte order */
+    uint8_t vni[3];
+};
+
+void vxlan_flow(vxlan_flow_t &flow, mac_t underlay_dmac, ipv4_addr_t underlay_dip, mac_t overlay_dmac, uint32_t vni,
+                uint16_t src_port);
+
+/* Hash of the inner headers behind the outer UDP source port */
+enum vxlan_sport_hash_t : uint8_t {
+    VXLAN_SPORT_HASH_NONE,     /* the lowest port of the range for every flow */
+    VXLAN_SPORT_HASH_CRC32,    /* CRC-32C of the inner 5-tuple */
+    VXLAN_SPORT_HASH_TOEPLITZ, /* RSS Toeplitz hash of the inner addresses and ports */
+};
+
+/*
+ * The outer UDP source port of a flow (RFC 7348 5): a hash of the inner
+ * headers mapped onto [port_min, port_max], so the underlay's ECMP and
+ * the receivers' RSS spread the flows of a tunnel like the flows
+ * themselves, and all packets of a flow take the same path. port_min is
+ * at most port_max, the appliance rejects other ranges. Addresses and
+ * ports in network byte order, ports 0 without TCP or UDP; host byte
+ * order result.
+ */
+uint16_t vxlan_src_port(vxlan_sport_hash_t hash, uint16_t port_min, uint16_t port_max, uint32_t sip, uint32_t dip,
+                        uint16_t sport, uint16_t dport, uint8_t protocol);
+
+/*
+ * vxlan_encap of sirius_vxlan.p4, with the underlay source of tmpl. The
+ * current headers become the inner headers and the outer headers are
+ * copied into the headroom in front of them, then given the flow's
+ * fields and the lengths. Returns false if the buffer has no room for
+ * the outer headers; a frame with less than VXLAN_ENCAP_SIZE bytes of
+ * headroom is first moved back to PACKET_HEADROOM.
+ *
+ * The outer IPv4 header checksum is the template's, adjusted for the
+ * length and destination (RFC 1624), or with offload_checksum 0 and
+ * PACKET_TX_IPV4_CSUM set for the NIC to fill in. The outer UDP checksum
+ * is 0, which RFC 7348 allows over IPv4.
+ */
+bool vxlan_encap(packet_t &pkt, headers_t &hdr, const vxlan_template_t &tmpl, const vxlan_flow_t &flow,
+                 bool offload_checksum = false);
+
+/*
+ * vxlan_decap of sirius_vxlan.p4, needs a valid inner_ethernet; the packet
+ * now starts there, the outer headers stay in the headroom
+ */
+void vxlan_decap(packet_t &pkt, headers_t &hdr);
+
+} // namespace sirius
+
+#endif /* _SIRIUS_VXLAN_H_ */